@@ -0,0 +1,394 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <new>
+#include "xtechnical_indicators.hpp"
+#include "xtechnical_bench.hpp"
+
+/* замеры производительности индикаторов: update, test и пакетные методы
+ * для нескольких периодов и типов float/double
+ *
+ * пример:
+ * bench_indicators --benchmark_out=base.json
+ * bench_indicators --benchmark_filter=SMA --baseline=base.json
+ */
+
+/* подсчет выделений памяти */
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+void *operator new(std::size_t size) {
+    ++xtechnical::bench::allocations();
+    if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+BENCH_NOINLINE void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace xtechnical;
+using namespace xtechnical::bench;
+
+static const size_t PRICES_SIZE = 20000;
+static const size_t periods[] = {10, 50, 200};
+
+template<class T>
+std::vector<T> make_prices() {
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.0002);
+    std::vector<T> prices;
+    double price = 1.1;
+    for (size_t i = 0; i < PRICES_SIZE; ++i) {
+        price += noise(gen);
+        prices.push_back((T)price);
+    }
+    return prices;
+}
+
+/* бары OHLC: по 4 цены на бар */
+template<class T>
+struct Bars {
+    std::vector<T> open, high, low, close;
+};
+
+template<class T>
+Bars<T> make_bars(const std::vector<T> &prices) {
+    Bars<T> bars;
+    for (size_t i = 0; i + 4 <= prices.size(); i += 4) {
+        bars.open.push_back(prices[i]);
+        bars.high.push_back(std::max(std::max(prices[i], prices[i + 1]), std::max(prices[i + 2], prices[i + 3])));
+        bars.low.push_back(std::min(std::min(prices[i], prices[i + 1]), std::min(prices[i + 2], prices[i + 3])));
+        bars.close.push_back(prices[i + 3]);
+    }
+    return bars;
+}
+
+/* лестница цен для test_many: n цен с шагом 0.00001 вокруг center */
+template<class T>
+std::vector<T> make_ladder(const T center, const size_t n) {
+    std::vector<T> ladder(n);
+    for (size_t i = 0; i < n; ++i) {
+        ladder[i] = (T)((double)center + ((double)i - (double)(n / 2)) * 0.00001);
+    }
+    return ladder;
+}
+
+template<class T>
+std::vector<T> make_weights(const size_t n) {
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<double> unif(-1.0, 1.0);
+    std::vector<T> weights(n);
+    for (auto &w : weights) w = (T)unif(gen);
+    return weights;
+}
+
+/** \brief Замеры update и test для индикатора с входом high, low, close
+ */
+template<class IND, class T, class MAKE>
+void run_hlc(Runner &runner, const std::string &name, const Bars<T> &bars, MAKE make) {
+    IND ind = make();
+    const size_t n = bars.close.size();
+    /* сумма выходов не дает компилятору выбросить цикл */
+    volatile double sink = 0;
+    runner.run(name + "/hlc/update", n, [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            ind.update(bars.high[i], bars.low[i], bars.close[i]);
+            sum += (double)ind.get();
+        }
+        sink = sink + sum;
+    });
+    runner.run(name + "/hlc/test", n, [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            ind.test(bars.high[i], bars.low[i], bars.close[i]);
+            sum += (double)ind.get();
+        }
+        sink = sink + sum;
+    });
+}
+
+/** \brief Замер test_many для лестницы цен после прогрева на prices
+ */
+template<class IND, class T, class MAKE>
+void run_test_many(Runner &runner, const std::string &name, const std::vector<T> &prices, const std::vector<T> &ladder, MAKE make) {
+    IND ind = make();
+    for (const T &p : prices) update(ind, p);
+    std::vector<T> out(ladder.size());
+    runner.run(name + "/test_many", ladder.size(), [&]() {
+        ind.test_many(ladder.data(), ladder.size(), out.data());
+    });
+}
+
+template<class T, size_t N>
+void bench_fixed(Runner &runner, const std::string &type_name, const std::vector<T> &prices) {
+    const std::string s = "<" + type_name + ">/" + std::to_string(N);
+    run_indicator<fixed::SMA<T, N>>(runner, "fixed::SMA" + s, prices, [&]{ return fixed::SMA<T, N>(); });
+    run_indicator<fixed::EMA<T, N>>(runner, "fixed::EMA" + s, prices, [&]{ return fixed::EMA<T, N>(); });
+    run_indicator<fixed::RSI<T, N>>(runner, "fixed::RSI" + s, prices, [&]{ return fixed::RSI<T, N>(); });
+    run_indicator<fixed::StdDev<T, N>>(runner, "fixed::StdDev" + s, prices, [&]{ return fixed::StdDev<T, N>(); });
+    run_indicator<fixed::BollingerBands<T, N>>(runner, "fixed::BollingerBands" + s, prices, [&]{ return fixed::BollingerBands<T, N>(2); });
+    run_indicator<fixed::FastMinMax<T, N>>(runner, "fixed::FastMinMax" + s, prices, [&]{ return fixed::FastMinMax<T, N>(); });
+}
+
+template<class T>
+void bench_crsi(Runner &runner, const std::string &s, const std::vector<T> &prices, const size_t p) {
+    run_indicator<CRSI<T, SMA<T>>>(runner, "CRSI" + s, prices, [&]{ return CRSI<T, SMA<T>>(3, 2, p); });
+}
+
+/* CRSI<float> не компилируется: combined_tolerance_compare использует std::max для double */
+void bench_crsi(Runner &, const std::string &, const std::vector<float> &, const size_t) {}
+
+template<class T>
+void bench_indicators(Runner &runner, const std::string &type_name) {
+    const std::vector<T> prices = make_prices<T>();
+    const Bars<T> bars = make_bars(prices);
+    const std::vector<T> ladder = make_ladder(prices.back(), 201);
+    {
+        const std::string s = "<" + type_name + ">";
+        run_indicator<TrueRange<T>>(runner, "TrueRange" + s, prices, [&]{ return TrueRange<T>(); });
+        run_hlc<TrueRange<T>>(runner, "TrueRange" + s, bars, [&]{ return TrueRange<T>(); });
+    }
+    for (const size_t p : periods) {
+        const std::string s = "<" + type_name + ">/" + std::to_string(p);
+        run_indicator<SMA<T>>(runner, "SMA" + s, prices, [&]{ return SMA<T>(p); });
+        run_indicator<EMA<T>>(runner, "EMA" + s, prices, [&]{ return EMA<T>(p); });
+        run_indicator<WMA<T>>(runner, "WMA" + s, prices, [&]{ return WMA<T>(p); });
+        run_indicator<MMA<T>>(runner, "MMA" + s, prices, [&]{ return MMA<T>(p); });
+        run_indicator<SUM<T>>(runner, "SUM" + s, prices, [&]{ return SUM<T>(p); });
+        run_indicator<LRMA<T>>(runner, "LRMA" + s, prices, [&]{ return LRMA<T>(p); });
+        run_indicator<AMA<T>>(runner, "AMA" + s, prices, [&]{ return AMA<T>(p); });
+        run_indicator<NoLagMa<T>>(runner, "NoLagMa" + s, prices, [&]{ return NoLagMa<T>(p); });
+        run_indicator<MAV<T>>(runner, "MAV" + s, prices, [&]{ return MAV<T>(p); });
+        run_indicator<MAZ<T>>(runner, "MAZ" + s, prices, [&]{ return MAZ<T>(p, p); });
+        run_indicator<RSI<T, SMA<T>>>(runner, "RSI" + s, prices, [&]{ return RSI<T, SMA<T>>(p); });
+        run_indicator<StdDev<T>>(runner, "StdDev" + s, prices, [&]{ return StdDev<T>(p); });
+        run_indicator<Zscore<T>>(runner, "Zscore" + s, prices, [&]{ return Zscore<T>(p); });
+        run_indicator<BollingerBands<T>>(runner, "BollingerBands" + s, prices, [&]{ return BollingerBands<T>(p, 2); });
+        run_indicator<MinMax<T>>(runner, "MinMax" + s, prices, [&]{ return MinMax<T>(p); });
+        run_indicator<FastMinMax<T>>(runner, "FastMinMax" + s, prices, [&]{ return FastMinMax<T>(p); });
+        run_indicator<MinMaxDiff<T>>(runner, "MinMaxDiff" + s, prices, [&]{ return MinMaxDiff<T>(p); });
+        run_indicator<PercentRank<T>>(runner, "PercentRank" + s, prices, [&]{ return PercentRank<T>(p, false); });
+        run_indicator<PRI<T>>(runner, "PRI" + s, prices, [&]{ return PRI<T>(p); });
+        run_indicator<RoC<T>>(runner, "RoC" + s, prices, [&]{ return RoC<T>(p); });
+        run_indicator<PercentDifference<T>>(runner, "PercentDifference" + s, prices, [&]{ return PercentDifference<T>(p); });
+        run_indicator<DelayLine<T>>(runner, "DelayLine" + s, prices, [&]{ return DelayLine<T>(p); });
+        run_indicator<RollingRegression<T>>(runner, "RollingRegression" + s, prices, [&]{ return RollingRegression<T>(p); });
+        run_indicator<TrendDirectionForceIndex<T, EMA<T>>>(runner, "TrendDirectionForceIndex" + s, prices,
+            [&]{ return TrendDirectionForceIndex<T, EMA<T>>(p); });
+        run_indicator<Stochastics<T, SMA<T>>>(runner, "Stochastics" + s, prices, [&]{ return Stochastics<T, SMA<T>>(p, 3, 3); });
+        bench_crsi(runner, s, prices, p);
+        run_indicator<OsMa<T>>(runner, "OsMa" + s, prices, [&]{ return OsMa<T>(p / 2, p, 9); });
+        run_indicator<DetectorWaveform<T>>(runner, "DetectorWaveform" + s, prices, [&]{ return DetectorWaveform<T>(p); });
+        run_indicator<ATR<T, SMA<T>>>(runner, "ATR" + s, prices, [&]{ return ATR<T, SMA<T>>(p); });
+        run_indicator<CCI<T, SMA<T>>>(runner, "CCI" + s, prices, [&]{ return CCI<T, SMA<T>>(p); });
+        run_indicator<SuperTrend<T, SMA<T>>>(runner, "SuperTrend" + s, prices, [&]{ return SuperTrend<T, SMA<T>>(p, p); });
+        run_indicator<FirFilter<T>>(runner, "FirFilter" + s, prices, [&]{ return FirFilter<T>(make_weights<T>(p)); });
+        run_indicator<BollingerBands<T>>(runner, "BollingerBands::with_factors" + s, prices,
+            [&]{ return BollingerBands<T>::with_factors(p, {1.0, 2.0, 2.5}); });
+
+        /* бары OHLC */
+        run_hlc<ATR<T, SMA<T>>>(runner, "ATR" + s, bars, [&]{ return ATR<T, SMA<T>>(p); });
+        run_hlc<SuperTrend<T, SMA<T>>>(runner, "SuperTrend" + s, bars, [&]{ return SuperTrend<T, SMA<T>>(p, p); });
+        {
+            BodyFilter<T, SMA<T>> ind(p);
+            const size_t n = bars.close.size();
+            runner.run("BodyFilter" + s + "/ohlc/update", n, [&]() {
+                for (size_t i = 0; i < n; ++i) ind.update(bars.open[i], bars.high[i], bars.low[i], bars.close[i]);
+            });
+            runner.run("BodyFilter" + s + "/ohlc/test", n, [&]() {
+                for (size_t i = 0; i < n; ++i) ind.test(bars.open[i], bars.high[i], bars.low[i], bars.close[i]);
+            });
+        }
+        {
+            FreqHist<T> ind(p, dft::RECTANGULAR_WINDOW);
+            std::vector<T> histogram;
+            runner.run("FreqHist" + s + "/update", prices.size(), [&]() {
+                for (const T &price : prices) ind.update(price, histogram);
+            });
+        }
+
+        /* test_many для лестницы цен */
+        run_test_many<SMA<T>>(runner, "SMA" + s, prices, ladder, [&]{ return SMA<T>(p); });
+        run_test_many<EMA<T>>(runner, "EMA" + s, prices, ladder, [&]{ return EMA<T>(p); });
+        run_test_many<MMA<T>>(runner, "MMA" + s, prices, ladder, [&]{ return MMA<T>(p); });
+        run_test_many<RSI<T, SMA<T>>>(runner, "RSI" + s, prices, ladder, [&]{ return RSI<T, SMA<T>>(p); });
+        run_test_many<StdDev<T>>(runner, "StdDev" + s, prices, ladder, [&]{ return StdDev<T>(p); });
+        run_test_many<CCI<T, SMA<T>>>(runner, "CCI" + s, prices, ladder, [&]{ return CCI<T, SMA<T>>(p); });
+        {
+            BollingerBands<T> ind(p, 2);
+            for (const T &price : prices) ind.update(price);
+            std::vector<T> tl(ladder.size()), ml(ladder.size()), bl(ladder.size());
+            runner.run("BollingerBands" + s + "/test_many", ladder.size(), [&]() {
+                ind.test_many(ladder.data(), ladder.size(), tl.data(), ml.data(), bl.data());
+            });
+        }
+        {
+            BollingerBands<T> ind = BollingerBands<T>::with_factors(p, {1.0, 2.0, 2.5});
+            for (const T &price : prices) ind.update(price);
+            std::vector<T> tl(ladder.size()), ml(ladder.size()), bl(ladder.size());
+            runner.run("BollingerBands::with_factors" + s + "/test_many", ladder.size(), [&]() {
+                ind.test_many(ladder.data(), ladder.size(), tl.data(), ml.data(), bl.data());
+            });
+        }
+        {
+            Stochastics<T, SMA<T>> ind(p, 3, 3);
+            for (const T &price : prices) ind.update(price);
+            std::vector<T> k(ladder.size()), d(ladder.size());
+            runner.run("Stochastics" + s + "/test_many", ladder.size(), [&]() {
+                ind.test_many(ladder.data(), ladder.size(), k.data(), d.data());
+            });
+        }
+
+        /* пакетные методы */
+        {
+            FirFilter<T> ind(make_weights<T>(p));
+            std::vector<T> out(prices.size());
+            runner.run("FirFilter" + s + "/batch", prices.size(), [&]() {
+                ind.update_many(prices.data(), prices.size(), out.data());
+            });
+        }
+    }
+    {
+        /* длинное ядро: update против update_many через БПФ */
+        const std::string s = "<" + type_name + ">/1024";
+        run_indicator<FirFilter<T>>(runner, "FirFilter" + s, prices, [&]{ return FirFilter<T>(make_weights<T>(1024)); });
+        FirFilter<T> ind(make_weights<T>(1024));
+        std::vector<T> out(prices.size());
+        runner.run("FirFilter" + s + "/batch", prices.size(), [&]() {
+            ind.update_many(prices.data(), prices.size(), out.data());
+        });
+    }
+    bench_fixed<T, 10>(runner, type_name, prices);
+    bench_fixed<T, 50>(runner, type_name, prices);
+    bench_fixed<T, 200>(runner, type_name, prices);
+}
+
+/* формирование баров из тиков */
+class BarSink {
+public:
+    double sum = 0;
+    void on_close_bar(const size_t, const BarShaperV1<double>::Bar &bar) {sum += bar.close;}
+    void on_unformed_bar(const size_t, const BarShaperV1<double>::Bar &) {}
+};
+
+void bench_bars(Runner &runner) {
+    const std::vector<double> prices = make_prices<double>();
+    std::vector<uint64_t> timestamps(prices.size());
+    for (size_t i = 0; i < prices.size(); ++i) {
+        timestamps[i] = 1600000000 + i * 3;
+    }
+    uint64_t offset = 0;
+    {
+        BarShaperV1<double> shaper(60);
+        double sum = 0;
+        shaper.on_close_bar = [&](const BarShaperV1<double>::Bar &bar) {sum += bar.close;};
+        runner.run("BarShaperV1<double>/60/update", prices.size(), [&]() {
+            for (size_t i = 0; i < prices.size(); ++i) shaper.update(prices[i], timestamps[i] + offset);
+            offset += prices.size() * 3;
+        });
+    }
+    {
+        const std::array<uint64_t, 4> bar_periods = {{60, 300, 900, 3600}};
+        MultiBarShaper<double, 4> shaper(bar_periods);
+        BarSink sink;
+        runner.run("MultiBarShaper<double>/60-3600/batch", prices.size(), [&]() {
+            shaper.update(prices.data(), timestamps.data(), prices.size(), sink);
+            for (auto &t : timestamps) t += prices.size() * 3;
+        });
+    }
+    {
+        const std::vector<uint64_t> steps = {5, 10, 20, 50};
+        const size_t capacity = 4096;
+        std::vector<std::vector<RenkoChart<double>::Bar>> buffers(steps.size(), std::vector<RenkoChart<double>::Bar>(capacity));
+        std::vector<RenkoChart<double>::Bar*> output(steps.size());
+        std::vector<size_t> output_size(steps.size());
+        for (size_t j = 0; j < steps.size(); ++j) output[j] = buffers[j].data();
+        RenkoBatch<double> renko(5, steps);
+        runner.run("RenkoBatch<double>/4/batch", prices.size(), [&]() {
+            size_t pos = 0;
+            while (pos < prices.size()) {
+                pos += renko.update(prices.data() + pos, timestamps.data() + pos, prices.size() - pos,
+                    output.data(), output_size.data(), capacity);
+            }
+        });
+    }
+    {
+        ClusterShaper shaper(60, 0.00001);
+        size_t clusters = 0;
+        shaper.on_close_bar = [&](const ClusterShaper::Cluster &) {++clusters;};
+        runner.run("ClusterShaper/60/update", prices.size(), [&]() {
+            for (size_t i = 0; i < prices.size(); ++i) shaper.update(prices[i], timestamps[i] + offset);
+            offset += prices.size() * 3;
+        });
+    }
+}
+
+/* индикаторы для целых тиков */
+void bench_tick(Runner &runner) {
+    const double pips_size = 0.00001;
+    const std::vector<double> prices = make_prices<double>();
+    std::vector<int32_t> ticks(prices.size());
+    for (size_t i = 0; i < prices.size(); ++i) ticks[i] = tick::to_ticks<int32_t>(prices[i], pips_size);
+    const Bars<int32_t> bars = make_bars(ticks);
+    run_hlc<tick::TrueRange<int32_t>>(runner, "tick::TrueRange<int32_t>", bars, [&]{ return tick::TrueRange<int32_t>(pips_size); });
+    for (const size_t p : periods) {
+        const std::string s = "<int32_t>/" + std::to_string(p);
+        run_indicator<tick::SMA<int32_t>>(runner, "tick::SMA" + s, ticks, [&]{ return tick::SMA<int32_t>(p, pips_size); });
+        run_indicator<tick::SUM<int32_t>>(runner, "tick::SUM" + s, ticks, [&]{ return tick::SUM<int32_t>(p, pips_size); });
+        run_indicator<tick::StdDev<int32_t>>(runner, "tick::StdDev" + s, ticks, [&]{ return tick::StdDev<int32_t>(p, pips_size); });
+        run_indicator<tick::MinMax<int32_t>>(runner, "tick::MinMax" + s, ticks, [&]{ return tick::MinMax<int32_t>(p, 0, pips_size); });
+        run_indicator<tick::ATR<int32_t>>(runner, "tick::ATR" + s, ticks, [&]{ return tick::ATR<int32_t>(p, pips_size); });
+        run_hlc<tick::ATR<int32_t>>(runner, "tick::ATR" + s, bars, [&]{ return tick::ATR<int32_t>(p, pips_size); });
+    }
+}
+
+/* SSA: update и прогноз на каждом тике */
+void bench_ssa(Runner &runner) {
+#ifndef NO_EIGEN
+    typedef SSA<double> SSAd;
+    const std::vector<double> prices = make_prices<double>();
+    const size_t windows[] = {64, 256};
+    const SSAd::SolverType solvers[] = {SSAd::SolverType::JacobiSVD, SSAd::SolverType::LagCovariance};
+    for (const size_t m : windows) {
+        for (const auto solver : solvers) {
+            const bool is_svd = solver == SSAd::SolverType::JacobiSVD;
+            /* JacobiSVD на больших окнах медленный, ограничиваем число тиков */
+            const size_t ticks = is_svd ? std::max((size_t)2, (size_t)(1024 / m)) : 32;
+            SSAd ssa(m);
+            size_t pos = 0;
+            for (; pos < m; ++pos) ssa.update(prices[pos]);
+            const std::string name = "SSA<double>/" + std::to_string(m) + (is_svd ? "/JacobiSVD" : "/LagCovariance");
+            runner.run(name + "/calc", ticks, [&]() {
+                for (size_t n = 0; n < ticks; ++n) {
+                    ssa.update(prices[pos]);
+                    pos = (pos + 1) % prices.size();
+                    ssa.calc(8, m / 8, 4, m / 16, SSAd::MetricType::None, false,
+                        SSAd::SSAMode::OriginalSeriesForecast, 4, solver);
+                }
+            });
+        }
+    }
+#else
+    (void)runner;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    Runner runner(argc, argv);
+    bench_indicators<double>(runner, "double");
+    bench_indicators<float>(runner, "float");
+    bench_bars(runner);
+    bench_tick(runner);
+    bench_ssa(runner);
+    return runner.finish() == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <string>
+#include <new>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+#include "xtechnical_indicators.hpp"
+
+/* отчет о памяти индикаторов: размер объекта и объем памяти в куче,
+ * который экземпляр удерживает после прогрева (update и test)
+ *
+ * пример:
+ * memory_report
+ * memory_report SMA
+ */
+
+/* учет занятой памяти: размер блока хранится перед блоком */
+static size_t live_bytes = 0;
+static const size_t HEADER_SIZE = 16;
+
+void *operator new(std::size_t size) {
+    void *ptr = std::malloc(size + HEADER_SIZE);
+    if (!ptr) throw std::bad_alloc();
+    *static_cast<size_t*>(ptr) = size;
+    live_bytes += size;
+    return static_cast<char*>(ptr) + HEADER_SIZE;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (!ptr) return;
+    char *base = static_cast<char*>(ptr) - HEADER_SIZE;
+    live_bytes -= *reinterpret_cast<size_t*>(base);
+    std::free(base);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+#if __cplusplus >= 201703L
+/* std::pmr::new_delete_resource выделяет память с выравниванием */
+void *operator new(std::size_t size, std::align_val_t align) {
+    const size_t a = std::max((size_t)align, HEADER_SIZE);
+    void *ptr = std::aligned_alloc(a, a + (size + a - 1) / a * a);
+    if (!ptr) throw std::bad_alloc();
+    char *data = static_cast<char*>(ptr) + a;
+    *reinterpret_cast<size_t*>(data - HEADER_SIZE) = size;
+    live_bytes += size;
+    return data;
+}
+
+void operator delete(void *ptr, std::align_val_t align) noexcept {
+    if (!ptr) return;
+    const size_t a = std::max((size_t)align, HEADER_SIZE);
+    char *data = static_cast<char*>(ptr);
+    live_bytes -= *reinterpret_cast<size_t*>(data - HEADER_SIZE);
+    std::free(data - a);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t align) noexcept {
+    operator delete(ptr, align);
+}
+#endif
+
+using namespace xtechnical;
+
+static std::vector<double> prices;
+static std::string filter;
+
+template<class INDICATOR, class F>
+void report(const std::string &name, const size_t period, F make) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) return;
+    const size_t before = live_bytes;
+    {
+        std::unique_ptr<INDICATOR> ind(new INDICATOR(make()));
+        for (size_t i = 0; i < 4 * period + 16; ++i) {
+            ind->test(prices[i] + 0.0001);
+            ind->update(prices[i]);
+        }
+        const size_t heap = live_bytes - before - sizeof(INDICATOR);
+        std::cout << std::setw(28) << std::left << name << std::right
+            << std::setw(8) << period
+            << std::setw(12) << sizeof(INDICATOR)
+            << std::setw(14) << heap
+            << std::setw(14) << std::fixed << std::setprecision(2) << (double)(heap + sizeof(INDICATOR)) / (double)period
+            << std::endl;
+    }
+}
+
+template<class T>
+void report_indicators(const std::string &type_name) {
+    const size_t periods[] = {14, 100, 1025};
+    for (const size_t p : periods) {
+        const std::string s = "<" + type_name + ">";
+        report<SMA<T>>("SMA" + s, p, [&]{ return SMA<T>(p); });
+        report<EMA<T>>("EMA" + s, p, [&]{ return EMA<T>(p); });
+        report<WMA<T>>("WMA" + s, p, [&]{ return WMA<T>(p); });
+        report<MMA<T>>("MMA" + s, p, [&]{ return MMA<T>(p); });
+        report<LRMA<T>>("LRMA" + s, p, [&]{ return LRMA<T>(p); });
+        report<RSI<T, SMA<T>>>("RSI" + s, p, [&]{ return RSI<T, SMA<T>>(p); });
+        report<StdDev<T>>("StdDev" + s, p, [&]{ return StdDev<T>(p); });
+        report<Zscore<T>>("Zscore" + s, p, [&]{ return Zscore<T>(p); });
+        report<BollingerBands<T>>("BollingerBands" + s, p, [&]{ return BollingerBands<T>(p, 2); });
+        report<MinMax<T>>("MinMax" + s, p, [&]{ return MinMax<T>(p); });
+        report<FastMinMax<T>>("FastMinMax" + s, p, [&]{ return FastMinMax<T>(p); });
+        report<RoC<T>>("RoC" + s, p, [&]{ return RoC<T>(p); });
+        report<DelayLine<T>>("DelayLine" + s, p, [&]{ return DelayLine<T>(p); });
+        report<RollingRegression<T>>("RollingRegression" + s, p, [&]{ return RollingRegression<T>(p); });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) filter = argv[1];
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.0002);
+    double price = 1.1;
+    for (size_t i = 0; i < 8192; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+    std::cout << std::setw(28) << std::left << "indicator" << std::right
+        << std::setw(8) << "period"
+        << std::setw(12) << "sizeof"
+        << std::setw(14) << "heap bytes"
+        << std::setw(14) << "bytes/period" << std::endl;
+    report_indicators<double>("double");
+    report_indicators<float>("float");
+    return 0;
+}
@@ -0,0 +1,292 @@
+#ifndef XTECHNICAL_BENCH_HPP_INCLUDED
+#define XTECHNICAL_BENCH_HPP_INCLUDED
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <atomic>
+#include <utility>
+#include <type_traits>
+#include <cstdlib>
+#include <cstring>
+
+namespace xtechnical {
+    /** \brief Минимальный набор средств для замера производительности
+     *
+     * Формат аргументов командной строки и JSON отчета повторяет Google Benchmark:
+     * --benchmark_filter=<подстрока>, --benchmark_min_time=<секунды>,
+     * --benchmark_out=<файл>. Дополнительно --baseline=<файл> сравнивает
+     * результат с ранее сохраненным отчетом.
+     */
+    namespace bench {
+
+        /** \brief Счетчик выделений памяти
+         *
+         * Увеличивается замененным operator new исполняемого файла замеров
+         */
+        inline std::atomic<size_t> &allocations() {
+            static std::atomic<size_t> value(0);
+            return value;
+        }
+
+        /** \brief Результат замера
+         */
+        class Result {
+        public:
+            std::string name;
+            size_t iterations = 0;      /**< Количество обработанных элементов */
+            double ns_per_op = 0;       /**< Время на элемент, нс */
+            double allocs_per_op = 0;   /**< Выделений памяти на элемент */
+        };
+
+        /** \brief Запуск замеров, вывод и сохранение результатов
+         */
+        class Runner {
+        private:
+            std::vector<Result> results;
+            std::string filter;
+            std::string out_file;
+            std::string baseline_file;
+            double min_time = 0.1;
+            double threshold = 0.1;     /**< Порог регрессии относительно базового отчета */
+
+            static bool parse_arg(const char *arg, const char *key, std::string &value) {
+                const size_t len = std::strlen(key);
+                if (std::strncmp(arg, key, len) != 0 || arg[len] != '=') return false;
+                value = arg + len + 1;
+                return true;
+            }
+
+            static std::string escape(const std::string &s) {
+                std::string out;
+                for (char c : s) {
+                    if (c == '"' || c == '\\') out += '\\';
+                    out += c;
+                }
+                return out;
+            }
+
+            /** \brief Прочитать время из JSON отчета
+             *
+             * Разбираются только пары "name" и "real_time" в отчете,
+             * сохраненном этим же классом или Google Benchmark
+             */
+            static std::map<std::string, double> load(const std::string &file_name) {
+                std::map<std::string, double> times;
+                std::ifstream file(file_name);
+                if (!file) return times;
+                std::stringstream ss;
+                ss << file.rdbuf();
+                const std::string text = ss.str();
+                size_t pos = 0;
+                while ((pos = text.find("\"name\"", pos)) != std::string::npos) {
+                    const size_t begin = text.find('"', text.find(':', pos) + 1) + 1;
+                    const size_t end = text.find('"', begin);
+                    const std::string name = text.substr(begin, end - begin);
+                    const size_t time_pos = text.find("\"real_time\"", end);
+                    const size_t next_pos = text.find("\"name\"", end);
+                    if (time_pos == std::string::npos) break;
+                    if (next_pos == std::string::npos || time_pos < next_pos) {
+                        times[name] = std::atof(text.c_str() + text.find(':', time_pos) + 1);
+                    }
+                    pos = end;
+                }
+                return times;
+            }
+
+        public:
+
+            Runner(int argc, char* argv[]) {
+                for (int i = 1; i < argc; ++i) {
+                    std::string value;
+                    if (parse_arg(argv[i], "--benchmark_filter", value)) filter = value;
+                    else if (parse_arg(argv[i], "--benchmark_out", value)) out_file = value;
+                    else if (parse_arg(argv[i], "--benchmark_min_time", value)) min_time = std::atof(value.c_str());
+                    else if (parse_arg(argv[i], "--baseline", value)) baseline_file = value;
+                    else if (parse_arg(argv[i], "--threshold", value)) threshold = std::atof(value.c_str());
+                    else std::cerr << "unknown argument: " << argv[i] << std::endl;
+                }
+                std::cout << std::left << std::setw(56) << "benchmark"
+                    << std::right << std::setw(14) << "ns/op"
+                    << std::setw(14) << "allocs/op" << std::endl;
+            }
+
+            /** \brief Выполнить замер
+             *
+             * Функция вызывается до тех пор, пока суммарное время меньше min_time.
+             * Первый вызов не учитывается (прогрев), если он быстрее min_time.
+             * \param name      Имя замера
+             * \param items     Количество элементов, обрабатываемых за один вызов f
+             * \param f         Замеряемая функция
+             */
+            template<class F>
+            void run(const std::string &name, const size_t items, F f) {
+                if (!filter.empty() && name.find(filter) == std::string::npos) return;
+                size_t calls = 0;
+                double elapsed = 0;
+                size_t allocs_start = allocations().load();
+                auto t1 = std::chrono::steady_clock::now();
+                f();
+                elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+                if (elapsed < min_time) {
+                    /* первый вызов был прогревом */
+                    elapsed = 0;
+                    allocs_start = allocations().load();
+                    t1 = std::chrono::steady_clock::now();
+                } else {
+                    /* медленная функция, первый вызов и есть замер */
+                    calls = 1;
+                }
+                while (elapsed < min_time) {
+                    f();
+                    ++calls;
+                    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+                }
+                Result r;
+                r.name = name;
+                r.iterations = calls * items;
+                r.ns_per_op = elapsed * 1e9 / (double)r.iterations;
+                r.allocs_per_op = (double)(allocations().load() - allocs_start) / (double)r.iterations;
+                results.push_back(r);
+                std::cout << std::left << std::setw(56) << name
+                    << std::right << std::setw(14) << std::fixed << std::setprecision(2) << r.ns_per_op
+                    << std::setw(14) << std::setprecision(4) << r.allocs_per_op << std::endl;
+            }
+
+            /** \brief Сохранить отчет и сравнить с базовым
+             * \return Количество регрессий относительно базового отчета
+             */
+            int finish() {
+                if (!out_file.empty()) {
+                    std::ofstream file(out_file);
+                    file << "{\n  \"context\": {\n    \"library\": \"xtechnical_analysis\"\n  },\n  \"benchmarks\": [\n";
+                    for (size_t i = 0; i < results.size(); ++i) {
+                        const Result &r = results[i];
+                        file << "    {\n"
+                            << "      \"name\": \"" << escape(r.name) << "\",\n"
+                            << "      \"iterations\": " << r.iterations << ",\n"
+                            << "      \"real_time\": " << std::setprecision(6) << r.ns_per_op << ",\n"
+                            << "      \"time_unit\": \"ns\",\n"
+                            << "      \"allocs_per_iteration\": " << r.allocs_per_op << "\n"
+                            << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+                    }
+                    file << "  ]\n}\n";
+                    std::cout << "saved: " << out_file << std::endl;
+                }
+                if (baseline_file.empty()) return 0;
+                const std::map<std::string, double> baseline = load(baseline_file);
+                if (baseline.empty()) {
+                    std::cout << "baseline not found: " << baseline_file << std::endl;
+                    return 0;
+                }
+                int regressions = 0;
+                std::cout << std::endl << std::left << std::setw(56) << "comparison"
+                    << std::right << std::setw(14) << "baseline"
+                    << std::setw(14) << "current"
+                    << std::setw(10) << "change" << std::endl;
+                for (const Result &r : results) {
+                    auto it = baseline.find(r.name);
+                    if (it == baseline.end() || it->second <= 0) continue;
+                    const double change = r.ns_per_op / it->second - 1.0;
+                    const bool is_regression = change > threshold;
+                    if (is_regression) ++regressions;
+                    std::cout << std::left << std::setw(56) << r.name
+                        << std::right << std::setw(14) << std::setprecision(2) << it->second
+                        << std::setw(14) << r.ns_per_op
+                        << std::setw(9) << std::showpos << (change * 100.0) << std::noshowpos << "%"
+                        << (is_regression ? " REGRESSION" : "") << std::endl;
+                }
+                std::cout << "regressions: " << regressions << std::endl;
+                return regressions;
+            }
+        };
+
+        namespace detail {
+            struct rank0 {};
+            struct rank1 : rank0 {};
+
+            template<class IND, class T>
+            inline auto update(IND &ind, const T in, rank1) -> decltype(ind.update(in), void()) {
+                ind.update(in);
+            }
+
+            template<class IND, class T>
+            inline auto update(IND &ind, const T in, rank0) -> decltype(ind.update(in, std::declval<T&>()), void()) {
+                T out = 0;
+                ind.update(in, out);
+            }
+
+            template<class IND, class T>
+            inline auto test(IND &ind, const T in, rank1) -> decltype(ind.test(in), void()) {
+                ind.test(in);
+            }
+
+            template<class IND, class T>
+            inline auto test(IND &ind, const T in, rank0) -> decltype(ind.test(in, std::declval<T&>()), void()) {
+                T out = 0;
+                ind.test(in, out);
+            }
+
+            template<class IND, class T>
+            auto has_test(rank1) -> decltype(test(std::declval<IND&>(), T(), rank1()), std::true_type());
+
+            template<class IND, class T>
+            std::false_type has_test(rank0);
+        };
+
+        /** \brief Вызвать update(in) или update(in, out)
+         */
+        template<class IND, class T>
+        inline void update(IND &ind, const T in) {
+            detail::update(ind, in, detail::rank1());
+        }
+
+        /** \brief Вызвать test(in) или test(in, out)
+         */
+        template<class IND, class T>
+        inline void test(IND &ind, const T in) {
+            detail::test(ind, in, detail::rank1());
+        }
+
+        /** \brief Проверить, есть ли у индикатора метод test
+         */
+        template<class IND, class T>
+        struct has_test : decltype(detail::has_test<IND, T>(detail::rank1())) {};
+
+        template<class IND, class T, class MAKE>
+        void run_test(Runner &runner, const std::string &name, const std::vector<T> &prices, MAKE make, std::true_type) {
+            IND ind = make();
+            for (const T &p : prices) update(ind, p);
+            runner.run(name + "/test", prices.size(), [&]() {
+                for (const T &p : prices) test(ind, p);
+            });
+        }
+
+        template<class IND, class T, class MAKE>
+        void run_test(Runner &, const std::string &, const std::vector<T> &, MAKE, std::false_type) {}
+
+        /** \brief Замеры update и test для индикатора с одним входом
+         * \param runner    Запуск замеров
+         * \param name      Имя индикатора
+         * \param prices    Входные данные
+         * \param make      Функция, создающая индикатор
+         */
+        template<class IND, class T, class MAKE>
+        void run_indicator(Runner &runner, const std::string &name, const std::vector<T> &prices, MAKE make) {
+            {
+                IND ind = make();
+                runner.run(name + "/update", prices.size(), [&]() {
+                    for (const T &p : prices) update(ind, p);
+                });
+            }
+            run_test<IND>(runner, name, prices, make, has_test<IND, T>());
+        }
+    };
+};
+
+#endif // XTECHNICAL_BENCH_HPP_INCLUDED
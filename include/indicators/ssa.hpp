@@ -2,7 +2,9 @@
 #define XTECHNICAL_SSA_HPP_INCLUDED
 
 #include "../xtechnical_common.hpp"
+#include "../xtechnical_thread_pool.hpp"
 #include <vector>
+#include <memory>
 
 #ifndef NO_EIGEN
 #include <Eigen/Dense>
@@ -28,6 +30,11 @@ namespace xtechnical {
             RSquared,
         };
 
+        enum class SolverType {
+            JacobiSVD,      /**< full SVD of the Hankel matrix */
+            LagCovariance,  /**< eigen-decomposition of the lag-covariance matrix, see LagCovarianceSolver */
+        };
+
     private:
 
         template<class VectorType = Eigen::VectorXd>
@@ -220,6 +227,252 @@ namespace xtechnical {
             return std::move(x1);
         }
 
+        typedef Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> MatrixT;
+        typedef Eigen::Matrix<T,Eigen::Dynamic,1> VectorT;
+
+        /** \brief Fast SSA solver
+         * Instead of the SVD of the L x K Hankel matrix X it decomposes
+         * the K x K lag-covariance matrix G = X^T * X:
+         * V - eigenvectors of G, S^2 - eigenvalues of G, U = X * V / S.
+         * G is updated incrementally: rank-2 update when the window slides,
+         * rank-1 update when a forecast tick is appended to the series.
+         * All work buffers are kept between ticks.
+         */
+        class LagCovarianceSolver {
+        public:
+
+            LagCovarianceSolver() {};
+
+            /** \brief Prepare the lag-covariance matrix of the window
+             * \param x - window, one-dimensional
+             * \param K - period
+             * \param shift - number of samples the window has moved since the previous call,
+             * SIZE_MAX if unknown
+             */
+            inline void prepare(const VectorT &x, const size_t K, const size_t shift) {
+                const size_t N = x.size();
+                const size_t n = N - K + 1;
+                if (!m_is_base || m_period != K || m_base.size() != (Eigen::Index)N ||
+                    shift >= n || (m_slides + shift) >= N) {
+                    build(x, K, m_base_cov);
+                    m_slides = 0;
+                } else
+                if (shift > 0) {
+                    // z = [old window, new samples], each step drops the first row of X and adds a new last row
+                    m_row.resize(N + shift);
+                    m_row.head(N) = m_base;
+                    m_row.tail(shift) = x.tail(shift);
+                    for (size_t j = 0; j < shift; ++j) {
+                        m_base_cov.noalias() -= m_row.segment(j, K) * m_row.segment(j, K).transpose();
+                        m_base_cov.noalias() += m_row.segment(n + j, K) * m_row.segment(n + j, K).transpose();
+                    }
+                    m_slides += shift;
+                }
+                m_base = x;
+                m_period = K;
+                m_is_base = true;
+                m_cov = m_base_cov;
+            }
+
+            /** \brief Forget the window (e.g. after an intrabar update)
+             */
+            inline void invalidate() noexcept {
+                m_is_base = false;
+            }
+
+            /** \brief one-tick SSA forecast, see ssa_tick
+             * \param x - time series, one-dimensional
+             * \param K - period
+             * \param r - rank of Hankel matrix
+             * \param mode - SSA mode
+             */
+            inline void tick(
+                    VectorT &x,
+                    const size_t K,
+                    const size_t r = 0,
+                    const SSAMode mode = SSAMode::RestoredSeriesAddition) {
+                const size_t N = x.size();
+                const size_t n = N - K + 1;
+                if (m_is_rebuild) build(x, K, m_cov);
+
+                const int rh = decompose(r);
+
+                // pi = last row of U, R(i) = U.row(i) * pi^T = X.row(i) * V * (pi / S)
+                m_last = x.segment(n - 1, K);
+                m_pi.noalias() = m_v.leftCols(rh).transpose() * m_last;
+                m_pi.array() /= m_s.head(rh).array();
+                const T sumsqr = m_pi.squaredNorm();
+                const T eps = std::numeric_limits<T>::epsilon();
+                m_w = m_pi.array() / m_s.head(rh).array();
+                m_coeff.noalias() = m_v.leftCols(rh) * m_w;
+                T scale = 1;
+                if (std::abs(sumsqr - 1.0) > eps) scale = 1.0 / (1.0 - sumsqr);
+
+                if (mode == SSAMode::OriginalSeriesForecast) {
+                    const T g = scale * dot_rows(x, x, K, n);
+                    append(x, g, K);
+                    return;
+                }
+
+                // X1 = X * V * V^T: first column and last row
+                m_ts.resize(N);
+                m_w.noalias() = m_v.leftCols(rh) * m_v.leftCols(rh).row(0).transpose();
+                for (size_t i = 0; i < n; ++i) {
+                    m_ts(i) = x.segment(i, K).dot(m_w);
+                }
+                m_pi.noalias() = m_v.leftCols(rh).transpose() * m_last;
+                m_w.noalias() = m_v.leftCols(rh) * m_pi;
+                m_ts.segment(n, K - 1) = m_w.segment(1, K - 1);
+
+                const T g = scale * dot_rows(x, m_ts, K, n);
+                if (mode == SSAMode::RestoredSeriesAddition) {
+                    x.resize(N + 1);
+                    x.head(N) = m_ts;
+                    x(N) = g;
+                    m_is_rebuild = true;
+                } else {
+                    append(x, g, K);
+                }
+            }
+
+            /** \brief SSA forecast, see ssa_multi_tick
+             */
+            inline void multi_tick(
+                    VectorT &x,
+                    const size_t M,
+                    const size_t K,
+                    const size_t r = 0,
+                    const SSAMode mode = SSAMode::RestoredSeriesAddition) {
+                m_is_rebuild = false;
+                for (size_t i = 0; i < M; ++i) {
+                    tick(x, K, r, mode);
+                }
+            }
+
+        private:
+            MatrixT m_base_cov;     // lag-covariance of the last window
+            MatrixT m_cov;          // lag-covariance of the series being forecast
+            MatrixT m_v;            // eigenvectors, the leading ones are used as a warm start
+            MatrixT m_z;
+            MatrixT m_h;
+            VectorT m_s;
+            VectorT m_base;
+            VectorT m_row;
+            VectorT m_last;
+            VectorT m_pi;
+            VectorT m_w;
+            VectorT m_coeff;
+            VectorT m_ts;
+            Eigen::SelfAdjointEigenSolver<MatrixT> m_eigen;
+            Eigen::SelfAdjointEigenSolver<MatrixT> m_eigen_small;
+            Eigen::HouseholderQR<MatrixT> m_qr;
+            size_t m_period = 0;
+            size_t m_slides = 0;
+            bool m_is_base = false;
+            bool m_is_rebuild = false;
+
+            /// below this period the full eigen-decomposition is cheaper than the subspace iteration
+            static const size_t MIN_TRUNCATED_PERIOD = 48;
+
+            /** \brief G(a,b) = sum x(i+a)*x(i+b), the diagonals are filled by sliding the lag window
+             */
+            inline static void build(const VectorT &x, const size_t K, MatrixT &G) {
+                const size_t n = x.size() - K + 1;
+                G.resize(K, K);
+                for (size_t b = 0; b < K; ++b) {
+                    G(0, b) = x.head(n).dot(x.segment(b, n));
+                }
+                for (size_t a = 1; a < K; ++a) {
+                    for (size_t b = a; b < K; ++b) {
+                        G(a, b) = G(a - 1, b - 1) - x(a - 1) * x(b - 1) + x(n + a - 1) * x(n + b - 1);
+                    }
+                }
+                for (size_t a = 1; a < K; ++a) {
+                    for (size_t b = 0; b < a; ++b) {
+                        G(a, b) = G(b, a);
+                    }
+                }
+            }
+
+            /** \brief sum over the first n-1 rows of X: (X.row(i) * coeff) * y(K + i)
+             */
+            inline T dot_rows(const VectorT &x, const VectorT &y, const size_t K, const size_t n) const {
+                T sum = 0;
+                for (size_t i = 0; i < (n - 1); ++i) {
+                    sum += x.segment(i, K).dot(m_coeff) * y(K + i);
+                }
+                return sum;
+            }
+
+            inline void append(VectorT &x, const T g, const size_t K) {
+                x.conservativeResize(x.size() + 1);
+                x(x.size() - 1) = g;
+                if (!m_is_rebuild) {
+                    m_cov.noalias() += x.tail(K) * x.tail(K).transpose();
+                }
+            }
+
+            /** \brief Leading eigenpairs of the lag-covariance matrix
+             * \param r - rank of Hankel matrix, 0 - all significant components
+             * \return number of components
+             */
+            inline int decompose(const size_t r) {
+                const size_t K = m_cov.rows();
+                if (r == 0 || (r * 4) >= K || K <= MIN_TRUNCATED_PERIOD || !decompose_truncated(r)) {
+                    m_eigen.compute(m_cov);
+                    m_v = m_eigen.eigenvectors().rowwise().reverse();
+                    m_s = m_eigen.eigenvalues().reverse();
+                }
+                // eigenvalues below the numerical rank of G are dropped
+                const T eps = std::numeric_limits<T>::epsilon();
+                const T tol = std::max(m_s(0), T(0)) * (T)K * eps;
+                int r1 = 0;
+                while (r1 < m_s.size() && m_s(r1) > tol) ++r1;
+                if (r1 == 0) r1 = 1;
+                m_s = m_s.cwiseMax(T(0)).cwiseSqrt();
+                if (m_s(0) == 0) m_s(0) = 1;
+                return ((int)r > r1 || r == 0) ? r1 : r;
+            }
+
+            /** \brief Subspace iteration with Rayleigh-Ritz, warm-started from the previous tick
+             * \return false if it did not converge
+             */
+            inline bool decompose_truncated(const size_t r) {
+                const size_t K = m_cov.rows();
+                const size_t p = std::min(K, r + std::max((size_t)2, r / 2));
+                if (m_v.rows() != (Eigen::Index)K || m_v.cols() < (Eigen::Index)p) {
+                    m_qr.compute(m_cov.leftCols(p));
+                    m_v = m_qr.householderQ() * MatrixT::Identity(K, p);
+                } else
+                if (m_v.cols() != (Eigen::Index)p) {
+                    m_v.conservativeResize(K, p);
+                }
+                const T tol = std::pow(std::numeric_limits<T>::epsilon(), T(4.0/5.0));
+                const size_t max_iter = 20;
+                for (size_t it = 0; it < max_iter; ++it) {
+                    m_z.noalias() = m_cov * m_v;
+                    m_h.noalias() = m_v.transpose() * m_z;
+                    m_eigen_small.compute(m_h);
+                    m_h = m_eigen_small.eigenvectors().rowwise().reverse();
+                    m_s = m_eigen_small.eigenvalues().reverse();
+                    m_v = m_v * m_h;
+                    m_z = m_z * m_h;
+                    const T limit = tol * std::max(std::abs(m_s(0)), std::numeric_limits<T>::min());
+                    bool is_converged = true;
+                    for (size_t j = 0; j < r; ++j) {
+                        if ((m_z.col(j) - m_s(j) * m_v.col(j)).norm() > limit) {
+                            is_converged = false;
+                            break;
+                        }
+                    }
+                    if (is_converged) return true;
+                    m_qr.compute(m_z);
+                    m_v = m_qr.householderQ() * MatrixT::Identity(K, p);
+                }
+                return false;
+            }
+        };
+
         template<class VectorType = Eigen::VectorXd>
         inline const T r_squared(const VectorType& data, const VectorType& predictions) {
             const T sum_x2 = (data.array().square()).sum();
@@ -251,26 +504,78 @@ namespace xtechnical {
         CircularBuffer<Eigen::Matrix<T,Eigen::Dynamic,1>> m_buffer;
         std::vector<T> m_reconstructed;
         std::vector<T> m_forecast;
+        std::vector<LagCovarianceSolver> m_solvers;
+        std::vector<VectorT> m_rows;
+        std::shared_ptr<ThreadPool> m_pool;
+        size_t m_shift = 0;
+        bool m_intrabar = false;
         T m_metric = 0;
 
+        /** \brief SSA forecast with the selected solver
+         * \param n_period - index of the period, selects the work buffers
+         */
+        inline VectorT multi_tick(
+                const VectorT &x,
+                const size_t n_period,
+                const size_t M,
+                const size_t K,
+                const size_t r,
+                const SSAMode mode,
+                const SolverType solver) {
+            LagCovarianceSolver &lcs = m_solvers[n_period];
+            if (solver == SolverType::JacobiSVD) {
+                lcs.invalidate();
+                return ssa_multi_tick<MatrixT, VectorT>(x, M, K, r, mode);
+            }
+            lcs.prepare(x, K, m_intrabar ? std::numeric_limits<size_t>::max() : m_shift);
+            if (m_intrabar) lcs.invalidate();
+            VectorT x1(x);
+            lcs.multi_tick(x1, M, K, r, mode);
+            return x1;
+        }
+
     public:
 
         SSA() {};
 
-        SSA(const size_t window_len) : m_buffer(window_len) {}
+        /** \brief SSA constructor
+         * \param window_len - window length
+         * \param num_threads - threads used by calc() for several periods, 0 - hardware concurrency
+         */
+        SSA(const size_t window_len, const size_t num_threads = 1) : m_buffer(window_len) {
+            set_num_threads(num_threads);
+        }
+
+        /** \brief Set the number of threads used by calc() for several periods
+         * \param num_threads - number of threads including the calling one, 0 - hardware concurrency
+         */
+        inline void set_num_threads(const size_t num_threads) {
+            if (num_threads == 1) m_pool.reset();
+            else m_pool = std::make_shared<ThreadPool>(num_threads);
+        }
 
         /** \brief SSA forecast
          * \param x - time series, one-dimensional
          * \param M - number on the ticks to forecast after the end of the time series x
          * \param K - period
          * \param r - rank of Hankel matrix
+         * \param mode - SSA mode
+         * \param solver - SVD of the Hankel matrix or eigen-decomposition of the lag-covariance matrix
          */
         inline static const Eigen::Matrix<T,Eigen::Dynamic,1> calc_ssa(
                 const Eigen::Matrix<T,Eigen::Dynamic,1> &x,
                 const size_t M,
                 const size_t K,
                 const size_t r = 0,
-                const SSAMode mode = SSAMode::RestoredSeriesAddition) {
+                const SSAMode mode = SSAMode::RestoredSeriesAddition,
+                const SolverType solver = SolverType::JacobiSVD) {
+            if (solver == SolverType::LagCovariance) {
+                LagCovarianceSolver lcs;
+                lcs.prepare(x, K, std::numeric_limits<size_t>::max());
+                VectorT x1(x);
+                lcs.multi_tick(x1, M, K, r, mode);
+                return x1;
+            }
             auto x1 = ssa_multi_tick<
                 Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic>,
                 Eigen::Matrix<T,Eigen::Dynamic,1>>(x, M, K, r, mode);
@@ -280,6 +585,8 @@ namespace xtechnical {
         template<class InputType = double>
         inline bool update(const InputType in, const common::PriceType type = common::PriceType::Close) noexcept {
             m_buffer.update(in, type);
+            m_intrabar = (type == common::PriceType::IntraBar);
+            if (!m_intrabar) ++m_shift;
             return m_buffer.full();
         }
 
@@ -287,6 +594,9 @@ namespace xtechnical {
             m_buffer.clear();
             m_reconstructed.clear();
             m_forecast.clear();
+            m_solvers.clear();
+            m_shift = 0;
+            m_intrabar = false;
             m_metric = 0;
         }
 
@@ -301,16 +611,23 @@ namespace xtechnical {
                   const MetricType metric = MetricType::None,
                   const bool ssa_rec = false,
                   const SSAMode mode = SSAMode::RestoredSeriesAddition,
-                  const size_t r = 0) {
+                  const size_t r = 0,
+                  const SolverType solver = SolverType::JacobiSVD) {
             if (!m_buffer.full()) return false;
             if (start_period == 0) return false;
+            if (m_solvers.size() < std::max(num_period, (size_t)1)) {
+                m_solvers.resize(std::max(num_period, (size_t)1));
+            }
+            for (size_t i = std::max(num_period, (size_t)1); i < m_solvers.size(); ++i) {
+                m_solvers[i].invalidate();
+            }
 
             if (num_period <= 1) {
 
                 auto input_data = m_buffer.get_vec();
 
-                auto vec = ssa_multi_tick<Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic>,Eigen::Matrix<T,Eigen::Dynamic,1>>(
-                    input_data, horizon, start_period, r, mode);
+                auto vec = multi_tick(input_data, 0, horizon, start_period, r, mode, solver);
+                m_shift = 0;
 
                 switch (metric) {
                 case MetricType::RSquared:
@@ -345,10 +662,18 @@ namespace xtechnical {
             const size_t len = ssa_rec ? (input_data.size() + horizon): horizon;
             Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> mat_mean(num_period, len);
 
-            for (size_t n_period = 0; n_period < num_period; ++n_period) {
+            // each period is independent and owns its work buffers
+            if (m_rows.size() < num_period) m_rows.resize(num_period);
+            auto task = [&](const size_t n_period) {
                 const size_t period = n_period * step_period + start_period;
-                mat_mean.row(n_period) = ssa_multi_tick<Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic>,Eigen::Matrix<T,Eigen::Dynamic,1>>(
-                    input_data, horizon, period, r, mode);
+                m_rows[n_period] = multi_tick(input_data, n_period, horizon, period, r, mode, solver);
+            };
+            if (m_pool) m_pool->parallel_for(num_period, task);
+            else for (size_t n_period = 0; n_period < num_period; ++n_period) task(n_period);
+            m_shift = 0;
+
+            for (size_t n_period = 0; n_period < num_period; ++n_period) {
+                mat_mean.row(n_period) = m_rows[n_period].tail(len);
             }
 
             Eigen::Matrix<T,Eigen::Dynamic,1> means = mat_mean.colwise().mean();
@@ -422,6 +747,11 @@ namespace xtechnical {
             RSquared,
         };
 
+        enum class SolverType {
+            JacobiSVD,
+            LagCovariance,
+        };
+
     private:
         std::vector<T> m_reconstructed;
         std::vector<T> m_forecast;
@@ -431,7 +761,9 @@ namespace xtechnical {
 
         SSA() {};
 
-        SSA(const size_t window_len) {}
+        SSA(const size_t window_len, const size_t num_threads = 1) {}
+
+        inline void set_num_threads(const size_t num_threads) {}
 
         template<class InputType = double>
         inline bool update(const InputType in, const common::PriceType type = common::PriceType::Close) noexcept {
@@ -455,7 +787,8 @@ namespace xtechnical {
                   const MetricType metric = MetricType::None,
                   const bool ssa_rec = false,
                   const SSAMode mode = SSAMode::RestoredSeriesAddition,
-                  const size_t r = 0) {
+                  const size_t r = 0,
+                  const SolverType solver = SolverType::JacobiSVD) {
             return false;
         }
 
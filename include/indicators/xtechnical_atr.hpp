@@ -17,7 +17,12 @@ namespace xtechnical {
     public:
         ATR() {};
 
-		ATR(const size_t period) : ma(period) {}
+		/** \brief 初始化平均真实范围
+		 * \param period    周期
+		 * \param resource  移动平均线的内存源（如果 MA_TYPE 支持）
+		 */
+		ATR(const size_t period, pmr::memory_resource *resource = pmr::get_default_resource()) :
+			ma(pmr::make_with_resource<MA_TYPE>(resource, period)) {}
 
 		inline int update(const T high, const T low, const T close) noexcept {
             tr.update(high, low, close);
@@ -117,6 +122,27 @@ namespace xtechnical {
             tr.clear();
             ma.clear();
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("ATR", 1, sizeof(T));
+            ma.save_state(out);
+            tr.save_state(out);
+            out.write(output_value);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("ATR", 1, sizeof(T)) && ma.load_state(in) && tr.load_state(in) &&
+                in.read(output_value);
+        }
     }; // ATR
 
 }; // xtechnical
@@ -19,8 +19,13 @@ namespace xtechnical {
 
         CCI() {};
 
-        CCI(const size_t p, const T c = 0.015) :
-            ma(p), buffer(p), coeff(c) {
+        /** \brief 初始化商品通道指数
+         * \param p         周期
+         * \param c         系数，默认值为 0.015
+         * \param resource  缓冲区和移动平均线的内存源（如果 MA_TYPE 支持）
+         */
+        CCI(const size_t p, const T c = 0.015, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            ma(pmr::make_with_resource<MA_TYPE>(resource, p)), buffer(p, resource), coeff(c) {
         };
 
         inline int update(const T in) noexcept {
@@ -28,12 +33,12 @@ namespace xtechnical {
             ma.update(in);
             if (!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
             if (std::isnan(ma.get())) return common::INDICATOR_NOT_READY_TO_WORK;
-            std::vector<T> temp(buffer.to_vector());
+            const size_t window = buffer.size();
             T sum = 0;
-            for (size_t  i = 0; i < temp.size(); ++i) {
-                sum += std::abs(temp[i] - ma.get());
+            for (size_t i = 0; i < window; ++i) {
+                sum += std::abs(buffer[i] - ma.get());
             }
-            const T mad = sum / (T)temp.size();
+            const T mad = sum / (T)window;
             output_value = (in - ma.get()) / (coeff * mad);
             return common::OK;
         }
@@ -60,12 +65,12 @@ namespace xtechnical {
             ma.test(in);
             if (!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
             if (std::isnan(ma.get())) return common::INDICATOR_NOT_READY_TO_WORK;
-            const std::vector<T> temp(buffer.to_vector());
+            const size_t window = buffer.size();
             T sum = 0;
-            for (size_t  i = 0; i < temp.size(); ++i) {
-                sum += std::abs(temp[i] - ma.get());
+            for (size_t i = 0; i < window; ++i) {
+                sum += std::abs(buffer[i] - ma.get());
             }
-            const T mad = sum / (T)temp.size();
+            const T mad = sum / (T)window;
             output_value = (in - ma.get()) / (coeff * mad);
             return common::OK;
         }
@@ -87,6 +92,59 @@ namespace xtechnical {
             return err;
         }
 
+        /** \brief 一次测试多个输入值
+         *
+         * 结果与依次调用 test(in[i], out[i]) 逐位一致，但不复制缓冲区。
+         * 平均绝对偏差没有增量公式，因此窗口中每个固定值只读取一次，
+         * 并在无分支的内层循环中累加到所有输入值的和上，编译器可以将其向量化。
+         * 数据按 XTECHNICAL_BLOCK_SIZE 分块处理，中线来自 MA_TYPE::test_many
+         * \param in    输入信号数组
+         * \param size  数组大小
+         * \param out   输出信号数组（大小为 size，可以与 in 相同）
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int test_many(const T *in, const size_t size, T *out) noexcept {
+            if (size == 0) return common::OK;
+            buffer.test(in[size - 1]);
+            if (!buffer.full()) {
+                std::fill(out, out + size, output_value);
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            const size_t window = buffer.size();
+            T ml[XTECHNICAL_BLOCK_SIZE];
+            T sum[XTECHNICAL_BLOCK_SIZE];
+            int err = common::OK;
+            for (size_t begin = 0; begin < size; begin += XTECHNICAL_BLOCK_SIZE) {
+                const size_t n = std::min((size_t)XTECHNICAL_BLOCK_SIZE, size - begin);
+                const T *block_in = in + begin;
+                T *block_out = out + begin;
+                ma.test_many(block_in, n, ml);
+                std::fill(sum, sum + n, T(0));
+                for (size_t j = 0; j + 1 < window; ++j) {
+                    const T value = buffer[j];
+                    for (size_t i = 0; i < n; ++i) {
+                        sum[i] += std::abs(value - ml[i]);
+                    }
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    sum[i] += std::abs(block_in[i] - ml[i]);
+                    const T mad = sum[i] / (T)window;
+                    block_out[i] = (block_in[i] - ml[i]) / (coeff * mad);
+                }
+                // если средняя еще не готова, test оставляет прежнее значение
+                for (size_t i = 0; i < n; ++i) {
+                    if (std::isnan(ml[i])) {
+                        block_out[i] = output_value;
+                        err = common::INDICATOR_NOT_READY_TO_WORK;
+                    } else {
+                        output_value = block_out[i];
+                        err = common::OK;
+                    }
+                }
+            }
+            return err;
+        }
+
         /** \brief 获取指标值
          * \return 指标值
          */
@@ -101,6 +159,28 @@ namespace xtechnical {
             buffer.clear();
             output_value = std::numeric_limits<T>::quiet_NaN();
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("CCI", 1, sizeof(T));
+            out.write(coeff);
+            ma.save_state(out);
+            buffer.save_state(out);
+            out.write(output_value);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("CCI", 1, sizeof(T)) && in.check(coeff) && ma.load_state(in) &&
+                buffer.load_state(in) && in.read(output_value);
+        }
     }; // CCI
 
 }; // xtechnical
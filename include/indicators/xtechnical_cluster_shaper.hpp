@@ -6,15 +6,19 @@
 namespace xtechnical {
 
 	/** \brief 集群形成器
+	 *
+	 * MAP 为价格分布的容器类型：ClusterShaper 使用 std::map<int, int>，
+	 * pmr::ClusterShaper 使用 pmr::map<int, int>，分布放在指定的内存源中
 	 */
-	class ClusterShaper {
+	template<class MAP>
+	class BasicClusterShaper {
 	public:
 
 		/** \brief 集群
 		*/
 		class Cluster {
 		public:
-			std::map<int, int> distribution;
+			MAP distribution;
 			int open = 0;
 			int close = 0;
 			int high = 0;
@@ -25,6 +29,14 @@ namespace xtechnical {
 			uint64_t timestamp = 0;
 			double pips_size = 0.0;
 
+			Cluster() {};
+
+			/** \brief 初始化集群
+			 * \param resource	分布的内存源（如果 MAP 支持）
+			 */
+			explicit Cluster(pmr::memory_resource *resource) :
+				distribution(pmr::make_with_resource<MAP>(resource)) {};
+
 			inline double get_close_price() noexcept {
 				return (double)close * pips_size;
 			}
@@ -105,15 +117,17 @@ namespace xtechnical {
 		bool is_once = false;
 
 	public:
-		ClusterShaper() {};
+		BasicClusterShaper() {};
 
 		/** \brief 初始化集群形成器
 		 * \param p		指标周期（秒）
 		 * \param ps		价格精度，例如 0.00001
 		 * \param ubst	标志，启用使用柱线结束时间而非开始时间作为柱线时间
+		 * \param resource	集群分布的内存源（仅 pmr::ClusterShaper 使用）
 		 */
-		ClusterShaper(const size_t p, const double ps, const bool ubst = false) :
-			period(p), pips_size(ps), is_use_bar_stop_time(ubst)  {
+		BasicClusterShaper(const size_t p, const double ps, const bool ubst = false,
+				pmr::memory_resource *resource = pmr::get_default_resource()) :
+			cluster(resource), period(p), pips_size(ps), is_use_bar_stop_time(ubst)  {
 		}
 
 		std::function<void(const Cluster &cluster)> on_close_bar;			/**< 柱线关闭时的回调函数 */
@@ -240,7 +254,54 @@ namespace xtechnical {
 			last_bar = 0;
 			is_once = false;
 		}
-	}; // ClusterShaper
+
+		/** \brief 保存指标状态
+		 * \param out 状态写入器
+		 */
+		void save_state(StateWriter &out) const {
+			out.begin("ClusterShaper", 1, sizeof(double));
+			out.write(period);
+			out.write(pips_size);
+			out.write(is_use_bar_stop_time);
+			out.write(last_bar);
+			out.write(is_fill);
+			out.write(is_once);
+			out.write(cluster.distribution);
+			out.write(cluster.open);
+			out.write(cluster.close);
+			out.write(cluster.high);
+			out.write(cluster.low);
+			out.write(cluster.volume);
+			out.write(cluster.max_volume);
+			out.write(cluster.max_index);
+			out.write(cluster.timestamp);
+			out.write(cluster.pips_size);
+		}
+
+		/** \brief 加载指标状态
+		 *
+		 * 指标必须以与保存时相同的参数创建
+		 * \param in 状态读取器
+		 * \return 成功返回 true
+		 */
+		bool load_state(StateReader &in) {
+			return in.begin("ClusterShaper", 1, sizeof(double)) && in.check(period) &&
+				in.check(pips_size) && in.check(is_use_bar_stop_time) && in.read(last_bar) &&
+				in.read(is_fill) && in.read(is_once) && in.read(cluster.distribution) &&
+				in.read(cluster.open) && in.read(cluster.close) && in.read(cluster.high) &&
+				in.read(cluster.low) && in.read(cluster.volume) && in.read(cluster.max_volume) &&
+				in.read(cluster.max_index) && in.read(cluster.timestamp) &&
+				in.read(cluster.pips_size);
+		}
+	}; // BasicClusterShaper
+
+	/// 集群形成器，分布为 std::map<int, int>
+	typedef BasicClusterShaper<std::map<int, int>> ClusterShaper;
+
+	namespace pmr {
+		/// 集群形成器，分布为 pmr::map<int, int>，从构造函数的内存源分配
+		typedef BasicClusterShaper<pmr::map<int, int>> ClusterShaper;
+	};
 
 }; // xtechnical
 
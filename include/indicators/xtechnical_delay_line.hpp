@@ -19,10 +19,11 @@ namespace xtechnical {
         DelayLine() : buffer() {};
 
         /** \brief 延迟线构造函数
-         * \param p     周期
+         * \param p         周期
+         * \param resource  缓冲区的内存源
          */
-        DelayLine(const size_t p) :
-            buffer(p + 1), period(p) {
+        DelayLine(const size_t p, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            buffer(p + 1, resource), period(p) {
         }
 
         /** \brief 更新指标状态
@@ -101,6 +102,27 @@ namespace xtechnical {
             buffer.clear();
             output_value = std::numeric_limits<T>::quiet_NaN();
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("DelayLine", 1, sizeof(T));
+            out.write(period);
+            buffer.save_state(out);
+            out.write(output_value);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("DelayLine", 1, sizeof(T)) && in.check(period) &&
+                buffer.load_state(in) && in.read(output_value);
+        }
     };
 }; // xtechnical
 
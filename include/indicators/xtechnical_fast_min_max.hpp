@@ -17,13 +17,50 @@ namespace xtechnical {
         T last_input = 0;
         int64_t period = 0;
         int64_t index = 0;
-        std::deque<std::pair<int64_t, T>> U, L;
+        pmr::deque<std::pair<int64_t, T>> U, L;
         DelayLine<T> delay_line;
+
+        /** \brief 在队列末尾添加元素后队首的值（不复制队列）
+         * \param q       队列
+         * \param last    添加的元素
+         * \param input   队列为空时返回的值
+         */
+        inline T front_after_push(
+                const pmr::deque<std::pair<int64_t, T>> &q,
+                const std::pair<int64_t, T> &last,
+                const T input) const noexcept {
+            const std::pair<int64_t, T> &front = q.empty() ? last : q.front();
+            if (index != period + front.first) return front.second;
+            if (q.size() > 1) return q[1].second;
+            return q.size() == 1 ? last.second : input;
+        }
+
+        /** \brief 从队列末尾删除元素后队首的值（不复制队列）
+         * \param q       队列
+         * \param input   输入信号，队列为空时返回该值
+         * \param remove  末尾元素是否应被删除
+         */
+        template<class REMOVE>
+        inline T front_after_trim(
+                const pmr::deque<std::pair<int64_t, T>> &q,
+                const T input,
+                REMOVE remove) const noexcept {
+            size_t size = q.size();
+            while (size > 0 && remove(q[size - 1].second)) --size;
+            if (size == 0) return input;
+            const size_t first = index == period + q.front().first ? 1 : 0;
+            return first < size ? q[first].second : input;
+        }
     public:
         FastMinMax() {};
 
-        FastMinMax(const size_t p, const size_t o = 0) :
-            period((int64_t)p), delay_line(o) {
+        /** \brief 初始化指标
+         * \param p           周期
+         * \param o           向后偏移
+         * \param resource    队列的内存源
+         */
+        FastMinMax(const size_t p, const size_t o = 0, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            period((int64_t)p), U(resource), L(resource), delay_line(o, resource) {
         };
 
         int update(T input) noexcept {
@@ -93,31 +130,19 @@ namespace xtechnical {
             }
             input = delay_line.get();
             if (index == 0) return common::INDICATOR_NOT_READY_TO_WORK;
-            std::deque<std::pair<int64_t, T>> tU(U), tL(L);
+            /* 与 update 的步骤相同，但只计算队首的值，不复制队列 */
+            const std::pair<int64_t, T> last = std::make_pair(index - 1, last_input);
+            T max_value = input, min_value = input;
             if (input > last_input) {
-                tL.push_back(std::make_pair(index - 1, last_input));
-                if (index == period + tL.front().first) tL.pop_front() ;
-                while (tU.size() > 0) {
-                    if (input <= tU.back().second) {
-                        if (index == period + tU.front().first) tU.pop_front();
-                        break ;
-                    } // end if
-                    tU.pop_back() ;
-                } // end while
+                min_value = front_after_push(L, last, input);
+                max_value = front_after_trim(U, input, [input](const T value) { return !(input <= value); });
             } else {
-                tU.push_back(std::make_pair(index - 1, last_input)) ;
-                if (index == period + tU.front().first) tU.pop_front() ;
-                while (tL.size() > 0) {
-                    if (input >= tL.back().second) {
-                        if (index == period + tL.front().first) tL.pop_front();
-                        break ;
-                    } // end if
-                    tL.pop_back();
-                } // end while
+                max_value = front_after_push(U, last, input);
+                min_value = front_after_trim(L, input, [input](const T value) { return !(input >= value); });
             } // end if else
             if ((index + 1) >= period) {
-                output_max_value = tU.size() > 0 ? tU.front().second : input;
-                output_min_value = tL.size() > 0 ? tL.front().second : input;
+                output_max_value = max_value;
+                output_min_value = min_value;
                 return common::OK;
             }
             return common::INDICATOR_NOT_READY_TO_WORK;
@@ -163,6 +188,33 @@ namespace xtechnical {
             L.clear();
             delay_line.clear();
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("FastMinMax", 1, sizeof(T));
+            out.write(period);
+            out.write(output_max_value);
+            out.write(output_min_value);
+            out.write(last_input);
+            out.write(index);
+            out.write(U);
+            out.write(L);
+            delay_line.save_state(out);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("FastMinMax", 1, sizeof(T)) && in.check(period) &&
+                in.read(output_max_value) && in.read(output_min_value) && in.read(last_input) &&
+                in.read(index) && in.read(U) && in.read(L) && delay_line.load_state(in);
+        }
     };
 }; // xtechnical
 
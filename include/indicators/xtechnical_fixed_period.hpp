@@ -0,0 +1,825 @@
+#ifndef XTECHNICAL_FIXED_PERIOD_HPP_INCLUDED
+#define XTECHNICAL_FIXED_PERIOD_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+#include "../xtechnical_fixed_circular_buffer.hpp"
+
+namespace xtechnical {
+    namespace fixed {
+
+        /** \brief 延迟线（周期在编译期确定）
+         */
+        template <typename T, size_t N>
+        class DelayLine {
+        private:
+            circular_buffer<T, (N > 0 ? N : 1)> buffer;
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+        public:
+
+            DelayLine() {};
+
+            /** \brief 更新指标状态
+             * \param in    输入信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int update(const T in) noexcept {
+                if(N == 0) {
+                    output_value = in;
+                    return common::OK;
+                }
+                if(buffer.update(in, output_value)) return common::OK;
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与update不同，
+             * 不会影响指标的内部状态
+             * \param in    输入信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int test(const T in) noexcept {
+                if(N == 0) {
+                    output_value = in;
+                    return common::OK;
+                }
+                if(buffer.test(in, output_value)) return common::OK;
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                buffer.clear();
+                output_value = std::numeric_limits<T>::quiet_NaN();
+            }
+        };
+
+        /** \brief 简单移动平均线（周期在编译期确定）
+         *
+         * 行为与 xtechnical::SMA 相同
+         */
+        template <typename T, size_t N>
+        class SMA {
+        private:
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+            circular_buffer<T, N> buffer;
+            /* last_data 与 output_value 不相邻：相邻时编译器会合并两次写入，
+             * 下一次读取 last_data 时存储转发失败 */
+            T last_data = 0;
+        public:
+            static_assert(N > 0, "period must be greater than zero");
+
+            SMA() {};
+
+            /** \brief 更新指标状态
+             * \param in 输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in) noexcept {
+                T removed;
+                if(buffer.update(in, removed)) {
+                    last_data = last_data + (in - removed);
+                    output_value = last_data/(T)N;
+                } else {
+                    last_data += in;
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in) noexcept {
+                T removed;
+                if(buffer.test(in, removed)) {
+                    output_value = (last_data + (in - removed))/(T)N;
+                } else {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 测试指标
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                buffer.clear();
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                last_data = 0;
+            }
+        };
+
+        /** \brief 指数移动平均线（周期在编译期确定）
+         *
+         * 行为与 xtechnical::EMA 相同，预热阶段只保存累计和，不使用 std::vector
+         */
+        template <typename T, size_t N>
+        class EMA {
+        private:
+            T last_data = 0;
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+            size_t count = 0;
+
+            static constexpr T alpha() noexcept {
+                return (T)(2.0 / (T)(N + 1.0));
+            }
+        public:
+            static_assert(N > 0, "period must be greater than zero");
+
+            EMA() {};
+
+            /** \brief 更新指标状态
+             * \param in 输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in) noexcept {
+                if(count < N) {
+                    last_data += in;
+                    if(++count == N) last_data /= (T)N;
+                } else {
+                    last_data = alpha() * in + (1.0 - alpha()) * last_data;
+                    output_value = last_data;
+                    return common::OK;
+                }
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in) noexcept {
+                if(count == N) {
+                    output_value = alpha() * in + (1.0 - alpha()) * last_data;
+                    return common::OK;
+                }
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+
+            /** \brief 测试指标
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                last_data = 0;
+                count = 0;
+                output_value = std::numeric_limits<T>::quiet_NaN();
+            }
+        };
+
+        /** \brief 相对强弱指标（周期在编译期确定）
+         *
+         * 行为与 xtechnical::RSI 相同
+         */
+        template <typename T, size_t N, class MA_TYPE = SMA<T, N>>
+        class RSI {
+        private:
+            MA_TYPE iU;
+            MA_TYPE iD;
+            bool is_update_ = false;
+            T prev_ = 0;
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+
+            inline int calc(const T u, const T d, const int erru, const int errd) noexcept {
+                if(erru != common::OK || errd != common::OK) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                if(d == 0) {
+                    output_value = 100.0;
+                    return common::OK;
+                }
+                const T rs = u / d;
+                output_value = 100.0 - (100.0 / (1.0 + rs));
+                return common::OK;
+            }
+        public:
+
+            RSI() {}
+
+            /** \brief 更新指标状态
+             * \param in 输入信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int update(const T in) noexcept {
+                if(!is_update_) {
+                    prev_ = in;
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    is_update_ = true;
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                T u = 0, d = 0;
+                if(prev_ < in) u = in - prev_;
+                else if(prev_ > in) d = prev_ - in;
+                const int erru = iU.update(u, u);
+                const int errd = iD.update(d, d);
+                prev_ = in;
+                return calc(u, d, erru, errd);
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int update(const T in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此函数与update不同，不会影响指标的内部状态
+             * \param in 输入信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int test(const T in) noexcept {
+                if(!is_update_) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                T u = 0, d = 0;
+                if(prev_ < in) u = in - prev_;
+                else if(prev_ > in) d = prev_ - in;
+                const int erru = iU.test(u, u);
+                const int errd = iD.test(d, d);
+                return calc(u, d, erru, errd);
+            }
+
+            /** \brief 测试指标
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int test(const T in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            void clear() noexcept {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                is_update_ = false;
+                iU.clear();
+                iD.clear();
+            }
+        };
+
+        /** \brief 标准差（周期在编译期确定）
+         *
+         * 行为与 xtechnical::StdDev 相同，小周期的方差循环在编译期展开
+         */
+        template <typename T, size_t N>
+        class StdDev {
+        private:
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+            circular_buffer<T, N> buffer;
+            T last_data = 0;    /**< 成员顺序的原因见 SMA */
+
+            inline void calc(const T mean) noexcept {
+                T sum = 0;
+                auto f = [&](const size_t i) {
+                    const T diff = buffer[i] - mean;
+                    sum += diff * diff;
+                };
+                detail::Loop<N>::run(f);
+                sum /= (T)(N - 1);
+                output_value = sum > 0 ? std::sqrt(sum) : 0;
+            }
+        public:
+            static_assert(N > 1, "period must be greater than one");
+
+            StdDev() {};
+
+            /** \brief 更新指标状态
+             * \param in 输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in) noexcept {
+                T removed;
+                if(buffer.update(in, removed)) {
+                    last_data = last_data + (in - removed);
+                    calc(last_data/(T)N);
+                } else {
+                    last_data += in;
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in) noexcept {
+                T removed;
+                if(buffer.test(in, removed)) {
+                    calc((last_data + (in - removed))/(T)N);
+                } else {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 测试指标
+             * \param in    输入信号
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                buffer.clear();
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                last_data = 0;
+            }
+        };
+
+        /** \brief 布林带（周期和偏移在编译期确定）
+         *
+         * 行为与 xtechnical::BollingerBands 相同：窗口的一阶和二阶矩按 O(1) 更新，
+         * 每 N 次更新按缓冲区重新计算一次，结果逐位一致
+         */
+        template <typename T, size_t N, class MA_TYPE = SMA<T, N>, size_t OFFSET = 0>
+        class BollingerBands {
+        private:
+            circular_buffer<T, N> buffer;
+            MA_TYPE ma;
+            DelayLine<T, OFFSET> delay_line;
+            double deviations = 0;
+            T shift = 0;                /**< 求和的参考值 */
+            T sum = 0;                  /**< 窗口内 (x - shift) 之和 */
+            T sum_sq = 0;               /**< 窗口内 (x - shift)^2 之和 */
+            T sum_sq_peak = 0;          /**< 上次重新计算以来 sum_sq 的最大值 */
+            size_t resync_counter = 0;  /**< 上次重新计算以来的更新次数 */
+            T output_tl = std::numeric_limits<T>::quiet_NaN();
+            T output_ml = std::numeric_limits<T>::quiet_NaN();
+            T output_bl = std::numeric_limits<T>::quiet_NaN();
+            T output_std_dev = std::numeric_limits<T>::quiet_NaN();
+
+            inline void clear_output() noexcept {
+                output_tl = std::numeric_limits<T>::quiet_NaN();
+                output_ml = std::numeric_limits<T>::quiet_NaN();
+                output_bl = std::numeric_limits<T>::quiet_NaN();
+                output_std_dev = std::numeric_limits<T>::quiet_NaN();
+            }
+
+            inline void resync(const T new_shift) noexcept {
+                shift = new_shift;
+                sum = 0;
+                sum_sq = 0;
+                const size_t size = buffer.size();
+                for (size_t i = 0; i < size; ++i) {
+                    const T y = buffer[i] - shift;
+                    sum += y;
+                    sum_sq += y * y;
+                }
+                sum_sq_peak = sum_sq;
+                resync_counter = 0;
+            }
+
+            inline int calc(const T base, const T s, const T s_sq, const T peak) noexcept {
+                output_ml = ma.get();
+                const T d = output_ml - base;
+                T sum_diff = s_sq - (T)2 * d * s + (T)N * d * d;
+                /* 与 xtechnical::BollingerBands::calc_sum_diff 相同：舍入误差范围内的值视为零 */
+                const T e = (T)(4 * N) * std::numeric_limits<T>::epsilon();
+                const T tolerance = e * (peak + (T)N * d * d) + (T)N * (e * output_ml) * (e * output_ml);
+                if (sum_diff <= tolerance) sum_diff = 0;
+                output_std_dev = std::sqrt(sum_diff / (T)(N - 1));
+                const T std_dev_offset = output_std_dev * deviations;
+                output_tl = std_dev_offset + output_ml;
+                output_bl = output_ml - std_dev_offset;
+                return common::OK;
+            }
+        public:
+            static_assert(N > 1, "period must be greater than one");
+
+            BollingerBands() {};
+
+            /** \brief 初始化布林带
+             * \param d 标准差倍数
+             */
+            BollingerBands(const double d) : deviations(d) {}
+
+            /** \brief 更新指标状态
+             * \param in    输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in) noexcept {
+                if(delay_line.update(in) != common::OK) {
+                    clear_output();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                const T x = delay_line.get();
+                if(buffer.empty()) shift = x;
+                if(buffer.full()) {
+                    const T y = buffer.front() - shift;
+                    sum -= y;
+                    sum_sq -= y * y;
+                }
+                const T y = x - shift;
+                sum += y;
+                sum_sq += y * y;
+                if(sum_sq > sum_sq_peak) sum_sq_peak = sum_sq;
+                buffer.update(x);
+                ma.update(x);
+                if(++resync_counter >= N) resync(x);
+                if(!buffer.full() || std::isnan(ma.get())) {
+                    clear_output();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return calc(shift, sum, sum_sq, sum_sq_peak);
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入信号
+             * \param tl    上轨
+             * \param ml    中轨
+             * \param bl    下轨
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const T in, T &tl, T &ml, T &bl) noexcept {
+                const int err = update(in);
+                tl = output_tl;
+                ml = output_ml;
+                bl = output_bl;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in    输入信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in) noexcept {
+                if(delay_line.test(in) != common::OK) {
+                    clear_output();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                const T x = delay_line.get();
+                const T base = buffer.empty() ? x : shift;
+                T s = buffer.empty() ? T(0) : sum;
+                T s_sq = buffer.empty() ? T(0) : sum_sq;
+                if(buffer.full()) {
+                    const T y = buffer.front() - base;
+                    s -= y;
+                    s_sq -= y * y;
+                }
+                const T y = x - base;
+                s += y;
+                s_sq += y * y;
+                const T peak = std::max(buffer.empty() ? T(0) : sum_sq_peak, s_sq);
+                ma.test(x);
+                if((buffer.size() + 1) < N || std::isnan(ma.get())) {
+                    clear_output();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return calc(base, s, s_sq, peak);
+            }
+
+            /** \brief 测试指标
+             * \param in    输入信号
+             * \param tl    上轨
+             * \param ml    中轨
+             * \param bl    下轨
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const T in, T &tl, T &ml, T &bl) noexcept {
+                const int err = test(in);
+                tl = output_tl;
+                ml = output_ml;
+                bl = output_bl;
+                return err;
+            }
+
+            inline T get_tl() const noexcept {return output_tl;};
+            inline T get_ml() const noexcept {return output_ml;};
+            inline T get_bl() const noexcept {return output_bl;};
+            inline T get_std_dev() const noexcept {return output_std_dev;};
+
+            /** \brief 清除指标数据
+             */
+            void clear() noexcept {
+                buffer.clear();
+                ma.clear();
+                delay_line.clear();
+                shift = 0;
+                sum = 0;
+                sum_sq = 0;
+                sum_sq_peak = 0;
+                resync_counter = 0;
+                clear_output();
+            }
+        };
+
+        /** \brief 快速查找最小值和最大值算法（周期在编译期确定）
+         *
+         * 与 xtechnical::FastMinMax 算法相同，单调队列存放在 std::array 中。
+         * test() 只复制队列的头尾索引，不复制队列本身：
+         * 新元素总是写入队列尾部之后的空闲单元。
+         * 原始来源: https://arxiv.org/abs/cs/0610046v5
+         */
+        template <class T, size_t N, size_t OFFSET = 0>
+        class FastMinMax {
+        private:
+
+            /** \brief 固定容量的单调队列
+             */
+            class Queue {
+            public:
+                static const size_t CAPACITY = detail::cpl2(N + 2);
+                static const size_t MASK = CAPACITY - 1;
+                std::array<std::pair<int64_t, T>, CAPACITY> data;
+                size_t head = 0;
+                size_t tail = 0;
+            };
+
+            /** \brief 队列的头尾索引
+             */
+            class Range {
+            public:
+                size_t head = 0;
+                size_t tail = 0;
+            };
+
+            T output_max_value = std::numeric_limits<T>::quiet_NaN();
+            T output_min_value = std::numeric_limits<T>::quiet_NaN();
+            T last_input = 0;
+            int64_t index = 0;
+            Queue U, L;
+            DelayLine<T, OFFSET> delay_line;
+
+            static inline void push_back(Queue &q, Range &r, const int64_t i, const T value) noexcept {
+                q.data[r.tail] = std::make_pair(i, value);
+                r.tail = (r.tail + 1) & Queue::MASK;
+            }
+
+            static inline const std::pair<int64_t, T> &front(const Queue &q, const Range &r) noexcept {
+                return q.data[r.head];
+            }
+
+            static inline const std::pair<int64_t, T> &back(const Queue &q, const Range &r) noexcept {
+                return q.data[(r.tail - 1) & Queue::MASK];
+            }
+
+            /** \brief 算法的一步，只修改 ru 和 rl 中的索引
+             */
+            inline void step(const T input, Range &ru, Range &rl) noexcept {
+                const int64_t period = (int64_t)N;
+                if (input > last_input) {
+                    push_back(L, rl, index - 1, last_input);
+                    if (index == period + front(L, rl).first) rl.head = (rl.head + 1) & Queue::MASK;
+                    while (ru.head != ru.tail) {
+                        if (input <= back(U, ru).second) {
+                            if (index == period + front(U, ru).first) ru.head = (ru.head + 1) & Queue::MASK;
+                            break;
+                        }
+                        ru.tail = (ru.tail - 1) & Queue::MASK;
+                    }
+                } else {
+                    push_back(U, ru, index - 1, last_input);
+                    if (index == period + front(U, ru).first) ru.head = (ru.head + 1) & Queue::MASK;
+                    while (rl.head != rl.tail) {
+                        if (input >= back(L, rl).second) {
+                            if (index == period + front(L, rl).first) rl.head = (rl.head + 1) & Queue::MASK;
+                            break;
+                        }
+                        rl.tail = (rl.tail - 1) & Queue::MASK;
+                    }
+                }
+            }
+
+            inline void output(const T input, const Range &ru, const Range &rl) noexcept {
+                output_max_value = ru.head != ru.tail ? front(U, ru).second : input;
+                output_min_value = rl.head != rl.tail ? front(L, rl).second : input;
+            }
+
+        public:
+            static_assert(N > 0, "period must be greater than zero");
+
+            FastMinMax() {};
+
+            /** \brief 更新指标状态
+             * \param input     输入信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int update(T input) noexcept {
+                if(delay_line.update(input) != common::OK) {
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                input = delay_line.get();
+                if (index == 0) {
+                    ++index;
+                    last_input = input;
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                Range ru, rl;
+                ru.head = U.head; ru.tail = U.tail;
+                rl.head = L.head; rl.tail = L.tail;
+                step(input, ru, rl);
+                U.head = ru.head; U.tail = ru.tail;
+                L.head = rl.head; L.tail = rl.tail;
+                ++index;
+                last_input = input;
+                if (index >= (int64_t)N) {
+                    output(input, ru, rl);
+                    return common::OK;
+                }
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+
+            /** \brief 更新指标状态
+             * \param input     输入信号
+             * \param min_value 周期内的最小输出信号
+             * \param max_value 周期内的最大输出信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int update(const T input, T &min_value, T &max_value) noexcept {
+                const int err = update(input);
+                min_value = output_min_value;
+                max_value = output_max_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此函数与update不同，不会影响指标的内部状态
+             * \param input     输入信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int test(T input) noexcept {
+                if(delay_line.test(input) != common::OK) {
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                input = delay_line.get();
+                if (index == 0) return common::INDICATOR_NOT_READY_TO_WORK;
+                Range ru, rl;
+                ru.head = U.head; ru.tail = U.tail;
+                rl.head = L.head; rl.tail = L.tail;
+                step(input, ru, rl);
+                if ((index + 1) >= (int64_t)N) {
+                    output(input, ru, rl);
+                    return common::OK;
+                }
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+
+            /** \brief 测试指标
+             * \param input     输入信号
+             * \param min_value 周期内的最小输出信号
+             * \param max_value 周期内的最大输出信号
+             * \return 成功返回0，否则参见ErrorType
+             */
+            int test(const T input, T &min_value, T &max_value) noexcept {
+                const int err = test(input);
+                min_value = output_min_value;
+                max_value = output_max_value;
+                return err;
+            }
+
+            /** \brief 获取指标的最小值
+             */
+            inline T get_min() const noexcept {
+                return output_min_value;
+            }
+
+            /** \brief 获取指标的最大值
+             */
+            inline T get_max() const noexcept {
+                return output_max_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                last_input = 0;
+                index = 0;
+                U.head = U.tail = 0;
+                L.head = L.tail = 0;
+                delay_line.clear();
+            }
+        };
+
+    };
+}; // xtechnical
+
+#endif // XTECHNICAL_FIXED_PERIOD_HPP_INCLUDED
@@ -11,7 +11,7 @@ namespace xtechnical {
     class PeriodStatsV1 {
     private:
         // время / значение
-        std::map<uint64_t, T> data;
+        pmr::map<uint64_t, T> data;
         uint64_t start_time = 0;
         uint64_t last_time = 0;
         uint64_t life_time = 0;
@@ -29,9 +29,10 @@ namespace xtechnical {
 
         /** \brief 构造函数
          * \param user_life_time 数据存储时间
+         * \param resource       数据的内存源
          */
-        PeriodStatsV1(const uint64_t user_life_time) :
-            life_time(user_life_time) {
+        PeriodStatsV1(const uint64_t user_life_time, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            data(resource), life_time(user_life_time) {
         }
 
         /** \brief 添加值
@@ -118,7 +119,8 @@ namespace xtechnical {
     class PeriodStatsV2 {
     private:
         // значение / время / win / loss
-        std::map<int, std::map<uint64_t, std::pair<int, int>>> data;
+        typedef pmr::map<uint64_t, std::pair<int, int>> TimeMap;
+        pmr::map<int, TimeMap> data;
         uint64_t start_time = 0;
         uint64_t last_time = 0;
         uint64_t life_time = 0;
@@ -144,9 +146,10 @@ namespace xtechnical {
 
         /** \brief 构造函数
          * \param user_life_time 数据存储时间
+         * \param resource       数据的内存源
          */
-        PeriodStatsV2(const uint64_t user_life_time) :
-            life_time(user_life_time) {
+        PeriodStatsV2(const uint64_t user_life_time, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            data(resource), life_time(user_life_time) {
         }
 
         /** \brief 添加值
@@ -159,15 +162,19 @@ namespace xtechnical {
             auto it = data.find(value);
             if (it == data.end()) {
                 // статистики по значению нету, добавляем
-                if (result > 0) data[value][time] = std::pair<int, int>(result, 0);
-                else if (result < 0) data[value][time] = std::pair<int, int>(0, -result);
+                if (result != 0) {
+                    // вложенный словарь берет память из того же источника
+                    it = data.emplace(value, TimeMap(TimeMap::allocator_type(data.get_allocator().resource()))).first;
+                }
+                if (result > 0) it->second[time] = std::pair<int, int>(result, 0);
+                else if (result < 0) it->second[time] = std::pair<int, int>(0, -result);
             } else {
                 // если значение есть, ищем время
                 auto it2 = it->second.find(time);
                 if (it2 == it->second.end()) {
                     // если время не найдено, добавляем
-                    if (result > 0) data[value][time] = std::pair<int, int>(result, 0);
-                    else if (result < 0) data[value][time] = std::pair<int, int>(0, -result);
+                    if (result > 0) it->second[time] = std::pair<int, int>(result, 0);
+                    else if (result < 0) it->second[time] = std::pair<int, int>(0, -result);
                 } else {
                     // если время найдено, учитываем статистику
                     if (result > 0) it2->second.first += result;
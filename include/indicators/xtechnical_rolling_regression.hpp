@@ -0,0 +1,268 @@
+#ifndef XTECHNICAL_ROLLING_REGRESSION_HPP_INCLUDED
+#define XTECHNICAL_ROLLING_REGRESSION_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+#include "../xtechnical_circular_buffer.hpp"
+#include "../math/xtechnical_ordinary_least_squares.hpp"
+
+namespace xtechnical {
+
+    /** \brief 滑动窗口回归（直线或抛物线）
+     *
+     * 窗口内的点横坐标为 0..period-1（最旧的点为 0），
+     * 拟合 Y = A1*X + A0 或 Y = A2*X^2 + A1*X + A0。
+     * 矩和 sum(y), sum(x*y), sum(x^2*y), sum(y^2) 在窗口滑动时以 O(1) 更新，
+     * x 的矩为常数，在构造函数中预先计算。
+     * 为了抑制累计误差，每 period 次更新按缓冲区重新计算一次矩和。
+     */
+    template <typename T>
+    class RollingRegression {
+    private:
+
+        /** \brief 窗口内 y 的矩和
+         */
+        class Moments {
+        public:
+            T sy = 0;
+            T sxy = 0;
+            T sx2y = 0;
+            T syy = 0;
+
+            /** \brief 在位置 x 添加点
+             */
+            inline void add(const T x, const T y) noexcept {
+                sy += y;
+                sxy += x * y;
+                sx2y += x * x * y;
+                syy += y * y;
+            }
+
+            /** \brief 删除位置 0 的点，其余点左移一位，在位置 x_last 添加点
+             */
+            inline void slide(const T y_old, const T x_last, const T y_new) noexcept {
+                const T sy_rest = sy - y_old;
+                sx2y = sx2y - (T)2 * sxy + sy_rest + x_last * x_last * y_new;
+                sxy = sxy - sy_rest + x_last * y_new;
+                sy = sy_rest + y_new;
+                syy = syy - y_old * y_old + y_new * y_new;
+            }
+
+            inline void clear() noexcept {
+                sy = sxy = sx2y = syy = 0;
+            }
+        };
+
+        xtechnical::circular_buffer<T> buffer;
+        Moments moments;
+        T inv[3][3] = {{0,0,0},{0,0,0},{0,0,0}};
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+        T intercept = std::numeric_limits<T>::quiet_NaN();
+        T slope = std::numeric_limits<T>::quiet_NaN();
+        T curvature = std::numeric_limits<T>::quiet_NaN();
+        T r_squared = std::numeric_limits<T>::quiet_NaN();
+        size_t period = 0;
+        size_t resync_counter = 0;
+        OlsFunctionType type = OlsFunctionType::LINE;
+
+        inline bool check_period() const noexcept {
+            if (type == OlsFunctionType::LINE) return period >= 2;
+            return period >= 3;
+        }
+
+        /** \brief 预先计算正规方程矩阵的逆矩阵
+         */
+        void init_matrix() noexcept {
+            double n = (double)period, sx = 0, sx2 = 0, sx3 = 0, sx4 = 0;
+            for (size_t i = 0; i < period; ++i) {
+                const double x = (double)i;
+                sx += x;
+                sx2 += x * x;
+                sx3 += x * x * x;
+                sx4 += x * x * x * x;
+            }
+            if (type == OlsFunctionType::LINE) {
+                /* n   sx
+                 * sx  sx2
+                 */
+                const double A = 1.0 / (n * sx2 - sx * sx);
+                inv[0][0] = (T)(A * sx2);
+                inv[0][1] = inv[1][0] = (T)(-A * sx);
+                inv[1][1] = (T)(A * n);
+            } else {
+                /* n   sx  sx2
+                 * sx  sx2 sx3
+                 * sx2 sx3 sx4
+                 */
+                const double A = 1.0 / (n * (sx2 * sx4 - sx3 * sx3) - sx * (sx * sx4 - sx2 * sx3) + sx2 * (sx * sx3 - sx2 * sx2));
+                inv[0][0] = (T)(A * (sx2 * sx4 - sx3 * sx3));
+                inv[0][1] = inv[1][0] = (T)(A * (sx2 * sx3 - sx * sx4));
+                inv[0][2] = inv[2][0] = (T)(A * (sx * sx3 - sx2 * sx2));
+                inv[1][1] = (T)(A * (n * sx4 - sx2 * sx2));
+                inv[1][2] = inv[2][1] = (T)(A * (sx * sx2 - n * sx3));
+                inv[2][2] = (T)(A * (n * sx2 - sx * sx));
+            }
+        }
+
+        /** \brief 按缓冲区重新计算矩和
+         */
+        inline void resync() noexcept {
+            moments.clear();
+            for (size_t i = 0; i < period; ++i) {
+                moments.add((T)i, buffer[i + 1]);
+            }
+            resync_counter = 0;
+        }
+
+        inline void calc(const Moments &m) noexcept {
+            intercept = inv[0][0] * m.sy + inv[0][1] * m.sxy + inv[0][2] * m.sx2y;
+            slope = inv[1][0] * m.sy + inv[1][1] * m.sxy + inv[1][2] * m.sx2y;
+            curvature = inv[2][0] * m.sy + inv[2][1] * m.sxy + inv[2][2] * m.sx2y;
+            const T x_last = (T)(period - 1);
+            output_value = intercept + slope * x_last + curvature * x_last * x_last;
+            /* SSE = sum(y^2) - coeff * X^T*y, SST = sum(y^2) - sum(y)^2/n */
+            const T sst = m.syy - m.sy * m.sy / (T)period;
+            const T sse = m.syy - (intercept * m.sy + slope * m.sxy + curvature * m.sx2y);
+            r_squared = sst > 0 ? std::max((T)0, std::min((T)1, (T)1 - sse / sst)) : (T)1;
+        }
+
+        inline void clear_output() noexcept {
+            output_value = std::numeric_limits<T>::quiet_NaN();
+            intercept = std::numeric_limits<T>::quiet_NaN();
+            slope = std::numeric_limits<T>::quiet_NaN();
+            curvature = std::numeric_limits<T>::quiet_NaN();
+            r_squared = std::numeric_limits<T>::quiet_NaN();
+        }
+
+    public:
+
+        RollingRegression() {};
+
+        /** \brief 初始化滑动窗口回归
+         * \param p     周期（直线至少 2，抛物线至少 3）
+         * \param t     拟合类型，直线或抛物线
+         */
+        RollingRegression(const size_t p, const OlsFunctionType t = OlsFunctionType::LINE) :
+                buffer(p + 1), period(p), type(t) {
+            if (check_period()) init_matrix();
+        }
+
+        /** \brief 更新指标状态
+         * \param in 输入信号
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int update(const T in) noexcept {
+            if (!check_period()) {
+                clear_output();
+                return common::NO_INIT;
+            }
+            buffer.update(in);
+            if (buffer.full()) {
+                moments.slide(buffer.front(), (T)(period - 1), in);
+                if (++resync_counter >= period) resync();
+            } else {
+                moments.add((T)(buffer.size() - 1), in);
+                if (buffer.size() < period) {
+                    clear_output();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+            }
+            calc(moments);
+            return common::OK;
+        }
+
+        /** \brief 更新指标状态
+         * \param in    输入信号
+         * \param out   输出信号（拟合线在窗口末端的值）
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief 测试指标
+         *
+         * 此方法与 update 方法的区别在于
+         * 不影响指标的内部状态
+         * \param in 输入信号
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int test(const T in) noexcept {
+            if (!check_period()) {
+                clear_output();
+                return common::NO_INIT;
+            }
+            buffer.test(in);
+            Moments m = moments;
+            if (buffer.full()) {
+                m.slide(buffer.front(), (T)(period - 1), in);
+            } else {
+                m.add((T)(buffer.size() - 1), in);
+                if (buffer.size() < period) {
+                    clear_output();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+            }
+            calc(m);
+            return common::OK;
+        }
+
+        /** \brief 测试指标
+         *
+         * 此方法与 update 方法的区别在于
+         * 不影响指标的内部状态
+         * \param in    输入信号
+         * \param out   输出信号（拟合线在窗口末端的值）
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int test(const T in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief 获取指标值
+         * \return 拟合线在窗口末端（最新点）的值
+         */
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        /** \brief 获取截距 A0（窗口最旧点处的拟合值）
+         */
+        inline T get_intercept() const noexcept {
+            return intercept;
+        }
+
+        /** \brief 获取系数 A1（直线的斜率）
+         */
+        inline T get_slope() const noexcept {
+            return slope;
+        }
+
+        /** \brief 获取系数 A2（抛物线的曲率，直线为 0）
+         */
+        inline T get_curvature() const noexcept {
+            return curvature;
+        }
+
+        /** \brief 获取决定系数 R^2
+         */
+        inline T get_r_squared() const noexcept {
+            return r_squared;
+        }
+
+        /** \brief 清除指标数据
+         */
+        inline void clear() noexcept {
+            buffer.clear();
+            moments.clear();
+            resync_counter = 0;
+            clear_output();
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_ROLLING_REGRESSION_HPP_INCLUDED
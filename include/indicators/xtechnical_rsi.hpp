@@ -21,10 +21,12 @@ namespace xtechnical {
         RSI() {}
 
         /** \brief 初始化相对强弱指标
-         * \param period 指标周期
+         * \param period    指标周期
+         * \param resource  移动平均线的内存源（如果 MA_TYPE 支持）
          */
-        RSI(const size_t period) :
-            iU(period), iD(period) {
+        RSI(const size_t period, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            iU(pmr::make_with_resource<MA_TYPE>(resource, period)),
+            iD(pmr::make_with_resource<MA_TYPE>(resource, period)) {
         }
 
         /** \brief 初始化相对强弱指标
@@ -130,6 +132,87 @@ namespace xtechnical {
             return common::OK;
         }
 
+        /** \brief 一次测试多个输入值
+         *
+         * 结果与对每个 in[i] 调用 test(in[i]) 逐位一致。
+         * 数据按 XTECHNICAL_BLOCK_SIZE 分块处理，涨跌幅先整块计算，
+         * 然后交给 MA_TYPE::test_many，中间数据存放在栈上。
+         * 两个循环都不含条件计算，GCC 在 -O3 下可将其向量化。
+         * 调用后 get() 返回最后一个输入值的结果
+         * \param in    输入信号数组
+         * \param size  数组大小
+         * \param out   输出信号数组（大小为 size，可以与 in 相同）
+         * \return 最后一个输入值的错误码，参见 ErrorType
+         */
+        int test_many(const T *in, const size_t size, T *out) noexcept {
+            if(size == 0) return common::OK;
+            if(!is_update_) {
+                std::fill(out, out + size, std::numeric_limits<T>::quiet_NaN());
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            int err = common::OK;
+            T u[XTECHNICAL_BLOCK_SIZE];
+            T d[XTECHNICAL_BLOCK_SIZE];
+            for (size_t begin = 0; begin < size; begin += XTECHNICAL_BLOCK_SIZE) {
+                const size_t n = std::min((size_t)XTECHNICAL_BLOCK_SIZE, size - begin);
+                const T *block_in = in + begin;
+                T *block_out = out + begin;
+                for (size_t i = 0; i < n; ++i) {
+                    const T x = block_in[i];
+                    u[i] = std::max(T(0), x - prev_);
+                    d[i] = std::max(T(0), prev_ - x);
+                }
+                const int erru = iU.test_many(u, n, u);
+                const int errd = iD.test_many(d, n, d);
+                if(erru != common::OK || errd != common::OK) {
+                    std::fill(block_out, block_out + n, std::numeric_limits<T>::quiet_NaN());
+                    err = common::INDICATOR_NOT_READY_TO_WORK;
+                    continue;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    /* d == 0 时 rs 为无穷大，结果正好是 100，与 test 一致 */
+                    const T num = d[i] == 0 ? T(1) : u[i];
+                    const T rs = num / d[i];
+                    block_out[i] = (T)(100.0 - (100.0 / (1.0 + rs)));
+                }
+                err = common::OK;
+            }
+            output_value = out[size - 1];
+            return err;
+        }
+
+        /** \brief 求使 test 结果等于给定值的输入信号
+         *
+         * MA_TYPE 必须提供 test_coefficients（例如 SMA、EMA、MMA）。
+         * RSI 随输入信号单调不减，因此解是唯一的：
+         * 先按 in == 上一个值时的 RSI 判断价格应上涨还是下跌，
+         * 然后解出对应的线性方程
+         * \param value 期望的 RSI 值，范围 (0, 100)
+         * \param in    输入信号
+         * \return 成功返回0，无法达到该值时返回 INVALID_PARAMETER，否则参见ErrorType
+         */
+        int test_inverse(const T value, T &in) noexcept {
+            if(!is_update_) return common::INDICATOR_NOT_READY_TO_WORK;
+            if(!(value > 0 && value < 100)) return common::INVALID_PARAMETER;
+            T au = 0, bu = 0, ad = 0, bd = 0;
+            const int erru = iU.test_coefficients(au, bu);
+            if(erru != common::OK) return erru;
+            const int errd = iD.test_coefficients(ad, bd);
+            if(errd != common::OK) return errd;
+            // RS = U / D, которое дает заданное значение RSI
+            const T rs = value / ((T)100 - value);
+            if(au >= rs * ad) {
+                // цена падает: U не меняется, D растет
+                if(au <= 0) return common::INVALID_PARAMETER;
+                in = prev_ - (au / rs - ad) / bd;
+            } else {
+                // цена растет: D не меняется, U растет
+                in = prev_ + (rs * ad - au) / bu;
+            }
+            return common::OK;
+        }
+
         /** \brief 获取指标值
          * \return 指标值
          */
@@ -145,6 +228,30 @@ namespace xtechnical {
             iU.clear();
             iD.clear();
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("RSI", 1, sizeof(T));
+            iU.save_state(out);
+            iD.save_state(out);
+            out.write(is_init_);
+            out.write(is_update_);
+            out.write(prev_);
+            out.write(output_value);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("RSI", 1, sizeof(T)) && iU.load_state(in) && iD.load_state(in) &&
+                in.read(is_init_) && in.read(is_update_) && in.read(prev_) && in.read(output_value);
+        }
     };
 
 }; // xtechnical
@@ -9,6 +9,7 @@ namespace xtechnical {
      */
     template <typename T>
     class SMA {
+        XTECHNICAL_PROBE("SMA")
     private:
         xtechnical::circular_buffer<T> buffer;
         T last_data = 0;
@@ -18,10 +19,11 @@ namespace xtechnical {
         SMA() {};
 
         /** \brief 初始化简单移动平均线
-         * \param p     周期
+         * \param p         周期
+         * \param resource  缓冲区的内存源
          */
-        SMA(const size_t p) :
-                buffer(p + 1), period(p) {
+        SMA(const size_t p, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                buffer(p + 1, resource), period(p) {
         }
 
         /** \brief 更新指标状态
@@ -29,6 +31,7 @@ namespace xtechnical {
          * \return 成功返回 0，否则参见 ErrorType
          */
         int update(const T in) noexcept {
+            XTECHNICAL_PROBE_UPDATE();
             if(period == 0) {
                 output_value = std::numeric_limits<T>::quiet_NaN();
                 return common::NO_INIT;
@@ -64,6 +67,7 @@ namespace xtechnical {
          * \return 成功返回 0，否则参见 ErrorType
          */
         int test(const T in) noexcept {
+            XTECHNICAL_PROBE_TEST();
             if(period == 0) {
                 output_value = std::numeric_limits<T>::quiet_NaN();
                 return common::NO_INIT;
@@ -92,6 +96,68 @@ namespace xtechnical {
             return err;
         }
 
+        /** \brief 一次测试多个输入值
+         *
+         * 结果与对每个 in[i] 调用 test(in[i]) 逐位一致。
+         * 窗口的公共部分只计算一次，对各输入值的循环没有分支，
+         * 编译器可以将其向量化。调用后 get() 返回最后一个输入值的结果
+         * \param in    输入信号数组
+         * \param size  数组大小
+         * \param out   输出信号数组（大小为 size，可以与 in 相同）
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int test_many(const T *in, const size_t size, T *out) noexcept {
+            if(size == 0) return common::OK;
+            if(period == 0) {
+                std::fill(out, out + size, std::numeric_limits<T>::quiet_NaN());
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            buffer.test(in[size - 1]);
+            if(!buffer.full()) {
+                std::fill(out, out + size, std::numeric_limits<T>::quiet_NaN());
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            const T sum = last_data;
+            const T front = buffer.front();
+            const T div = (T)period;
+            for(size_t i = 0; i < size; ++i) {
+                out[i] = (sum + (in[i] - front)) / div;
+            }
+            output_value = out[size - 1];
+            return common::OK;
+        }
+
+        /** \brief 获取 test 的线性系数
+         *
+         * test(in) 的结果等于 offset + scale * in（在舍入误差范围内）
+         * \param offset    常数项
+         * \param scale     输入信号的系数
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int test_coefficients(T &offset, T &scale) noexcept {
+            if(period == 0) return common::NO_INIT;
+            buffer.test(last_data);
+            if(!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
+            offset = (last_data - buffer.front()) / (T)period;
+            scale = (T)1 / (T)period;
+            return common::OK;
+        }
+
+        /** \brief 求使 test 结果等于给定值的输入信号
+         * \param value 期望的指标值
+         * \param in    输入信号
+         * \return 成功返回 0，否则参见 ErrorType
+         */
+        int test_inverse(const T value, T &in) noexcept {
+            if(period == 0) return common::NO_INIT;
+            buffer.test(value);
+            if(!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
+            in = value * (T)period - (last_data - buffer.front());
+            return common::OK;
+        }
+
         /** \brief 获取指标值
          * \return 指标值
          */
@@ -106,6 +172,28 @@ namespace xtechnical {
             output_value = std::numeric_limits<T>::quiet_NaN();
             last_data = 0;
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("SMA", 1, sizeof(T));
+            out.write(period);
+            buffer.save_state(out);
+            out.write(last_data);
+            out.write(output_value);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("SMA", 1, sizeof(T)) && in.check(period) && buffer.load_state(in) &&
+                in.read(last_data) && in.read(output_value);
+        }
     };
 
 }; // xtechnical
@@ -11,6 +11,7 @@ namespace xtechnical {
      */
     template <typename T, class MA_TYPE>
     class SuperTrend {
+        XTECHNICAL_PROBE("SuperTrend")
     private:
         CCI<T, MA_TYPE> iCCI;
         ATR<T, MA_TYPE> iATR;
@@ -24,12 +25,15 @@ namespace xtechnical {
          * \param   period_cci  CCI周期. 标准值为50
          * \param   period_atr  ATR周期. 标准值为5
          * \param   coeff_cci   CCI系数, 默认值为0.015
+         * \param   resource    CCI 和 ATR 内部缓冲区的内存源
          */
-        SuperTrend(const size_t period_cci, const size_t period_atr, const T coeff_cci = 0.015) :
-            iCCI(period_cci, coeff_cci), iATR(period_atr) {
+        SuperTrend(const size_t period_cci, const size_t period_atr, const T coeff_cci = 0.015,
+                pmr::memory_resource *resource = pmr::get_default_resource()) :
+            iCCI(period_cci, coeff_cci, resource), iATR(period_atr, resource) {
         };
 
         inline int update(const T in) noexcept {
+            XTECHNICAL_PROBE_UPDATE();
             iCCI.update(in);
             iATR.update(in);
             if (std::isnan(iCCI.get())) return common::NO_INIT;
@@ -41,6 +45,7 @@ namespace xtechnical {
         }
 
         inline int update(const T high, const T low, const T close) noexcept {
+            XTECHNICAL_PROBE_UPDATE();
             iCCI.update(high, low, close);
             iATR.update(high, low, close);
             if (std::isnan(iCCI.get())) return common::NO_INIT;
@@ -64,6 +69,7 @@ namespace xtechnical {
         }
 
         inline int test(const T in) noexcept {
+            XTECHNICAL_PROBE_TEST();
             iCCI.test(in);
             iATR.test(in);
             if (std::isnan(iCCI.get())) return common::NO_INIT;
@@ -75,6 +81,7 @@ namespace xtechnical {
         }
 
         inline int test(const T high, const T low, const T close) noexcept {
+            XTECHNICAL_PROBE_TEST();
             iCCI.test(high, low, close);
             iATR.test(high, low, close);
             if (std::isnan(iCCI.get())) return common::NO_INIT;
@@ -119,6 +126,28 @@ namespace xtechnical {
             output_cci = std::numeric_limits<T>::quiet_NaN();
             output_value = std::numeric_limits<T>::quiet_NaN();
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("SuperTrend", 1, sizeof(T));
+            iCCI.save_state(out);
+            iATR.save_state(out);
+            out.write(output_value);
+            out.write(output_cci);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("SuperTrend", 1, sizeof(T)) && iCCI.load_state(in) &&
+                iATR.load_state(in) && in.read(output_value) && in.read(output_cci);
+        }
     }; // CCI
 
 }; // xtechnical
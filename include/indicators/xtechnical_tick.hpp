@@ -0,0 +1,821 @@
+#ifndef XTECHNICAL_TICK_HPP_INCLUDED
+#define XTECHNICAL_TICK_HPP_INCLUDED
+
+#include "../xtechnical_common.hpp"
+#include "../xtechnical_circular_buffer.hpp"
+#include "../xtechnical_monotonic_queue.hpp"
+#include <type_traits>
+#include <cstdint>
+
+namespace xtechnical {
+
+    /** \brief 整数 tick 价格的指标
+     *
+     * 输入为整数 tick（价格 / pips_size，例如 ClusterShaper 中的 tick），
+     * 窗口中只存储 tick（int32_t 时内存减半），滚动和使用 int64_t 精确累加，
+     * 不会累积舍入误差，也不需要定期重新计算。
+     * 只有输出才乘以 pips_size 转换为浮点价格。
+     * 行为（就绪条件、test、错误码）与对应的浮点指标相同。
+     */
+    namespace tick {
+
+        /** \brief 价格转换为 tick
+         * \param price     价格
+         * \param pips_size 价格精度，例如 0.00001
+         * \return 四舍五入后的 tick
+         */
+        template <typename I>
+        inline I to_ticks(const double price, const double pips_size) noexcept {
+            return (I)std::llround(price / pips_size);
+        }
+
+        /** \brief 简单移动平均线（整数 tick）
+         */
+        template <typename I, typename T = double>
+        class SMA {
+            static_assert(std::is_integral<I>::value, "tick type must be integral");
+        private:
+            xtechnical::circular_buffer<I> buffer;
+            int64_t sum = 0;        /**< 窗口中 tick 的精确和 */
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+            T pips_size = 1;
+            size_t period = 0;
+        public:
+            SMA() {};
+
+            /** \brief 初始化简单移动平均线
+             * \param p     周期
+             * \param ps    价格精度，输出为 tick 的平均值乘以 ps
+             */
+            SMA(const size_t p, const T ps = 1) :
+                    buffer(p + 1), pips_size(ps), period(p) {
+            }
+
+            /** \brief 更新指标状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in) noexcept {
+                if(period == 0) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::NO_INIT;
+                }
+                buffer.update(in);
+                if(buffer.full()) {
+                    sum += (int64_t)in - (int64_t)buffer.front();
+                    output_value = (T)sum * pips_size / (T)period;
+                } else {
+                    sum += in;
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入 tick
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in) noexcept {
+                if(period == 0) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::NO_INIT;
+                }
+                buffer.test(in);
+                if(buffer.full()) {
+                    const int64_t s = sum + ((int64_t)in - (int64_t)buffer.front());
+                    output_value = (T)s * pips_size / (T)period;
+                } else {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 测试指标
+             * \param in    输入 tick
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值（价格）
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 获取窗口中 tick 的精确和
+             *
+             * 指标就绪后为最后 period 个 tick 的和
+             */
+            inline int64_t get_sum_ticks() const noexcept {
+                return sum;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                buffer.clear();
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                sum = 0;
+            }
+
+            /** \brief 保存指标状态
+             * \param out 状态写入器
+             */
+            void save_state(StateWriter &out) const {
+                out.begin("TickSMA", 1, sizeof(I));
+                out.write(period);
+                out.write(pips_size);
+                buffer.save_state(out);
+                out.write(sum);
+                out.write(output_value);
+            }
+
+            /** \brief 加载指标状态
+             *
+             * 指标必须以与保存时相同的参数创建
+             * \param in 状态读取器
+             * \return 成功返回 true
+             */
+            bool load_state(StateReader &in) {
+                return in.begin("TickSMA", 1, sizeof(I)) && in.check(period) && in.check(pips_size) &&
+                    buffer.load_state(in) && in.read(sum) && in.read(output_value);
+            }
+        };
+
+        /** \brief 滑动和（整数 tick）
+         */
+        template <typename I, typename T = double>
+        class SUM {
+            static_assert(std::is_integral<I>::value, "tick type must be integral");
+        private:
+            xtechnical::circular_buffer<I> buffer;
+            int64_t sum = 0;        /**< 窗口中 tick 的精确和 */
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+            T pips_size = 1;
+            size_t period = 0;
+        public:
+            SUM() {};
+
+            /** \brief 初始化滑动和
+             * \param p     周期
+             * \param ps    价格精度，输出为 tick 的和乘以 ps
+             */
+            SUM(const size_t p, const T ps = 1) :
+                    buffer(p + 1), pips_size(ps), period(p) {
+            }
+
+            /** \brief 更新指标状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in) noexcept {
+                if(period == 0) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::NO_INIT;
+                }
+                buffer.update(in);
+                if(buffer.full()) {
+                    sum += (int64_t)in - (int64_t)buffer.front();
+                    output_value = (T)sum * pips_size;
+                } else {
+                    sum += in;
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入 tick
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in) noexcept {
+                if(period == 0) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::NO_INIT;
+                }
+                buffer.test(in);
+                if(buffer.full()) {
+                    const int64_t s = sum + ((int64_t)in - (int64_t)buffer.front());
+                    output_value = (T)s * pips_size;
+                } else {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                return common::OK;
+            }
+
+            /** \brief 测试指标
+             * \param in    输入 tick
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值（价格）
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 获取窗口中 tick 的精确和
+             */
+            inline int64_t get_ticks() const noexcept {
+                return sum;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                buffer.clear();
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                sum = 0;
+            }
+
+            /** \brief 保存指标状态
+             * \param out 状态写入器
+             */
+            void save_state(StateWriter &out) const {
+                out.begin("TickSUM", 1, sizeof(I));
+                out.write(period);
+                out.write(pips_size);
+                buffer.save_state(out);
+                out.write(sum);
+                out.write(output_value);
+            }
+
+            /** \brief 加载指标状态
+             *
+             * 指标必须以与保存时相同的参数创建
+             * \param in 状态读取器
+             * \return 成功返回 true
+             */
+            bool load_state(StateReader &in) {
+                return in.begin("TickSUM", 1, sizeof(I)) && in.check(period) && in.check(pips_size) &&
+                    buffer.load_state(in) && in.read(sum) && in.read(output_value);
+            }
+        };
+
+        /** \brief 标准差（整数 tick）
+         *
+         * 窗口内保存 (x - base) 的和与平方和，二者都是精确的整数。
+         * 方差按 (n * s2 - s1 * s1) / (n * (n - 1)) 计算，分子在整数中精确求得，
+         * 因此没有浮点算法中的抵消误差。base 每 period 次更新移动到最新的 tick，
+         * 只是为了让平方和保持较小，结果不受影响。
+         * 要求 period^2 * (窗口内 tick 的波动范围)^2 不超过 int64_t 的范围
+         */
+        template <typename I, typename T = double>
+        class StdDev {
+            static_assert(std::is_integral<I>::value, "tick type must be integral");
+        private:
+            xtechnical::circular_buffer<I> buffer;
+            int64_t base = 0;       /**< 和的基准值 */
+            int64_t sum = 0;        /**< 窗口中 (x - base) 的和 */
+            int64_t sum_sq = 0;     /**< 窗口中 (x - base)^2 的和 */
+            size_t rebase_counter = 0;
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+            T pips_size = 1;
+            size_t period = 0;
+
+            /** \brief 以新的基准值重新计算窗口的和
+             */
+            void rebase(const int64_t new_base) noexcept {
+                base = new_base;
+                sum = 0;
+                sum_sq = 0;
+                /* 缓冲区索引从大小为 period + 1 的满缓冲区末尾开始计算 */
+                const size_t size = std::min(buffer.size(), period);
+                for (size_t i = period + 1 - size; i <= period; ++i) {
+                    const int64_t y = (int64_t)buffer[i] - base;
+                    sum += y;
+                    sum_sq += y * y;
+                }
+                rebase_counter = 0;
+            }
+
+            inline T calc_output(const int64_t s, const int64_t s_sq) const noexcept {
+                const int64_t n = (int64_t)period;
+                const int64_t num = n * s_sq - s * s;
+                const T var = (T)num / ((T)n * (T)(n - 1));
+                return (var > 0 ? std::sqrt(var) : 0) * pips_size;
+            }
+
+        public:
+            StdDev() {};
+
+            /** \brief 初始化标准差
+             * \param p     周期
+             * \param ps    价格精度，输出为 tick 的标准差乘以 ps
+             */
+            StdDev(const size_t p, const T ps = 1) :
+                    buffer(p + 1), pips_size(ps), period(p) {
+            }
+
+            /** \brief 更新指标状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in) noexcept {
+                if(period == 0) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::NO_INIT;
+                }
+                if(buffer.empty()) base = in;
+                buffer.update(in);
+                const int64_t y = (int64_t)in - base;
+                sum += y;
+                sum_sq += y * y;
+                if(buffer.full()) {
+                    const int64_t y_front = (int64_t)buffer.front() - base;
+                    sum -= y_front;
+                    sum_sq -= y_front * y_front;
+                }
+                if(++rebase_counter >= period) rebase(in);
+                if(!buffer.full()) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                output_value = calc_output(sum, sum_sq);
+                return common::OK;
+            }
+
+            /** \brief 更新指标状态
+             * \param in    输入 tick
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in) noexcept {
+                if(period == 0) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::NO_INIT;
+                }
+                buffer.test(in);
+                if(!buffer.full()) {
+                    output_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                const int64_t y = (int64_t)in - base;
+                const int64_t y_front = (int64_t)buffer.front() - base;
+                output_value = calc_output(sum + y - y_front, sum_sq + y * y - y_front * y_front);
+                return common::OK;
+            }
+
+            /** \brief 测试指标
+             * \param in    输入 tick
+             * \param out   输出信号
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值（价格）
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                buffer.clear();
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                base = sum = sum_sq = 0;
+                rebase_counter = 0;
+            }
+
+            /** \brief 保存指标状态
+             * \param out 状态写入器
+             */
+            void save_state(StateWriter &out) const {
+                out.begin("TickStdDev", 1, sizeof(I));
+                out.write(period);
+                out.write(pips_size);
+                buffer.save_state(out);
+                out.write(base);
+                out.write(sum);
+                out.write(sum_sq);
+                out.write(rebase_counter);
+                out.write(output_value);
+            }
+
+            /** \brief 加载指标状态
+             *
+             * 指标必须以与保存时相同的参数创建
+             * \param in 状态读取器
+             * \return 成功返回 true
+             */
+            bool load_state(StateReader &in) {
+                return in.begin("TickStdDev", 1, sizeof(I)) && in.check(period) && in.check(pips_size) &&
+                    buffer.load_state(in) && in.read(base) && in.read(sum) && in.read(sum_sq) &&
+                    in.read(rebase_counter) && in.read(output_value);
+            }
+        };
+
+        /** \brief 滑动最小值和最大值（整数 tick）
+         */
+        template <typename I, typename T = double>
+        class MinMax {
+            static_assert(std::is_integral<I>::value, "tick type must be integral");
+        private:
+            MonotonicMinMax<I> window;
+            I min_ticks = 0;
+            I max_ticks = 0;
+            T output_min_value = std::numeric_limits<T>::quiet_NaN();
+            T output_max_value = std::numeric_limits<T>::quiet_NaN();
+            T pips_size = 1;
+            size_t period = 0;
+
+            inline int set_output(const bool is_ready) noexcept {
+                if(!is_ready) {
+                    output_min_value = std::numeric_limits<T>::quiet_NaN();
+                    output_max_value = std::numeric_limits<T>::quiet_NaN();
+                    return common::INDICATOR_NOT_READY_TO_WORK;
+                }
+                output_min_value = (T)min_ticks * pips_size;
+                output_max_value = (T)max_ticks * pips_size;
+                return common::OK;
+            }
+
+        public:
+            MinMax() {};
+
+            /** \brief 初始化滑动最小值和最大值
+             * \param p     周期
+             * \param o     向后偏移
+             * \param ps    价格精度
+             */
+            MinMax(const size_t p, const size_t o = 0, const T ps = 1) :
+                    window(p, o), pips_size(ps), period(p) {
+            }
+
+            /** \brief 更新指标状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in) noexcept {
+                if(period == 0) return set_output(false), common::NO_INIT;
+                return set_output(window.update(in, min_ticks, max_ticks));
+            }
+
+            /** \brief 更新指标状态
+             * \param in        输入 tick
+             * \param min_value 周期内的最小值
+             * \param max_value 周期内的最大值
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int update(const I in, T &min_value, T &max_value) noexcept {
+                const int err = update(in);
+                min_value = output_min_value;
+                max_value = output_max_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in) noexcept {
+                if(period == 0) return set_output(false), common::NO_INIT;
+                return set_output(window.test(in, min_ticks, max_ticks));
+            }
+
+            /** \brief 测试指标
+             * \param in        输入 tick
+             * \param min_value 周期内的最小值
+             * \param max_value 周期内的最大值
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            int test(const I in, T &min_value, T &max_value) noexcept {
+                const int err = test(in);
+                min_value = output_min_value;
+                max_value = output_max_value;
+                return err;
+            }
+
+            inline T get_min() const noexcept {return output_min_value;};
+            inline T get_max() const noexcept {return output_max_value;};
+            inline I get_min_ticks() const noexcept {return min_ticks;};
+            inline I get_max_ticks() const noexcept {return max_ticks;};
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                window.clear();
+                set_output(false);
+            }
+        };
+
+        /** \brief 真实范围（整数 tick）
+         */
+        template <typename I, typename T = double>
+        class TrueRange {
+            static_assert(std::is_integral<I>::value, "tick type must be integral");
+        private:
+            I last_data = 0;
+            I output_ticks = 0;
+            bool is_last_data = false;
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+            T pips_size = 1;
+        public:
+            /** \brief 初始化真实范围
+             * \param ps 价格精度
+             */
+            TrueRange(const T ps = 1) : pips_size(ps) {};
+
+            inline int update(const I high, const I low, const I close) noexcept {
+                output_ticks = std::max(std::max(high - low, high - close), close - low);
+                output_value = (T)output_ticks * pips_size;
+                return common::OK;
+            }
+
+            inline int update(const I high, const I low, const I close, T &out) noexcept {
+                const int err = update(high, low, close);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 更新指标状态
+             * \param in 输入 tick
+             * \return 成功返回0，否则参见ErrorType
+             */
+            inline int update(const I in) noexcept {
+                if(!is_last_data) {
+                    last_data = in;
+                    is_last_data = true;
+                    return common::NO_INIT;
+                }
+                output_ticks = in > last_data ? in - last_data : last_data - in;
+                output_value = (T)output_ticks * pips_size;
+                last_data = in;
+                return common::OK;
+            }
+
+            inline int update(const I in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            inline int test(const I high, const I low, const I close) noexcept {
+                return update(high, low, close);
+            }
+
+            inline int test(const I high, const I low, const I close, T &out) noexcept {
+                const int err = test(high, low, close);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此函数与update不同，
+             * 不会影响指标的内部状态
+             * \param in 输入 tick
+             * \return 成功返回0，否则参见ErrorType
+             */
+            inline int test(const I in) noexcept {
+                if(!is_last_data) return common::NO_INIT;
+                output_ticks = in > last_data ? in - last_data : last_data - in;
+                output_value = (T)output_ticks * pips_size;
+                return common::OK;
+            }
+
+            inline int test(const I in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值（价格）
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值（tick）
+             */
+            inline I get_ticks() const noexcept {
+                return output_ticks;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_ticks = 0;
+                is_last_data = false;
+            }
+
+            /** \brief 保存指标状态
+             * \param out 状态写入器
+             */
+            void save_state(StateWriter &out) const {
+                out.begin("TickTrueRange", 1, sizeof(I));
+                out.write(pips_size);
+                out.write(last_data);
+                out.write(output_ticks);
+                out.write(is_last_data);
+                out.write(output_value);
+            }
+
+            /** \brief 加载指标状态
+             *
+             * 指标必须以与保存时相同的参数创建
+             * \param in 状态读取器
+             * \return 成功返回 true
+             */
+            bool load_state(StateReader &in) {
+                return in.begin("TickTrueRange", 1, sizeof(I)) && in.check(pips_size) &&
+                    in.read(last_data) && in.read(output_ticks) && in.read(is_last_data) &&
+                    in.read(output_value);
+            }
+        };
+
+        /** \brief 平均真实范围（整数 tick）
+         *
+         * 真实范围以 tick 计算，平均值使用精确整数和的 tick::SMA
+         */
+        template <typename I, typename T = double>
+        class ATR {
+            static_assert(std::is_integral<I>::value, "tick type must be integral");
+        private:
+            SMA<I, T> ma;
+            TrueRange<I, T> tr;
+            T output_value = std::numeric_limits<T>::quiet_NaN();
+        public:
+            ATR() {};
+
+            /** \brief 初始化平均真实范围
+             * \param period    周期
+             * \param ps        价格精度
+             */
+            ATR(const size_t period, const T ps = 1) : ma(period, ps), tr(ps) {}
+
+            inline int update(const I high, const I low, const I close) noexcept {
+                tr.update(high, low, close);
+                if(ma.update(tr.get_ticks()) != common::OK) return common::NO_INIT;
+                output_value = ma.get();
+                return common::OK;
+            }
+
+            inline int update(const I high, const I low, const I close, T &out) noexcept {
+                const int err = update(high, low, close);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 更新指标状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            inline int update(const I in) noexcept {
+                if(tr.update(in) != common::OK) return common::NO_INIT;
+                if(ma.update(tr.get_ticks()) != common::OK) return common::NO_INIT;
+                output_value = ma.get();
+                return common::OK;
+            }
+
+            inline int update(const I in, T &out) noexcept {
+                const int err = update(in);
+                out = output_value;
+                return err;
+            }
+
+            inline int test(const I high, const I low, const I close) noexcept {
+                tr.test(high, low, close);
+                if(ma.test(tr.get_ticks()) != common::OK) return common::NO_INIT;
+                output_value = ma.get();
+                return common::OK;
+            }
+
+            inline int test(const I high, const I low, const I close, T &out) noexcept {
+                const int err = test(high, low, close);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 测试指标
+             *
+             * 此方法与 update 方法的区别在于
+             * 不影响指标的内部状态
+             * \param in 输入 tick
+             * \return 成功返回 0，否则参见 ErrorType
+             */
+            inline int test(const I in) noexcept {
+                if(tr.test(in) != common::OK) return common::NO_INIT;
+                if(ma.test(tr.get_ticks()) != common::OK) return common::NO_INIT;
+                output_value = ma.get();
+                return common::OK;
+            }
+
+            inline int test(const I in, T &out) noexcept {
+                const int err = test(in);
+                out = output_value;
+                return err;
+            }
+
+            /** \brief 获取指标值
+             * \return 指标值（价格）
+             */
+            inline T get() const noexcept {
+                return output_value;
+            }
+
+            /** \brief 清除指标数据
+             */
+            inline void clear() noexcept {
+                ma.clear();
+                tr.clear();
+                output_value = std::numeric_limits<T>::quiet_NaN();
+            }
+
+            /** \brief 保存指标状态
+             * \param out 状态写入器
+             */
+            void save_state(StateWriter &out) const {
+                out.begin("TickATR", 1, sizeof(I));
+                ma.save_state(out);
+                tr.save_state(out);
+                out.write(output_value);
+            }
+
+            /** \brief 加载指标状态
+             *
+             * 指标必须以与保存时相同的参数创建
+             * \param in 状态读取器
+             * \return 成功返回 true
+             */
+            bool load_state(StateReader &in) {
+                return in.begin("TickATR", 1, sizeof(I)) && ma.load_state(in) &&
+                    tr.load_state(in) && in.read(output_value);
+            }
+        };
+
+    }; // tick
+
+}; // xtechnical
+
+#endif // XTECHNICAL_TICK_HPP_INCLUDED
@@ -103,6 +103,26 @@ namespace xtechnical {
             output_value = std::numeric_limits<T>::quiet_NaN();
             last_data = std::numeric_limits<T>::quiet_NaN();
         }
+
+        /** \brief 保存指标状态
+         * \param out 状态写入器
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("TrueRange", 1, sizeof(T));
+            out.write(last_data);
+            out.write(output_value);
+        }
+
+        /** \brief 加载指标状态
+         *
+         * 指标必须以与保存时相同的参数创建
+         * \param in 状态读取器
+         * \return 成功返回 true
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("TrueRange", 1, sizeof(T)) && in.read(last_data) &&
+                in.read(output_value);
+        }
     }; // TrueRange
 
 }; // xtechnical
@@ -2,39 +2,117 @@
 #define XTECHNICAL_CIRCULAR_BUFFER_HPP_INCLUDED
 
 #include <vector>
+#include "xtechnical_instrumentation.hpp"
+#include "xtechnical_memory_resource.hpp"
+#include "xtechnical_state.hpp"
 
 namespace xtechnical {
     /** \brief Класс циклического буфера
+     *
+     * Буфер занимает ровно size элементов, индекс при переходе через конец
+     * массива вычисляется одним сравнением и вычитанием (без деления).
+     * В режиме теста буфер не копируется: новое значение хранится отдельно
+     * и подставляется на место последнего элемента.
      */
     template<class T>
     class circular_buffer {
+        XTECHNICAL_PROBE("circular_buffer")
     private:
 	
-        std::vector<T> buffer;      /**< Основной буфер */
-        std::vector<T> buffer_test; /**< Буфер для теста */
+        pmr::vector<T> buffer;      /**< Основной буфер */
+        T test_value;               /**< Значение для теста */
         uint32_t buffer_size;       /**< Размер буфера */
         uint32_t buffer_size_div2;  /**< Индекс середины массива */
-        uint32_t buffer_offset;     /**< Смещение в буфере для размера массива не кратного степени двойки */
         uint32_t count;             /**< Количество элементов в буфере */
-        uint32_t count_test;        /**< Количество элементов в буфере для теста */
-        uint32_t offset;            /**< Смещение в буфере */
-        uint32_t offset_test;
-        uint32_t mask;              /**< Маска */
-        bool is_power_of_two;       /**< Флаг степени двойки */
+        uint32_t offset;            /**< Смещение в буфере, указывает на самый старый элемент */
         bool is_test;               /**< Флаг теста */
 
-        inline const uint32_t cpl2(uint32_t x) const {
-            x = x - 1;
-            x = x | (x >> 1);
-            x = x | (x >> 2);
-            x = x | (x >> 4);
-            x = x | (x >> 8);
-            x = x | (x >> 16);
-            return x + 1;
+        pmr::vector<T> prefix_sum;      /**< Префиксные суммы (x - prefix_shift) */
+        pmr::vector<T> prefix_sum_sq;   /**< Префиксные суммы (x - prefix_shift)^2 */
+        T prefix_shift;                 /**< Опорное значение префиксных сумм */
+        T prefix_sum_test;              /**< Префиксная сумма с учетом значения теста */
+        T prefix_sum_sq_test;           /**< Префиксная сумма квадратов с учетом значения теста */
+        uint32_t prefix_pos;            /**< Позиция последнего значения в префиксных суммах */
+        bool use_prefix_sum;            /**< Флаг префиксных сумм */
+
+        /** \brief Привести позицию к индексу массива
+         * \param pos Позиция от 0 до 2 * buffer_size - 1
+         */
+        inline uint32_t wrap(const uint32_t pos) const {
+            return pos >= buffer_size ? pos - buffer_size : pos;
+        }
+
+        /** \brief Индекс массива для индекса буфера без учета теста
+         */
+        inline uint32_t committed_index(const uint32_t index) const {
+            return wrap(offset + index);
+        }
+
+        /** \brief Значение по индексу буфера с учетом теста
+         */
+        inline T &at(const uint32_t index) {
+            if(is_test) {
+                const uint32_t pos = wrap(wrap(offset + 1) + index);
+                return pos == offset ? test_value : buffer[pos];
+            }
+            return buffer[committed_index(index)];
+        }
+
+        inline const T &at(const uint32_t index) const {
+            if(is_test) {
+                const uint32_t pos = wrap(wrap(offset + 1) + index);
+                return pos == offset ? test_value : buffer[pos];
+            }
+            return buffer[committed_index(index)];
+        }
+
+        /** \brief Пересчитать префиксные суммы по содержимому буфера
+         *
+         * Вызывается при инициализации и каждые buffer_size обновлений,
+         * поэтому ошибка округления не накапливается, а обновление стоит O(1) в среднем
+         */
+        void rebuild_prefix_sum() {
+            if(!use_prefix_sum) return;
+            prefix_shift = buffer[committed_index(buffer_size - 1)];
+            prefix_sum[0] = 0;
+            prefix_sum_sq[0] = 0;
+            for(uint32_t index = 0; index < buffer_size; ++index) {
+                const T value = buffer[committed_index(index)] - prefix_shift;
+                prefix_sum[index + 1] = prefix_sum[index] + value;
+                prefix_sum_sq[index + 1] = prefix_sum_sq[index] + value * value;
+            }
+            prefix_pos = buffer_size;
+        }
+
+        inline void push_prefix_sum(const T value) {
+            const T diff = value - prefix_shift;
+            prefix_sum[prefix_pos + 1] = prefix_sum[prefix_pos] + diff;
+            prefix_sum_sq[prefix_pos + 1] = prefix_sum_sq[prefix_pos] + diff * diff;
+            if(++prefix_pos == 2 * buffer_size) rebuild_prefix_sum();
+        }
+
+        inline void test_prefix_sum(const T value) {
+            const T diff = value - prefix_shift;
+            prefix_sum_test = prefix_sum[prefix_pos] + diff;
+            prefix_sum_sq_test = prefix_sum_sq[prefix_pos] + diff * diff;
         }
 
-        inline const bool check_power_of_two(const uint32_t value) const {
-            return value && !(value & (value - 1));
+        /** \brief Префиксные суммы на границе индекса буфера
+         * \param index Индекс буфера от 0 до buffer_size включительно
+         */
+        inline void get_prefix_sum(const uint32_t index, T &s, T &s_sq) const {
+            if(is_test) {
+                if(index == buffer_size) {
+                    s = prefix_sum_test;
+                    s_sq = prefix_sum_sq_test;
+                    return;
+                }
+                s = prefix_sum[prefix_pos + 1 - buffer_size + index];
+                s_sq = prefix_sum_sq[prefix_pos + 1 - buffer_size + index];
+                return;
+            }
+            s = prefix_sum[prefix_pos - buffer_size + index];
+            s_sq = prefix_sum_sq[prefix_pos - buffer_size + index];
         }
 		
     public:
@@ -44,67 +122,104 @@ namespace xtechnical {
         /** \brief Конструктор циклического буфера
          */
         circular_buffer() :
-            buffer_size(0), buffer_size_div2(0), buffer_offset(0),
-            count(0), count_test(0), offset(0), offset_test(0), mask(0),
-            is_power_of_two(false), is_test(false) {};
+            test_value(0), buffer_size(0), buffer_size_div2(0),
+            count(0), offset(0), is_test(false),
+            prefix_shift(0), prefix_sum_test(0), prefix_sum_sq_test(0),
+            prefix_pos(0), use_prefix_sum(false) {};
+
+        /** \brief Конструктор пустого циклического буфера
+         * \param resource        Источник памяти буфера
+         */
+        explicit circular_buffer(pmr::memory_resource *resource) :
+            buffer(resource), test_value(0), buffer_size(0), buffer_size_div2(0),
+            count(0), offset(0), is_test(false),
+            prefix_sum(resource), prefix_sum_sq(resource),
+            prefix_shift(0), prefix_sum_test(0), prefix_sum_sq_test(0),
+            prefix_pos(0), use_prefix_sum(false) {};
 
         /** \brief Конструктор циклического буфера
-         * \param user_size Размер циклического буфера
-         */
-        circular_buffer(const size_t user_size) :
-                buffer_size(user_size), buffer_size_div2(0), buffer_offset(0),
-                count(0), count_test(0), offset(0), offset_test(0),
-                is_power_of_two(false), is_test(false) {
-            if(check_power_of_two(user_size)) {
-                buffer.resize(buffer_size);
-                buffer_test.resize(buffer_size);
-                mask = user_size - 1;
-                is_power_of_two = true;
-            } else {
-                const size_t new_size = cpl2(buffer_size);
-                buffer.resize(new_size);
-                buffer_test.resize(new_size);
-                mask = new_size - 1;
-                buffer_offset = buffer_size - new_size;
-                is_power_of_two = false;
+         *
+         * С включенными префиксными суммами методы sum(), sum(start_index, stop_index),
+         * mean() и variance() работают за O(1), в том числе в режиме теста,
+         * и совпадают с перебором элементов с точностью до округления.
+         * После записи в буфер через ссылки (get, operator[], front, back, middle)
+         * префиксные суммы не обновляются.
+         * \param user_size       Размер циклического буфера
+         * \param use_prefix      Включить префиксные суммы
+         * \param resource        Источник памяти буфера
+         */
+        circular_buffer(const size_t user_size, const bool use_prefix = false,
+                pmr::memory_resource *resource = pmr::get_default_resource()) :
+                buffer(resource), test_value(0), buffer_size(user_size), buffer_size_div2(user_size / 2),
+                count(0), offset(0), is_test(false),
+                prefix_sum(resource), prefix_sum_sq(resource),
+                prefix_shift(0), prefix_sum_test(0), prefix_sum_sq_test(0),
+                prefix_pos(0), use_prefix_sum(use_prefix && user_size > 0) {
+            buffer.resize(buffer_size);
+            if(use_prefix_sum) {
+                prefix_sum.resize(2 * buffer_size + 1);
+                prefix_sum_sq.resize(2 * buffer_size + 1);
+                rebuild_prefix_sum();
             }
-            buffer_size_div2 = buffer_size / 2;
         };
 
+        /** \brief Конструктор циклического буфера без префиксных сумм
+         *
+         * Отдельная перегрузка, чтобы указатель на источник не превратился в bool
+         * \param user_size       Размер циклического буфера
+         * \param resource        Источник памяти буфера
+         */
+        circular_buffer(const size_t user_size, pmr::memory_resource *resource) :
+            circular_buffer(user_size, false, resource) {};
+
+        /** \brief Проверить, если включены префиксные суммы
+         */
+        inline bool has_prefix_sum() const {
+            return use_prefix_sum;
+        }
+
         /** \brief Добавить значение в циклический буфер
          * \param value Значение
          */
         inline void push_back(const T value) {
-            buffer[offset++] = value;
-            if(offset > count) count = offset;
-            offset &= mask;
+            buffer[offset] = value;
+            offset = wrap(offset + 1);
+            if(count < buffer_size) ++count;
+            if(use_prefix_sum) push_prefix_sum(value);
         }
 
         /** \brief Получить размер циклического буфера
          * \return Размер циклического буфера. Может быть меньше максимального, если буфер еще не заполнился.
          */
         inline size_t size() const {
-            return is_test ? std::min((size_t)count_test, (size_t)buffer_size) : std::min((size_t)count, (size_t)buffer_size);
+            return is_test ? std::min((size_t)count + 1, (size_t)buffer_size) : (size_t)count;
         }
 
         /** \brief Проверить, если циклическй буфер пуст
          * \return Вернет true, если циклическй буфер пуст
          */
         inline bool empty() const {
-            return is_test ? (count_test == 0) : (count == 0);
+            return is_test ? false : (count == 0);
         }
 
         /** \brief Проверить, если циклическй буфер полн
          * \return Вернет true, если циклическй буфер полн
          */
         inline bool full() const {
-            if(is_test) return (count_test >= buffer_size);
+            if(is_test) return ((count + 1) >= buffer_size);
             return (count >= buffer_size);
         }
 
+        /** \brief Заполнить буфер значением
+         *
+         * В режиме теста заполняется и основной буфер, и значение теста
+         * \param value Значение
+         */
         void fill(const T value) {
-            if(is_test) std::fill(buffer_test.begin(), buffer_test.end(), value);
-            else std::fill(buffer.begin(), buffer.end(), value);
+            std::fill(buffer.begin(), buffer.end(), value);
+            if(is_test) test_value = value;
+            rebuild_prefix_sum();
+            if(is_test && use_prefix_sum) test_prefix_sum(value);
         }
 
         /** \brief Обновить состояние циклического буфера
@@ -112,6 +227,7 @@ namespace xtechnical {
          * \return Вернет true, если циклическй буфер полн
          */
         inline bool update(const T value) {
+            XTECHNICAL_PROBE_COUNT_UPDATE();
             is_test = false;
             push_back(value);
             return full();
@@ -122,17 +238,10 @@ namespace xtechnical {
          * \return Вернет true, если циклическй буфер полн
          */
         inline bool test(const double value) {
-            if(!is_test) {
-                is_test = true;
-                buffer_test = buffer;
-                offset_test = offset;
-                count_test = count;
-                buffer_test[offset_test++] = value;
-                if(offset_test > count_test) count_test = offset_test;
-                offset_test &= mask;
-            } else {
-                buffer_test[(offset_test - 1) & mask] = value;
-            }
+            XTECHNICAL_PROBE_COUNT_TEST();
+            is_test = true;
+            test_value = value;
+            if(use_prefix_sum) test_prefix_sum(value);
             return full();
         }
 
@@ -141,8 +250,7 @@ namespace xtechnical {
          * \return Значение циклического буфера
          */
         inline T &get(const uint32_t index) {
-            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
-            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return at(index);
         }
 
         /** \brief Получить значение циклического буфера по индексу
@@ -150,8 +258,7 @@ namespace xtechnical {
          * \return Значение циклического буфера
          */
         T& operator[](std::size_t index) {
-            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
-            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return at(index);
         }
 
         /** \brief Получить значение циклического буфера по индексу
@@ -159,96 +266,60 @@ namespace xtechnical {
          * \return Значение циклического буфера
          */
         const T& operator[](std::size_t index) const {
-            if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
-            return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            return at(index);
         }
 
         /** \brief Доступ к первому элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline T &front() {
-            if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
-            return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            return at(0);
         }
 
         /** \brief Доступ к первому элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline const T &front() const {
-            if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
-            return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            return at(0);
         }
 
         /** \brief Доступ к последнему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline T &back() {
-            if(is_test) return buffer_test[(offset_test - 1) & mask];
-            return buffer[(offset - 1) & mask];
+            if(is_test) return test_value;
+            return buffer[committed_index(buffer_size - 1)];
         }
 
         /** \brief Доступ к последнему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline const T &back() const {
-            if(is_test) return buffer_test[(offset_test - 1) & mask];
-            return buffer[(offset - 1) & mask];
+            if(is_test) return test_value;
+            return buffer[committed_index(buffer_size - 1)];
         }
 
         /** \brief Доступ к среднему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline T &middle() {
-            if(is_test) {
-                if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-                else return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
-            }
-            if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-            else return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+            if(full()) return at(buffer_size_div2);
+            return at(size() / 2);
         }
 
         /** \brief Доступ к среднему элементу
          * \return Возвращает ссылку на первый элемент циклического буфера
          */
         inline const T &middle() const {
-            if(is_test) {
-                if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-                return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
-            }
-            if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
-            return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+            if(full()) return at(buffer_size_div2);
+            return at(size() / 2);
         }
 
         /** \brief Получить сумму
          * \return Возвращает сумму элементов циклического буфера
          */
         inline const T sum() const {
-            T temp = 0;
-            if(is_test) {
-                if(is_power_of_two) {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer_test[(offset_test + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
-                }
-            } else {
-                if(is_power_of_two) {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer[(offset + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = 0; index < buffer_size; ++index) {
-                        temp += buffer[(offset + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
-                }
-            }
+            return sum(0, buffer_size);
         }
 
         /** \brief Получить сумму
@@ -257,32 +328,26 @@ namespace xtechnical {
          * \return Возвращает сумму элементов циклического буфера
          */
         inline const T sum(const uint32_t start_index, const uint32_t stop_index) const {
+            if(use_prefix_sum) {
+                if(stop_index <= start_index) return 0;
+                T s_start = 0, s_sq_start = 0, s_stop = 0, s_sq_stop = 0;
+                get_prefix_sum(start_index, s_start, s_sq_start);
+                get_prefix_sum(stop_index, s_stop, s_sq_stop);
+                return (s_stop - s_start) + (T)(stop_index - start_index) * prefix_shift;
+            }
             T temp = 0;
             if(is_test) {
-                if(is_power_of_two) {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer_test[(offset_test + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
-                }
-            } else {
-                if(is_power_of_two) {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer[(offset + index) & mask];
-                    }
-                    return temp;
-                } else {
-                    for(uint32_t index = start_index; index < stop_index; ++index) {
-                        temp += buffer[(offset + (index - buffer_offset)) & mask];
-                    }
-                    return temp;
+                for(uint32_t index = start_index; index < stop_index; ++index) {
+                    temp += at(index);
                 }
+                return temp;
             }
+            uint32_t pos = committed_index(start_index);
+            for(uint32_t index = start_index; index < stop_index; ++index) {
+                temp += buffer[pos];
+                pos = wrap(pos + 1);
+            }
+            return temp;
         }
 
         /** \brief Получить среднее значение
@@ -292,58 +357,101 @@ namespace xtechnical {
             return sum() / (T)buffer_size;
         }
 
+        /** \brief Получить дисперсию
+         * \param start_index Начальный индекс
+         * \param stop_index Конечный индекс
+         * \return Возвращает выборочную дисперсию (деление на n - 1) элементов от start_index до stop_index, не включая stop_index
+         */
+        inline const T variance(const uint32_t start_index, const uint32_t stop_index) const {
+            if(stop_index <= start_index + 1) return 0;
+            const T n = (T)(stop_index - start_index);
+            T s = 0, s_sq = 0;
+            if(use_prefix_sum) {
+                T s_start = 0, s_sq_start = 0;
+                get_prefix_sum(start_index, s_start, s_sq_start);
+                get_prefix_sum(stop_index, s, s_sq);
+                s -= s_start;
+                s_sq -= s_sq_start;
+            } else {
+                const T base = (*this)[start_index];
+                for(uint32_t index = start_index; index < stop_index; ++index) {
+                    const T diff = (*this)[index] - base;
+                    s += diff;
+                    s_sq += diff * diff;
+                }
+            }
+            const T temp = (s_sq - s * s / n) / (n - 1);
+            return temp < 0 ? 0 : temp;
+        }
+
+        /** \brief Получить дисперсию
+         * \return Возвращает выборочную дисперсию элементов циклического буфера
+         */
+        inline const T variance() const {
+            return variance(0, buffer_size);
+        }
+
         /** \brief Преобразовать к вектору
          * \return Вектор
          */
         std::vector<T> to_vector() {
             std::vector<T> temp;
             temp.reserve(buffer_size);
-            const uint32_t max_index = buffer_size - 1;
+            if(buffer_size == 0) return temp;
             if(is_test) {
-                uint32_t start_index = 0;
-                uint32_t stop_index = 0;
-                if(is_power_of_two) {
-                    start_index = (offset_test) & mask;
-                    stop_index = (offset_test + max_index) & mask;
-                } else {
-                    start_index = (offset_test - buffer_offset) & mask;
-                    stop_index = (offset_test + (max_index - buffer_offset)) & mask;
-                }
-                if(start_index > stop_index) {
-                    std::copy(buffer_test.begin() + start_index, buffer_test.end(), std::back_inserter(temp));
-                    std::copy(buffer_test.begin(), buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
-                } else {
-                    std::copy(buffer_test.begin() + start_index, buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
-                }
-            } else {
-                uint32_t start_index = 0;
-                uint32_t stop_index = 0;
-                if(is_power_of_two) {
-                    start_index = offset & mask;
-                    stop_index = (offset + max_index) & mask;
-                } else {
-                    start_index = (offset- buffer_offset) & mask;
-                    stop_index = (offset + (max_index - buffer_offset)) & mask;
-                }
-                if(start_index > stop_index) {
+                const uint32_t start_index = wrap(offset + 1);
+                if(start_index > offset) {
                     std::copy(buffer.begin() + start_index, buffer.end(), std::back_inserter(temp));
-                    std::copy(buffer.begin(), buffer.begin() + stop_index + 1, std::back_inserter(temp));
+                    std::copy(buffer.begin(), buffer.begin() + offset, std::back_inserter(temp));
                 } else {
-                    std::copy(buffer.begin() + start_index, buffer.begin() + stop_index + 1, std::back_inserter(temp));
+                    std::copy(buffer.begin() + start_index, buffer.begin() + offset, std::back_inserter(temp));
                 }
+                temp.push_back(test_value);
+            } else {
+                std::copy(buffer.begin() + offset, buffer.end(), std::back_inserter(temp));
+                std::copy(buffer.begin(), buffer.begin() + offset, std::back_inserter(temp));
             }
-            return std::move(temp);
+            return temp;
         }
 
         /** \brief Очистить данные циклического буфера
          */
         inline void clear() {
             count = 0;
-            count_test = 0;
             offset = 0;
-            offset_test = 0;
             is_test = false;
             //fill(0);
+            rebuild_prefix_sum();
+        }
+
+        /** \brief Сохранить состояние циклического буфера
+         * \param out Запись состояния
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("circular_buffer", 2, sizeof(T));
+            out.write(buffer_size);
+            out.write(count);
+            out.write(offset);
+            out.write(buffer.data(), count);
+        }
+
+        /** \brief Загрузить состояние циклического буфера
+         *
+         * Буфер должен быть создан с тем же размером, что и сохраненный
+         * \param in Чтение состояния
+         * \return Вернет true в случае успеха
+         */
+        bool load_state(StateReader &in) {
+            uint32_t c = 0, o = 0;
+            if (!in.begin("circular_buffer", 2, sizeof(T)) || !in.check(buffer_size) ||
+                !in.read(c) || !in.read(o)) return false;
+            if (c > buffer_size || (o >= buffer_size && o != 0)) return false;
+            if (!in.read(buffer.data(), c)) return false;
+            count = c;
+            offset = o;
+            is_test = false;
+            rebuild_prefix_sum();
+            return true;
         }
     };
 };
@@ -35,6 +35,13 @@
 #include <numeric>
 #include <cmath>
 #include <limits>
+#include "xtechnical_instrumentation.hpp"
+#include "xtechnical_memory_resource.hpp"
+
+#ifndef XTECHNICAL_BLOCK_SIZE
+/// Размер блока для методов test_many: промежуточные значения блока хранятся в стеке и помещаются в кэш L1
+#define XTECHNICAL_BLOCK_SIZE 256
+#endif
 
 namespace xtechnical {
     namespace common {
@@ -75,4 +82,6 @@ namespace xtechnical {
     }; // common
 }; // xtechnical
 
+#include "xtechnical_state.hpp"
+
 #endif // XTECHNICAL_COMMON_HPP_INCLUDED
@@ -4,19 +4,23 @@
 #include <mutex>
 #include <future>
 #include <limits>
-#include "xtechnical_circular_buffer.hpp"
+#include "xtechnical_time_grid.hpp"
 #include "xtechnical_correlation.hpp"
 #include "xtechnical_normalization.hpp"
 
 namespace xtechnical {
 
     /** \brief Класс для измерения задержки
+     *
+     * Цены двух потоков приводятся к общей сетке времени TimeGrid.
+     * Пропуски в потоке запоминаются как длины серий, поэтому update
+     * работает за O(1), а сетка восстанавливается только в calc
      */
     class DelayMeter {
     private:
         std::mutex buffer_mutex;
-        xtechnical::circular_buffer<double> first_buffer;
-        xtechnical::circular_buffer<double> second_buffer;
+        xtechnical::TimeGrid<double> first_buffer;
+        xtechnical::TimeGrid<double> second_buffer;
         uint64_t first_start_time = 0;
         uint64_t second_start_time = 0;
         //uint64_t first_last_time = 0;
@@ -25,7 +29,6 @@ namespace xtechnical {
         uint64_t first_diff_time = 0;
         uint64_t second_diff_time = 0;
 
-        uint64_t last_time = 0;
         uint64_t time_step = 0;
         size_t buffer_size = 0;
         size_t window_size = 0;
@@ -40,15 +43,12 @@ namespace xtechnical {
         std::future<void> calc_future;
         std::atomic<bool> is_ready = ATOMIC_VAR_INIT(false);
 
-        uint64_t time_rounding(const uint64_t timestamp) {
-            return timestamp - (timestamp %  time_step);
-        }
     public:
         DelayMeter() {};
 
         DelayMeter(const size_t user_buffer_size, const size_t user_window_size, const uint64_t user_time_step) :
-            first_buffer(user_buffer_size),
-            second_buffer(user_buffer_size),
+            first_buffer(user_buffer_size, user_time_step),
+            second_buffer(user_buffer_size, user_time_step),
             time_step(user_time_step),
             buffer_size(user_buffer_size),
             window_size(user_window_size) {
@@ -71,44 +71,26 @@ namespace xtechnical {
         };
 
         /** \brief Обновить состояние индикатора
+         *
+         * Метка времени раньше последнего отсчета сетки
+         * обновляет последний отсчет
          * \param price Цена нового тика
          * \param ftimestamp Метка времени
          * \param index Индекс
          */
         void update(const double price, const double ftimestamp, const uint32_t index) {
-            const uint64_t timestamp = time_rounding(ftimestamp * 1000.0d);
+            const uint64_t timestamp_ms = ftimestamp * 1000.0d;
             std::lock_guard<std::mutex> lock(buffer_mutex);
-            if(last_time == 0) last_time = timestamp;
-            if(last_time < timestamp) {
-                const double first_temp = first_buffer.back();
-                const double second_temp = second_buffer.back();
-                for(uint64_t t = (last_time + time_step); t <= timestamp; t += time_step) {
-                    first_buffer.push_back(first_temp);
-                    second_buffer.push_back(second_temp);
-                }
-            } else
-            if(last_time > timestamp) {
-                /*
-                if(index == 0) {
-                    for(uint64_t t = timestamp; t <= last_time; t += time_step) {
-                        first_buffer.back() = price;
-
-                    }
-                } else
-                if(index == 1) {
-                    for(uint64_t t = timestamp; t <= last_time; t += time_step) {
-                        second_buffer.back() = price;
-                    }
-                }
-                */
-            }
-            last_time = timestamp;
+            /* обе сетки сдвигаются вместе, пропуск заполняется последними ценами */
+            first_buffer.advance(timestamp_ms);
+            second_buffer.advance(timestamp_ms);
+            const uint64_t timestamp = first_buffer.get_last_time();
             if(index == 0) {
-                first_buffer.back() = price;
+                first_buffer.set_back(price);
                 if(first_start_time == 0) first_start_time = timestamp;
             } else
             if(index == 1) {
-                second_buffer.back() = price;
+                second_buffer.set_back(price);
                 if(second_start_time == 0) second_start_time = timestamp;
             }
             first_diff_time = timestamp - first_start_time;
@@ -131,10 +113,8 @@ namespace xtechnical {
             std::vector<double> second_data(buffer_size);
             {
                 std::lock_guard<std::mutex> lock(buffer_mutex);
-                for(uint32_t i = 0; i < buffer_size; ++i) {
-                    first_data[i] = first_buffer[i];
-                    second_data[i] = second_buffer[i];
-                }
+                first_buffer.copy_to(first_data.data(), buffer_size);
+                second_buffer.copy_to(second_data.data(), buffer_size);
             }
             const int32_t start_index = buffer_size - window_size;
             const int32_t max_offset = start_index + 1;
@@ -265,7 +245,6 @@ namespace xtechnical {
             second_buffer.clear();
             first_diff_time = 0;
             second_diff_time = 0;
-            last_time = 0;
             first_start_time = 0;
             second_start_time = 0;
         }
@@ -77,9 +77,52 @@ namespace xtechnical {
             std::vector<T> sine_table;
             std::vector<T> cosine_table;
             std::vector<T> window_table;
+            std::vector<T> window_dft_real;     /**< Несокращенное ДПФ окна, для нормализации */
+            std::vector<T> window_dft_imag;
+            std::vector<T> input_scratch;       /**< Подготовленные входные данные */
+            std::vector<T> sum_real;            /**< Несокращенное ДПФ входных данных */
+            std::vector<T> sum_imag;
+            std::vector<T> frequencies_table;   /**< Частоты для frequencies_sample_rate */
+            T frequencies_sample_rate = 0;
             size_t table_period = 0;
             size_t window_type = RECTANGULAR_WINDOW;
 
+            /** \brief Несокращенное ДПФ входных данных для j = 0..period/2
+             */
+            void calc_sums(const std::vector<T> &input) noexcept {
+                const size_t period_div2 = table_period / 2;
+                for(size_t j = 0; j <= period_div2; ++j) {
+                    T re = 0, im = 0;
+                    size_t index = 0;
+                    for(size_t k = 0; k < table_period; ++k) {
+                        re += input[k] * cosine_table[index];
+                        im += input[k] * sine_table[index];
+                        index += j;
+                        if(index >= table_period) index -= table_period;
+                    }
+                    sum_real[j] = re;
+                    sum_imag[j] = im;
+                }
+            }
+
+            /** \brief Подготовить буферы для текущего периода и окна
+             */
+            void prepare_scratch() {
+                const size_t period_div2 = table_period / 2;
+                input_scratch.resize(table_period);
+                sum_real.resize(period_div2 + 1);
+                sum_imag.resize(period_div2 + 1);
+                window_dft_real.resize(period_div2 + 1);
+                window_dft_imag.resize(period_div2 + 1);
+                for(size_t k = 0; k < table_period; ++k) {
+                    input_scratch[k] = window_type == RECTANGULAR_WINDOW ? (T)1 : window_table[k];
+                }
+                calc_sums(input_scratch);
+                window_dft_real = sum_real;
+                window_dft_imag = sum_imag;
+                frequencies_table.clear();
+            }
+
             void generate_table(const size_t period) {
                 if(period == table_period) return;
                 cosine_table.resize(period);
@@ -159,6 +202,7 @@ namespace xtechnical {
             DftReal(const size_t period, const size_t use_window_type) {
                 generate_table(period);
                 calc_window(use_window_type);
+                if(table_period % 2 == 0 && table_period >= 4) prepare_scratch();
             }
 
             template<class FLOAT_TYPE>
@@ -199,9 +243,9 @@ namespace xtechnical {
                         output_imag[j] /= (FLOAT_TYPE)table_period;
                     }
                 } else {
-                    std::vector<FLOAT_TYPE> temp_input_real = input_real;
+                    input_scratch.resize(table_period);
                     for(size_t k = 0; k < table_period; ++k) {
-                        temp_input_real[k] *= window_table[k];
+                        input_scratch[k] = input_real[k] * window_table[k];
                     }
                     for(size_t j = 0; j <= period_div2; ++j) {
                         output_real[j] = 0.0;
@@ -209,10 +253,10 @@ namespace xtechnical {
                         for(size_t k = 0; k < table_period; ++k) {
                             size_t temp = j * k;
                             output_real[j] +=
-                                temp_input_real[k] *
+                                input_scratch[k] *
                                 cosine_table[temp % table_period];
                             output_imag[j] +=
-                                temp_input_real[k] *
+                                input_scratch[k] *
                                 sine_table[temp % table_period];
                         }
                         output_real[j] /= (FLOAT_TYPE)table_period;
@@ -258,6 +302,92 @@ namespace xtechnical {
                 }
                 return ::xtechnical::common::OK;
             }
+
+            /** \brief Амплитудный спектр нормализованного окна данных
+             *
+             * Данные читаются напрямую из буфера (например, кольцевого),
+             * без копирования. Нормализация MINMAX_SIGNED, окно и ДПФ
+             * выполняются за один проход по данным: ДПФ линейно, поэтому
+             * ДПФ нормализованных данных a * x - c равно a * ДПФ(x) - c * ДПФ(окна),
+             * где ДПФ окна считается один раз для периода.
+             * Для точности из данных вычитается первый отсчет.
+             * Буферы выделяются только при смене периода.
+             * \param input        Данные, доступ input[k] для k = 0..period-1
+             * \param amplitude    Амплитуды для частот 0..period/2
+             * \return Вернет 0 в случае успеха, иначе см. ErrorType
+             */
+            template<class BUFFER_TYPE>
+            int update_min_max_signed(
+                    const BUFFER_TYPE &input,
+                    const size_t period,
+                    std::vector<T> &amplitude) {
+                if(period != table_period) {
+                    generate_table(period);
+                    calc_window(window_type);
+                    if(table_period % 2 == 0 && table_period >= 4) prepare_scratch();
+                }
+                if(table_period % 2 != 0 || table_period < 4)
+                    return ::xtechnical::common::INVALID_PARAMETER;
+                if(input_scratch.size() != table_period) prepare_scratch();
+
+                const size_t period_div2 = table_period / 2;
+                const T x0 = input[0];
+                T min_data = x0, max_data = x0;
+                if(window_type == RECTANGULAR_WINDOW) {
+                    for(size_t k = 0; k < table_period; ++k) {
+                        const T x = input[k];
+                        if(x < min_data) min_data = x;
+                        if(x > max_data) max_data = x;
+                        input_scratch[k] = x - x0;
+                    }
+                } else {
+                    for(size_t k = 0; k < table_period; ++k) {
+                        const T x = input[k];
+                        if(x < min_data) min_data = x;
+                        if(x > max_data) max_data = x;
+                        input_scratch[k] = (x - x0) * window_table[k];
+                    }
+                }
+
+                amplitude.resize(period_div2 + 1);
+                const T ampl = max_data - min_data;
+                if(ampl == 0) {
+                    std::fill(amplitude.begin(), amplitude.end(), T(0));
+                    return ::xtechnical::common::OK;
+                }
+                calc_sums(input_scratch);
+
+                const T a = 2.0 / ampl;
+                const T c = 2.0 * (min_data - x0) / ampl + 1.0;
+                for(size_t j = 0; j <= period_div2; ++j) {
+                    const T re = (a * sum_real[j] - c * window_dft_real[j]) / (T)table_period;
+                    const T im = (a * sum_imag[j] - c * window_dft_imag[j]) / (T)table_period;
+                    amplitude[j] = 2 * std::sqrt(re * re + im * im);
+                }
+                return ::xtechnical::common::OK;
+            }
+
+            /** \brief Частоты спектра
+             *
+             * Считаются один раз для периода и частоты дискретизации
+             * \param sample_rate  Частота дискретизации, 0 - номера частот
+             * \return Частоты для 0..period/2
+             */
+            const std::vector<T> &get_frequencies(const T sample_rate = 0) {
+                const size_t period_div2 = table_period / 2;
+                if(frequencies_table.size() == period_div2 + 1 &&
+                    frequencies_sample_rate == sample_rate) return frequencies_table;
+                frequencies_table.resize(period_div2 + 1);
+                for(size_t i = 0; i < period_div2 + 1; ++i) {
+                    if(sample_rate != 0) {
+                        frequencies_table[i] = (T)i*((T)sample_rate/(T)table_period);
+                    } else {
+                        frequencies_table[i] = i;
+                    }
+                }
+                frequencies_sample_rate = sample_rate;
+                return frequencies_table;
+            }
         };
     }; // dft
 };
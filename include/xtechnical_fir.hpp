@@ -0,0 +1,387 @@
+#ifndef XTECHNICAL_FIR_HPP_INCLUDED
+#define XTECHNICAL_FIR_HPP_INCLUDED
+
+#include "xtechnical_common.hpp"
+#include "xtechnical_memory_resource.hpp"
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/** \brief Минимальная длина ядра, с которой update_many использует БПФ
+ */
+#ifndef XTECHNICAL_FIR_FFT_MIN_SIZE
+#define XTECHNICAL_FIR_FFT_MIN_SIZE 64
+#endif
+
+namespace xtechnical {
+
+    namespace fir {
+
+        /** \brief Скалярное произведение
+         *
+         * Четыре независимые суммы позволяют компилятору использовать SIMD
+         * без изменения порядка сложения, поэтому результат не зависит от флагов сборки
+         * \param a Первый массив
+         * \param b Второй массив
+         * \param n Длина массивов
+         * \return Скалярное произведение
+         */
+        template<class T>
+        inline T dot(const T *a, const T *b, const size_t n) noexcept {
+            T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                s0 += a[i] * b[i];
+                s1 += a[i + 1] * b[i + 1];
+                s2 += a[i + 2] * b[i + 2];
+                s3 += a[i + 3] * b[i + 3];
+            }
+            T s = (s0 + s1) + (s2 + s3);
+            for (; i < n; ++i) s += a[i] * b[i];
+            return s;
+        }
+
+#if defined(__AVX2__)
+        /** \brief Скалярное произведение на AVX2
+         *
+         * Порядок сложения совпадает с общей версией (умножение и сложение без FMA),
+         * поэтому результат побитово тот же
+         */
+        template<>
+        inline double dot<double>(const double *a, const double *b, const size_t n) noexcept {
+            __m256d acc = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+            }
+            alignas(32) double s[4];
+            _mm256_store_pd(s, acc);
+            double sum = (s[0] + s[1]) + (s[2] + s[3]);
+            for (; i < n; ++i) sum += a[i] * b[i];
+            return sum;
+        }
+#endif
+
+        /** \brief Таблица поворотных множителей БПФ
+         * \param n         Размер БПФ, степень двойки
+         * \param twiddles  exp(-2 pi i k / n), k = 0..n/2-1
+         */
+        template<class T, class VECTOR>
+        void make_twiddles(const size_t n, VECTOR &twiddles) {
+            const T pi = 3.14159265358979323846264338327950288;
+            twiddles.resize(n / 2);
+            for (size_t k = 0; k < n / 2; ++k) {
+                const T angle = -2.0 * pi * (T)k / (T)n;
+                twiddles[k] = std::complex<T>(std::cos(angle), std::sin(angle));
+            }
+        }
+
+        /** \brief БПФ по основанию 2 на месте
+         * \param a         Данные, n - степень двойки
+         * \param n         Размер
+         * \param twiddles  Таблица make_twiddles для n
+         * \param inverse   Обратное преобразование (без деления на n)
+         */
+        template<class T>
+        void fft(std::complex<T> *a, const size_t n, const std::complex<T> *twiddles, const bool inverse) noexcept {
+            for (size_t i = 1, j = 0; i < n; ++i) {
+                size_t bit = n >> 1;
+                for (; j & bit; bit >>= 1) j ^= bit;
+                j ^= bit;
+                if (i < j) std::swap(a[i], a[j]);
+            }
+            for (size_t len = 2; len <= n; len <<= 1) {
+                const size_t half = len >> 1;
+                const size_t stride = n / len;
+                for (size_t i = 0; i < n; i += len) {
+                    for (size_t k = 0; k < half; ++k) {
+                        const std::complex<T> w = inverse ? std::conj(twiddles[k * stride]) : twiddles[k * stride];
+                        const std::complex<T> u = a[i + k];
+                        const std::complex<T> v = a[i + k + half] * w;
+                        a[i + k] = u + v;
+                        a[i + k + half] = u - v;
+                    }
+                }
+            }
+        }
+    }; // fir
+
+    /** \brief Потоковый КИХ-фильтр с фиксированными весами
+     *
+     * Выход - скалярное произведение весов и последних n значений,
+     * вес weights[n - 1] относится к самому новому значению.
+     * История хранится дважды подряд, поэтому окно всегда непрерывно
+     * и update, test выполняют одно скалярное произведение без копирования.
+     * update_many для длинных ядер считает свертку через БПФ (overlap-save).
+     * Если задано zero_padding, значения до первого считаются нулевыми
+     * и фильтр готов с первого значения, иначе - после n значений.
+     */
+    template<class T>
+    class FirFilter {
+    private:
+        pmr::vector<T> weights;
+        pmr::vector<T> history;     /**< Кольцевой буфер истории, записанный дважды */
+        size_t pos = 0;             /**< Позиция самого старого значения окна */
+        size_t count = 0;           /**< Количество принятых значений */
+        bool zero_padding = false;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+
+        /* данные overlap-save */
+        size_t fft_size = 0;
+        pmr::vector<std::complex<T>> kernel_spectrum;
+        pmr::vector<std::complex<T>> twiddles;
+        pmr::vector<std::complex<T>> block;
+
+        inline bool is_ready(const size_t c) const noexcept {
+            return zero_padding || c >= weights.size();
+        }
+
+        inline void push(const T in) noexcept {
+            const size_t n = weights.size();
+            history[pos] = in;
+            history[pos + n] = in;
+            pos = pos + 1 == n ? 0 : pos + 1;
+            ++count;
+        }
+
+        void prepare_fft() {
+            const size_t n = weights.size();
+            if (fft_size != 0) return;
+            fft_size = 1;
+            while (fft_size < 4 * n) fft_size <<= 1;
+            fir::make_twiddles<T>(fft_size, twiddles);
+            kernel_spectrum.assign(fft_size, std::complex<T>(0, 0));
+            /* свертка с перевернутыми весами: h[k] = weights[n - 1 - k] */
+            for (size_t k = 0; k < n; ++k) kernel_spectrum[k] = weights[n - 1 - k];
+            fir::fft(kernel_spectrum.data(), fft_size, twiddles.data(), false);
+            block.resize(fft_size);
+        }
+
+        /** \brief Свертка через БПФ (overlap-save)
+         * \param in    Входные значения
+         * \param size  Количество значений
+         * \param out   Массив для выхода без учета готовности
+         */
+        void convolve_fft(const T *in, const size_t size, T *out) {
+            prepare_fft();
+            const size_t n = weights.size();
+            const size_t step = fft_size - (n - 1);
+            /* входной ряд: n - 1 значений истории, затем in */
+            auto input = [&](const size_t i) -> T {
+                if (i < n - 1) return history[pos + 1 + i];
+                const size_t j = i - (n - 1);
+                return j < size ? in[j] : T(0);
+            };
+            const T scale = (T)1 / (T)fft_size;
+            for (size_t start = 0; start < size; start += step) {
+                for (size_t i = 0; i < fft_size; ++i) block[i] = input(start + i);
+                fir::fft(block.data(), fft_size, twiddles.data(), false);
+                for (size_t i = 0; i < fft_size; ++i) block[i] *= kernel_spectrum[i];
+                fir::fft(block.data(), fft_size, twiddles.data(), true);
+                const size_t stop = std::min(step, size - start);
+                for (size_t i = 0; i < stop; ++i) {
+                    out[start + i] = block[n - 1 + i].real() * scale;
+                }
+            }
+        }
+
+    public:
+        FirFilter() {};
+
+        /** \brief Конструктор КИХ-фильтра
+         *
+         * Веса принимаются в векторе с любым аллокатором,
+         * в том числе pmr::vector из того же источника памяти
+         * \param w         Веса от самого старого значения к самому новому
+         * \param zp        Считать значения до первого нулевыми
+         * \param resource  Источник памяти фильтра
+         */
+        template<class ALLOC>
+        FirFilter(const std::vector<T, ALLOC> &w, const bool zp = false,
+                pmr::memory_resource *resource = pmr::get_default_resource()) :
+                weights(w.begin(), w.end(), resource), history(2 * w.size(), T(0), resource), zero_padding(zp),
+                kernel_spectrum(resource), twiddles(resource), block(resource) {
+        }
+
+        /** \brief Конструктор КИХ-фильтра
+         *
+         * Отдельная перегрузка, чтобы указатель на источник не превратился в bool
+         * \param w         Веса от самого старого значения к самому новому
+         * \param resource  Источник памяти фильтра
+         */
+        template<class ALLOC>
+        FirFilter(const std::vector<T, ALLOC> &w, pmr::memory_resource *resource) :
+            FirFilter(w, false, resource) {
+        }
+
+        /** \brief Обновить состояние фильтра
+         * \param in Сигнал на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in) noexcept {
+            const size_t n = weights.size();
+            if (n == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            push(in);
+            if (!is_ready(count)) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = fir::dot(weights.data(), history.data() + pos, n);
+            return common::OK;
+        }
+
+        /** \brief Обновить состояние фильтра
+         * \param in    Сигнал на входе
+         * \param out   Сигнал на выходе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in, T &out) noexcept {
+            const int err = update(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief Протестировать фильтр
+         *
+         * Данный метод отличается от update тем,
+         * что не влияет на внутреннее состояние фильтра.
+         * Результат побитово совпадает с update
+         * \param in    Сигнал на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in) noexcept {
+            const size_t n = weights.size();
+            if (n == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            if (!is_ready(count + 1)) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            /* временно записываем значение на место самого старого */
+            const T old = history[pos];
+            history[pos + n] = in;
+            output_value = fir::dot(weights.data(), history.data() + pos + 1, n);
+            history[pos + n] = old;
+            return common::OK;
+        }
+
+        /** \brief Протестировать фильтр
+         * \param in    Сигнал на входе
+         * \param out   Сигнал на выходе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in, T &out) noexcept {
+            const int err = test(in);
+            out = output_value;
+            return err;
+        }
+
+        /** \brief Обновить состояние фильтра массивом значений
+         *
+         * Эквивалентно вызову update для каждого значения. Для ядер длиной
+         * от XTECHNICAL_FIR_FFT_MIN_SIZE используется свертка через БПФ,
+         * ее результат совпадает с update с точностью до ошибок округления
+         * \param in    Массив значений
+         * \param size  Количество значений
+         * \param out   Массив выходов, NaN пока фильтр не готов
+         * \return Код ошибки последнего значения
+         */
+        int update_many(const T *in, const size_t size, T *out) {
+            const size_t n = weights.size();
+            if (size == 0) return n == 0 ? common::NO_INIT : (is_ready(count) ? common::OK : common::INDICATOR_NOT_READY_TO_WORK);
+            if (n < XTECHNICAL_FIR_FFT_MIN_SIZE || size < n || n < 2) {
+                int err = common::OK;
+                for (size_t i = 0; i < size; ++i) {
+                    err = update(in[i], out[i]);
+                }
+                return err;
+            }
+            convolve_fft(in, size, out);
+            for (size_t i = 0; i < size; ++i) {
+                if (!is_ready(count + i + 1)) out[i] = std::numeric_limits<T>::quiet_NaN();
+            }
+            /* в истории остаются последние n значений */
+            pos = (pos + size - n) % n;
+            count += size - n;
+            for (size_t i = size - n; i < size; ++i) push(in[i]);
+            output_value = out[size - 1];
+            return is_ready(count) ? common::OK : common::INDICATOR_NOT_READY_TO_WORK;
+        }
+
+        /** \brief Получить значение фильтра
+         * \return Значение фильтра
+         */
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        /** \brief Веса фильтра от самого старого значения к самому новому
+         */
+        inline const pmr::vector<T> &get_weights() const noexcept {
+            return weights;
+        }
+
+        /** \brief Длина ядра
+         */
+        inline size_t size() const noexcept {
+            return weights.size();
+        }
+
+        /** \brief Очистить данные фильтра
+         */
+        inline void clear() noexcept {
+            std::fill(history.begin(), history.end(), T(0));
+            pos = 0;
+            count = 0;
+            output_value = std::numeric_limits<T>::quiet_NaN();
+        }
+
+        /** \brief Сохранить состояние фильтра
+         * \param out Запись состояния
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("FirFilter", 1, sizeof(T));
+            out.write(weights);
+            out.write(zero_padding);
+            out.write(history);
+            out.write(pos);
+            out.write(count);
+            out.write(output_value);
+        }
+
+        /** \brief Загрузить состояние фильтра
+         *
+         * Фильтр должен быть создан с теми же весами
+         * \param in Чтение состояния
+         * \return Вернет true в случае успеха
+         */
+        bool load_state(StateReader &in) {
+            /* временные массивы берут память из источника фильтра */
+            pmr::vector<T> w(weights.get_allocator()), h(history.get_allocator());
+            bool zp = false;
+            size_t p = 0, c = 0;
+            T out = 0;
+            if (!in.begin("FirFilter", 1, sizeof(T)) || !in.read(w) || !in.read(zp) ||
+                !in.read(h) || !in.read(p) || !in.read(c) || !in.read(out)) return false;
+            if (w != weights || zp != zero_padding || h.size() != history.size() || (p != 0 && p >= weights.size())) return false;
+            history.assign(h.begin(), h.end());
+            pos = p;
+            count = c;
+            output_value = out;
+            return true;
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_FIR_HPP_INCLUDED
@@ -0,0 +1,236 @@
+#ifndef XTECHNICAL_FIXED_CIRCULAR_BUFFER_HPP_INCLUDED
+#define XTECHNICAL_FIXED_CIRCULAR_BUFFER_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef XTECHNICAL_FIXED_UNROLL_MAX
+/// Максимальный размер, для которого циклы разворачиваются на этапе компиляции
+#define XTECHNICAL_FIXED_UNROLL_MAX 16
+#endif
+
+namespace xtechnical {
+    /** \brief Индикаторы с периодом, известным на этапе компиляции
+     */
+    namespace fixed {
+        namespace detail {
+
+            /** \brief Ближайшая степень двойки, не меньше x
+             */
+            constexpr size_t cpl2(const size_t x, const size_t p = 1) {
+                return p >= x ? p : cpl2(x, p << 1);
+            }
+
+            template<size_t I, size_t N>
+            struct Unroll {
+                template<class F>
+                static inline void run(F &f) {
+                    f(I);
+                    Unroll<I + 1, N>::run(f);
+                }
+            };
+
+            template<size_t N>
+            struct Unroll<N, N> {
+                template<class F>
+                static inline void run(F &) {}
+            };
+
+            /** \brief Цикл 0..N-1, для малых N разворачивается на этапе компиляции
+             */
+            template<size_t N, bool IS_SMALL = (N <= XTECHNICAL_FIXED_UNROLL_MAX)>
+            struct Loop {
+                template<class F>
+                static inline void run(F &f) {
+                    Unroll<0, N>::run(f);
+                }
+            };
+
+            template<size_t N>
+            struct Loop<N, false> {
+                template<class F>
+                static inline void run(F &f) {
+                    for (size_t i = 0; i < N; ++i) f(i);
+                }
+            };
+        };
+
+        /** \brief Циклический буфер фиксированного размера
+         *
+         * Аналог xtechnical::circular_buffer, размер N задается на этапе компиляции.
+         * Данные хранятся в std::array размером степень двойки больше N, поэтому
+         * индекс всегда вычисляется одной маской, без ветвлений.
+         * Свободная ячейка за последним элементом используется методом test,
+         * поэтому тест не копирует буфер.
+         */
+        template<class T, size_t N>
+        class circular_buffer {
+        public:
+            static const size_t CAPACITY = detail::cpl2(N + 1);    /**< Размер хранилища */
+            static const size_t MASK = CAPACITY - 1;
+            static const size_t START = CAPACITY - N;               /**< Смещение первого элемента относительно offset */
+
+        private:
+            std::array<T, CAPACITY> buffer;
+            size_t count = 0;       /**< Количество элементов в буфере */
+            size_t offset = 0;      /**< Смещение в буфере */
+            size_t is_test = 0;     /**< Флаг теста, 0 или 1 */
+
+            inline size_t index_of(const size_t index) const noexcept {
+                return (offset + is_test + START + index) & MASK;
+            }
+
+        public:
+
+            typedef T value_t;
+
+            /** \brief Конструктор циклического буфера
+             */
+            circular_buffer() {
+                buffer.fill(T(0));
+            };
+
+            /** \brief Получить размер циклического буфера
+             * \return Размер циклического буфера. Может быть меньше максимального, если буфер еще не заполнился.
+             */
+            inline size_t size() const noexcept {
+                const size_t c = count + is_test;
+                return c < N ? c : N;
+            }
+
+            /** \brief Максимальный размер циклического буфера
+             */
+            static constexpr size_t max_size() noexcept {
+                return N;
+            }
+
+            /** \brief Проверить, если циклическй буфер пуст
+             */
+            inline bool empty() const noexcept {
+                return (count + is_test) == 0;
+            }
+
+            /** \brief Проверить, если циклическй буфер полн
+             */
+            inline bool full() const noexcept {
+                return (count + is_test) >= N;
+            }
+
+            /** \brief Обновить состояние циклического буфера
+             * \param value Новое значение
+             * \return Вернет true, если циклическй буфер полн
+             */
+            inline bool update(const T value) noexcept {
+                is_test = 0;
+                buffer[offset] = value;
+                offset = (offset + 1) & MASK;
+                if (count < N) ++count;
+                return full();
+            }
+
+            /** \brief Протестировать состояние циклического буфера
+             * \param value Новое значение
+             * \return Вернет true, если циклическй буфер полн
+             */
+            inline bool test(const T value) noexcept {
+                is_test = 1;
+                buffer[offset] = value;
+                return full();
+            }
+
+            /** \brief Обновить состояние циклического буфера
+             *
+             * Самый старый элемент читается до записи нового,
+             * поэтому чтение не зависит от записи
+             * \param value   Новое значение
+             * \param removed Элемент, вытесненный из буфера
+             * \return Вернет true, если буфер был полн и removed содержит вытесненный элемент
+             */
+            inline bool update(const T value, T &removed) noexcept {
+                removed = buffer[(offset + START) & MASK];
+                const bool is_full = count >= N;
+                update(value);
+                return is_full;
+            }
+
+            /** \brief Протестировать состояние циклического буфера
+             * \param value   Новое значение
+             * \param removed Элемент, который был бы вытеснен из буфера
+             * \return Вернет true, если буфер полн и removed содержит вытесняемый элемент
+             */
+            inline bool test(const T value, T &removed) noexcept {
+                removed = buffer[(offset + START) & MASK];
+                test(value);
+                return count >= N;
+            }
+
+            /** \brief Получить значение циклического буфера по индексу
+             * \param index Индекс, 0 - самый старый элемент
+             */
+            inline const T &operator[](const size_t index) const noexcept {
+                return buffer[index_of(index)];
+            }
+
+            inline T &operator[](const size_t index) noexcept {
+                return buffer[index_of(index)];
+            }
+
+            /** \brief Доступ к первому элементу
+             */
+            inline const T &front() const noexcept {
+                return buffer[index_of(0)];
+            }
+
+            /** \brief Доступ к последнему элементу
+             */
+            inline const T &back() const noexcept {
+                return buffer[index_of(N - 1)];
+            }
+
+            /** \brief Получить сумму
+             * \return Возвращает сумму элементов циклического буфера
+             */
+            inline T sum() const noexcept {
+                T temp = 0;
+                auto f = [&](const size_t i) { temp += buffer[index_of(i)]; };
+                detail::Loop<N>::run(f);
+                return temp;
+            }
+
+            /** \brief Получить среднее значение
+             */
+            inline T mean() const noexcept {
+                return sum() / (T)N;
+            }
+
+            /** \brief Вызвать функцию для каждого элемента, от старого к новому
+             * \param f Функция, принимает индекс и значение
+             */
+            template<class F>
+            inline void for_each(F f) const {
+                auto g = [&](const size_t i) { f(i, buffer[index_of(i)]); };
+                detail::Loop<N>::run(g);
+            }
+
+            /** \brief Очистить данные циклического буфера
+             */
+            inline void clear() noexcept {
+                count = 0;
+                offset = 0;
+                is_test = 0;
+            }
+        };
+
+        template<class T, size_t N>
+        const size_t circular_buffer<T, N>::CAPACITY;
+
+        template<class T, size_t N>
+        const size_t circular_buffer<T, N>::MASK;
+
+        template<class T, size_t N>
+        const size_t circular_buffer<T, N>::START;
+    };
+};
+
+#endif // XTECHNICAL_FIXED_CIRCULAR_BUFFER_HPP_INCLUDED
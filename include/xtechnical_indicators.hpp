@@ -25,10 +25,13 @@
 #define XTECHNICAL_INDICATORS_HPP_INCLUDED
 
 #include "xtechnical_dft.hpp"
+#include "xtechnical_fir.hpp"
 #include "xtechnical_correlation.hpp"
 #include "xtechnical_normalization.hpp"
 #include "xtechnical_moving_window.hpp"
 #include "xtechnical_circular_buffer.hpp"
+#include "xtechnical_monotonic_queue.hpp"
+#include "xtechnical_pipeline.hpp"
 #include "xtechnical_common.hpp"
 #include "math/xtechnical_compare.hpp"
 #include "math/xtechnical_smoothing.hpp"
@@ -47,8 +50,12 @@
 #include "indicators/xtechnical_body_filter.hpp"
 #include "indicators/xtechnical_period_stats.hpp"
 #include "indicators/ssa.hpp"
+#include "indicators/xtechnical_rolling_regression.hpp"
+#include "indicators/xtechnical_fixed_period.hpp"
+#include "indicators/xtechnical_tick.hpp"
 
 #include <vector>
+#include <array>
 #include <deque>
 #include <list>
 #include <algorithm>
@@ -246,11 +253,14 @@ namespace xtechnical {
     };
 
     /** \brief Cкользящий Min Max
+     *
+     * Минимум и максимум хранятся в монотонных очередях,
+     * поэтому update работает за амортизированное O(1), а test - за O(1)
      */
     template <class T>
     class MinMax {
     private:
-        xtechnical::circular_buffer<T> buffer;
+        MonotonicMinMax<T> window;
         T output_min_value = std::numeric_limits<T>::quiet_NaN();
         T output_max_value = std::numeric_limits<T>::quiet_NaN();
         size_t period = 0;
@@ -259,11 +269,12 @@ namespace xtechnical {
         MinMax() {};
 
         /** \brief Конструктор скользящего Min Max
-         * \param p     Период
-         * \param o     Смещение назад
+         * \param p         Период
+         * \param o         Смещение назад
+         * \param resource  Источник памяти окна
          */
-        MinMax(const size_t p, const size_t o = 0) :
-                buffer(p + o), period(p), offset(o) {
+        MinMax(const size_t p, const size_t o = 0, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                window(p, o, resource), period(p), offset(o) {
         }
 
         /** \brief Обновить состояние индикатора
@@ -276,16 +287,7 @@ namespace xtechnical {
                 output_max_value = std::numeric_limits<T>::quiet_NaN();
                 return common::NO_INIT;
             }
-            buffer.update(in);
-            if(buffer.full()) {
-                T temp = buffer[0];
-                output_max_value = output_min_value = temp;
-                for(size_t i = 1; i < period; ++i) {
-                    temp = buffer[i];
-                    if(output_max_value < temp) output_max_value = temp;
-                    else if(output_min_value > temp) output_min_value = temp;
-                }
-            } else {
+            if(!window.update(in, output_min_value, output_max_value)) {
                 output_min_value = std::numeric_limits<T>::quiet_NaN();
                 output_max_value = std::numeric_limits<T>::quiet_NaN();
                 return common::INDICATOR_NOT_READY_TO_WORK;
@@ -319,16 +321,7 @@ namespace xtechnical {
                 output_max_value = std::numeric_limits<T>::quiet_NaN();
                 return common::NO_INIT;
             }
-            buffer.test(in);
-            if(buffer.full()) {
-                T temp = buffer[0];
-                output_max_value = output_min_value = temp;
-                for(size_t i = 1; i < period; ++i) {
-                    temp = buffer[i];
-                    if(output_max_value < temp) output_max_value = temp;
-                    else if(output_min_value > temp) output_min_value = temp;
-                }
-            } else {
+            if(!window.test(in, output_min_value, output_max_value)) {
                 output_min_value = std::numeric_limits<T>::quiet_NaN();
                 output_max_value = std::numeric_limits<T>::quiet_NaN();
                 return common::INDICATOR_NOT_READY_TO_WORK;
@@ -368,7 +361,7 @@ namespace xtechnical {
         /** \brief Очистить данные индикатора
          */
         inline void clear() noexcept {
-            buffer.clear();
+            window.clear();
             output_min_value = std::numeric_limits<T>::quiet_NaN();
             output_max_value = std::numeric_limits<T>::quiet_NaN();
         }
@@ -550,6 +543,27 @@ namespace xtechnical {
         T output_d_value = std::numeric_limits<T>::quiet_NaN();
 
         size_t period = 0;
+        size_t offset = 0;
+
+        /** \brief Получить минимум и максимум окна для test без нового значения
+         *
+         * Без смещения новое значение входит в окно, тогда минимум и максимум
+         * остальных значений окна получаются тестом с крайними значениями типа.
+         * Со смещением окно не зависит от нового значения
+         */
+        int test_window(T &min_value, T &max_value) noexcept {
+            if(offset > 0) {
+                const int err = min_max.test(T(0));
+                min_value = min_max.get_min();
+                max_value = min_max.get_max();
+                return err;
+            }
+            const int err = min_max.test(std::numeric_limits<T>::lowest());
+            max_value = min_max.get_max();
+            min_max.test(std::numeric_limits<T>::max());
+            min_value = min_max.get_min();
+            return err;
+        }
 	public:
 		Stochastics() {};
 
@@ -558,16 +572,18 @@ namespace xtechnical {
          * \param pk    Период %K
          * \param pd    Период %D
          * \param o     Смещение назад
+         * \param resource  Источник памяти (для MA_TYPE, если тип его принимает)
          */
         Stochastics(
 				const size_t p,
 				const size_t pk,
 				const size_t pd,
-				const size_t o = 0) :
-            min_max(p, o),
-			k_ma(pk),
-			d_ma(pd),
-			period(p)  {
+				const size_t o = 0,
+				pmr::memory_resource *resource = pmr::get_default_resource()) :
+            min_max(p, o, resource),
+			k_ma(pmr::make_with_resource<MA_TYPE>(resource, pk)),
+			d_ma(pmr::make_with_resource<MA_TYPE>(resource, pd)),
+			period(p), offset(o)  {
         }
 
 		/** \brief Обновить состояние индикатора
@@ -654,6 +670,92 @@ namespace xtechnical {
             return err;
         }
 
+        /** \brief Протестировать индикатор для нескольких значений
+         *
+         * Результат совпадает с последовательными вызовами test(in[i], k_out[i], d_out[i]).
+         * Минимум и максимум остальных значений окна находятся один раз,
+         * затем для каждого значения считаются за O(1). Данные обрабатываются
+         * блоками по XTECHNICAL_BLOCK_SIZE, %K и %D берутся из MA_TYPE::test_many
+         * \param in       Массив котировок
+         * \param size     Размер массива
+         * \param k_out    Массив для линии %K (размер size)
+         * \param d_out    Массив для линии %D (размер size)
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test_many(const T *in, const size_t size, T *k_out, T *d_out) noexcept {
+            if(size == 0) return common::OK;
+            T min_value = 0, max_value = 0;
+            if(period == 0 || test_window(min_value, max_value) != common::OK) {
+                std::fill(k_out, k_out + size, std::numeric_limits<T>::quiet_NaN());
+                std::fill(d_out, d_out + size, std::numeric_limits<T>::quiet_NaN());
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_k_value = std::numeric_limits<T>::quiet_NaN();
+                output_d_value = std::numeric_limits<T>::quiet_NaN();
+                return period == 0 ? common::NO_INIT : common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            T raw[XTECHNICAL_BLOCK_SIZE];
+            T d_test[XTECHNICAL_BLOCK_SIZE];
+            T d_value = output_d_value;
+            for (size_t begin = 0; begin < size; begin += XTECHNICAL_BLOCK_SIZE) {
+                const size_t n = std::min((size_t)XTECHNICAL_BLOCK_SIZE, size - begin);
+                const T *block_in = in + begin;
+                T *block_k = k_out + begin;
+                T *block_d = d_out + begin;
+                /* ступень 1: %K до сглаживания */
+                if(offset > 0) {
+                    const T diff = max_value - min_value;
+                    for (size_t i = 0; i < n; ++i) {
+                        raw[i] = diff == 0 ? (T)50 : (T)100 * ((block_in[i] - min_value) / diff);
+                    }
+                } else {
+                    for (size_t i = 0; i < n; ++i) {
+                        const T x = block_in[i];
+                        const T lo = x < min_value ? x : min_value;
+                        const T hi = x > max_value ? x : max_value;
+                        const T diff = hi - lo;
+                        raw[i] = diff == 0 ? (T)50 : (T)100 * ((x - lo) / diff);
+                    }
+                }
+                /* ступень 2: %K */
+                k_ma.test_many(raw, n, block_k);
+                /* ступень 3: %D, пока %K нет, сохраняется прежнее значение */
+                d_ma.test_many(block_k, n, d_test);
+                for (size_t i = 0; i < n; ++i) {
+                    if (!std::isnan(block_k[i])) d_value = d_test[i];
+                    block_d[i] = d_value;
+                }
+            }
+            output_value = raw[(size - 1) % XTECHNICAL_BLOCK_SIZE];
+            output_k_value = k_out[size - 1];
+            output_d_value = d_value;
+            return common::OK;
+        }
+
+        /** \brief Найти котировку, при которой test даст заданную линию %K
+         *
+         * MA_TYPE должен предоставлять test_coefficients (SMA, EMA, MMA).
+         * Без смещения котировка ищется внутри диапазона остальных значений окна,
+         * поэтому значение %K до сглаживания должно быть в пределах от 0 до 100
+         * \param value    Значение линии %K
+         * \param in       Котировка
+         * \return Вернет 0 в случае успеха, INVALID_PARAMETER если значение недостижимо, иначе см. ErrorType
+         */
+        int test_inverse(const T value, T &in) noexcept {
+            if(period == 0) return common::NO_INIT;
+            T min_value = 0, max_value = 0;
+            const int err = test_window(min_value, max_value);
+            if(err != common::OK) return err;
+            T k_offset = 0, k_scale = 0;
+            const int err_k = k_ma.test_coefficients(k_offset, k_scale);
+            if(err_k != common::OK) return err_k;
+            const T raw = (value - k_offset) / k_scale;
+            if(offset == 0 && !(raw >= 0 && raw <= 100)) return common::INVALID_PARAMETER;
+            const T diff = max_value - min_value;
+            if(diff == 0) return common::INVALID_PARAMETER;
+            in = min_value + raw / (T)100 * diff;
+            return common::OK;
+        }
+
 		/** \brief Получить значение %K до сглаживания
          * \return Значение %K до сглаживания или NaN, если значение отсутствует
          */
@@ -819,10 +921,11 @@ namespace xtechnical {
         StdDev() {};
 
         /** \brief Инициализировать простую скользящую среднюю
-         * \param p     Период
+         * \param p         Период
+         * \param resource  Источник памяти буфера
          */
-        StdDev(const size_t p) :
-                buffer(p + 1), period(p) {
+        StdDev(const size_t p, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                buffer(p + 1, resource), period(p) {
         }
 
         /** \brief Обновить состояние индикатора
@@ -907,6 +1010,58 @@ namespace xtechnical {
             return err;
         }
 
+        /** \brief Протестировать индикатор для нескольких значений
+         *
+         * period - 1 значений окна общие для всех сигналов на входе, поэтому
+         * их среднее mf и сумма квадратов отклонений m2 считаются один раз.
+         * Для каждого сигнала сумма квадратов отклонений от среднего окна mean
+         * равна m2 + (period - 1) * (mf - mean)^2 + (in - mean)^2, все слагаемые
+         * неотрицательны, поэтому результат совпадает с test(in[i])
+         * с точностью до округления. Сложность O(period + size) вместо O(period * size).
+         * После вызова get() вернет результат для последнего значения
+         * \param in    Массив сигналов на входе
+         * \param size  Размер массива
+         * \param out   Массив сигналов на выходе (размер size, может совпадать с in)
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test_many(const T *in, const size_t size, T *out) noexcept {
+            if(size == 0) return common::OK;
+            if(period == 0) {
+                std::fill(out, out + size, std::numeric_limits<T>::quiet_NaN());
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            buffer.test(in[size - 1]);
+            if(!buffer.full()) {
+                std::fill(out, out + size, std::numeric_limits<T>::quiet_NaN());
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            const size_t fixed = period - 1;
+            T mf = 0, m2 = 0;
+            if(fixed > 0) {
+                for(size_t i = 1; i <= fixed; ++i) mf += buffer[i];
+                mf /= (T)fixed;
+                for(size_t i = 1; i <= fixed; ++i) {
+                    const T diff = buffer[i] - mf;
+                    m2 += diff * diff;
+                }
+            }
+            const T sum = last_data;
+            const T front = buffer.front();
+            const T div = (T)period;
+            const T fixed_count = (T)fixed;
+            for(size_t i = 0; i < size; ++i) {
+                const T mean = (sum + (in[i] - front)) / div;
+                const T shift = mf - mean;
+                const T diff = in[i] - mean;
+                const T var = (m2 + fixed_count * shift * shift + diff * diff) / fixed_count;
+                out[i] = var > 0 ? std::sqrt(var) : 0;
+            }
+            output_value = out[size - 1];
+            return common::OK;
+        }
+
         /** \brief Получить значение индикатора
          * \return Значение индикатора
          */
@@ -921,6 +1076,28 @@ namespace xtechnical {
             output_value = std::numeric_limits<T>::quiet_NaN();
             last_data = 0;
         }
+
+        /** \brief Сохранить состояние индикатора
+         * \param out Запись состояния
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("StdDev", 1, sizeof(T));
+            out.write(period);
+            buffer.save_state(out);
+            out.write(last_data);
+            out.write(output_value);
+        }
+
+        /** \brief Загрузить состояние индикатора
+         *
+         * Индикатор должен быть создан с теми же параметрами, что и сохраненный
+         * \param in Чтение состояния
+         * \return Вернет true в случае успеха
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("StdDev", 1, sizeof(T)) && in.check(period) && buffer.load_state(in) &&
+                in.read(last_data) && in.read(output_value);
+        }
     };
 
     /** \brief Линия задержки события
@@ -981,11 +1158,14 @@ namespace xtechnical {
     };
 
     /** \brief Cкользящий Min Max Difference
+     *
+     * Минимум и максимум хранятся в монотонных очередях,
+     * поэтому update работает за амортизированное O(1), а test - за O(1)
      */
     template <typename T>
     class MinMaxDiff {
     private:
-        xtechnical::circular_buffer<T> buffer;
+        MonotonicMinMax<T> window;
         DelayLine<T> delay_line;
         T output_value = std::numeric_limits<T>::quiet_NaN();
         T output_min_value = std::numeric_limits<T>::quiet_NaN();
@@ -996,11 +1176,12 @@ namespace xtechnical {
         MinMaxDiff() {};
 
         /** \brief Конструктор скользящего Min Max Difference
-         * \param p     Период
-         * \param o     Смещение назад
+         * \param p         Период
+         * \param o         Смещение назад
+         * \param resource  Источник памяти окна и линии задержки
          */
-        MinMaxDiff(const size_t p, const size_t o = 0) :
-                buffer(p + o), delay_line(1),
+        MinMaxDiff(const size_t p, const size_t o = 0, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                window(p, o, resource), delay_line(1, resource),
                 period(p), offset(o) {
         }
 
@@ -1023,16 +1204,7 @@ namespace xtechnical {
                 return common::INDICATOR_NOT_READY_TO_WORK;
             }
             output_value = std::abs(in - delay_line.get());
-            buffer.update(output_value);
-            if(buffer.full()) {
-                T temp = buffer[0];
-                output_max_value = output_min_value = temp;
-                for(size_t i = 1; i < period; ++i) {
-                    temp = buffer[i];
-                    if(output_max_value < temp) output_max_value = temp;
-                    else if(output_min_value > temp) output_min_value = temp;
-                }
-            } else {
+            if(!window.update(output_value, output_min_value, output_max_value)) {
                 output_value = std::numeric_limits<T>::quiet_NaN();
                 output_min_value = std::numeric_limits<T>::quiet_NaN();
                 output_max_value = std::numeric_limits<T>::quiet_NaN();
@@ -1077,16 +1249,7 @@ namespace xtechnical {
                 return common::INDICATOR_NOT_READY_TO_WORK;
             }
             output_value = std::abs(in - delay_line.get());
-            buffer.test(output_value);
-            if(buffer.full()) {
-                T temp = buffer[0];
-                output_max_value = output_min_value = temp;
-                for(size_t i = 1; i < period; ++i) {
-                    temp = buffer[i];
-                    if(output_max_value < temp) output_max_value = temp;
-                    else if(output_min_value > temp) output_min_value = temp;
-                }
-            } else {
+            if(!window.test(output_value, output_min_value, output_max_value)) {
                 output_value = std::numeric_limits<T>::quiet_NaN();
                 output_min_value = std::numeric_limits<T>::quiet_NaN();
                 output_max_value = std::numeric_limits<T>::quiet_NaN();
@@ -1136,7 +1299,7 @@ namespace xtechnical {
         /** \brief Очистить данные индикатора
          */
         inline void clear() noexcept {
-            buffer.clear();
+            window.clear();
             output_value = std::numeric_limits<T>::quiet_NaN();
             output_min_value = std::numeric_limits<T>::quiet_NaN();
             output_max_value = std::numeric_limits<T>::quiet_NaN();
@@ -1388,21 +1551,44 @@ namespace xtechnical {
     };
 
     /** \brief Взвешенное скользящее среднее
+     *
+     * Свертка окна с весами 1, 2, ..., period считается КИХ-фильтром
      */
     template <typename T>
     class WMA {
+        XTECHNICAL_PROBE("WMA")
     private:
-        std::vector<T> data_;
+        FirFilter<T> fir;
+        T update_value = std::numeric_limits<T>::quiet_NaN();  /**< Значение после последнего update */
         T output_value = std::numeric_limits<T>::quiet_NaN();
         size_t period = 0;
+        bool is_full = false;
+
+        /** \brief Рассчитать веса WMA
+         * \param p        Период
+         * \param resource Источник памяти
+         * \return Веса от самой старой цены к самой новой
+         */
+        static pmr::vector<T> calc_weights(const size_t p, pmr::memory_resource *resource) {
+            pmr::vector<T> w(p, T(0), resource);
+            for(size_t i = 0; i < p; ++i) {
+                w[i] = (T)(i + 1);
+            }
+            return w;
+        }
+
+        inline T normalize(const T sum) const noexcept {
+            return (sum * 2.0d) / ((T)period * ((T)period + 1.0d));
+        }
     public:
         WMA() {};
 
         /** \brief Инициализировать взвешенное скользящее среднее
-         * \param p Период
+         * \param p        Период
+         * \param resource Источник памяти окна
          */
-        WMA(const size_t p) : period(p) {
-            data_.reserve(p);
+        WMA(const size_t p, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                fir(calc_weights(p, resource), resource), period(p) {
         }
 
         /** \brief Обновить состояние индикатора
@@ -1410,31 +1596,15 @@ namespace xtechnical {
          * \return Вернет 0 в случае успеха, иначе см. ErrorType
          */
         int update(const T in) noexcept {
+            XTECHNICAL_PROBE_UPDATE();
             if(period == 0) {
                 output_value = in;
                 return common::NO_INIT;
             }
-            if(data_.size() < (size_t)period) {
-                data_.push_back(in);
-                if(data_.size() == (size_t)period) {
-                    T sum = 0;
-                    for(size_t i = data_.size(); i > 0; i--) {
-                        sum += data_[i - 1] * (T)i;
-                    }
-                    output_value = (sum * 2.0d) / ((T)period * ((T)period + 1.0d));
-                    return common::OK;
-                }
-            } else {
-                data_.push_back(in);
-                data_.erase(data_.begin());
-                T sum = 0;
-                for(size_t i = data_.size(); i > 0; i--) {
-                    sum += data_[i - 1] * (T)i;
-                }
-                output_value = (sum * 2.0d) / ((T)period * ((T)period + 1.0d));
-                return common::OK;
-            }
-            return common::INDICATOR_NOT_READY_TO_WORK;
+            if(fir.update(in) != common::OK) return common::INDICATOR_NOT_READY_TO_WORK;
+            update_value = output_value = normalize(fir.get());
+            is_full = true;
+            return common::OK;
         }
 
         /** \brief Обновить состояние индикатора
@@ -1451,37 +1621,25 @@ namespace xtechnical {
         /** \brief Протестировать индикатор
          *
          * Данный метод отличается от update тем,
-         * что не влияет на внутреннее состояние индикатора
+         * что не влияет на внутреннее состояние индикатора.
+         * При заполненном окне, как и в исходной реализации,
+         * возвращается значение последнего update без учета in
          * \param in    Сигнал на входе
          * \return Вернет 0 в случае успеха, иначе см. ErrorType
          */
         int test(const T in) noexcept {
+            XTECHNICAL_PROBE_TEST();
             if(period == 0) {
                 output_value = in;
                 return common::NO_INIT;
             }
-            std::vector<T> _data = data_;
-            if(_data.size() < (size_t)period) {
-                _data.push_back(in);
-                if(_data.size() == (size_t)period) {
-                    T sum = 0;
-                    for(size_t i = _data.size(); i > 0; i--) {
-                        sum += _data[i - 1] * (T)i;
-                    }
-                    output_value = (sum * 2.0d) / ((T)period * ((T)period + 1.0d));
-                    return common::OK;
-                }
-            } else {
-                _data.push_back(in);
-                _data.erase(_data.begin());
-                T sum = 0;
-                for(size_t i = data_.size(); i > 0; i--) {
-                    sum += data_[i - 1] * (T)i;
-                }
-                output_value = (sum * 2.0d) / ((T)period * ((T)period + 1.0d));
+            if(is_full) {
+                output_value = update_value;
                 return common::OK;
             }
-            return common::INDICATOR_NOT_READY_TO_WORK;
+            if(fir.test(in) != common::OK) return common::INDICATOR_NOT_READY_TO_WORK;
+            output_value = normalize(fir.get());
+            return common::OK;
         }
 
         /** \brief Протестировать индикатор
@@ -1508,8 +1666,33 @@ namespace xtechnical {
         /** \brief Очистить данные индикатора
          */
         inline void clear() noexcept {
-            data_.clear();
+            fir.clear();
+            update_value = std::numeric_limits<T>::quiet_NaN();
             output_value = std::numeric_limits<T>::quiet_NaN();
+            is_full = false;
+        }
+
+        /** \brief Сохранить состояние индикатора
+         * \param out Запись состояния
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("WMA", 2, sizeof(T));
+            out.write(period);
+            fir.save_state(out);
+            out.write(update_value);
+            out.write(output_value);
+            out.write(is_full);
+        }
+
+        /** \brief Загрузить состояние индикатора
+         *
+         * Индикатор должен быть создан с теми же параметрами, что и сохраненный
+         * \param in Чтение состояния
+         * \return Вернет true в случае успеха
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("WMA", 2, sizeof(T)) && in.check(period) && fir.load_state(in) &&
+                in.read(update_value) && in.read(output_value) && in.read(is_full);
         }
     };
 
@@ -1517,22 +1700,33 @@ namespace xtechnical {
      */
     template <class T>
     class EMA {
+        XTECHNICAL_PROBE("EMA")
     protected:
-        std::vector<T> data_;
+        pmr::vector<T> data_;
         T last_data_;
         T a;
         size_t period_ = 0;
         T output_value = std::numeric_limits<T>::quiet_NaN();
+
+        /** \brief Инициализировать среднее с заданным коэффициентом (для MMA)
+         * \param period   период
+         * \param alpha    коэффициент сглаживания
+         * \param resource источник памяти
+         */
+        EMA(const size_t period, const T alpha, pmr::memory_resource *resource) :
+                data_(resource), a(alpha), period_(period) {
+            data_.reserve(period_);
+        }
     public:
         EMA() {};
 
         /** \brief Инициализировать экспоненциально взвешенное
          * скользящее среднее
-         * \param period период
+         * \param period   период
+         * \param resource источник памяти
          */
-        EMA(const size_t period) : period_(period) {
-            data_.reserve(period_);
-            a = 2.0/(T)(period_ + 1.0d);
+        EMA(const size_t period, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            EMA(period, 2.0/(T)(period + 1.0d), resource) {
         }
 
         /** \brief Обновить состояние индикатора
@@ -1540,6 +1734,7 @@ namespace xtechnical {
          * \return Вернет 0 в случае успеха, иначе см. ErrorType
          */
         virtual int update(const T in) noexcept {
+            XTECHNICAL_PROBE_UPDATE();
             if(period_ == 0) {
                 output_value = in;
                 return common::NO_INIT;
@@ -1577,6 +1772,7 @@ namespace xtechnical {
          * \return Вернет 0 в случае успеха, иначе см. ErrorType
          */
         int test(const T &in) noexcept {
+            XTECHNICAL_PROBE_TEST();
             if(period_ == 0) {
                 output_value = in;
                 return common::NO_INIT;
@@ -1602,6 +1798,64 @@ namespace xtechnical {
             return err;
         }
 
+        /** \brief Протестировать индикатор для нескольких значений
+         *
+         * Результат побитово совпадает с вызовами test(in[i]) для каждого i,
+         * цикл по значениям без ветвлений векторизуется компилятором.
+         * После вызова get() вернет результат для последнего значения
+         * \param in    Массив сигналов на входе
+         * \param size  Размер массива
+         * \param out   Массив сигналов на выходе (размер size, может совпадать с in)
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test_many(const T *in, const size_t size, T *out) noexcept {
+            if(size == 0) return common::OK;
+            if(period_ == 0) {
+                if(out != in) std::copy(in, in + size, out);
+                output_value = in[size - 1];
+                return common::NO_INIT;
+            }
+            if(data_.size() != period_) {
+                std::fill(out, out + size, output_value);
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            const T k = a;
+            const auto prev = (1.0 - a) * last_data_;
+            for(size_t i = 0; i < size; ++i) {
+                out[i] = k * in[i] + prev;
+            }
+            output_value = out[size - 1];
+            return common::OK;
+        }
+
+        /** \brief Получить линейные коэффициенты test
+         *
+         * Результат test(in) равен offset + scale * in
+         * \param offset    Свободный член
+         * \param scale     Коэффициент сигнала на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test_coefficients(T &offset, T &scale) const noexcept {
+            if(period_ == 0) return common::NO_INIT;
+            if(data_.size() != period_) return common::INDICATOR_NOT_READY_TO_WORK;
+            offset = (1.0 - a) * last_data_;
+            scale = a;
+            return common::OK;
+        }
+
+        /** \brief Найти сигнал на входе, при котором test вернет заданное значение
+         * \param value Значение индикатора
+         * \param in    Сигнал на входе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test_inverse(const T value, T &in) const noexcept {
+            T offset = 0, scale = 0;
+            const int err = test_coefficients(offset, scale);
+            if(err != common::OK) return err;
+            in = (value - offset) / scale;
+            return common::OK;
+        }
+
         /** \brief Получить значение индикатора
          * \return Значение индикатора
          */
@@ -1615,6 +1869,29 @@ namespace xtechnical {
             data_.clear();
             output_value = std::numeric_limits<T>::quiet_NaN();
         }
+
+        /** \brief Сохранить состояние индикатора
+         * \param out Запись состояния
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("EMA", 1, sizeof(T));
+            out.write(period_);
+            out.write(a);
+            out.write(data_);
+            out.write(last_data_);
+            out.write(output_value);
+        }
+
+        /** \brief Загрузить состояние индикатора
+         *
+         * Индикатор должен быть создан с теми же параметрами, что и сохраненный
+         * \param in Чтение состояния
+         * \return Вернет true в случае успеха
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("EMA", 1, sizeof(T)) && in.check(period_) && in.check(a) &&
+                in.read(data_) && in.read(last_data_) && in.read(output_value);
+        }
     };
 
     /** \brief Модифицированное скользящее среднее
@@ -1622,15 +1899,17 @@ namespace xtechnical {
     template <class T>
     class MMA : public EMA<T> {
     public:
-        MMA() {};
+        MMA() {
+            XTECHNICAL_PROBE_NAME("MMA");
+        };
 
         /** \brief Инициализировать модифицированное скользящее среднее
-         * \param period период
+         * \param period   период
+         * \param resource источник памяти
          */
-        MMA(const size_t period) {
-            EMA<T>::period_ = period;
-            EMA<T>::data_.reserve(period);
-            EMA<T>::a = 1.0/(T)period;
+        MMA(const size_t period, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                EMA<T>(period, 1.0/(T)period, resource) {
+            XTECHNICAL_PROBE_NAME("MMA");
         }
     };
 
@@ -2181,8 +2460,8 @@ namespace xtechnical {
 
         CCI() {};
 
-        CCI(const size_t p) :
-            ma(p), buffer(p) {
+        CCI(const size_t p, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            ma(pmr::make_with_resource<MA_TYPE>(resource, p)), buffer(p, resource) {
         };
 
         int update(const T in) {
@@ -2269,19 +2548,110 @@ namespace xtechnical {
 #endif
 
     /** \brief Линии Боллинджера
+     *
+     * Сумма и сумма квадратов окна обновляются за O(1) на каждом вызове update и test.
+     * Значения хранятся со сдвигом относительно опорного значения, чтобы избежать
+     * потери точности при вычитании, а каждые period обновлений суммы
+     * пересчитываются по буферу заново и опорное значение переносится.
+     * Отклонение считается относительно средней линии MA_TYPE, как и раньше.
      */
     template <typename T, class MA_TYPE = SMA<T>>
     class BollingerBands {
+        XTECHNICAL_PROBE("BollingerBands")
     private:
         xtechnical::circular_buffer<T> buffer;
         MA_TYPE ma;
         DelayLine<T> delay_line;
         size_t period = 0;
         double deviations = 0;
+        pmr::vector<double> factors;    /**< Дополнительные множители стандартного отклонения */
+        pmr::vector<T> output_tls;
+        pmr::vector<T> output_bls;
+        T shift = 0;                    /**< Опорное значение для сумм */
+        T sum = 0;                      /**< Сумма (x - shift) в окне */
+        T sum_sq = 0;                   /**< Сумма (x - shift)^2 в окне */
+        T sum_sq_peak = 0;              /**< Наибольшая sum_sq после пересчета сумм */
+        size_t resync_counter = 0;      /**< Количество обновлений после пересчета сумм */
         T output_tl = std::numeric_limits<T>::quiet_NaN();
         T output_ml = std::numeric_limits<T>::quiet_NaN();
         T output_bl = std::numeric_limits<T>::quiet_NaN();
         T output_std_dev = std::numeric_limits<T>::quiet_NaN();
+
+        struct FactorsTag {};
+
+        BollingerBands(FactorsTag, const size_t p, const std::vector<double> &f, const size_t o,
+                pmr::memory_resource *resource) :
+                buffer(p, resource), ma(pmr::make_with_resource<MA_TYPE>(resource, p)), delay_line(o, resource),
+                period(p), deviations(f.empty() ? 0.0 : f[0]), factors(f.begin(), f.end(), resource),
+                output_tls(f.size(), std::numeric_limits<T>::quiet_NaN(), resource),
+                output_bls(f.size(), std::numeric_limits<T>::quiet_NaN(), resource) {
+        }
+
+        /** \brief Сумма квадратов отклонений от средней линии по суммам окна
+         *
+         * На ровном окне разность сумм и ошибка округления средней линии
+         * дают шум вместо нуля, поэтому значения на уровне ошибок
+         * округления считаются нулем и полосы совпадают со средней линией.
+         * Остаток в s_sq копится от вычитания прежних слагаемых, поэтому
+         * ошибка оценивается по наибольшей сумме квадратов после пересчета
+         * \param m     Средняя линия
+         * \param base  Опорное значение сумм
+         * \param s     Сумма (x - base)
+         * \param s_sq  Сумма (x - base)^2
+         * \param peak  Наибольшая сумма квадратов после пересчета сумм
+         */
+        inline T calc_sum_diff(const T m, const T base, const T s, const T s_sq, const T peak) const noexcept {
+            const T d = m - base;
+            const T sum_diff = s_sq - (T)2 * d * s + (T)period * d * d;
+            const T e = (T)(4 * period) * std::numeric_limits<T>::epsilon();
+            const T tolerance = e * (peak + (T)period * d * d) + (T)period * (e * m) * (e * m);
+            return sum_diff <= tolerance ? T(0) : sum_diff;
+        }
+
+        /** \brief Пересчитать суммы по буферу с новым опорным значением
+         */
+        void resync(const T new_shift) noexcept {
+            shift = new_shift;
+            sum = 0;
+            sum_sq = 0;
+            const size_t size = buffer.size();
+            for (size_t i = 0; i < size; ++i) {
+                const T y = buffer[i] - shift;
+                sum += y;
+                sum_sq += y * y;
+            }
+            sum_sq_peak = sum_sq;
+            resync_counter = 0;
+        }
+
+        /** \brief Записать выходы по суммам окна
+         * \param base  Опорное значение сумм
+         * \param s     Сумма (x - base)
+         * \param s_sq  Сумма (x - base)^2
+         * \param peak  Наибольшая сумма квадратов после пересчета сумм
+         */
+        inline void calc_output(const T base, const T s, const T s_sq, const T peak) noexcept {
+            output_ml = ma.get();
+            output_std_dev = std::sqrt(calc_sum_diff(output_ml, base, s, s_sq, peak) / (T)(period - 1));
+            const T std_dev_offset = output_std_dev * deviations;
+            output_tl = std_dev_offset + output_ml;
+            output_bl = output_ml - std_dev_offset;
+            for (size_t i = 0; i < factors.size(); ++i) {
+                const T offset = output_std_dev * factors[i];
+                output_tls[i] = offset + output_ml;
+                output_bls[i] = output_ml - offset;
+            }
+        }
+
+        inline void clear_output() noexcept {
+            output_tl = std::numeric_limits<T>::quiet_NaN();
+            output_ml = std::numeric_limits<T>::quiet_NaN();
+            output_bl = std::numeric_limits<T>::quiet_NaN();
+            output_std_dev = std::numeric_limits<T>::quiet_NaN();
+            std::fill(output_tls.begin(), output_tls.end(), std::numeric_limits<T>::quiet_NaN());
+            std::fill(output_bls.begin(), output_bls.end(), std::numeric_limits<T>::quiet_NaN());
+        }
+
     public:
 
         BollingerBands() {};
@@ -2290,10 +2660,26 @@ namespace xtechnical {
          * \param p Период
          * \param d Множитель стандартного отклонения
          * \param o Смещение назад
+         * \param resource Источник памяти буферов (и MA_TYPE, если тип его принимает)
+         */
+        BollingerBands(const size_t p, const size_t d, const size_t o = 0,
+                pmr::memory_resource *resource = pmr::get_default_resource()) :
+                buffer(p, resource), ma(pmr::make_with_resource<MA_TYPE>(resource, p)), delay_line(o, resource),
+                period(p), deviations(d), factors(resource), output_tls(resource), output_bls(resource) {
+        }
+
+        /** \brief Создать линии Боллинджера с несколькими множителями
+         *
+         * Полосы для всех множителей считаются за один проход,
+         * первый множитель также доступен через get_tl() и get_bl()
+         * \param p     Период
+         * \param f     Множители стандартного отклонения, например {1.0, 2.0, 2.5}
+         * \param o     Смещение назад
+         * \param resource  Источник памяти буферов (и MA_TYPE, если тип его принимает)
          */
-        BollingerBands(const size_t p, const size_t d, const size_t o = 0) :
-                buffer(p), ma(p), delay_line(o),
-                period(p), deviations(d) {
+        static BollingerBands with_factors(const size_t p, const std::vector<double> &f, const size_t o = 0,
+                pmr::memory_resource *resource = pmr::get_default_resource()) {
+            return BollingerBands(FactorsTag(), p, f, o, resource);
         }
 
         /** \brief Обновить состояние индикатора
@@ -2301,39 +2687,33 @@ namespace xtechnical {
          * \return Вернет 0 в случае успеха, иначе см. ErrorType
          */
         int update(const T in) noexcept {
+            XTECHNICAL_PROBE_UPDATE();
             if(period == 0) {
-                output_tl = std::numeric_limits<T>::quiet_NaN();
-                output_ml = std::numeric_limits<T>::quiet_NaN();
-                output_bl = std::numeric_limits<T>::quiet_NaN();
-                output_std_dev = std::numeric_limits<T>::quiet_NaN();
+                clear_output();
                 return common::NO_INIT;
             }
             if(delay_line.update(in) != common::OK) {
-                output_tl = std::numeric_limits<T>::quiet_NaN();
-                output_ml = std::numeric_limits<T>::quiet_NaN();
-                output_bl = std::numeric_limits<T>::quiet_NaN();
-                output_std_dev = std::numeric_limits<T>::quiet_NaN();
+                clear_output();
                 return common::INDICATOR_NOT_READY_TO_WORK;
             }
-            buffer.update(delay_line.get());
-            ma.update(delay_line.get());
+            const T x = delay_line.get();
+            if(buffer.empty()) shift = x;
+            if(buffer.full()) {
+                const T y = buffer.front() - shift;
+                sum -= y;
+                sum_sq -= y * y;
+            }
+            const T y = x - shift;
+            sum += y;
+            sum_sq += y * y;
+            if(sum_sq > sum_sq_peak) sum_sq_peak = sum_sq;
+            buffer.update(x);
+            ma.update(x);
+            if(++resync_counter >= period) resync(x);
             if(buffer.full() && !std::isnan(ma.get())) {
-                std::vector<T> data = buffer.to_vector();
-                output_ml = ma.get();
-                T sum = 0;
-                for (size_t i = 0; i < period; ++i) {
-                    const T diff = (data[i] - output_ml);
-                    sum += diff * diff;
-                }
-                output_std_dev = std::sqrt(sum / (T)(period - 1));
-                const T std_dev_offset = output_std_dev * deviations;
-                output_tl = std_dev_offset + output_ml;
-                output_bl = output_ml - std_dev_offset;
+                calc_output(shift, sum, sum_sq, sum_sq_peak);
             } else {
-                output_tl = std::numeric_limits<T>::quiet_NaN();
-                output_ml = std::numeric_limits<T>::quiet_NaN();
-                output_bl = std::numeric_limits<T>::quiet_NaN();
-                output_std_dev = std::numeric_limits<T>::quiet_NaN();
+                clear_output();
                 return common::INDICATOR_NOT_READY_TO_WORK;
             }
             return common::OK;
@@ -2368,43 +2748,39 @@ namespace xtechnical {
         }
 
         /** \brief Протестировать индикатор
+         *
+         * Буфер не копируется, суммы окна считаются за O(1)
          * \param in    Сигнал на входе
          * \return Вернет 0 в случае успеха, иначе см. ErrorType
          */
         int test(const T in) noexcept {
+            XTECHNICAL_PROBE_TEST();
             if(period == 0) {
-                output_tl = std::numeric_limits<T>::quiet_NaN();
-                output_ml = std::numeric_limits<T>::quiet_NaN();
-                output_bl = std::numeric_limits<T>::quiet_NaN();
-                output_std_dev = std::numeric_limits<T>::quiet_NaN();
+                clear_output();
                 return common::NO_INIT;
             }
             if(delay_line.test(in) != common::OK) {
-                output_tl = std::numeric_limits<T>::quiet_NaN();
-                output_ml = std::numeric_limits<T>::quiet_NaN();
-                output_bl = std::numeric_limits<T>::quiet_NaN();
-                output_std_dev = std::numeric_limits<T>::quiet_NaN();
+                clear_output();
                 return common::INDICATOR_NOT_READY_TO_WORK;
             }
-            buffer.test(delay_line.get());
-            ma.test(delay_line.get());
-            if(buffer.full() && !std::isnan(ma.get())) {
-                std::vector<T> data = buffer.to_vector();
-                output_ml = ma.get();
-                T sum = 0;
-                for (size_t i = 0; i < period; ++i) {
-                    const T diff = (data[i] - output_ml);
-                    sum += diff * diff;
-                }
-                output_std_dev = std::sqrt(sum / (T)(period - 1));
-                const T std_dev_offset = output_std_dev * deviations;
-                output_tl = std_dev_offset + output_ml;
-                output_bl = output_ml - std_dev_offset;
+            const T x = delay_line.get();
+            const T base = buffer.empty() ? x : shift;
+            T s = buffer.empty() ? T(0) : sum;
+            T s_sq = buffer.empty() ? T(0) : sum_sq;
+            if(buffer.full()) {
+                const T y = buffer.front() - base;
+                s -= y;
+                s_sq -= y * y;
+            }
+            const T y = x - base;
+            s += y;
+            s_sq += y * y;
+            const T peak = std::max(buffer.empty() ? T(0) : sum_sq_peak, s_sq);
+            ma.test(x);
+            if((buffer.size() + 1) >= period && !std::isnan(ma.get())) {
+                calc_output(base, s, s_sq, peak);
             } else {
-                output_tl = std::numeric_limits<T>::quiet_NaN();
-                output_ml = std::numeric_limits<T>::quiet_NaN();
-                output_bl = std::numeric_limits<T>::quiet_NaN();
-                output_std_dev = std::numeric_limits<T>::quiet_NaN();
+                clear_output();
                 return common::INDICATOR_NOT_READY_TO_WORK;
             }
             return common::OK;
@@ -2444,21 +2820,146 @@ namespace xtechnical {
             return err;
         }
 
+        /** \brief Протестировать индикатор для нескольких значений
+         *
+         * Результат побитово совпадает с вызовами test(in[i]) для каждого i.
+         * Суммы окна без нового значения считаются один раз, средняя линия
+         * берется из MA_TYPE::test_many, цикл расчета полос не содержит ветвлений.
+         * Данные обрабатываются блоками по XTECHNICAL_BLOCK_SIZE.
+         * Полосы считаются для первого множителя, после вызова
+         * все get_*() вернут результат для последнего значения
+         * \param in    Массив сигналов на входе
+         * \param size  Размер массива
+         * \param tl    Массив верхней полосы (размер size)
+         * \param ml    Массив средней полосы (размер size)
+         * \param bl    Массив нижней полосы (размер size)
+         * \return Код ошибки последнего значения, см. ErrorType
+         */
+        int test_many(const T *in, const size_t size, T *tl, T *ml, T *bl) noexcept {
+            if(size == 0) return common::OK;
+            const T last_in = in[size - 1];
+            if(period == 0) {
+                std::fill(tl, tl + size, std::numeric_limits<T>::quiet_NaN());
+                std::fill(ml, ml + size, std::numeric_limits<T>::quiet_NaN());
+                std::fill(bl, bl + size, std::numeric_limits<T>::quiet_NaN());
+                clear_output();
+                return common::NO_INIT;
+            }
+            const bool is_empty = buffer.empty();
+            T s0 = is_empty ? T(0) : sum;
+            T s_sq0 = is_empty ? T(0) : sum_sq;
+            const T peak0 = is_empty ? T(0) : sum_sq_peak;
+            if(buffer.full()) {
+                const T y = buffer.front() - shift;
+                s0 -= y;
+                s_sq0 -= y * y;
+            }
+            const bool is_full = (buffer.size() + 1) >= period;
+            const T div = (T)(period - 1);
+            T x[XTECHNICAL_BLOCK_SIZE];
+            for (size_t begin = 0; begin < size; begin += XTECHNICAL_BLOCK_SIZE) {
+                const size_t n = std::min((size_t)XTECHNICAL_BLOCK_SIZE, size - begin);
+                T *block_tl = tl + begin;
+                T *block_ml = ml + begin;
+                T *block_bl = bl + begin;
+                bool is_ready = is_full;
+                for (size_t i = 0; i < n; ++i) {
+                    if(delay_line.test(in[begin + i]) != common::OK) is_ready = false;
+                    x[i] = delay_line.get();
+                }
+                if(!is_ready) {
+                    std::fill(block_tl, block_tl + n, std::numeric_limits<T>::quiet_NaN());
+                    std::fill(block_ml, block_ml + n, std::numeric_limits<T>::quiet_NaN());
+                    std::fill(block_bl, block_bl + n, std::numeric_limits<T>::quiet_NaN());
+                    continue;
+                }
+                ma.test_many(x, n, block_ml);
+                for (size_t i = 0; i < n; ++i) {
+                    const T base = is_empty ? x[i] : shift;
+                    const T y = x[i] - base;
+                    const T s = s0 + y;
+                    const T s_sq = s_sq0 + y * y;
+                    const T m = block_ml[i];
+                    const T std_dev = std::sqrt(calc_sum_diff(m, base, s, s_sq, std::max(peak0, s_sq)) / div);
+                    const T std_dev_offset = std_dev * deviations;
+                    /* NaN средней линии дает NaN на всех полосах, как в test */
+                    block_tl[i] = std_dev_offset + m;
+                    block_bl[i] = m - std_dev_offset;
+                }
+            }
+            /* выходы и все множители - как после test последнего значения */
+            return test(last_in);
+        }
+
         inline T get_tl() const noexcept {return output_tl;};
         inline T get_ml() const noexcept {return output_ml;};
         inline T get_bl() const noexcept {return output_bl;};
         inline T get_std_dev() const noexcept {return output_std_dev;};
 
+        /** \brief Количество множителей, заданных при инициализации
+         */
+        inline size_t get_factors_size() const noexcept {return factors.size();};
+
+        /** \brief Верхняя полоса для множителя с индексом index
+         */
+        inline T get_tl(const size_t index) const noexcept {return output_tls[index];};
+
+        /** \brief Нижняя полоса для множителя с индексом index
+         */
+        inline T get_bl(const size_t index) const noexcept {return output_bls[index];};
+
         /** \brief Очистить данные индикатора
          */
         void clear() noexcept {
             buffer.clear();
             ma.clear();
             delay_line.clear();
-            output_tl = std::numeric_limits<T>::quiet_NaN();
-            output_ml = std::numeric_limits<T>::quiet_NaN();
-            output_bl = std::numeric_limits<T>::quiet_NaN();
-            output_std_dev = std::numeric_limits<T>::quiet_NaN();
+            shift = 0;
+            sum = 0;
+            sum_sq = 0;
+            sum_sq_peak = 0;
+            resync_counter = 0;
+            clear_output();
+        }
+
+        /** \brief Сохранить состояние индикатора
+         * \param out Запись состояния
+         */
+        void save_state(StateWriter &out) const {
+            out.begin("BollingerBands", 3, sizeof(T));
+            out.write(period);
+            out.write(deviations);
+            out.write(factors);
+            buffer.save_state(out);
+            ma.save_state(out);
+            delay_line.save_state(out);
+            out.write(shift);
+            out.write(sum);
+            out.write(sum_sq);
+            out.write(sum_sq_peak);
+            out.write(resync_counter);
+            out.write(output_tl);
+            out.write(output_ml);
+            out.write(output_bl);
+            out.write(output_std_dev);
+            out.write(output_tls);
+            out.write(output_bls);
+        }
+
+        /** \brief Загрузить состояние индикатора
+         *
+         * Индикатор должен быть создан с теми же параметрами, что и сохраненный
+         * \param in Чтение состояния
+         * \return Вернет true в случае успеха
+         */
+        bool load_state(StateReader &in) {
+            return in.begin("BollingerBands", 3, sizeof(T)) && in.check(period) &&
+                in.check(deviations) && in.check(factors) && buffer.load_state(in) &&
+                ma.load_state(in) && delay_line.load_state(in) && in.read(shift) &&
+                in.read(sum) && in.read(sum_sq) && in.read(sum_sq_peak) && in.read(resync_counter) &&
+                in.read(output_tl) && in.read(output_ml) && in.read(output_bl) &&
+                in.read(output_std_dev) && in.read(output_tls) && in.read(output_bls) &&
+                output_tls.size() == factors.size() && output_bls.size() == factors.size();
         }
     };
 
@@ -2764,95 +3265,186 @@ namespace xtechnical {
     };
 
     /** \brief Экспериментальный индикатор, не применять!
+     *
+     * Ранговая корреляция Спирмена последних len значений с шаблонами
+     * exp(x) (рост) и -exp(x) (падение). Шаблоны строго монотонны,
+     * поэтому их ранги равны номерам позиций и вычисляются в конструкторе
+     * один раз. Окно хранится вместе с отсортированной копией, которая
+     * обновляется вставкой и удалением без выделения памяти. При каждом
+     * обновлении коэффициенты для всех длин от MIN_WAVEFORM_LEN до max_len
+     * считаются за один проход: фрагмент наращивается от новых значений
+     * к старым, ранги и поправки на одинаковые ранги ведутся через
+     * дерево Фенвика по позициям в отсортированном окне.
      */
     template <typename T>
     class DetectorWaveform {
     private:
-        MW<T> iMW;
         const size_t MIN_WAVEFORM_LEN = 3;
-        T coeff_exp = 3.141592;
-        std::vector<std::vector<T>> exp_data_up_;
-        std::vector<std::vector<T>> exp_data_dn_;
+        xtechnical::circular_buffer<T> window;
+        std::vector<T> sorted_;         /**< Окно, отсортированное по возрастанию */
+        std::vector<T> fenwick_num_;    /**< Число значений фрагмента по позициям в sorted_ */
+        std::vector<T> fenwick_pos_;    /**< Сумма индексов значений фрагмента по позициям в sorted_ */
+        std::vector<T> equal_num_;      /**< Число одинаковых значений фрагмента */
+        std::vector<T> equal_pos_;      /**< Сумма индексов одинаковых значений фрагмента */
+        std::vector<T> sum_rank_sq_;    /**< Сумма квадратов рангов шаблона для каждой длины */
+        std::vector<T> coeff_up_;
+        std::vector<T> coeff_dn_;
+        size_t max_len_ = 0;
 
-        void init_exp_data_up(std::vector<T> &data) {
-            T dt = 1.0/(T)data.size();
-            for(size_t i = 0; i < data.size(); ++i) {
-                data[i] = exp(coeff_exp*(T)i*dt);
-            }
-            normalization::calculate_min_max(
-                data,
-                data,
-                common::MINMAX_UNSIGNED);
+        inline void fenwick_add(std::vector<T> &tree, size_t i, const T value) noexcept {
+            for (++i; i <= tree.size(); i += i & (~i + 1)) tree[i - 1] += value;
         }
 
-        void init_exp_data_dn(std::vector<T> &data) {
-            T dt = 1.0/(T)data.size();
-            for(size_t i = 0; i < data.size(); ++i) {
-                data[i] = -exp(coeff_exp*(T)i*dt);
+        /** \brief Сумма по позициям [0, i)
+         */
+        inline T fenwick_sum(const std::vector<T> &tree, size_t i) const noexcept {
+            T sum = 0;
+            for (; i > 0; i -= i & (~i + 1)) sum += tree[i - 1];
+            return sum;
+        }
+
+        void erase_sorted(const T value) noexcept {
+            auto it = std::lower_bound(sorted_.begin(), sorted_.end(), value);
+            if (it != sorted_.end()) sorted_.erase(it);
+        }
+
+        void insert_sorted(const T value) noexcept {
+            sorted_.insert(std::upper_bound(sorted_.begin(), sorted_.end(), value), value);
+        }
+
+        /** \brief Посчитать коэффициенты для всех длин
+         */
+        void calc() noexcept {
+            const size_t n = window.size();
+            std::fill(fenwick_num_.begin(), fenwick_num_.end(), T(0));
+            std::fill(fenwick_pos_.begin(), fenwick_pos_.end(), T(0));
+            std::fill(equal_num_.begin(), equal_num_.end(), T(0));
+            std::fill(equal_pos_.begin(), equal_pos_.end(), T(0));
+            T sum_rank_pos = 0;     // сумма rank * index по фрагменту
+            T sum_pos = 0;          // сумма индексов фрагмента
+            T ties_pairs = 0;       // количество пар одинаковых рангов
+            T ties_cube = 0;        // сумма t^3 - t по группам одинаковых значений
+            for (size_t l = 1; l <= n; ++l) {
+                const size_t g = n - l;
+                const T value = window[g];
+                const size_t c = std::distance(sorted_.begin(), std::lower_bound(sorted_.begin(), sorted_.end(), value));
+                const T t = equal_num_[c];
+                const T less_num = fenwick_sum(fenwick_num_, c);
+                const T less_pos = fenwick_sum(fenwick_pos_, c);
+                const T greater_pos = sum_pos - less_pos - equal_pos_[c];
+                /* ранги больших значений растут на 1, одинаковых - на 1/2 */
+                const T rank = less_num + (t + 2.0) / 2.0;
+                sum_rank_pos += greater_pos + equal_pos_[c] / 2.0 + rank * (T)g;
+                ties_pairs += t;
+                ties_cube += 3.0 * t * (t + 1.0);
+
+                fenwick_add(fenwick_num_, c, 1);
+                fenwick_add(fenwick_pos_, c, (T)g);
+                equal_num_[c] += 1;
+                equal_pos_[c] += (T)g;
+                sum_pos += (T)g;
+
+                if (l < MIN_WAVEFORM_LEN) continue;
+                const T len = (T)l;
+                const T sum_rank = len * (len + 1.0) / 2.0;
+                const T sum_rank_sq = sum_rank_sq_[l - MIN_WAVEFORM_LEN];
+                const T sum_rank_sq_x = sum_rank_sq - ties_cube / 12.0;
+                /* позиция во фрагменте i = index - g, ранг шаблона роста i + 1, падения l - i */
+                const T sum_up = sum_rank_pos - ((T)g - 1.0) * sum_rank;
+                const T sum_dn = (len + (T)g) * sum_rank - sum_rank_pos;
+                const T d1 = ties_pairs > 0 ? (ties_pairs * ties_pairs * ties_pairs - ties_pairs) / 12.0 : 0.0;
+                const T den = len * len * len - len;
+                coeff_up_[l - MIN_WAVEFORM_LEN] = 1.0 - ((6.0 * (sum_rank_sq_x - 2.0 * sum_up + sum_rank_sq) + d1) / den);
+                coeff_dn_[l - MIN_WAVEFORM_LEN] = 1.0 - ((6.0 * (sum_rank_sq_x - 2.0 * sum_dn + sum_rank_sq) + d1) / den);
             }
-            normalization::calculate_min_max(
-                data,
-                data,
-                common::MINMAX_UNSIGNED);
         }
+
     public:
         /** \brief Инициализировать класс
          * \param max_len максимальная длина файла
          */
-        DetectorWaveform(const int max_len) : iMW(max_len) {
-            if(max_len < MIN_WAVEFORM_LEN) return;
-            size_t max_num_exp_data = max_len - MIN_WAVEFORM_LEN + 1;
-            exp_data_up_.resize(max_num_exp_data);
-            exp_data_dn_.resize(max_num_exp_data);
-            for(size_t l = MIN_WAVEFORM_LEN; l <= max_len; ++l) {
-                exp_data_up_[l-MIN_WAVEFORM_LEN].resize(l);
-                exp_data_dn_[l-MIN_WAVEFORM_LEN].resize(l);
-                init_exp_data_up(exp_data_up_[l-MIN_WAVEFORM_LEN]);
-                init_exp_data_dn(exp_data_dn_[l-MIN_WAVEFORM_LEN]);
+        DetectorWaveform(const int max_len) : window(max_len > 0 ? max_len : 0) {
+            if(max_len < (int)MIN_WAVEFORM_LEN) return;
+            max_len_ = max_len;
+            const size_t max_num_exp_data = max_len - MIN_WAVEFORM_LEN + 1;
+            sorted_.reserve(max_len_ + 1);
+            fenwick_num_.resize(max_len_);
+            fenwick_pos_.resize(max_len_);
+            equal_num_.resize(max_len_);
+            equal_pos_.resize(max_len_);
+            coeff_up_.resize(max_num_exp_data, std::numeric_limits<T>::quiet_NaN());
+            coeff_dn_.resize(max_num_exp_data, std::numeric_limits<T>::quiet_NaN());
+            sum_rank_sq_.resize(max_num_exp_data);
+            for(size_t l = MIN_WAVEFORM_LEN; l <= max_len_; ++l) {
+                const T len = (T)l;
+                sum_rank_sq_[l - MIN_WAVEFORM_LEN] = len * (len + 1.0) * (2.0 * len + 1.0) / 6.0;
             }
         }
 
+        /** \brief Обновить состояние индикатора
+         *
+         * Считает коэффициенты для всех длин, см. get
+         * \param in сигнал на входе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in) {
+            if(max_len_ == 0) return common::NO_INIT;
+            if(window.full()) erase_sorted(window.front());
+            window.update(in);
+            insert_sorted(in);
+            if(!window.full()) return common::INDICATOR_NOT_READY_TO_WORK;
+            calc();
+            return common::OK;
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in сигнал на входе
+         * \param out коэффициент корреляции с шаблоном, больший по модулю
+         * \param len_waveform длина фрагмента
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
         int update(T in, T &out, const int len_waveform) {
-            std::vector<T> mw_out;
-            int err = iMW.update(in, mw_out);
-            if(err == common::OK) {
-                if(mw_out.size() >= MIN_WAVEFORM_LEN &&
-                    len_waveform <= mw_out.size()) {
-                    std::vector<T> fragment_data;
-                    fragment_data.insert(
-                        fragment_data.begin(),
-                        mw_out.begin() + mw_out.size() - len_waveform,
-                        mw_out.end());
-                    int err_n = normalization::calculate_min_max(
-                        fragment_data,
-                        fragment_data,
-                        common::MINMAX_UNSIGNED);
-                    if(err_n != common::OK) return err_n;
-                    T coeff_up = 0, coeff_dn = 0;
-                    int err_up = correlation::calculate_spearman_rank_correlation_coefficient(
-                        fragment_data,
-                        exp_data_up_[len_waveform-MIN_WAVEFORM_LEN],
-                        coeff_up);
-
-                    int err_dn = correlation::calculate_spearman_rank_correlation_coefficient(
-                        fragment_data,
-                        exp_data_dn_[len_waveform-MIN_WAVEFORM_LEN],
-                        coeff_dn);
-                    if(err_up != common::OK) return err_up;
-                    if(err_dn != common::OK) return err_dn;
-                    if(abs(coeff_up) > abs(coeff_dn)) {
-                        out = coeff_up;
-                    } else {
-                        out = coeff_dn;
-                    }
-                    return common::OK;
-                }
+            if(len_waveform < (int)MIN_WAVEFORM_LEN || len_waveform > (int)max_len_) {
+                return common::INVALID_PARAMETER;
             }
-            return err;
+            const int err = update(in);
+            if(err != common::OK) return err;
+            out = get(len_waveform);
+            return common::OK;
+        }
+
+        /** \brief Получить коэффициент для длины фрагмента
+         * \param len_waveform длина фрагмента
+         * \return коэффициент корреляции с шаблоном, больший по модулю
+         */
+        inline T get(const int len_waveform) const noexcept {
+            if(len_waveform < (int)MIN_WAVEFORM_LEN || len_waveform > (int)max_len_) {
+                return std::numeric_limits<T>::quiet_NaN();
+            }
+            const T coeff_up = coeff_up_[len_waveform - MIN_WAVEFORM_LEN];
+            const T coeff_dn = coeff_dn_[len_waveform - MIN_WAVEFORM_LEN];
+            return std::abs(coeff_up) > std::abs(coeff_dn) ? coeff_up : coeff_dn;
+        }
+
+        /** \brief Коэффициенты корреляции с шаблоном роста для всех длин
+         * \return Массив, индекс 0 соответствует длине MIN_WAVEFORM_LEN
+         */
+        inline const std::vector<T> &get_up() const noexcept {
+            return coeff_up_;
+        }
+
+        /** \brief Коэффициенты корреляции с шаблоном падения для всех длин
+         * \return Массив, индекс 0 соответствует длине MIN_WAVEFORM_LEN
+         */
+        inline const std::vector<T> &get_dn() const noexcept {
+            return coeff_dn_;
         }
 
         void clear() {
-            iMW.clear();
+            window.clear();
+            sorted_.clear();
+            std::fill(coeff_up_.begin(), coeff_up_.end(), std::numeric_limits<T>::quiet_NaN());
+            std::fill(coeff_dn_.begin(), coeff_dn_.end(), std::numeric_limits<T>::quiet_NaN());
         }
     };
 
@@ -3176,106 +3768,98 @@ namespace xtechnical {
     };
 
     /** \brief Скользящая средняя NoLagMa
+     *
+     * Взвешенная сумма последних length * 4 + length - 1 цен
+     * (цены до первой считаются нулевыми), деленная на сумму весов.
+     * Веса считаются один раз при создании, свертка выполняется FirFilter
      */
     template <typename T>
     class NoLagMa {
         private:
-        T Pi = 3.14159265358979323846264338327950288;
-        std::vector<T> nlm_values;
-        std::vector<T> nlm_prices;
-        std::vector<T> nlm_alphas;
-        uint32_t _length = 0;
-        uint32_t _len = 1;
-        uint32_t _weight = 2;
-        uint32_t LengthMA = 10;
-        size_t bars = 0;
+        T weight = 0;       /**< Сумма весов, рассчитывается до создания fir */
+        FirFilter<T> fir;
         int err = common::NO_INIT;
 
-        inline T calc(const T price, const int length, int r) {
-            /* прошу прощения за говнокод,
-             * это копипаст из метатрейдера, переписанный на С++
-             */
-            if(nlm_prices.size() != bars) {
-                nlm_prices.resize(bars);
-            }
-            nlm_prices[r] = price;
-            if (nlm_values[_length] != length) {
-                T Cycle = 4.0;
-                T Coeff = 3.0*Pi;
-                int    Phase = length-1;
-
-                nlm_values[_length] = length;
-                nlm_values[_len] = length*4 + Phase;
-                nlm_values[_weight] = 0;
-
-                if (nlm_alphas.size() < nlm_values[_len]) {
-                    nlm_alphas.resize((size_t)nlm_values[_len]);
-                }
-                for (int k = 0; k< nlm_values[_len]; k++) {
-                    T t;
-                    if (k <= Phase-1) {
-                        t = 1.0 * k/(Phase-1);
-                    } else {
-                        t = 1.0 + (k - Phase + 1)*(2.0 * Cycle - 1.0)/
-                            (Cycle * (T)length - 1.0);
-                    }
-                    T beta = cos(Pi*t);
-                    T g = 1.0/(Coeff*t+1);
-                    if (t <= 0.5 ) {g = 1;}
-
-                    nlm_alphas[k] = g * beta;
-                    nlm_values[_weight] += nlm_alphas[k];
+        /** \brief Рассчитать веса NoLagMa
+         * \param length   Период
+         * \param sum      Сумма весов
+         * \return Веса от самой старой цены к самой новой
+         */
+        static std::vector<T> calc_alphas(const int length, T &sum) {
+            /* формулы из индикатора для метатрейдера */
+            const T Pi = 3.14159265358979323846264338327950288;
+            const T Cycle = 4.0;
+            const T Coeff = 3.0*Pi;
+            const int Phase = length-1;
+            const int len = length*4 + Phase;
+            sum = 0;
+            if (len <= 0) return std::vector<T>();
+            std::vector<T> alphas((size_t)len);
+            for (int k = 0; k < len; k++) {
+                T t;
+                if (k <= Phase-1) {
+                    t = 1.0 * k/(Phase-1);
+                } else {
+                    t = 1.0 + (k - Phase + 1)*(2.0 * Cycle - 1.0)/
+                        (Cycle * (T)length - 1.0);
                 }
+                T beta = cos(Pi*t);
+                T g = 1.0/(Coeff*t+1);
+                if (t <= 0.5 ) {g = 1;}
+                /* alpha[k] относится к цене k баров назад */
+                alphas[len - 1 - k] = g * beta;
+                sum += g * beta;
             }
-
-            if (nlm_values[_weight]>0) {
-                double sum = 0;
-                for (int k=0; k < nlm_values[_len] && (r-k)>=0; k++)
-                    sum += nlm_alphas[k]*nlm_prices[r-k];
-                err = common::OK;
-                return(sum / nlm_values[_weight]);
-            } else return 0;
+            return alphas;
         }
 
         public:
 
-        NoLagMa(const uint32_t period = 10) {
-            LengthMA = period;
-            nlm_values.resize(3);
+        /** \brief Инициализировать NoLagMa
+         * \param period    Период
+         * \param resource  Источник памяти КИХ-фильтра
+         */
+        NoLagMa(const uint32_t period = 10, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            fir(calc_alphas(period, weight), true, resource) {
         }
 
         int update(const T in, T &out) {
-            ++bars;
-            out = calc(in, LengthMA, bars - 1);
+            fir.update(in);
+            if (!(weight > 0)) {
+                out = 0;
+                return err;
+            }
+            out = fir.get() / weight;
+            err = common::OK;
             return err;
         }
 
         int test(const T in, T &out) {
-            std::vector<T> old_nlm_values = nlm_values;
-            std::vector<T> old_nlm_prices = nlm_prices;
-            std::vector<T> old_nlm_alphas = nlm_alphas;
-            out = calc(in, LengthMA, bars);
-            nlm_values = old_nlm_values;
-            nlm_prices = old_nlm_prices;
-            nlm_alphas = old_nlm_alphas;
-            bars = 0;
+            fir.test(in);
+            if (!(weight > 0)) {
+                out = 0;
+                return err;
+            }
+            out = fir.get() / weight;
+            err = common::OK;
             return err;
         }
 
         void clear() {
-            nlm_values.resize(3);
-            nlm_prices.clear();
-            nlm_alphas.clear();
+            fir.clear();
             err = common::NO_INIT;
         }
     };
 
     /** \brief Гистограмма частот
+     *
+     * Окно хранится в кольцевом буфере и передается в ДПФ без копирования,
+     * нормализация, оконная функция и ДПФ выполняются за один проход
      */
     template<class T>
     class FreqHist {
     private:
-        MW<T> iMW;
+        xtechnical::circular_buffer<T> buffer;
         dft::DftReal<T> iDftReal;
         size_t dft_period = 0;
     public:
@@ -3283,7 +3867,7 @@ namespace xtechnical {
         FreqHist() {};
 
         FreqHist(const size_t period, const size_t window_type) :
-            iMW(period), iDftReal(period, window_type) {
+            buffer(period), iDftReal(period, window_type) {
             dft_period = period;
         };
 
@@ -3291,16 +3875,10 @@ namespace xtechnical {
                 const T &input,
                 std::vector<T> &histogram,
                 const T sample_rate = 0) {
-            int err = iMW.update(input);
-            if(err != common::OK) return err;
-            std::vector<T> buffer;
-            iMW.get_data(buffer);
-            std::vector<T> frequencies;
-            normalization::calculate_min_max(
-                buffer,
-                buffer,
-                common::MINMAX_SIGNED);
-            return iDftReal.update(buffer, histogram, frequencies, sample_rate);
+            if(dft_period == 0) return common::NO_INIT;
+            buffer.update(input);
+            if(!buffer.full()) return common::INDICATOR_NOT_READY_TO_WORK;
+            return iDftReal.update_min_max_signed(buffer, dft_period, histogram);
         }
 
         int update(
@@ -3308,19 +3886,15 @@ namespace xtechnical {
                 std::vector<T> &amplitude,
                 std::vector<T> &frequencies,
                 const T sample_rate = 0) {
-            int err = iMW.update(input);
+            const int err = update(input, amplitude, sample_rate);
             if(err != common::OK) return err;
-            std::vector<T> buffer;
-            iMW.get_data(buffer);
-            normalization::calculate_min_max(
-                buffer,
-                buffer,
-                common::MINMAX_SIGNED);
-            return iDftReal.update(buffer, amplitude, frequencies, sample_rate);
+            const std::vector<T> &table = iDftReal.get_frequencies(sample_rate);
+            frequencies.assign(table.begin(), table.end());
+            return common::OK;
         }
 
         void clear() {
-            iMW.clear();
+            buffer.clear();
         }
     };
 
@@ -3919,7 +4493,7 @@ namespace xtechnical {
     private:
         INDICATOR_TYPE ma1;
         INDICATOR_TYPE ma2;
-        xtechnical::circular_buffer<T> buffer;
+        MonotonicQueue<T> max_queue;    /**< Максимум модуля TDF в окне буфера */
         T prev_ma1 = std::numeric_limits<T>::quiet_NaN();
         T prev_ma2 = std::numeric_limits<T>::quiet_NaN();
         T output = std::numeric_limits<T>::quiet_NaN();
@@ -3932,7 +4506,7 @@ namespace xtechnical {
          */
         TrendDirectionForceIndex(const size_t user_period) :
                 ma1(user_period), ma2(user_period),
-                buffer(3 * user_period) {
+                max_queue(3 * user_period) {
         }
 
         /** \brief Инициализировать индикатор индекса относительной силы
@@ -3944,7 +4518,7 @@ namespace xtechnical {
             const size_t user_period_buffer) :
                 ma1(user_period_ma),
                 ma2(user_period_ma),
-                buffer(user_period_buffer) {
+                max_queue(user_period_buffer) {
         }
 
         /** \brief Инициализировать индикатор индекса относительной силы
@@ -3953,7 +4527,7 @@ namespace xtechnical {
         void init(const size_t user_period) noexcept {
             ma1 = INDICATOR_TYPE(user_period);
             ma2 = INDICATOR_TYPE(user_period);
-            buffer = xtechnical::circular_buffer<T>(3 * user_period);
+            max_queue = MonotonicQueue<T>(3 * user_period);
         }
 
         /** \brief Инициализировать индикатор индекса относительной силы
@@ -3965,7 +4539,7 @@ namespace xtechnical {
                 const size_t user_period_buffer) noexcept {
             ma1 = INDICATOR_TYPE(user_period_ma);
             ma2 = INDICATOR_TYPE(user_period_ma);
-            buffer = xtechnical::circular_buffer<T>(user_period_buffer);
+            max_queue = MonotonicQueue<T>(user_period_buffer);
         }
 
         inline void set_point(const T user_point) noexcept {
@@ -4007,13 +4581,11 @@ namespace xtechnical {
             prev_ma1 = v1;
             prev_ma2 = v2;
 
-            buffer.update(std::abs(tdf));
-            if(buffer.full()) {
-                T h = 0;
-                std::vector<T> data = buffer.to_vector();
-                for (size_t i = 0; i < data.size(); ++i) {
-                    if (h < data[i]) h = data[i];
-                }
+            /* NaN не сравнивается и не должен вытеснять максимум из очереди */
+            if(std::isnan(tdf)) max_queue.skip();
+            else max_queue.update(std::abs(tdf));
+            if(max_queue.full()) {
+                const T h = max_queue.get();
                 output = (h > 0.0) ? (tdf / h) : 0.0;
                 return common::OK;
             };
@@ -4068,13 +4640,9 @@ namespace xtechnical {
             prev_ma1 = v1;
             prev_ma2 = v2;
 
-            buffer.test(std::abs(tdf));
-            if(buffer.full()) {
-                T h = 0;
-                std::vector<T> data = buffer.to_vector();
-                for (size_t i = 0; i < data.size(); ++i) {
-                    if (h < data[i]) h = data[i];
-                }
+            /* окно заполнится с учетом тестового значения */
+            if((max_queue.size() + 1) >= max_queue.max_size()) {
+                const T h = std::isnan(tdf) ? max_queue.test_skip() : max_queue.test(std::abs(tdf));
                 output = (h > 0.0) ? (tdf / h) : 0.0;
                 return common::OK;
             };
@@ -4102,7 +4670,7 @@ namespace xtechnical {
         inline void clear() noexcept {
             ma1.clear();
             ma2.clear();
-            buffer.clear();
+            max_queue.clear();
             prev_ma1 = std::numeric_limits<T>::quiet_NaN();
             prev_ma2 = std::numeric_limits<T>::quiet_NaN();
             output = std::numeric_limits<T>::quiet_NaN();
@@ -4535,6 +5103,229 @@ namespace xtechnical {
     };
 
 
+    /** \brief Иерархический формирователь баров для нескольких таймфреймов
+     *
+     * Бары младшего таймфрейма формируются из тиков так же, как в BarShaperV1,
+     * бары старших таймфреймов собираются из закрытых баров предыдущего
+     * таймфрейма. Метка времени делится только на период младшего таймфрейма,
+     * номера баров старших таймфреймов вычисляются лишь при смене бара младшего.
+     * Результат совпадает с набором независимых BarShaperV1 с теми же настройками.
+     *
+     * Бары передаются в приемник SINK без std::function. Приемник должен иметь методы:
+     * on_close_bar(const size_t tf, const Bar &bar) и
+     * on_unformed_bar(const size_t tf, const Bar &bar),
+     * где tf - индекс таймфрейма.
+     * \tparam T    Тип цены
+     * \tparam N    Количество таймфреймов
+     */
+    template<class T, size_t N>
+    class MultiBarShaper {
+    public:
+
+        typedef typename BarShaperV1<T>::Bar Bar;
+
+    private:
+
+        /** \brief Состояние таймфрейма
+         */
+        class State {
+        public:
+            Bar bar;                /**< Бар, собранный из закрытых баров младшего таймфрейма */
+            uint64_t period = 0;    /**< Период */
+            uint64_t ratio = 1;     /**< Отношение периода к периоду младшего таймфрейма */
+            uint64_t last_bar = 0;
+            bool is_once = false;
+        };
+
+        std::array<State, N> states;
+        T last_close = 0;           /**< Цена закрытия последнего тика, общая для всех таймфреймов */
+        bool is_init = false;
+        bool is_open_equal_prev_close = false;
+        bool is_use_bar_stop_time = false;
+        bool is_fill = false;
+        bool is_unformed = false;
+
+        inline uint64_t get_timestamp(const State &s, const uint64_t b) const noexcept {
+            return is_use_bar_stop_time ? (b * s.period + s.period) : (b * s.period);
+        }
+
+        /** \brief Добавить бар младшего таймфрейма к бару старшего
+         */
+        inline static void merge(Bar &dst, const Bar &src) noexcept {
+            dst.high = std::max(dst.high, src.high);
+            dst.low = std::min(dst.low, src.low);
+            dst.close = src.close;
+        }
+
+        /** \brief Начать новый бар таймфрейма
+         */
+        inline void start_bar(State &s, const T input) noexcept {
+            if (is_open_equal_prev_close) {
+                if (last_close != 0) {
+                    s.bar.open = last_close;
+                    s.is_once = true;
+                }
+            } else {
+                s.bar.open = input;
+                s.is_once = true;
+            }
+            s.bar.high = input;
+            s.bar.low = input;
+            s.bar.close = input;
+        }
+
+        /** \brief Передать несформированные бары таймфреймов, начиная с from
+         * \param from     Индекс первого таймфрейма
+         * \param current  Несформированный бар таймфрейма from - 1
+         * \param sink     Приемник баров
+         */
+        template<class SINK>
+        inline void send_unformed(const size_t from, Bar current, SINK &sink) {
+            for (size_t k = from; k < N; ++k) {
+                State &s = states[k];
+                if (!s.is_once) break;
+                Bar temp = s.bar;
+                merge(temp, current);
+                temp.timestamp = get_timestamp(s, s.last_bar);
+                sink.on_unformed_bar(k, temp);
+                current = temp;
+            }
+        }
+
+    public:
+
+        MultiBarShaper() {};
+
+        /** \brief Инициализировать формирователь баров
+         * \param p     Периоды таймфреймов по возрастанию, каждый период кратен предыдущему
+         * \param oepc  Флаг, включает эквивалетность цены открытия цене закрытия предыдущего бара
+         * \param ubst  Флаг, включает использование последней метки времени бара вместо начала бара, как времени бара
+         * \param uf    Флаг, включает заполнение пропущенных баров
+         * \param uub   Флаг, включает вызов on_unformed_bar на каждом тике
+         */
+        MultiBarShaper(
+                const std::array<uint64_t, N> &p,
+                const bool oepc = false,
+                const bool ubst = false,
+                const bool uf = false,
+                const bool uub = false) :
+                is_open_equal_prev_close(oepc),
+                is_use_bar_stop_time(ubst),
+                is_fill(uf),
+                is_unformed(uub) {
+            if (N == 0 || p[0] == 0) return;
+            for (size_t k = 1; k < N; ++k) {
+                if (p[k] < p[k - 1] || (p[k] % p[k - 1]) != 0) return;
+            }
+            for (size_t k = 0; k < N; ++k) {
+                states[k].period = p[k];
+                states[k].ratio = p[k] / p[0];
+            }
+            is_init = true;
+        };
+
+        /** \brief Обновить состояние формирователя баров
+         * \param input     Текущая цена
+         * \param timestamp Метка времени
+         * \param sink      Приемник баров
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        template<class SINK>
+        int update(const T input, const uint64_t timestamp, SINK &sink) {
+            if (!is_init) return common::NO_INIT;
+            State &s0 = states[0];
+            const uint64_t current_bar = timestamp / s0.period;
+            if (s0.last_bar == 0) {
+                for (size_t k = 0; k < N; ++k) {
+                    states[k].last_bar = current_bar / states[k].ratio;
+                }
+                return common::OK;
+            }
+            if (current_bar > s0.last_bar) {
+                /* закрываем бары, начиная с младшего таймфрейма,
+                 * закрытый бар добавляется к бару следующего таймфрейма
+                 */
+                size_t top = 0; /**< Старший таймфрейм, у которого сменился бар */
+                for (size_t k = 0; k < N; ++k) {
+                    State &s = states[k];
+                    const uint64_t bar_index = k == 0 ? current_bar : current_bar / s.ratio;
+                    if (bar_index <= s.last_bar) break;
+                    top = k;
+                    if (s.is_once) {
+                        s.bar.timestamp = get_timestamp(s, s.last_bar);
+                        sink.on_close_bar(k, s.bar);
+                        if ((k + 1) < N && states[k + 1].is_once) merge(states[k + 1].bar, s.bar);
+                        if (is_fill) {
+                            Bar fill_bar;
+                            fill_bar.open = fill_bar.low = fill_bar.high = fill_bar.close = s.bar.close;
+                            for (uint64_t b = (s.last_bar + 1); b < bar_index; ++b) {
+                                fill_bar.timestamp = get_timestamp(s, b);
+                                sink.on_close_bar(k, fill_bar);
+                            }
+                        }
+                    }
+                    s.last_bar = bar_index;
+                }
+                for (size_t k = 0; k <= top; ++k) {
+                    start_bar(states[k], input);
+                }
+                last_close = input;
+                if (!is_unformed) return common::OK;
+                /* несформированные бары таймфреймов, у которых бар не сменился */
+                send_unformed(top + 1, states[top].bar, sink);
+            } else
+            if (current_bar == s0.last_bar) {
+                last_close = input;
+                if (!s0.is_once) {
+                    s0.bar.close = input;
+                    return common::OK;
+                }
+                s0.bar.high = std::max(input, s0.bar.high);
+                s0.bar.low = std::min(input, s0.bar.low);
+                s0.bar.close = input;
+                if (!is_unformed) return common::OK;
+                s0.bar.timestamp = get_timestamp(s0, s0.last_bar);
+                sink.on_unformed_bar(0, s0.bar);
+                send_unformed(1, s0.bar, sink);
+            }
+            return common::OK;
+        }
+
+        /** \brief Обновить состояние формирователя баров массивом тиков
+         * \param input     Массив цен
+         * \param timestamp Массив меток времени
+         * \param size      Размер массивов
+         * \param sink      Приемник баров
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        template<class SINK>
+        int update(const T *input, const uint64_t *timestamp, const size_t size, SINK &sink) {
+            if (!is_init) return common::NO_INIT;
+            for (size_t i = 0; i < size; ++i) {
+                update(input[i], timestamp[i], sink);
+            }
+            return common::OK;
+        }
+
+        /** \brief Получить период таймфрейма
+         * \param tf Индекс таймфрейма
+         */
+        inline uint64_t get_period(const size_t tf) const noexcept {
+            return states[tf].period;
+        }
+
+        /** \brief Очистить данные формирователя баров
+         */
+        void clear() noexcept {
+            for (size_t k = 0; k < N; ++k) {
+                states[k].bar = Bar();
+                states[k].last_bar = 0;
+                states[k].is_once = false;
+            }
+            last_close = 0;
+        }
+    };
+
     /** \brief График ренко
      */
     template<class T>
@@ -4583,14 +5374,14 @@ namespace xtechnical {
                     is_once = true;
                     return;
                 }
-                if (last_level > level) {
+                if (level > last_level) {
                     bar.timestamp = timestamp;
                     for (int64_t l = last_level + 1; l <= level; ++l) {
                         bar.close = (double)l * digits_to_value[digits] * (double)step;
                         on_close_bar(bar);
                     }
                 } else
-                if (last_level < level) {
+                if (level < last_level) {
                     bar.timestamp = timestamp;
                     for (int64_t l = last_level - 1; l >= level; --l) {
                         bar.close = (double)l * digits_to_value[digits] * (double)step;
@@ -4614,13 +5405,13 @@ namespace xtechnical {
                     is_once = true;
                     return;
                 }
-                if (last_level > level) {
+                if (level > last_level) {
                     for (int64_t l = last_level + 1; l <= level; ++l) {
                         bar.close = (double)l * digits_to_value[digits] * (double)step;
                         on_close_bar(bar);
                     }
                 } else
-                if (last_level < level) {
+                if (level < last_level) {
                     for (int64_t l = last_level - 1; l >= level; --l) {
                         bar.close = (double)l * digits_to_value[digits] * (double)step;
                         on_close_bar(bar);
@@ -4631,6 +5422,307 @@ namespace xtechnical {
         }
     };
 
+    /** \brief Пакетное построение графика ренко для нескольких размеров кирпича
+     *
+     * Цены переводятся в целое число пунктов один раз на тик,
+     * дальше используется только целочисленная арифметика.
+     * Для каждого размера кирпича хранятся границы текущего уровня,
+     * поэтому деление выполняется только при смене уровня.
+     * Кирпичи записываются в буферы, выделенные вызывающей стороной.
+     * Правила построения совпадают с RenkoChart.
+     */
+    template<class T>
+    class RenkoBatch {
+    public:
+
+        typedef typename RenkoChart<T>::Bar Bar;
+
+    private:
+
+        /** \brief Состояние для одного размера кирпича
+         */
+        class State {
+        public:
+            int64_t step = 0;
+            int64_t last_level = 0;
+            int64_t lo = 0;         /**< Нижняя граница уровня last_level в пунктах */
+            int64_t hi = 0;         /**< Верхняя граница уровня last_level в пунктах (не включительно) */
+            bool is_once = false;
+        };
+
+        std::vector<State> states;
+        double scale = 0;           /**< Количество пунктов в единице цены */
+        double point = 0;           /**< Цена одного пункта */
+
+        /** \brief Уровень, как в RenkoChart (целая часть от деления)
+         */
+        inline void set_level(State &s, const int64_t level) noexcept {
+            s.last_level = level;
+            s.lo = level * s.step - (level <= 0 ? (s.step - 1) : 0);
+            s.hi = level * s.step + (level >= 0 ? s.step : 1);
+        }
+
+    public:
+
+        RenkoBatch() {};
+
+        /** \brief Инициализировать построение графиков ренко
+         * \param d     Количество разрядов (1-8)
+         * \param steps Размеры кирпича в пунктах
+         */
+        RenkoBatch(const uint64_t d, const std::vector<uint64_t> &steps) {
+            static const double digits_to_value[9] = {0.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001, 0.00000001};
+            if (d == 0 || d > 8) return;
+            for (size_t i = 0; i < steps.size(); ++i) {
+                if (steps[i] == 0) return;
+            }
+            point = digits_to_value[d];
+            scale = std::pow(10.0, (double)d);
+            states.resize(steps.size());
+            for (size_t i = 0; i < steps.size(); ++i) {
+                states[i].step = (int64_t)steps[i];
+            }
+        }
+
+        /** \brief Количество размеров кирпича
+         */
+        inline size_t size() const noexcept {
+            return states.size();
+        }
+
+        /** \brief Построить кирпичи по массиву тиков
+         *
+         * Если кирпичи тика не помещаются в один из буферов,
+         * обработка останавливается перед этим тиком. Тогда нужно
+         * освободить буферы и вызвать метод для оставшихся тиков.
+         * Емкость буфера должна быть не меньше максимального количества баров одного тика.
+         * \param input         Массив цен
+         * \param timestamp     Массив меток времени
+         * \param length        Количество тиков
+         * \param output        Массив буферов, по одному на размер кирпича
+         * \param output_size   Количество записанных кирпичей для каждого буфера
+         * \param capacity      Емкость каждого буфера
+         * \return Количество обработанных тиков
+         */
+        size_t update(
+                const T *input,
+                const uint64_t *timestamp,
+                const size_t length,
+                Bar *const *output,
+                size_t *output_size,
+                const size_t capacity) {
+            const size_t n = states.size();
+            for (size_t j = 0; j < n; ++j) {
+                output_size[j] = 0;
+            }
+            if (n == 0) return 0;
+            for (size_t i = 0; i < length; ++i) {
+                const int64_t price = std::llround((double)input[i] * scale);
+                /* все кирпичи тика должны поместиться в буферы */
+                for (size_t j = 0; j < n; ++j) {
+                    const State &s = states[j];
+                    if (!s.is_once || s.last_level == 0 || (price >= s.lo && price < s.hi)) continue;
+                    const int64_t level = price / s.step;
+                    const uint64_t bricks = (uint64_t)std::abs(level - s.last_level);
+                    if (bricks > (capacity - output_size[j])) return i;
+                }
+                for (size_t j = 0; j < n; ++j) {
+                    State &s = states[j];
+                    if (price >= s.lo && price < s.hi) continue;
+                    const int64_t level = price / s.step;
+                    if (s.last_level == 0 || !s.is_once) {
+                        if (s.last_level != 0 && level != s.last_level) s.is_once = true;
+                        set_level(s, level);
+                        continue;
+                    }
+                    Bar *out = output[j] + output_size[j];
+                    if (level > s.last_level) {
+                        for (int64_t l = s.last_level + 1; l <= level; ++l, ++out) {
+                            out->close = (double)l * point * (double)s.step;
+                            out->timestamp = timestamp[i];
+                        }
+                    } else {
+                        for (int64_t l = s.last_level - 1; l >= level; --l, ++out) {
+                            out->close = (double)l * point * (double)s.step;
+                            out->timestamp = timestamp[i];
+                        }
+                    }
+                    output_size[j] = out - output[j];
+                    set_level(s, level);
+                }
+            }
+            return length;
+        }
+
+        /** \brief Очистить состояние
+         */
+        void clear() noexcept {
+            for (size_t j = 0; j < states.size(); ++j) {
+                const int64_t step = states[j].step;
+                states[j] = State();
+                states[j].step = step;
+            }
+        }
+    };
+
+    /** \brief Пакетное построение графика range-баров для нескольких диапазонов
+     *
+     * Бар закрывается, когда его диапазон превышает заданное количество пунктов.
+     * Закрытый бар ограничивается ровно диапазоном, следующий бар
+     * открывается ценой закрытия предыдущего, при разрыве цены
+     * формируется несколько баров.
+     * Используется только целочисленная арифметика в пунктах,
+     * бары записываются в буферы, выделенные вызывающей стороной.
+     */
+    template<class T>
+    class RangeBarBatch {
+    public:
+
+        typedef typename BarShaperV1<T>::Bar Bar;
+
+    private:
+
+        /** \brief Состояние для одного диапазона
+         */
+        class State {
+        public:
+            int64_t range = 0;
+            int64_t open = 0, high = 0, low = 0, close = 0;
+            bool is_once = false;
+        };
+
+        std::vector<State> states;
+        double scale = 0;           /**< Количество пунктов в единице цены */
+        double point = 0;           /**< Цена одного пункта */
+
+        inline void write_bar(Bar *out, const int64_t o, const int64_t h, const int64_t l, const int64_t c, const uint64_t t) const noexcept {
+            out->open = (double)o * point;
+            out->high = (double)h * point;
+            out->low = (double)l * point;
+            out->close = (double)c * point;
+            out->timestamp = t;
+        }
+
+    public:
+
+        RangeBarBatch() {};
+
+        /** \brief Инициализировать построение range-баров
+         * \param d         Количество разрядов (1-8)
+         * \param ranges    Диапазоны баров в пунктах
+         */
+        RangeBarBatch(const uint64_t d, const std::vector<uint64_t> &ranges) {
+            static const double digits_to_value[9] = {0.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001, 0.00000001};
+            if (d == 0 || d > 8) return;
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                if (ranges[i] == 0) return;
+            }
+            point = digits_to_value[d];
+            scale = std::pow(10.0, (double)d);
+            states.resize(ranges.size());
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                states[i].range = (int64_t)ranges[i];
+            }
+        }
+
+        /** \brief Количество диапазонов
+         */
+        inline size_t size() const noexcept {
+            return states.size();
+        }
+
+        /** \brief Построить бары по массиву тиков
+         *
+         * Если бары тика не помещаются в один из буферов,
+         * обработка останавливается перед этим тиком. Тогда нужно
+         * освободить буферы и вызвать метод для оставшихся тиков.
+         * Емкость буфера должна быть не меньше максимального количества баров одного тика.
+         * \param input         Массив цен
+         * \param timestamp     Массив меток времени
+         * \param length        Количество тиков
+         * \param output        Массив буферов, по одному на диапазон
+         * \param output_size   Количество записанных баров для каждого буфера
+         * \param capacity      Емкость каждого буфера
+         * \return Количество обработанных тиков
+         */
+        size_t update(
+                const T *input,
+                const uint64_t *timestamp,
+                const size_t length,
+                Bar *const *output,
+                size_t *output_size,
+                const size_t capacity) {
+            const size_t n = states.size();
+            for (size_t j = 0; j < n; ++j) {
+                output_size[j] = 0;
+            }
+            if (n == 0) return 0;
+            for (size_t i = 0; i < length; ++i) {
+                const int64_t price = std::llround((double)input[i] * scale);
+                /* все бары тика должны поместиться в буферы */
+                for (size_t j = 0; j < n; ++j) {
+                    const State &s = states[j];
+                    if (!s.is_once) continue;
+                    int64_t bars = 0;
+                    if (price > (s.low + s.range)) {
+                        bars = 1 + (price - s.low - s.range - 1) / s.range;
+                    } else
+                    if (price < (s.high - s.range)) {
+                        bars = 1 + (s.high - s.range - price - 1) / s.range;
+                    }
+                    if ((uint64_t)bars > (capacity - output_size[j])) return i;
+                }
+                for (size_t j = 0; j < n; ++j) {
+                    State &s = states[j];
+                    if (!s.is_once) {
+                        s.open = s.high = s.low = s.close = price;
+                        s.is_once = true;
+                        continue;
+                    }
+                    if (price > (s.low + s.range)) {
+                        Bar *out = output[j] + output_size[j];
+                        int64_t c = s.low + s.range;
+                        write_bar(out++, s.open, c, s.low, c, timestamp[i]);
+                        while (price > (c + s.range)) {
+                            write_bar(out++, c, c + s.range, c, c + s.range, timestamp[i]);
+                            c += s.range;
+                        }
+                        output_size[j] = out - output[j];
+                        s.open = s.low = c;
+                        s.high = s.close = price;
+                    } else
+                    if (price < (s.high - s.range)) {
+                        Bar *out = output[j] + output_size[j];
+                        int64_t c = s.high - s.range;
+                        write_bar(out++, s.open, s.high, c, c, timestamp[i]);
+                        while (price < (c - s.range)) {
+                            write_bar(out++, c, c, c - s.range, c - s.range, timestamp[i]);
+                            c -= s.range;
+                        }
+                        output_size[j] = out - output[j];
+                        s.open = s.high = c;
+                        s.low = s.close = price;
+                    } else {
+                        s.high = std::max(s.high, price);
+                        s.low = std::min(s.low, price);
+                        s.close = price;
+                    }
+                }
+            }
+            return length;
+        }
+
+        /** \brief Очистить состояние
+         */
+        void clear() noexcept {
+            for (size_t j = 0; j < states.size(); ++j) {
+                const int64_t range = states[j].range;
+                states[j] = State();
+                states[j].range = range;
+            }
+        }
+    };
+
     /** \brief Мера склонности к чередовнию знаков (z-счет)
      *
      * Z - число СКО, на которое количество серий в выборке отклоняется
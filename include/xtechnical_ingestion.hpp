@@ -0,0 +1,410 @@
+#ifndef XTECHNICAL_INGESTION_HPP_INCLUDED
+#define XTECHNICAL_INGESTION_HPP_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include "xtechnical_memory_resource.hpp"
+
+#ifndef XTECHNICAL_CACHE_LINE_SIZE
+#define XTECHNICAL_CACHE_LINE_SIZE 64
+#endif
+
+namespace xtechnical {
+
+    /** \brief Запись рыночных данных
+     */
+    struct MarketRecord {
+        uint32_t symbol_id;     /**< Номер инструмента */
+        uint64_t timestamp;     /**< Метка времени */
+        double bid;
+        double ask;
+        double volume;
+    };
+
+    /** \brief Статистика очереди
+     *
+     * Значения читаются без блокировки и могут немного отставать
+     */
+    struct QueueStats {
+        uint64_t pushed = 0;    /**< Принято записей */
+        uint64_t dropped = 0;   /**< Отброшено записей, очередь была заполнена */
+        uint64_t popped = 0;    /**< Извлечено записей */
+        size_t size = 0;        /**< Записей в очереди */
+        size_t max_size = 0;    /**< Наибольшее число записей, которое видел потребитель */
+        size_t capacity = 0;    /**< Емкость очереди */
+    };
+
+    namespace ingestion_detail {
+
+        inline size_t round_capacity(const size_t c) noexcept {
+            size_t size = 2;
+            while (size < c) size <<= 1;
+            return size;
+        }
+
+        /** \brief Обновить наибольшее значение (пишет только потребитель)
+         */
+        inline void update_max(std::atomic<size_t> &value, const size_t x) noexcept {
+            if (x > value.load(std::memory_order_relaxed)) {
+                value.store(x, std::memory_order_relaxed);
+            }
+        }
+    }; // ingestion_detail
+
+    /** \brief Ограниченная очередь без блокировок: один производитель, один потребитель
+     *
+     * Производитель (поток приема данных) никогда не ждет: если очередь заполнена,
+     * push отбрасывает запись и увеличивает счетчик отброшенных записей.
+     * Позиции производителя и потребителя лежат в разных кэш-линиях.
+     * Емкость округляется вверх до степени двойки.
+     */
+    template<class T>
+    class SpscQueue {
+    private:
+        pmr::vector<T> buffer;
+        size_t mask = 0;
+        char pad0[XTECHNICAL_CACHE_LINE_SIZE];
+        /* данные производителя */
+        std::atomic<uint64_t> tail = ATOMIC_VAR_INIT(0);
+        uint64_t cached_head = 0;
+        std::atomic<uint64_t> dropped = ATOMIC_VAR_INIT(0);
+        char pad1[XTECHNICAL_CACHE_LINE_SIZE];
+        /* данные потребителя */
+        std::atomic<uint64_t> head = ATOMIC_VAR_INIT(0);
+        std::atomic<size_t> max_size = ATOMIC_VAR_INIT(0);
+        char pad2[XTECHNICAL_CACHE_LINE_SIZE];
+
+    public:
+        typedef T value_type;
+
+        /** \brief Конструктор очереди
+         * \param c        Емкость очереди
+         * \param resource Источник памяти буфера очереди
+         */
+        SpscQueue(const size_t c, pmr::memory_resource *resource = pmr::get_default_resource()) :
+            buffer(ingestion_detail::round_capacity(c), resource),
+            mask(ingestion_detail::round_capacity(c) - 1) {
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue &operator=(const SpscQueue&) = delete;
+
+        /** \brief Добавить запись
+         *
+         * Вызывается только из потока производителя
+         * \param value Запись
+         * \return Вернет false, если очередь заполнена и запись отброшена
+         */
+        inline bool push(const T &value) noexcept {
+            const uint64_t t = tail.load(std::memory_order_relaxed);
+            if (t - cached_head > mask) {
+                cached_head = head.load(std::memory_order_acquire);
+                if (t - cached_head > mask) {
+                    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            buffer[t & mask] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** \brief Извлечь несколько записей
+         *
+         * Вызывается только из потока потребителя
+         * \param out   Массив для записей
+         * \param max   Наибольшее число записей
+         * \return Число извлеченных записей
+         */
+        inline size_t pop_batch(T *out, const size_t max) noexcept {
+            const uint64_t h = head.load(std::memory_order_relaxed);
+            const size_t available = (size_t)(tail.load(std::memory_order_acquire) - h);
+            if (available == 0) return 0;
+            ingestion_detail::update_max(max_size, available);
+            const size_t n = std::min(available, max);
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = buffer[(h + i) & mask];
+            }
+            head.store(h + n, std::memory_order_release);
+            return n;
+        }
+
+        /** \brief Число записей в очереди
+         */
+        inline size_t size() const noexcept {
+            const uint64_t h = head.load(std::memory_order_acquire);
+            return (size_t)(tail.load(std::memory_order_acquire) - h);
+        }
+
+        /** \brief Емкость очереди
+         */
+        inline size_t capacity() const noexcept {
+            return mask + 1;
+        }
+
+        /** \brief Получить статистику очереди
+         */
+        QueueStats get_stats() const noexcept {
+            QueueStats stats;
+            stats.popped = head.load(std::memory_order_acquire);
+            stats.pushed = tail.load(std::memory_order_acquire);
+            stats.dropped = dropped.load(std::memory_order_relaxed);
+            stats.size = (size_t)(stats.pushed - stats.popped);
+            stats.max_size = max_size.load(std::memory_order_relaxed);
+            stats.capacity = capacity();
+            return stats;
+        }
+    };
+
+    /** \brief Ограниченная очередь без блокировок: несколько производителей, один потребитель
+     *
+     * Каждая ячейка хранит номер последовательности, производители занимают
+     * ячейки через compare_exchange на общей позиции и никогда не ждут:
+     * если очередь заполнена, push отбрасывает запись.
+     * Емкость округляется вверх до степени двойки.
+     */
+    template<class T>
+    class MpscQueue {
+    private:
+        struct Cell {
+            std::atomic<uint64_t> sequence;
+            T data;
+        };
+
+        pmr::vector<Cell> cells;
+        size_t mask = 0;
+        char pad0[XTECHNICAL_CACHE_LINE_SIZE];
+        /* данные производителей */
+        std::atomic<uint64_t> tail = ATOMIC_VAR_INIT(0);
+        char pad1[XTECHNICAL_CACHE_LINE_SIZE];
+        std::atomic<uint64_t> dropped = ATOMIC_VAR_INIT(0);
+        char pad2[XTECHNICAL_CACHE_LINE_SIZE];
+        /* данные потребителя */
+        std::atomic<uint64_t> head = ATOMIC_VAR_INIT(0);
+        std::atomic<size_t> max_size = ATOMIC_VAR_INIT(0);
+        char pad3[XTECHNICAL_CACHE_LINE_SIZE];
+
+    public:
+        typedef T value_type;
+
+        /** \brief Конструктор очереди
+         * \param c        Емкость очереди
+         * \param resource Источник памяти ячеек очереди
+         */
+        MpscQueue(const size_t c, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                cells(ingestion_detail::round_capacity(c), resource),
+                mask(ingestion_detail::round_capacity(c) - 1) {
+            for (size_t i = 0; i < cells.size(); ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue &operator=(const MpscQueue&) = delete;
+
+        /** \brief Добавить запись
+         *
+         * Может вызываться из нескольких потоков
+         * \param value Запись
+         * \return Вернет false, если очередь заполнена и запись отброшена
+         */
+        inline bool push(const T &value) noexcept {
+            uint64_t pos = tail.load(std::memory_order_relaxed);
+            Cell *cell = nullptr;
+            for (;;) {
+                cell = &cells[pos & mask];
+                const uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+                const int64_t diff = (int64_t)(seq - pos);
+                if (diff == 0) {
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else
+                if (diff < 0) {
+                    /* ячейку еще не освободил потребитель: очередь заполнена */
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    pos = tail.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = value;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /** \brief Извлечь несколько записей
+         *
+         * Вызывается только из потока потребителя.
+         * Записи извлекаются до первой ячейки, которую производитель еще не заполнил
+         * \param out   Массив для записей
+         * \param max   Наибольшее число записей
+         * \return Число извлеченных записей
+         */
+        inline size_t pop_batch(T *out, const size_t max) noexcept {
+            const uint64_t start = head.load(std::memory_order_relaxed);
+            /* пока head не сдвинут, производители не могут занять больше capacity ячеек */
+            const uint64_t t = tail.load(std::memory_order_relaxed);
+            uint64_t h = start;
+            size_t n = 0;
+            while (n < max) {
+                Cell &cell = cells[h & mask];
+                if (cell.sequence.load(std::memory_order_acquire) != h + 1) break;
+                out[n++] = cell.data;
+                cell.sequence.store(h + mask + 1, std::memory_order_release);
+                ++h;
+            }
+            if (n == 0) return 0;
+            ingestion_detail::update_max(max_size, (size_t)(std::max(t, h) - start));
+            head.store(h, std::memory_order_release);
+            return n;
+        }
+
+        /** \brief Число записей в очереди (включая записываемые)
+         */
+        inline size_t size() const noexcept {
+            const uint64_t h = head.load(std::memory_order_acquire);
+            return (size_t)(tail.load(std::memory_order_acquire) - h);
+        }
+
+        /** \brief Емкость очереди
+         */
+        inline size_t capacity() const noexcept {
+            return mask + 1;
+        }
+
+        /** \brief Получить статистику очереди
+         */
+        QueueStats get_stats() const noexcept {
+            QueueStats stats;
+            stats.popped = head.load(std::memory_order_acquire);
+            stats.pushed = tail.load(std::memory_order_acquire);
+            stats.dropped = dropped.load(std::memory_order_relaxed);
+            stats.size = (size_t)(stats.pushed - stats.popped);
+            stats.max_size = max_size.load(std::memory_order_relaxed);
+            stats.capacity = capacity();
+            return stats;
+        }
+    };
+
+    /** \brief Потребитель очереди, который раздает записи обработчикам инструментов
+     *
+     * Обработчик инструмента (например, конвейер индикаторов Pipeline)
+     * вызывается в потоке потребителя для каждой записи с его symbol_id.
+     * Записи одного инструмента приходят в порядке добавления в очередь.
+     * Обработчики задаются до запуска потока.
+     * \tparam QUEUE SpscQueue или MpscQueue с записями, у которых есть поле symbol_id
+     */
+    template<class QUEUE>
+    class IngestionWorker {
+    public:
+        typedef typename QUEUE::value_type value_type;
+        typedef std::function<void(const value_type &)> Handler;
+
+    private:
+        QUEUE &queue;
+        std::vector<Handler> handlers;
+        std::vector<value_type> batch;
+        std::thread thread;
+        std::atomic<bool> is_stop = ATOMIC_VAR_INIT(false);
+        std::atomic<uint64_t> processed = ATOMIC_VAR_INIT(0);
+        std::atomic<uint64_t> unknown = ATOMIC_VAR_INIT(0);
+        std::atomic<uint64_t> batches = ATOMIC_VAR_INIT(0);
+
+    public:
+
+        /** \brief Конструктор потребителя
+         * \param q             Очередь
+         * \param batch_size    Наибольшее число записей за одно извлечение
+         */
+        IngestionWorker(QUEUE &q, const size_t batch_size = 64) :
+            queue(q), batch(std::max((size_t)1, batch_size)) {
+        }
+
+        IngestionWorker(const IngestionWorker&) = delete;
+        IngestionWorker &operator=(const IngestionWorker&) = delete;
+
+        ~IngestionWorker() {
+            stop();
+        }
+
+        /** \brief Задать обработчик инструмента
+         * \param symbol_id Номер инструмента
+         * \param handler   Обработчик записи
+         */
+        void set_handler(const uint32_t symbol_id, const Handler &handler) {
+            if (symbol_id >= handlers.size()) handlers.resize(symbol_id + 1);
+            handlers[symbol_id] = handler;
+        }
+
+        /** \brief Извлечь и обработать одну пачку записей
+         *
+         * Можно вызывать из своего цикла вместо start
+         * \return Число обработанных записей
+         */
+        size_t poll() {
+            const size_t n = queue.pop_batch(batch.data(), batch.size());
+            if (n == 0) return 0;
+            uint64_t skipped = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const value_type &record = batch[i];
+                if (record.symbol_id < handlers.size() && handlers[record.symbol_id]) {
+                    handlers[record.symbol_id](record);
+                } else {
+                    ++skipped;
+                }
+            }
+            processed.store(processed.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            batches.store(batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (skipped) unknown.store(unknown.load(std::memory_order_relaxed) + skipped, std::memory_order_relaxed);
+            return n;
+        }
+
+        /** \brief Запустить поток потребителя
+         */
+        void start() {
+            if (thread.joinable()) return;
+            is_stop = false;
+            thread = std::thread([this] {
+                while (!is_stop.load(std::memory_order_acquire)) {
+                    if (poll() == 0) std::this_thread::yield();
+                }
+                /* обрабатываем записи, добавленные до остановки */
+                while (poll() != 0) {}
+            });
+        }
+
+        /** \brief Остановить поток потребителя
+         *
+         * Записи, которые уже лежат в очереди, будут обработаны
+         */
+        void stop() {
+            if (!thread.joinable()) return;
+            is_stop.store(true, std::memory_order_release);
+            thread.join();
+        }
+
+        /** \brief Число обработанных записей
+         */
+        inline uint64_t get_processed() const noexcept {
+            return processed.load(std::memory_order_relaxed);
+        }
+
+        /** \brief Число записей без обработчика
+         */
+        inline uint64_t get_unknown() const noexcept {
+            return unknown.load(std::memory_order_relaxed);
+        }
+
+        /** \brief Число извлеченных пачек
+         */
+        inline uint64_t get_batches() const noexcept {
+            return batches.load(std::memory_order_relaxed);
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_INGESTION_HPP_INCLUDED
@@ -0,0 +1,524 @@
+#ifndef XTECHNICAL_INSTRUMENTATION_HPP_INCLUDED
+#define XTECHNICAL_INSTRUMENTATION_HPP_INCLUDED
+
+/** \file xtechnical_instrumentation.hpp
+ * \brief Инструментирование горячих путей индикаторов
+ *
+ * Включается макросом XTECHNICAL_USE_INSTRUMENTATION, который нужно определить
+ * до подключения заголовков библиотеки (во всех единицах трансляции одинаково).
+ * Без него макросы XTECHNICAL_PROBE* раскрываются в пустоту, классы индикаторов
+ * не получают новых членов и код не меняется.
+ *
+ * С включенным инструментированием каждый экземпляр индикатора содержит
+ * зонд (Probe) со счетчиками вызовов update и test, гистограммами задержек
+ * в стиле HDR (логарифмические корзины по 8 подкорзин, точность около 12%)
+ * и счетчиками выделений памяти. Зонд пишет только поток, который вызывает
+ * методы индикатора, поэтому запись обходится без блокировок и атомарных
+ * read-modify-write операций. Снимок (snapshot) можно брать из любого потока.
+ *
+ * Выделения памяти считаются, если в одной единице трансляции программы
+ * раскрыт макрос XTECHNICAL_INSTRUMENTATION_DEFINE_ALLOCATION_HOOKS(),
+ * который заменяет глобальные operator new и operator delete.
+ *
+ * Время вложенных вызовов входит во время внешнего индикатора: например,
+ * время BollingerBands::update включает время SMA::update.
+ */
+
+#ifdef XTECHNICAL_USE_INSTRUMENTATION
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#if defined(XTECHNICAL_INSTRUMENTATION_USE_RDTSC)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace xtechnical {
+    namespace instrumentation {
+
+        /** \brief Текущее время для измерения задержек
+         *
+         * По умолчанию наносекунды std::chrono::steady_clock.
+         * С макросом XTECHNICAL_INSTRUMENTATION_USE_RDTSC - такты счетчика TSC.
+         */
+        inline uint64_t now() noexcept {
+#if defined(XTECHNICAL_INSTRUMENTATION_USE_RDTSC)
+            return (uint64_t)__rdtsc();
+#else
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        /** \brief Единица измерения задержек
+         */
+        inline const char *time_unit() noexcept {
+#if defined(XTECHNICAL_INSTRUMENTATION_USE_RDTSC)
+            return "cycles";
+#else
+            return "ns";
+#endif
+        }
+
+        /** \brief Счетчик выделений памяти текущего потока
+         */
+        inline uint64_t &thread_allocations() noexcept {
+            static thread_local uint64_t counter = 0;
+            return counter;
+        }
+
+        namespace detail {
+
+            /** \brief Увеличить счетчик, в который пишет только один поток
+             */
+            inline void add(std::atomic<uint64_t> &counter, const uint64_t value) noexcept {
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+
+            inline size_t log2(uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                return 63 - (size_t)__builtin_clzll(value);
+#else
+                size_t n = 0;
+                while (value >>= 1) ++n;
+                return n;
+#endif
+            }
+        };
+
+        /** \brief Гистограмма задержек в стиле HDR
+         *
+         * Значения меньше SUB_BUCKETS хранятся точно, остальные - в корзинах,
+         * каждая степень двойки делится на SUB_BUCKETS равных частей.
+         */
+        class Histogram {
+        public:
+            static const size_t SUB_BUCKET_BITS = 3;
+            static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+            static const size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+            /** \brief Индекс корзины для значения
+             */
+            static inline size_t index_of(const uint64_t value) noexcept {
+                if (value < SUB_BUCKETS) return (size_t)value;
+                const size_t e = detail::log2(value);
+                return (e - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+                    (size_t)((value >> (e - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+            }
+
+            /** \brief Наименьшее значение корзины
+             */
+            static inline uint64_t lowest_of(const size_t index) noexcept {
+                if (index < SUB_BUCKETS) return index;
+                const size_t e = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+                return (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << (e - SUB_BUCKET_BITS);
+            }
+
+            /** \brief Наибольшее значение корзины
+             */
+            static inline uint64_t highest_of(const size_t index) noexcept {
+                if (index < SUB_BUCKETS) return index;
+                const size_t e = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+                return lowest_of(index) + (((uint64_t)1 << (e - SUB_BUCKET_BITS)) - 1);
+            }
+
+            Histogram() noexcept {
+                clear();
+            }
+
+            inline void record(const uint64_t value) noexcept {
+                detail::add(counts[index_of(value)], 1);
+            }
+
+            inline uint64_t count(const size_t index) const noexcept {
+                return counts[index].load(std::memory_order_relaxed);
+            }
+
+            inline void clear() noexcept {
+                for (auto &c : counts) c.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::array<std::atomic<uint64_t>, BUCKETS> counts;
+        };
+
+        /** \brief Снимок статистики одного метода индикатора
+         */
+        struct ChannelSnapshot {
+            uint64_t calls = 0;         /**< Количество вызовов */
+            uint64_t timed_calls = 0;   /**< Количество вызовов с измерением времени */
+            uint64_t allocations = 0;   /**< Количество выделений памяти внутри вызовов */
+            uint64_t total = 0;         /**< Суммарное время */
+            uint64_t min = 0;           /**< Минимальное время */
+            uint64_t max = 0;           /**< Максимальное время */
+            double mean = 0;            /**< Среднее время */
+            uint64_t p50 = 0;
+            uint64_t p90 = 0;
+            uint64_t p99 = 0;
+            uint64_t p999 = 0;
+            std::vector<std::pair<uint64_t, uint64_t>> buckets; /**< Непустые корзины: наибольшее значение и количество */
+
+            /** \brief Значение задержки для процентиля
+             * \param percentile Процентиль, от 0 до 100
+             * \return Наибольшее значение корзины, в которую попал процентиль
+             */
+            uint64_t value_at(const double percentile) const noexcept {
+                if (timed_calls == 0) return 0;
+                uint64_t rank = (uint64_t)std::ceil(percentile / 100.0 * (double)timed_calls);
+                if (rank == 0) rank = 1;
+                uint64_t sum = 0;
+                for (auto &b : buckets) {
+                    sum += b.second;
+                    if (sum >= rank) return std::min(b.first, max);
+                }
+                return max;
+            }
+        };
+
+        /** \brief Счетчики одного метода индикатора
+         */
+        class Channel {
+        public:
+            Channel() noexcept {
+                clear();
+            }
+
+            /** \brief Учесть вызов без измерения времени
+             */
+            inline void count() noexcept {
+                detail::add(calls, 1);
+            }
+
+            /** \brief Учесть вызов с измеренным временем
+             * \param elapsed       Время вызова
+             * \param allocations   Количество выделений памяти внутри вызова
+             */
+            inline void record(const uint64_t elapsed, const uint64_t allocations) noexcept {
+                detail::add(calls, 1);
+                detail::add(timed_calls, 1);
+                if (allocations) detail::add(allocation_count, allocations);
+                detail::add(total, elapsed);
+                if (elapsed < min.load(std::memory_order_relaxed)) min.store(elapsed, std::memory_order_relaxed);
+                if (elapsed > max.load(std::memory_order_relaxed)) max.store(elapsed, std::memory_order_relaxed);
+                histogram.record(elapsed);
+            }
+
+            ChannelSnapshot snapshot() const {
+                ChannelSnapshot s;
+                s.calls = calls.load(std::memory_order_relaxed);
+                s.timed_calls = timed_calls.load(std::memory_order_relaxed);
+                s.allocations = allocation_count.load(std::memory_order_relaxed);
+                s.total = total.load(std::memory_order_relaxed);
+                s.max = max.load(std::memory_order_relaxed);
+                s.min = s.timed_calls ? min.load(std::memory_order_relaxed) : 0;
+                s.mean = s.timed_calls ? (double)s.total / (double)s.timed_calls : 0.0;
+                uint64_t histogram_calls = 0;
+                for (size_t i = 0; i < Histogram::BUCKETS; ++i) {
+                    const uint64_t c = histogram.count(i);
+                    if (c == 0) continue;
+                    s.buckets.push_back(std::make_pair(Histogram::highest_of(i), c));
+                    histogram_calls += c;
+                }
+                /* запись могла идти во время чтения, процентили считаем по гистограмме */
+                s.timed_calls = histogram_calls;
+                s.p50 = s.value_at(50.0);
+                s.p90 = s.value_at(90.0);
+                s.p99 = s.value_at(99.0);
+                s.p999 = s.value_at(99.9);
+                return s;
+            }
+
+            inline void clear() noexcept {
+                calls.store(0, std::memory_order_relaxed);
+                timed_calls.store(0, std::memory_order_relaxed);
+                allocation_count.store(0, std::memory_order_relaxed);
+                total.store(0, std::memory_order_relaxed);
+                min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+                max.store(0, std::memory_order_relaxed);
+                histogram.clear();
+            }
+
+        private:
+            std::atomic<uint64_t> calls;
+            std::atomic<uint64_t> timed_calls;
+            std::atomic<uint64_t> allocation_count;
+            std::atomic<uint64_t> total;
+            std::atomic<uint64_t> min;
+            std::atomic<uint64_t> max;
+            Histogram histogram;
+        };
+
+        /** \brief Снимок статистики одного экземпляра индикатора
+         */
+        struct ProbeSnapshot {
+            uint64_t id = 0;            /**< Уникальный номер экземпляра */
+            std::string name;           /**< Имя класса */
+            std::string label;          /**< Метка, заданная пользователем */
+            ChannelSnapshot update;
+            ChannelSnapshot test;
+        };
+
+        class Probe;
+
+        namespace detail {
+
+            /** \brief Реестр всех зондов программы
+             *
+             * Создается один раз и не разрушается, чтобы зонды статических
+             * объектов могли сняться с учета в любом порядке.
+             */
+            class Registry {
+            public:
+                std::mutex mutex;
+                std::vector<Probe*> probes;
+                uint64_t next_id = 0;
+
+                static Registry &instance() {
+                    static Registry *registry = new Registry();
+                    return *registry;
+                }
+            };
+        };
+
+        /** \brief Зонд экземпляра индикатора
+         *
+         * Копия зонда - новый экземпляр с нулевыми счетчиками,
+         * присваивание не меняет ни счетчики, ни номер зонда.
+         */
+        class Probe {
+        public:
+
+            explicit Probe(const char *class_name) : name(class_name) {
+                attach();
+            }
+
+            Probe(const Probe &other) : name(other.name) {
+                attach();
+            }
+
+            Probe &operator=(const Probe &) noexcept {
+                return *this;
+            }
+
+            ~Probe() {
+                detail::Registry &registry = detail::Registry::instance();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                auto it = std::find(registry.probes.begin(), registry.probes.end(), this);
+                if (it == registry.probes.end()) return;
+                *it = registry.probes.back();
+                registry.probes.pop_back();
+            }
+
+            inline Channel &update_channel() noexcept {
+                return update_stats;
+            }
+
+            inline Channel &test_channel() noexcept {
+                return test_stats;
+            }
+
+            inline uint64_t get_id() const noexcept {
+                return id;
+            }
+
+            /** \brief Изменить имя класса
+             *
+             * Используется наследниками, например MMA на основе EMA
+             */
+            inline void set_name(const char *class_name) {
+                std::lock_guard<std::mutex> lock(detail::Registry::instance().mutex);
+                name = class_name;
+            }
+
+            /** \brief Задать метку экземпляра, например символ и таймфрейм
+             */
+            inline void set_label(const std::string &value) {
+                std::lock_guard<std::mutex> lock(detail::Registry::instance().mutex);
+                label = value;
+            }
+
+            /** \brief Снимок статистики
+             *
+             * Вызывается под блокировкой реестра
+             */
+            ProbeSnapshot snapshot() const {
+                ProbeSnapshot s;
+                s.id = id;
+                s.name = name;
+                s.label = label;
+                s.update = update_stats.snapshot();
+                s.test = test_stats.snapshot();
+                return s;
+            }
+
+            inline void clear() noexcept {
+                update_stats.clear();
+                test_stats.clear();
+            }
+
+        private:
+            const char *name;
+            std::string label;
+            uint64_t id = 0;
+            Channel update_stats;
+            Channel test_stats;
+
+            void attach() {
+                detail::Registry &registry = detail::Registry::instance();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                id = registry.next_id++;
+                registry.probes.push_back(this);
+            }
+        };
+
+        /** \brief Измерение времени и выделений памяти одного вызова
+         */
+        class ScopedCall {
+        public:
+            explicit ScopedCall(Channel &c) noexcept :
+                channel(c), allocations(thread_allocations()), start(now()) {
+            }
+
+            ~ScopedCall() {
+                const uint64_t stop = now();
+                channel.record(stop - start, thread_allocations() - allocations);
+            }
+
+            ScopedCall(const ScopedCall &) = delete;
+            ScopedCall &operator=(const ScopedCall &) = delete;
+
+        private:
+            Channel &channel;
+            const uint64_t allocations;
+            const uint64_t start;
+        };
+
+        /** \brief Снимок статистики всех зондов
+         * \return Зонды в порядке создания
+         */
+        inline std::vector<ProbeSnapshot> snapshot() {
+            std::vector<ProbeSnapshot> result;
+            detail::Registry &registry = detail::Registry::instance();
+            {
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                result.reserve(registry.probes.size());
+                for (auto p : registry.probes) result.push_back(p->snapshot());
+            }
+            std::sort(result.begin(), result.end(),
+                [](const ProbeSnapshot &a, const ProbeSnapshot &b) { return a.id < b.id; });
+            return result;
+        }
+
+        /** \brief Обнулить статистику всех зондов
+         *
+         * Если в этот момент индикаторы обновляются в других потоках,
+         * часть их вызовов может остаться в статистике
+         */
+        inline void reset() {
+            detail::Registry &registry = detail::Registry::instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (auto p : registry.probes) p->clear();
+        }
+
+        /** \brief Статистика в текстовом формате Prometheus
+         * \param skip_idle Пропустить зонды без вызовов
+         */
+        inline std::string to_prometheus(const bool skip_idle = true) {
+            const std::vector<ProbeSnapshot> probes = snapshot();
+            std::ostringstream out;
+            const std::string unit = time_unit();
+            out << "# TYPE xtechnical_calls_total counter\n";
+            out << "# TYPE xtechnical_allocations_total counter\n";
+            out << "# TYPE xtechnical_latency_" << unit << " summary\n";
+            auto write = [&](const ProbeSnapshot &p, const char *method, const ChannelSnapshot &c) {
+                if (skip_idle && c.calls == 0) return;
+                std::ostringstream labels;
+                labels << "indicator=\"" << p.name << "\",id=\"" << p.id << "\"";
+                if (!p.label.empty()) labels << ",label=\"" << p.label << "\"";
+                labels << ",method=\"" << method << "\"";
+                const std::string l = labels.str();
+                out << "xtechnical_calls_total{" << l << "} " << c.calls << "\n";
+                if (c.timed_calls == 0) return;
+                out << "xtechnical_allocations_total{" << l << "} " << c.allocations << "\n";
+                out << "xtechnical_latency_" << unit << "{" << l << ",quantile=\"0.5\"} " << c.p50 << "\n";
+                out << "xtechnical_latency_" << unit << "{" << l << ",quantile=\"0.9\"} " << c.p90 << "\n";
+                out << "xtechnical_latency_" << unit << "{" << l << ",quantile=\"0.99\"} " << c.p99 << "\n";
+                out << "xtechnical_latency_" << unit << "{" << l << ",quantile=\"0.999\"} " << c.p999 << "\n";
+                out << "xtechnical_latency_" << unit << "_sum{" << l << "} " << c.total << "\n";
+                out << "xtechnical_latency_" << unit << "_count{" << l << "} " << c.timed_calls << "\n";
+            };
+            for (auto &p : probes) {
+                write(p, "update", p.update);
+                write(p, "test", p.test);
+            }
+            return out.str();
+        }
+    }; // instrumentation
+}; // xtechnical
+
+/// Добавить зонд в класс индикатора. Ставится первой строкой тела класса
+#define XTECHNICAL_PROBE(NAME) \
+    public: \
+        inline xtechnical::instrumentation::Probe &get_probe() noexcept { return xtechnical_probe_; } \
+    private: \
+        xtechnical::instrumentation::Probe xtechnical_probe_{NAME};
+
+/// Изменить имя класса в зонде (для наследников)
+#define XTECHNICAL_PROBE_NAME(NAME) this->get_probe().set_name(NAME)
+/// Измерить время вызова update до конца области видимости
+#define XTECHNICAL_PROBE_UPDATE() \
+    const xtechnical::instrumentation::ScopedCall xtechnical_probe_call_(xtechnical_probe_.update_channel())
+/// Измерить время вызова test до конца области видимости
+#define XTECHNICAL_PROBE_TEST() \
+    const xtechnical::instrumentation::ScopedCall xtechnical_probe_call_(xtechnical_probe_.test_channel())
+/// Посчитать вызов update без измерения времени (для дешевых методов)
+#define XTECHNICAL_PROBE_COUNT_UPDATE() xtechnical_probe_.update_channel().count()
+/// Посчитать вызов test без измерения времени (для дешевых методов)
+#define XTECHNICAL_PROBE_COUNT_TEST() xtechnical_probe_.test_channel().count()
+
+/// Заменить глобальные operator new и delete для подсчета выделений памяти.
+/// Раскрыть в одной единице трансляции программы, вне пространств имен
+#define XTECHNICAL_INSTRUMENTATION_DEFINE_ALLOCATION_HOOKS() \
+    void *operator new(std::size_t size) { \
+        ++xtechnical::instrumentation::thread_allocations(); \
+        if (void *p = std::malloc(size ? size : 1)) return p; \
+        throw std::bad_alloc(); \
+    } \
+    void *operator new[](std::size_t size) { \
+        ++xtechnical::instrumentation::thread_allocations(); \
+        if (void *p = std::malloc(size ? size : 1)) return p; \
+        throw std::bad_alloc(); \
+    } \
+    void operator delete(void *p) noexcept { std::free(p); } \
+    void operator delete[](void *p) noexcept { std::free(p); } \
+    void operator delete(void *p, std::size_t) noexcept { std::free(p); } \
+    void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+#else // XTECHNICAL_USE_INSTRUMENTATION
+
+#define XTECHNICAL_PROBE(NAME)
+#define XTECHNICAL_PROBE_NAME(NAME) ((void)0)
+#define XTECHNICAL_PROBE_UPDATE() ((void)0)
+#define XTECHNICAL_PROBE_TEST() ((void)0)
+#define XTECHNICAL_PROBE_COUNT_UPDATE() ((void)0)
+#define XTECHNICAL_PROBE_COUNT_TEST() ((void)0)
+#define XTECHNICAL_INSTRUMENTATION_DEFINE_ALLOCATION_HOOKS()
+
+#endif // XTECHNICAL_USE_INSTRUMENTATION
+
+#endif // XTECHNICAL_INSTRUMENTATION_HPP_INCLUDED
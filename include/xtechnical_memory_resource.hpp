@@ -0,0 +1,502 @@
+#ifndef XTECHNICAL_MEMORY_RESOURCE_HPP_INCLUDED
+#define XTECHNICAL_MEMORY_RESOURCE_HPP_INCLUDED
+
+/** \file xtechnical_memory_resource.hpp
+ * \brief Источники памяти для внутренних контейнеров индикаторов
+ *
+ * Контейнеры индикаторов (circular_buffer, FastMinMax, MW, WMA, BollingerBands,
+ * pmr::ClusterShaper, PeriodStats и др.) используют xtechnical::pmr::polymorphic_allocator.
+ * Источник памяти передается последним аргументом конструктора индикатора
+ * и доходит до всех его контейнеров, в том числе до вложенных индикаторов.
+ * Поэтому весь набор индикаторов можно разместить в одной монотонной арене:
+ *
+ * \code
+ * xtechnical::pmr::monotonic_buffer_resource arena(1 << 20);
+ * xtechnical::SMA<double> sma(20, &arena);
+ * xtechnical::FastMinMax<double> min_max(30, 0, &arena);
+ * \endcode
+ *
+ * Арена должна жить дольше индикаторов. Память арены освобождается целиком
+ * в release() или в деструкторе. Без аргумента используется источник
+ * по умолчанию, то есть куча. Как и в std::pmr, копия индикатора берет память
+ * из источника по умолчанию, а не из источника оригинала.
+ *
+ * Монотонная арена не использует освобожденную память повторно. Индикаторы,
+ * контейнеры которых постоянно выделяют и освобождают узлы (FastMinMax,
+ * pmr::ClusterShaper, PeriodStats), нужно размещать в unsynchronized_pool_resource
+ * поверх арены, иначе арена будет расти с каждым обновлением.
+ *
+ * В C++17 при наличии <memory_resource> имена из xtechnical::pmr совпадают
+ * с std::pmr. Для C++11 и C++14 используется совместимая реализация с тем же
+ * интерфейсом. Источник передается явно, поэтому наборы индикаторов в разных
+ * аренах можно создавать из разных потоков одновременно.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <map>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <type_traits>
+
+#if !defined(XTECHNICAL_USE_STD_PMR) && __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#define XTECHNICAL_USE_STD_PMR
+#endif
+#endif
+
+#ifdef XTECHNICAL_USE_STD_PMR
+#include <memory_resource>
+#else
+#include <atomic>
+#include <cstdlib>
+#endif
+
+namespace xtechnical {
+    namespace pmr {
+
+#ifdef XTECHNICAL_USE_STD_PMR
+
+        using std::pmr::memory_resource;
+        using std::pmr::polymorphic_allocator;
+        using std::pmr::monotonic_buffer_resource;
+        using std::pmr::unsynchronized_pool_resource;
+        using std::pmr::new_delete_resource;
+        using std::pmr::get_default_resource;
+        using std::pmr::set_default_resource;
+
+#else
+
+        /** \brief Источник памяти
+         *
+         * Интерфейс повторяет std::pmr::memory_resource
+         */
+        class memory_resource {
+        public:
+            virtual ~memory_resource() {}
+
+            void *allocate(const size_t bytes, const size_t alignment = alignof(std::max_align_t)) {
+                return do_allocate(bytes, alignment);
+            }
+
+            void deallocate(void *p, const size_t bytes, const size_t alignment = alignof(std::max_align_t)) {
+                do_deallocate(p, bytes, alignment);
+            }
+
+            bool is_equal(const memory_resource &other) const noexcept {
+                return do_is_equal(other);
+            }
+
+        private:
+            virtual void *do_allocate(size_t bytes, size_t alignment) = 0;
+            virtual void do_deallocate(void *p, size_t bytes, size_t alignment) = 0;
+            virtual bool do_is_equal(const memory_resource &other) const noexcept = 0;
+        };
+
+        inline bool operator == (const memory_resource &a, const memory_resource &b) noexcept {
+            return &a == &b || a.is_equal(b);
+        }
+
+        inline bool operator != (const memory_resource &a, const memory_resource &b) noexcept {
+            return !(a == b);
+        }
+
+        namespace detail {
+
+            /** \brief Источник памяти на основе operator new и operator delete
+             */
+            class new_delete_resource_impl : public memory_resource {
+            private:
+                void *do_allocate(size_t bytes, size_t) override {
+                    return ::operator new(bytes);
+                }
+
+                void do_deallocate(void *p, size_t, size_t) override {
+                    ::operator delete(p);
+                }
+
+                bool do_is_equal(const memory_resource &other) const noexcept override {
+                    return this == &other;
+                }
+            };
+        };
+
+        /** \brief Источник памяти, который использует глобальные operator new и operator delete
+         */
+        inline memory_resource *new_delete_resource() noexcept {
+            static detail::new_delete_resource_impl resource;
+            return &resource;
+        }
+
+        namespace detail {
+            inline std::atomic<memory_resource*> &default_resource() noexcept {
+                static std::atomic<memory_resource*> resource(new_delete_resource());
+                return resource;
+            }
+        };
+
+        /** \brief Получить источник памяти по умолчанию
+         */
+        inline memory_resource *get_default_resource() noexcept {
+            return detail::default_resource().load(std::memory_order_acquire);
+        }
+
+        /** \brief Установить источник памяти по умолчанию
+         * \param r Новый источник или nullptr для new_delete_resource()
+         * \return Предыдущий источник
+         */
+        inline memory_resource *set_default_resource(memory_resource *r) noexcept {
+            if (!r) r = new_delete_resource();
+            return detail::default_resource().exchange(r, std::memory_order_acq_rel);
+        }
+
+        /** \brief Аллокатор, который берет память из memory_resource
+         *
+         * Интерфейс повторяет std::pmr::polymorphic_allocator: копия контейнера
+         * получает источник по умолчанию, а не источник оригинала
+         */
+        template<class T>
+        class polymorphic_allocator {
+        private:
+            memory_resource *res;
+
+            template<class U> friend class polymorphic_allocator;
+        public:
+            typedef T value_type;
+
+            polymorphic_allocator() noexcept : res(get_default_resource()) {}
+
+            polymorphic_allocator(memory_resource *r) noexcept : res(r ? r : get_default_resource()) {}
+
+            polymorphic_allocator(const polymorphic_allocator &other) noexcept = default;
+
+            template<class U>
+            polymorphic_allocator(const polymorphic_allocator<U> &other) noexcept : res(other.res) {}
+
+            polymorphic_allocator &operator = (const polymorphic_allocator &) = delete;
+
+            T *allocate(const size_t n) {
+                return static_cast<T*>(res->allocate(n * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T *p, const size_t n) {
+                res->deallocate(p, n * sizeof(T), alignof(T));
+            }
+
+            polymorphic_allocator select_on_container_copy_construction() const {
+                return polymorphic_allocator();
+            }
+
+            memory_resource *resource() const noexcept {
+                return res;
+            }
+        };
+
+        template<class T, class U>
+        inline bool operator == (const polymorphic_allocator<T> &a, const polymorphic_allocator<U> &b) noexcept {
+            return *a.resource() == *b.resource();
+        }
+
+        template<class T, class U>
+        inline bool operator != (const polymorphic_allocator<T> &a, const polymorphic_allocator<U> &b) noexcept {
+            return !(a == b);
+        }
+
+        /** \brief Монотонная арена
+         *
+         * Выделяет память последовательно из блоков, которые растут в 2 раза.
+         * deallocate ничего не делает, вся память освобождается в release()
+         * или в деструкторе. Интерфейс повторяет std::pmr::monotonic_buffer_resource
+         */
+        class monotonic_buffer_resource : public memory_resource {
+        private:
+            struct Block {
+                Block *next;
+                size_t size;
+            };
+
+            memory_resource *upstream;
+            void *initial_buffer = nullptr;
+            size_t initial_size = 0;
+            Block *blocks = nullptr;    /**< Блоки, выделенные у upstream */
+            char *current = nullptr;    /**< Свободная память текущего блока */
+            size_t space = 0;           /**< Размер свободной памяти текущего блока */
+            size_t next_size = 1024;    /**< Размер следующего блока */
+            size_t first_size = 1024;   /**< Размер первого блока после release() */
+
+            void reset_current() noexcept {
+                current = static_cast<char*>(initial_buffer);
+                space = initial_buffer ? initial_size : 0;
+            }
+
+            void *do_allocate(size_t bytes, size_t alignment) override {
+                if (bytes == 0) bytes = 1;
+                size_t adjust = (alignment - reinterpret_cast<uintptr_t>(current) % alignment) % alignment;
+                if (!current || adjust + bytes > space) {
+                    size_t size = next_size;
+                    while (size < bytes + alignment + sizeof(Block)) size *= 2;
+                    Block *block = static_cast<Block*>(upstream->allocate(size, alignof(std::max_align_t)));
+                    block->next = blocks;
+                    block->size = size;
+                    blocks = block;
+                    current = reinterpret_cast<char*>(block) + sizeof(Block);
+                    space = size - sizeof(Block);
+                    next_size = size * 2;
+                    adjust = (alignment - reinterpret_cast<uintptr_t>(current) % alignment) % alignment;
+                }
+                char *p = current + adjust;
+                current = p + bytes;
+                space -= adjust + bytes;
+                return p;
+            }
+
+            void do_deallocate(void *, size_t, size_t) override {}
+
+            bool do_is_equal(const memory_resource &other) const noexcept override {
+                return this == &other;
+            }
+
+        public:
+
+            monotonic_buffer_resource() : upstream(get_default_resource()) {}
+
+            explicit monotonic_buffer_resource(memory_resource *u) : upstream(u) {}
+
+            /** \brief Конструктор арены
+             * \param initial   Размер первого блока
+             * \param u         Источник памяти для блоков
+             */
+            explicit monotonic_buffer_resource(const size_t initial, memory_resource *u = get_default_resource()) :
+                upstream(u), next_size(initial ? initial : 1), first_size(next_size) {}
+
+            /** \brief Конструктор арены с внешним буфером
+             *
+             * Буфер используется первым, затем блоки берутся у u
+             * \param buffer    Начальный буфер
+             * \param size      Размер начального буфера
+             * \param u         Источник памяти для блоков
+             */
+            monotonic_buffer_resource(void *buffer, const size_t size, memory_resource *u = get_default_resource()) :
+                    upstream(u), initial_buffer(buffer), initial_size(size),
+                    next_size(size ? size * 2 : 1024), first_size(next_size) {
+                reset_current();
+            }
+
+            monotonic_buffer_resource(const monotonic_buffer_resource &) = delete;
+            monotonic_buffer_resource &operator = (const monotonic_buffer_resource &) = delete;
+
+            ~monotonic_buffer_resource() {
+                release();
+            }
+
+            /** \brief Освободить всю память арены
+             */
+            void release() noexcept {
+                while (blocks) {
+                    Block *next = blocks->next;
+                    upstream->deallocate(blocks, blocks->size, alignof(std::max_align_t));
+                    blocks = next;
+                }
+                next_size = first_size;
+                reset_current();
+            }
+
+            memory_resource *upstream_resource() const noexcept {
+                return upstream;
+            }
+        };
+
+        /** \brief Пул блоков памяти для одного потока
+         *
+         * Блоки до 4096 байт делятся на классы размеров (степени двойки),
+         * освобожденные блоки попадают в список свободных блоков своего класса
+         * и выдаются повторно. Память для блоков берется у upstream порциями,
+         * которые растут в 2 раза, поэтому поверх монотонной арены пул
+         * не растет при постоянном выделении и освобождении (например, узлов
+         * std::deque и std::map). Большие блоки выделяются у upstream напрямую.
+         * Интерфейс повторяет std::pmr::unsynchronized_pool_resource
+         */
+        class unsynchronized_pool_resource : public memory_resource {
+        private:
+            static const size_t MIN_BLOCK_SHIFT = 3;
+            static const size_t MAX_BLOCK_SHIFT = 12;
+            static const size_t POOLS = MAX_BLOCK_SHIFT - MIN_BLOCK_SHIFT + 1;
+            static const size_t MAX_CHUNK_BLOCKS = 1024;
+
+            struct FreeBlock {
+                FreeBlock *next;
+            };
+
+            struct Chunk {
+                Chunk *next;
+                size_t size;
+            };
+
+            /** \brief Заголовок большого блока
+             */
+            struct alignas(std::max_align_t) LargeBlock {
+                LargeBlock *prev;
+                LargeBlock *next;
+                size_t size;
+                size_t alignment;
+            };
+
+            struct Pool {
+                FreeBlock *free = nullptr;
+                size_t next_blocks = 16;    /**< Количество блоков в следующей порции */
+            };
+
+            memory_resource *upstream;
+            Pool pools[POOLS];
+            Chunk *chunks = nullptr;
+            LargeBlock *large = nullptr;
+
+            static inline size_t pool_index(const size_t bytes, const size_t alignment) noexcept {
+                const size_t size = bytes > alignment ? bytes : alignment;
+                size_t shift = MIN_BLOCK_SHIFT;
+                while (((size_t)1 << shift) < size) ++shift;
+                return shift - MIN_BLOCK_SHIFT;
+            }
+
+            static inline size_t large_header(const size_t alignment) noexcept {
+                return sizeof(LargeBlock) > alignment ? sizeof(LargeBlock) :
+                    ((sizeof(LargeBlock) + alignment - 1) / alignment) * alignment;
+            }
+
+            void refill(const size_t index) {
+                Pool &pool = pools[index];
+                const size_t block_size = (size_t)1 << (index + MIN_BLOCK_SHIFT);
+                const size_t header = ((sizeof(Chunk) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t)) * alignof(std::max_align_t);
+                const size_t size = header + block_size * pool.next_blocks;
+                Chunk *chunk = static_cast<Chunk*>(upstream->allocate(size, alignof(std::max_align_t)));
+                chunk->next = chunks;
+                chunk->size = size;
+                chunks = chunk;
+                char *p = reinterpret_cast<char*>(chunk) + header;
+                for (size_t i = 0; i < pool.next_blocks; ++i) {
+                    FreeBlock *block = reinterpret_cast<FreeBlock*>(p + i * block_size);
+                    block->next = pool.free;
+                    pool.free = block;
+                }
+                if (pool.next_blocks < MAX_CHUNK_BLOCKS) pool.next_blocks *= 2;
+            }
+
+            void *do_allocate(size_t bytes, size_t alignment) override {
+                if (bytes == 0) bytes = 1;
+                const size_t index = pool_index(bytes, alignment);
+                if (index < POOLS && alignment <= alignof(std::max_align_t)) {
+                    Pool &pool = pools[index];
+                    if (!pool.free) refill(index);
+                    FreeBlock *block = pool.free;
+                    pool.free = block->next;
+                    return block;
+                }
+                const size_t header = large_header(alignment);
+                char *p = static_cast<char*>(upstream->allocate(header + bytes, alignment > alignof(LargeBlock) ? alignment : alignof(LargeBlock)));
+                LargeBlock *block = reinterpret_cast<LargeBlock*>(p + header - sizeof(LargeBlock));
+                block->prev = nullptr;
+                block->next = large;
+                block->size = header + bytes;
+                block->alignment = alignment;
+                if (large) large->prev = block;
+                large = block;
+                return p + header;
+            }
+
+            void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+                if (!p) return;
+                if (bytes == 0) bytes = 1;
+                const size_t index = pool_index(bytes, alignment);
+                if (index < POOLS && alignment <= alignof(std::max_align_t)) {
+                    FreeBlock *block = static_cast<FreeBlock*>(p);
+                    block->next = pools[index].free;
+                    pools[index].free = block;
+                    return;
+                }
+                const size_t header = large_header(alignment);
+                LargeBlock *block = reinterpret_cast<LargeBlock*>(static_cast<char*>(p) - sizeof(LargeBlock));
+                if (block->prev) block->prev->next = block->next;
+                else large = block->next;
+                if (block->next) block->next->prev = block->prev;
+                upstream->deallocate(static_cast<char*>(p) - header, block->size,
+                    alignment > alignof(LargeBlock) ? alignment : alignof(LargeBlock));
+            }
+
+            bool do_is_equal(const memory_resource &other) const noexcept override {
+                return this == &other;
+            }
+
+        public:
+
+            unsynchronized_pool_resource() : upstream(get_default_resource()) {}
+
+            explicit unsynchronized_pool_resource(memory_resource *u) : upstream(u) {}
+
+            unsynchronized_pool_resource(const unsynchronized_pool_resource &) = delete;
+            unsynchronized_pool_resource &operator = (const unsynchronized_pool_resource &) = delete;
+
+            ~unsynchronized_pool_resource() {
+                release();
+            }
+
+            /** \brief Вернуть всю память пула источнику upstream
+             */
+            void release() {
+                while (large) {
+                    LargeBlock *next = large->next;
+                    const size_t header = large_header(large->alignment);
+                    const size_t alignment = large->alignment > alignof(LargeBlock) ? large->alignment : alignof(LargeBlock);
+                    upstream->deallocate(reinterpret_cast<char*>(large) + sizeof(LargeBlock) - header, large->size, alignment);
+                    large = next;
+                }
+                while (chunks) {
+                    Chunk *next = chunks->next;
+                    upstream->deallocate(chunks, chunks->size, alignof(std::max_align_t));
+                    chunks = next;
+                }
+                for (auto &pool : pools) pool = Pool();
+            }
+
+            memory_resource *upstream_resource() const noexcept {
+                return upstream;
+            }
+        };
+
+#endif
+
+        /** \brief Создать вложенный индикатор с источником памяти
+         *
+         * Источник передается последним аргументом, если конструктор типа T
+         * его принимает (например, SMA, EMA, WMA), иначе объект создается
+         * без него. Нужно для параметров шаблона вроде MA_TYPE
+         * \param resource Источник памяти
+         * \param args     Аргументы конструктора
+         */
+        template<class T, class... ARGS>
+        inline typename std::enable_if<std::is_constructible<T, ARGS..., memory_resource*>::value, T>::type
+        make_with_resource(memory_resource *resource, const ARGS &... args) {
+            return T(args..., resource);
+        }
+
+        template<class T, class... ARGS>
+        inline typename std::enable_if<!std::is_constructible<T, ARGS..., memory_resource*>::value, T>::type
+        make_with_resource(memory_resource *, const ARGS &... args) {
+            return T(args...);
+        }
+
+        template<class T>
+        using vector = std::vector<T, polymorphic_allocator<T>>;
+
+        template<class T>
+        using deque = std::deque<T, polymorphic_allocator<T>>;
+
+        template<class K, class V, class COMPARE = std::less<K>>
+        using map = std::map<K, V, COMPARE, polymorphic_allocator<std::pair<const K, V>>>;
+
+    }; // pmr
+}; // xtechnical
+
+#endif // XTECHNICAL_MEMORY_RESOURCE_HPP_INCLUDED
@@ -0,0 +1,269 @@
+#ifndef XTECHNICAL_MONOTONIC_QUEUE_HPP_INCLUDED
+#define XTECHNICAL_MONOTONIC_QUEUE_HPP_INCLUDED
+
+#include <vector>
+#include <functional>
+#include <limits>
+#include <cstdint>
+#include "xtechnical_memory_resource.hpp"
+
+namespace xtechnical {
+
+    /** \brief Монотонная очередь для максимума (минимума) в скользящем окне
+     *
+     * Хранит индексы и значения кандидатов, упорядоченные по убыванию
+     * (для COMPARE = std::greater) от начала к концу очереди.
+     * Метод update работает за амортизированное O(1), get и test - за O(1).
+     * Очередь хранится в кольцевом буфере размером степень двойки,
+     * поэтому после инициализации память не выделяется.
+     * \tparam COMPARE  std::greater<T> - максимум, std::less<T> - минимум
+     */
+    template<class T, class COMPARE = std::greater<T>>
+    class MonotonicQueue {
+    private:
+        pmr::vector<uint64_t> indexes;
+        pmr::vector<T> values;
+        uint64_t period = 0;
+        uint64_t count = 0;     /**< Количество принятых значений */
+        size_t head = 0;        /**< Начало очереди */
+        size_t length = 0;      /**< Длина очереди */
+        size_t mask = 0;
+        COMPARE compare;
+
+        inline size_t at(const size_t i) const noexcept {
+            return (head + i) & mask;
+        }
+
+    public:
+
+        MonotonicQueue() {};
+
+        /** \brief Конструктор монотонной очереди
+         * \param p        Период окна
+         * \param resource Источник памяти очереди
+         */
+        MonotonicQueue(const size_t p, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                indexes(resource), values(resource), period(p) {
+            size_t capacity = 1;
+            while (capacity < p) capacity <<= 1;
+            indexes.resize(capacity);
+            values.resize(capacity);
+            mask = capacity - 1;
+        }
+
+        /** \brief Добавить значение
+         * \param value Новое значение
+         */
+        inline void update(const T value) noexcept {
+            if (period == 0) return;
+            /* удаляем значения, которые уже не могут стать экстремумом */
+            while (length > 0 && !compare(values[at(length - 1)], value)) --length;
+            /* удаляем значение, вышедшее из окна */
+            if (length > 0 && indexes[head] + period <= count) {
+                head = (head + 1) & mask;
+                --length;
+            }
+            const size_t pos = at(length);
+            indexes[pos] = count;
+            values[pos] = value;
+            ++length;
+            ++count;
+        }
+
+        /** \brief Пропустить значение
+         *
+         * Окно сдвигается на одно значение, но оно не становится кандидатом.
+         * Используется для значений, которые не сравниваются (NaN)
+         */
+        inline void skip() noexcept {
+            if (period == 0) return;
+            if (length > 0 && indexes[head] + period <= count) {
+                head = (head + 1) & mask;
+                --length;
+            }
+            ++count;
+        }
+
+        /** \brief Получить экстремум окна
+         * \return Экстремум последних period значений или NaN, если значений нет
+         */
+        inline T get() const noexcept {
+            if (length == 0) return std::numeric_limits<T>::quiet_NaN();
+            return values[head];
+        }
+
+        /** \brief Получить экстремум окна с учетом нового значения
+         *
+         * Этот метод не меняет состояние очереди и не копирует ее
+         * \param value Новое значение
+         * \return Экстремум окна, которое было бы после update(value)
+         */
+        inline T test(const T value) const noexcept {
+            if (period == 0) return std::numeric_limits<T>::quiet_NaN();
+            /* первый кандидат выходит из окна, тогда экстремум - второй кандидат */
+            size_t i = 0;
+            if (length > 0 && indexes[head] + period <= count) i = 1;
+            if (i >= length) return value;
+            const T &candidate = values[at(i)];
+            return compare(candidate, value) ? candidate : value;
+        }
+
+        /** \brief Получить экстремум окна после skip()
+         *
+         * Этот метод не меняет состояние очереди
+         * \return Экстремум окна, которое было бы после skip(), или NaN
+         */
+        inline T test_skip() const noexcept {
+            if (period == 0) return std::numeric_limits<T>::quiet_NaN();
+            size_t i = 0;
+            if (length > 0 && indexes[head] + period <= count) i = 1;
+            if (i >= length) return std::numeric_limits<T>::quiet_NaN();
+            return values[at(i)];
+        }
+
+        /** \brief Количество значений в окне
+         */
+        inline size_t size() const noexcept {
+            return (size_t)(count < period ? count : period);
+        }
+
+        /** \brief Период окна
+         */
+        inline size_t max_size() const noexcept {
+            return (size_t)period;
+        }
+
+        /** \brief Проверить, если окно заполнено
+         */
+        inline bool full() const noexcept {
+            return period > 0 && count >= period;
+        }
+
+        /** \brief Очистить данные очереди
+         */
+        inline void clear() noexcept {
+            count = 0;
+            head = 0;
+            length = 0;
+        }
+    };
+
+    /** \brief Минимум и максимум скользящего окна со смещением назад
+     *
+     * Окно - period значений, которые предшествуют последним offset значениям.
+     * Результат совпадает побитово с перебором окна от старого значения к новому,
+     * где экстремум заменяется только строго большим (меньшим) значением:
+     * из равных значений (например, 0.0 и -0.0) выбирается самое старое,
+     * значения NaN пропускаются, но если самое старое значение окна NaN,
+     * то минимум и максимум равны ему.
+     * Метод update работает за амортизированное O(1), test - за O(1) без копирования.
+     */
+    template<class T>
+    class MonotonicMinMax {
+    private:
+        pmr::vector<T> history;     /**< Последние period + offset значений */
+        MonotonicQueue<T, std::greater_equal<T>> max_queue;
+        MonotonicQueue<T, std::less_equal<T>> min_queue;
+        uint64_t count = 0;         /**< Количество принятых значений */
+        size_t period = 0;
+        size_t offset = 0;
+        size_t mask = 0;
+
+        static inline bool is_nan(const T &value) noexcept {
+            return value != value;
+        }
+
+    public:
+
+        MonotonicMinMax() {};
+
+        /** \brief Конструктор окна
+         * \param p        Период
+         * \param o        Смещение назад
+         * \param resource Источник памяти окна
+         */
+        MonotonicMinMax(const size_t p, const size_t o = 0, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                history(resource), max_queue(p, resource), min_queue(p, resource), period(p), offset(o) {
+            size_t capacity = 1;
+            while (capacity < p + o) capacity <<= 1;
+            history.resize(capacity);
+            mask = capacity - 1;
+        }
+
+        /** \brief Добавить значение
+         * \param value     Новое значение
+         * \param min_value Минимум окна
+         * \param max_value Максимум окна
+         * \return Вернет true, если окно заполнено и min_value, max_value заданы
+         */
+        inline bool update(const T value, T &min_value, T &max_value) noexcept {
+            if (period == 0) return false;
+            history[count & mask] = value;
+            ++count;
+            if (count > offset) {
+                const T &enter = history[(count - 1 - offset) & mask];
+                if (is_nan(enter)) {
+                    max_queue.skip();
+                    min_queue.skip();
+                } else {
+                    max_queue.update(enter);
+                    min_queue.update(enter);
+                }
+            }
+            if (count < period + offset) return false;
+            const T &oldest = history[(count - period - offset) & mask];
+            if (is_nan(oldest)) {
+                min_value = max_value = oldest;
+            } else {
+                max_value = max_queue.get();
+                min_value = min_queue.get();
+            }
+            return true;
+        }
+
+        /** \brief Получить минимум и максимум окна с учетом нового значения
+         *
+         * Этот метод не меняет состояние окна
+         * \param value     Новое значение
+         * \param min_value Минимум окна
+         * \param max_value Максимум окна
+         * \return Вернет true, если окно было бы заполнено
+         */
+        inline bool test(const T value, T &min_value, T &max_value) const noexcept {
+            if (period == 0) return false;
+            if (count + 1 < period + offset) return false;
+            const uint64_t first = count + 1 - period - offset;
+            const T &oldest = first == count ? value : history[first & mask];
+            if (is_nan(oldest)) {
+                min_value = max_value = oldest;
+                return true;
+            }
+            const T &enter = offset == 0 ? value : history[(count - offset) & mask];
+            if (is_nan(enter)) {
+                max_value = max_queue.test_skip();
+                min_value = min_queue.test_skip();
+            } else {
+                max_value = max_queue.test(enter);
+                min_value = min_queue.test(enter);
+            }
+            return true;
+        }
+
+        /** \brief Проверить, если окно заполнено
+         */
+        inline bool full() const noexcept {
+            return period > 0 && count >= period + offset;
+        }
+
+        /** \brief Очистить данные окна
+         */
+        inline void clear() noexcept {
+            count = 0;
+            max_queue.clear();
+            min_queue.clear();
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_MONOTONIC_QUEUE_HPP_INCLUDED
@@ -41,18 +41,20 @@ namespace xtechnical {
     template <typename T>
     class MW {
     private:
-        std::vector<T> data_;
-        std::vector<T> data_test_;
+        pmr::vector<T> data_;
+        pmr::vector<T> data_test_;
         size_t period_ = 0;
         bool is_test_ = false;
     public:
         MW() {};
 
         /** \brief Инициализировать скользящее окно
-         * \param period период
+         * \param period   период
+         * \param resource источник памяти окна
          */
-        MW(const size_t period) : period_(period) {
-            data_.reserve(period_);
+        MW(const size_t period, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                data_(resource), data_test_(resource), period_(period) {
+            data_.reserve(period_ + 1);
         }
 
         /** \brief Проверить инициализацию буфера скользящего окна
@@ -74,13 +76,13 @@ namespace xtechnical {
             if(data_.size() < period_) {
                 data_.push_back(in);
                 if(data_.size() == period_) {
-                    out = data_;
+                    out.assign(data_.begin(), data_.end());
                     return common::OK;
                 }
             } else {
                 data_.push_back(in);
                 data_.erase(data_.begin());
-                out = data_;
+                out.assign(data_.begin(), data_.end());
                 return common::OK;
             }
             return common::INDICATOR_NOT_READY_TO_WORK;
@@ -121,13 +123,13 @@ namespace xtechnical {
             if(data_test_.size() < period_) {
                 data_test_.push_back(in);
                 if(data_test_.size() == period_) {
-                    out = data_test_;
+                    out.assign(data_test_.begin(), data_test_.end());
                     return common::OK;
                 }
             } else {
                 data_test_.push_back(in);
                 data_test_.erase(data_test_.begin());
-                out = data_test_;
+                out.assign(data_test_.begin(), data_test_.end());
                 return common::OK;
             }
             return common::INDICATOR_NOT_READY_TO_WORK;
@@ -161,8 +163,8 @@ namespace xtechnical {
          * \param buffer буфер
          */
         void get_data(std::vector<T> &buffer) {
-            if(is_test_) buffer = data_test_;
-            else buffer = data_;
+            if(is_test_) buffer.assign(data_test_.begin(), data_test_.end());
+            else buffer.assign(data_.begin(), data_.end());
         }
 
         /** \brief Получить максимальное значение буфера
@@ -0,0 +1,426 @@
+#ifndef XTECHNICAL_PIPELINE_HPP_INCLUDED
+#define XTECHNICAL_PIPELINE_HPP_INCLUDED
+
+#include "xtechnical_common.hpp"
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+#include <map>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+#include <functional>
+#include <limits>
+#include <cmath>
+
+namespace xtechnical {
+
+    namespace pipeline_detail {
+
+        /** \brief Записать параметр индикатора в ключ узла
+         */
+        template<class A>
+        inline typename std::enable_if<std::is_enum<A>::value>::type
+        append_param(std::ostringstream &s, const A &a) {
+            s << static_cast<long long>(a);
+        }
+
+        template<class A>
+        inline typename std::enable_if<!std::is_enum<A>::value>::type
+        append_param(std::ostringstream &s, const A &a) {
+            s << a;
+        }
+
+        inline void append_params(std::ostringstream &) {}
+
+        template<class A, class... ARGS>
+        inline void append_params(std::ostringstream &s, const A &a, const ARGS &... args) {
+            s << ',';
+            append_param(s, a);
+            append_params(s, args...);
+        }
+
+        /** \brief Вызов update/test индикатора с нужным числом входов
+         *
+         * Перегрузка с int выбирается, если у индикатора есть метод
+         * с таким числом аргументов, иначе выбирается перегрузка с long.
+         */
+        template<class IND, class T>
+        inline auto call(IND &ind, const T *v, const size_t n, const bool is_test, int)
+                -> decltype(ind.update(v[0]), ind.test(v[0]), int()) {
+            if (n != 1) return common::INVALID_PARAMETER;
+            return is_test ? ind.test(v[0]) : ind.update(v[0]);
+        }
+
+        template<class IND, class T>
+        inline int call(IND &, const T *, const size_t, const bool, long) {
+            return common::INVALID_PARAMETER;
+        }
+
+        template<class IND, class T>
+        inline auto call3(IND &ind, const T *v, const size_t n, const bool is_test, int)
+                -> decltype(ind.update(v[0], v[1], v[2]), ind.test(v[0], v[1], v[2]), int()) {
+            if (n != 3) return call(ind, v, n, is_test, 0);
+            return is_test ? ind.test(v[0], v[1], v[2]) : ind.update(v[0], v[1], v[2]);
+        }
+
+        template<class IND, class T>
+        inline int call3(IND &ind, const T *v, const size_t n, const bool is_test, long) {
+            return call(ind, v, n, is_test, 0);
+        }
+
+        /** \brief Проверить, есть ли у индикатора update и test с n входами
+         */
+        template<class IND, class T>
+        auto has_inputs1(int) -> decltype(
+            std::declval<IND&>().update(std::declval<T>()),
+            std::declval<IND&>().test(std::declval<T>()),
+            std::true_type());
+
+        template<class IND, class T>
+        std::false_type has_inputs1(long);
+
+        template<class IND, class T>
+        auto has_inputs3(int) -> decltype(
+            std::declval<IND&>().update(std::declval<T>(), std::declval<T>(), std::declval<T>()),
+            std::declval<IND&>().test(std::declval<T>(), std::declval<T>(), std::declval<T>()),
+            std::true_type());
+
+        template<class IND, class T>
+        std::false_type has_inputs3(long);
+
+        /** \brief Получить выход индикатора, если у него есть метод get
+         */
+        template<class IND, class T>
+        inline auto get(IND &ind, int) -> decltype(T(ind.get())) {
+            return ind.get();
+        }
+
+        template<class IND, class T>
+        inline T get(IND &, long) {
+            return std::numeric_limits<T>::quiet_NaN();
+        }
+
+        template<class IND, class T>
+        inline bool is_supported(const size_t n) {
+            if (n == 1) return decltype(has_inputs1<IND, T>(0))::value;
+            if (n == 3) return decltype(has_inputs3<IND, T>(0))::value;
+            return false;
+        }
+    }; // pipeline_detail
+
+    /** \brief Конвейер индикаторов с общими промежуточными результатами
+     *
+     * Узлы конвейера - входы (цены) и индикаторы. Индикатор добавляется
+     * с указанием узлов-входов и параметров конструктора. Узлы с одинаковым
+     * типом, параметрами и входами не дублируются: повторное добавление
+     * вернет номер уже существующего узла. Поэтому несколько составных
+     * индикаторов, построенных на одном конвейере, считают общий SMA(20)
+     * или ATR(14) один раз за бар.
+     *
+     * Узел может ссылаться только на уже добавленные узлы, поэтому порядок
+     * добавления является топологическим и узлы вычисляются по порядку.
+     * Выходы всех узлов хранятся в одном непрерывном массиве.
+     * Если хотя бы один вход узла равен NaN, узел не обновляется,
+     * а его выход на этом баре равен NaN.
+     */
+    template<class T>
+    class Pipeline {
+    public:
+        static const size_t NO_NODE = std::numeric_limits<size_t>::max();
+
+    private:
+
+        /** \brief Базовый класс узла
+         */
+        class NodeBase {
+        public:
+            virtual ~NodeBase() {};
+            virtual int update(const T *in, const size_t n, const bool is_test, T &out) = 0;
+            virtual void clear() = 0;
+        };
+
+        /** \brief Узел с индикатором
+         */
+        template<class IND>
+        class IndicatorNode : public NodeBase {
+        public:
+            IND indicator;
+
+            template<class... ARGS>
+            IndicatorNode(const ARGS &... args) : indicator(args...) {};
+
+            int update(const T *in, const size_t n, const bool is_test, T &out) override {
+                const int err = pipeline_detail::call3(indicator, in, n, is_test, 0);
+                out = pipeline_detail::get<IND, T>(indicator, 0);
+                return err;
+            }
+
+            void clear() override {
+                indicator.clear();
+            }
+        };
+
+        /** \brief Узел с функцией от входов
+         */
+        class FunctionNode : public NodeBase {
+        public:
+            std::function<T(const T *)> function;
+
+            FunctionNode(const std::function<T(const T *)> &f) : function(f) {};
+
+            int update(const T *in, const size_t, const bool, T &out) override {
+                out = function(in);
+                return std::isnan(out) ? common::INDICATOR_NOT_READY_TO_WORK : common::OK;
+            }
+
+            void clear() override {};
+        };
+
+        /** \brief Описание узла
+         */
+        class Node {
+        public:
+            std::unique_ptr<NodeBase> node;     /**< Индикатор узла, пусто для входа */
+            std::vector<size_t> inputs;         /**< Номера узлов-входов */
+            std::string name;                   /**< Ключ узла */
+        };
+
+        std::vector<Node> nodes;
+        std::vector<size_t> sources;            /**< Номера узлов-входов конвейера */
+        std::vector<T> values;                  /**< Выходы всех узлов */
+        std::vector<T> args;                    /**< Входы текущего узла */
+        std::map<std::string, size_t> index;    /**< Ключ узла -> номер узла */
+
+        std::string make_key(const std::string &type, const std::vector<size_t> &inputs) const {
+            std::ostringstream s;
+            s << type << '(';
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                if (i) s << ',';
+                s << '#' << inputs[i];
+            }
+            s << ')';
+            return s.str();
+        }
+
+        bool check_inputs(const std::vector<size_t> &inputs) const {
+            if (inputs.empty()) return false;
+            for (size_t id : inputs) {
+                if (id >= nodes.size()) return false;
+            }
+            return true;
+        }
+
+        size_t insert(const std::string &key, const std::vector<size_t> &inputs, NodeBase *node) {
+            const size_t id = nodes.size();
+            nodes.emplace_back();
+            nodes.back().node.reset(node);
+            nodes.back().inputs = inputs;
+            nodes.back().name = key;
+            values.push_back(std::numeric_limits<T>::quiet_NaN());
+            if (args.size() < inputs.size()) args.resize(inputs.size());
+            index[key] = id;
+            return id;
+        }
+
+        int calc(const bool is_test) {
+            int err = common::OK;
+            for (size_t id = 0; id < nodes.size(); ++id) {
+                Node &node = nodes[id];
+                if (!node.node) continue;
+                bool is_nan = false;
+                for (size_t i = 0; i < node.inputs.size(); ++i) {
+                    args[i] = values[node.inputs[i]];
+                    if (std::isnan(args[i])) is_nan = true;
+                }
+                if (is_nan) {
+                    values[id] = std::numeric_limits<T>::quiet_NaN();
+                    err = common::INDICATOR_NOT_READY_TO_WORK;
+                    continue;
+                }
+                if (node.node->update(args.data(), node.inputs.size(), is_test, values[id]) != common::OK) {
+                    err = common::INDICATOR_NOT_READY_TO_WORK;
+                }
+            }
+            return err;
+        }
+
+        int set_sources(const std::vector<T> &in) {
+            if (in.size() != sources.size()) return common::INVALID_PARAMETER;
+            for (size_t i = 0; i < in.size(); ++i) {
+                values[sources[i]] = in[i];
+            }
+            return common::OK;
+        }
+
+    public:
+
+        Pipeline() {};
+
+        /** \brief Добавить вход конвейера
+         * \param name  Имя входа, например "close"
+         * \return Номер узла. Вход с тем же именем не дублируется
+         */
+        size_t add_input(const std::string &name) {
+            const std::string key = "input:" + name;
+            auto it = index.find(key);
+            if (it != index.end()) return it->second;
+            const size_t id = nodes.size();
+            nodes.emplace_back();
+            nodes.back().name = key;
+            values.push_back(std::numeric_limits<T>::quiet_NaN());
+            sources.push_back(id);
+            index[key] = id;
+            return id;
+        }
+
+        /** \brief Добавить индикатор
+         *
+         * Пример: pipeline.add<SMA<double>>({close}, 20);
+         * Индикатор должен иметь методы update и test с одним
+         * или тремя входами (high, low, close) и метод clear.
+         * Выход узла - значение get(). Если метода get нет
+         * (например, BollingerBands), выход узла равен NaN,
+         * а значения доступны через get_indicator.
+         * \param inputs    Номера узлов-входов
+         * \param params    Параметры конструктора индикатора
+         * \return Номер узла или NO_NODE, если входы указаны неверно
+         * или индикатор не поддерживает такое число входов
+         */
+        template<class IND, class... ARGS>
+        size_t add(const std::vector<size_t> &inputs, const ARGS &... params) {
+            if (!check_inputs(inputs)) return NO_NODE;
+            if (!pipeline_detail::is_supported<IND, T>(inputs.size())) return NO_NODE;
+            std::ostringstream s;
+            s.precision(17);
+            s << typeid(IND).name();
+            pipeline_detail::append_params(s, params...);
+            const std::string key = make_key(s.str(), inputs);
+            auto it = index.find(key);
+            if (it != index.end()) return it->second;
+            return insert(key, inputs, new IndicatorNode<IND>(params...));
+        }
+
+        /** \brief Добавить функцию от выходов других узлов
+         *
+         * Функции сравниваются по имени, поэтому одно имя
+         * должно соответствовать одной функции.
+         * \param name      Имя функции
+         * \param inputs    Номера узлов-входов
+         * \param function  Функция, принимает массив входов
+         * \return Номер узла или NO_NODE, если входы указаны неверно
+         */
+        size_t add_function(
+                const std::string &name,
+                const std::vector<size_t> &inputs,
+                const std::function<T(const T *)> &function) {
+            if (!check_inputs(inputs) || !function) return NO_NODE;
+            const std::string key = make_key("function:" + name, inputs);
+            auto it = index.find(key);
+            if (it != index.end()) return it->second;
+            return insert(key, inputs, new FunctionNode(function));
+        }
+
+        /** \brief Обновить состояние конвейера
+         * \param in    Значения входов в порядке их добавления
+         * \return Вернет 0, если все узлы готовы, иначе см. ErrorType
+         */
+        int update(const std::vector<T> &in) {
+            const int err = set_sources(in);
+            if (err != common::OK) return err;
+            return calc(false);
+        }
+
+        /** \brief Обновить состояние конвейера с одним входом
+         * \param in    Сигнал на входе
+         * \return Вернет 0, если все узлы готовы, иначе см. ErrorType
+         */
+        int update(const T in) {
+            if (sources.size() != 1) return common::INVALID_PARAMETER;
+            values[sources[0]] = in;
+            return calc(false);
+        }
+
+        /** \brief Протестировать конвейер
+         *
+         * Этот метод отличается от update тем,
+         * что не влияет на внутреннее состояние индикаторов
+         * \param in    Значения входов в порядке их добавления
+         * \return Вернет 0, если все узлы готовы, иначе см. ErrorType
+         */
+        int test(const std::vector<T> &in) {
+            const int err = set_sources(in);
+            if (err != common::OK) return err;
+            return calc(true);
+        }
+
+        /** \brief Протестировать конвейер с одним входом
+         * \param in    Сигнал на входе
+         * \return Вернет 0, если все узлы готовы, иначе см. ErrorType
+         */
+        int test(const T in) {
+            if (sources.size() != 1) return common::INVALID_PARAMETER;
+            values[sources[0]] = in;
+            return calc(true);
+        }
+
+        /** \brief Получить выход узла
+         * \param id    Номер узла
+         */
+        inline T get(const size_t id) const noexcept {
+            if (id >= values.size()) return std::numeric_limits<T>::quiet_NaN();
+            return values[id];
+        }
+
+        /** \brief Получить выходы всех узлов
+         */
+        inline const std::vector<T> &get_values() const noexcept {
+            return values;
+        }
+
+        /** \brief Получить индикатор узла
+         *
+         * Нужен для индикаторов с несколькими выходами,
+         * например get_tl() у BollingerBands
+         * \param id    Номер узла, добавленного методом add<IND>
+         * \return Указатель на индикатор или nullptr, если такого узла нет,
+         * узел является входом или функцией, или тип индикатора другой
+         */
+        template<class IND>
+        IND *get_indicator(const size_t id) {
+            if (id >= nodes.size()) return nullptr;
+            IndicatorNode<IND> *node = dynamic_cast<IndicatorNode<IND>*>(nodes[id].node.get());
+            return node ? &node->indicator : nullptr;
+        }
+
+        /** \brief Получить ключ узла (тип, параметры и входы)
+         */
+        inline const std::string &get_name(const size_t id) const {
+            return nodes.at(id).name;
+        }
+
+        /** \brief Количество узлов
+         */
+        inline size_t size() const noexcept {
+            return nodes.size();
+        }
+
+        /** \brief Очистить состояние всех индикаторов
+         *
+         * Структура конвейера сохраняется
+         */
+        void clear() {
+            for (size_t id = 0; id < nodes.size(); ++id) {
+                if (nodes[id].node) nodes[id].node->clear();
+                values[id] = std::numeric_limits<T>::quiet_NaN();
+            }
+        }
+    };
+
+    template<class T>
+    const size_t Pipeline<T>::NO_NODE;
+
+}; // xtechnical
+
+#endif // XTECHNICAL_PIPELINE_HPP_INCLUDED
@@ -0,0 +1,557 @@
+#ifndef XTECHNICAL_STATE_HPP_INCLUDED
+#define XTECHNICAL_STATE_HPP_INCLUDED
+
+/** \file xtechnical_state.hpp
+ * \brief Сохранение и восстановление состояния индикаторов
+ *
+ * Индикаторы, которые поддерживают сохранение, имеют методы
+ * save_state(StateWriter &) и load_state(StateReader &).
+ * Состояние пишется в двоичном виде в порядке байтов платформы,
+ * каждый объект начинается с метки класса, версии формата и размера типа T,
+ * параметры индикатора (период и т.п.) сохраняются и при загрузке сравниваются
+ * с параметрами объекта, в который загружается состояние.
+ *
+ * Функции state::save и state::load добавляют к состоянию заголовок
+ * с размером и контрольной суммой. Классы StateFileWriter и StateFileReader
+ * хранят в одном файле состояния целого набора индикаторов по строковым ключам,
+ * файл читается через mmap без копирования (на POSIX системах).
+ */
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include "xtechnical_common.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define XTECHNICAL_STATE_USE_MMAP
+#endif
+
+namespace xtechnical {
+
+    namespace state {
+        namespace detail {
+
+            /** \brief Хеш FNV-1a, 32 бита
+             */
+            inline uint32_t fnv1a(const void *data, const size_t size, uint32_t hash = 2166136261u) noexcept {
+                const uint8_t *p = static_cast<const uint8_t*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    hash ^= p[i];
+                    hash *= 16777619u;
+                }
+                return hash;
+            }
+
+            inline uint32_t fnv1a(const char *str) noexcept {
+                return fnv1a(str, std::strlen(str));
+            }
+        };
+    };
+
+    /** \brief Запись состояния индикаторов в буфер
+     */
+    class StateWriter {
+    public:
+        std::vector<uint8_t> &data;
+
+        explicit StateWriter(std::vector<uint8_t> &d) : data(d) {}
+
+        /** \brief Начать запись объекта
+         * \param tag           Метка класса
+         * \param version       Версия формата состояния класса
+         * \param value_size    Размер типа данных индикатора
+         */
+        inline void begin(const char *tag, const uint8_t version, const uint8_t value_size) {
+            write(state::detail::fnv1a(tag));
+            write(version);
+            write(value_size);
+        }
+
+        template<class V>
+        inline typename std::enable_if<std::is_arithmetic<V>::value>::type
+        write(const V &value) {
+            const size_t pos = data.size();
+            data.resize(pos + sizeof(V));
+            std::memcpy(data.data() + pos, &value, sizeof(V));
+        }
+
+        template<class V>
+        inline void write(const V *values, const size_t size) {
+            static_assert(std::is_arithmetic<V>::value, "write: arithmetic type expected");
+            if (size == 0) return;
+            const size_t pos = data.size();
+            data.resize(pos + size * sizeof(V));
+            std::memcpy(data.data() + pos, values, size * sizeof(V));
+        }
+
+        template<class A, class B>
+        inline void write(const std::pair<A, B> &value) {
+            write(value.first);
+            write(value.second);
+        }
+
+        template<class V, class A>
+        inline void write(const std::vector<V, A> &values) {
+            write((uint64_t)values.size());
+            for (auto &v : values) write(v);
+        }
+
+        template<class V, class A>
+        inline void write(const std::deque<V, A> &values) {
+            write((uint64_t)values.size());
+            for (auto &v : values) write(v);
+        }
+
+        template<class K, class V, class C, class A>
+        inline void write(const std::map<K, V, C, A> &values) {
+            write((uint64_t)values.size());
+            for (auto &v : values) write(v);
+        }
+    };
+
+    /** \brief Чтение состояния индикаторов из буфера
+     *
+     * Буфер не копируется, поэтому его можно отобразить из файла.
+     * После первой ошибки все методы возвращают false.
+     */
+    class StateReader {
+    private:
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        size_t offset = 0;
+        bool is_ok = true;
+
+        inline bool fail() noexcept {
+            is_ok = false;
+            return false;
+        }
+
+        /** \brief Прочитать размер контейнера
+         * \param min_item_size Минимальный размер элемента, для проверки размера
+         */
+        inline bool read_size(size_t &value, const size_t min_item_size) noexcept {
+            uint64_t temp = 0;
+            if (!read(temp)) return false;
+            if (temp > (uint64_t)(size - offset) / min_item_size) return fail();
+            value = (size_t)temp;
+            return true;
+        }
+
+    public:
+
+        StateReader(const void *d, const size_t s) :
+            data(static_cast<const uint8_t*>(d)), size(s) {}
+
+        /** \brief Начать чтение объекта
+         * \return Вернет false, если метка, версия или размер типа не совпадают
+         */
+        inline bool begin(const char *tag, const uint8_t version, const uint8_t value_size) noexcept {
+            uint32_t h = 0;
+            uint8_t v = 0, s = 0;
+            if (!read(h) || !read(v) || !read(s)) return false;
+            if (h != state::detail::fnv1a(tag) || v != version || s != value_size) return fail();
+            return true;
+        }
+
+        template<class V>
+        inline typename std::enable_if<std::is_arithmetic<V>::value, bool>::type
+        read(V &value) noexcept {
+            if (!is_ok || size - offset < sizeof(V)) return fail();
+            std::memcpy(&value, data + offset, sizeof(V));
+            offset += sizeof(V);
+            return true;
+        }
+
+        template<class V>
+        inline bool read(V *values, const size_t count) noexcept {
+            static_assert(std::is_arithmetic<V>::value, "read: arithmetic type expected");
+            if (!is_ok || (size - offset) / sizeof(V) < count) return fail();
+            if (count == 0) return true;
+            std::memcpy(values, data + offset, count * sizeof(V));
+            offset += count * sizeof(V);
+            return true;
+        }
+
+        template<class A, class B>
+        inline bool read(std::pair<A, B> &value) {
+            return read(value.first) && read(value.second);
+        }
+
+        template<class V, class A>
+        inline bool read(std::vector<V, A> &values) {
+            size_t n = 0;
+            if (!read_size(n, 1)) return false;
+            values.resize(n);
+            for (auto &v : values) if (!read(v)) return false;
+            return true;
+        }
+
+        template<class V, class A>
+        inline bool read(std::deque<V, A> &values) {
+            size_t n = 0;
+            if (!read_size(n, 1)) return false;
+            values.resize(n);
+            for (auto &v : values) if (!read(v)) return false;
+            return true;
+        }
+
+        template<class K, class V, class C, class A>
+        inline bool read(std::map<K, V, C, A> &values) {
+            size_t n = 0;
+            if (!read_size(n, 1)) return false;
+            values.clear();
+            for (size_t i = 0; i < n; ++i) {
+                std::pair<K, V> item;
+                if (!read(item)) return false;
+                values.insert(values.end(), item);
+            }
+            return true;
+        }
+
+        /** \brief Прочитать параметр и сравнить его с ожидаемым
+         * \return Вернет false, если параметр не совпадает
+         */
+        template<class V>
+        inline bool check(const V &expected) noexcept {
+            V value = V();
+            if (!read(value)) return false;
+            if (!(value == expected)) return fail();
+            return true;
+        }
+
+        inline bool ok() const noexcept {
+            return is_ok;
+        }
+
+        /** \brief Проверить, если все данные прочитаны
+         */
+        inline bool done() const noexcept {
+            return is_ok && offset == size;
+        }
+    };
+
+    namespace state {
+
+        const uint32_t BLOB_MAGIC = 0x54535458;         /**< "XTST" */
+        const uint16_t BLOB_VERSION = 1;
+        const size_t BLOB_HEADER_SIZE = 16;
+        const char FILE_MAGIC[8] = "XTSTATE";
+        const uint64_t FILE_VERSION = 1;
+
+        /** \brief Сохранить состояние индикатора
+         * \param indicator Индикатор
+         * \param out       Буфер, состояние добавляется в его конец
+         */
+        template<class IND>
+        void save(const IND &indicator, std::vector<uint8_t> &out) {
+            const size_t start = out.size();
+            out.resize(start + BLOB_HEADER_SIZE);
+            StateWriter writer(out);
+            indicator.save_state(writer);
+            const uint32_t payload_size = (uint32_t)(out.size() - start - BLOB_HEADER_SIZE);
+            const uint32_t checksum = detail::fnv1a(out.data() + start + BLOB_HEADER_SIZE, payload_size);
+            const uint16_t reserved = 0;
+            uint8_t *header = out.data() + start;
+            std::memcpy(header, &BLOB_MAGIC, 4);
+            std::memcpy(header + 4, &BLOB_VERSION, 2);
+            std::memcpy(header + 6, &reserved, 2);
+            std::memcpy(header + 8, &payload_size, 4);
+            std::memcpy(header + 12, &checksum, 4);
+        }
+
+        /** \brief Сохранить состояние индикатора
+         * \param indicator Индикатор
+         * \return Состояние индикатора
+         */
+        template<class IND>
+        std::vector<uint8_t> save(const IND &indicator) {
+            std::vector<uint8_t> out;
+            save(indicator, out);
+            return out;
+        }
+
+        /** \brief Загрузить состояние индикатора
+         *
+         * Индикатор должен быть создан с теми же параметрами, что и сохраненный.
+         * При ошибке состояние индикатора не меняется
+         * \param indicator Индикатор
+         * \param data      Состояние, полученное от save
+         * \param size      Размер состояния
+         * \return Вернет 0 в случае успеха, иначе INVALID_PARAMETER
+         */
+        template<class IND>
+        int load(IND &indicator, const void *data, const size_t size) {
+            if (data == nullptr || size < BLOB_HEADER_SIZE) return common::INVALID_PARAMETER;
+            const uint8_t *header = static_cast<const uint8_t*>(data);
+            uint32_t magic = 0, payload_size = 0, checksum = 0;
+            uint16_t version = 0, reserved = 0;
+            std::memcpy(&magic, header, 4);
+            std::memcpy(&version, header + 4, 2);
+            std::memcpy(&reserved, header + 6, 2);
+            std::memcpy(&payload_size, header + 8, 4);
+            std::memcpy(&checksum, header + 12, 4);
+            if (magic != BLOB_MAGIC || version != BLOB_VERSION || reserved != 0) return common::INVALID_PARAMETER;
+            if (payload_size != size - BLOB_HEADER_SIZE) return common::INVALID_PARAMETER;
+            const uint8_t *payload = header + BLOB_HEADER_SIZE;
+            if (detail::fnv1a(payload, payload_size) != checksum) return common::INVALID_PARAMETER;
+            StateReader reader(payload, payload_size);
+            IND temp(indicator);
+            if (!temp.load_state(reader) || !reader.done()) return common::INVALID_PARAMETER;
+            indicator = std::move(temp);
+            return common::OK;
+        }
+
+        template<class IND>
+        inline int load(IND &indicator, const std::vector<uint8_t> &data) {
+            return load(indicator, data.data(), data.size());
+        }
+    };
+
+    /** \brief Запись файла состояний набора индикаторов
+     *
+     * Формат файла: заголовок, таблица записей, отсортированная по ключу,
+     * затем ключи и состояния, выровненные по 8 байт.
+     */
+    class StateFileWriter {
+    private:
+        std::map<std::string, std::vector<uint8_t>> items;
+
+    public:
+
+        /** \brief Добавить состояние индикатора
+         * \param key       Уникальный ключ, например "EURUSD/M1/SMA20"
+         * \param indicator Индикатор
+         */
+        template<class IND>
+        void add(const std::string &key, const IND &indicator) {
+            std::vector<uint8_t> &blob = items[key];
+            blob.clear();
+            state::save(indicator, blob);
+        }
+
+        inline size_t size() const noexcept {
+            return items.size();
+        }
+
+        inline void clear() noexcept {
+            items.clear();
+        }
+
+        /** \brief Записать файл
+         * \param path  Путь к файлу
+         * \return Вернет true в случае успеха
+         */
+        bool write(const std::string &path) const {
+            const uint64_t count = items.size();
+            const uint64_t index_size = count * 32;
+            std::vector<uint8_t> index;
+            index.reserve((size_t)index_size);
+            std::vector<uint8_t> body;
+            uint64_t offset = 32 + index_size;
+            auto put = [](std::vector<uint8_t> &out, const uint64_t value) {
+                const size_t pos = out.size();
+                out.resize(pos + 8);
+                std::memcpy(out.data() + pos, &value, 8);
+            };
+            auto align = [&]() {
+                while (body.size() % 8) body.push_back(0);
+            };
+            for (auto &item : items) {
+                const uint64_t key_offset = offset + body.size();
+                body.insert(body.end(), item.first.begin(), item.first.end());
+                align();
+                const uint64_t blob_offset = offset + body.size();
+                body.insert(body.end(), item.second.begin(), item.second.end());
+                align();
+                put(index, key_offset);
+                put(index, item.first.size());
+                put(index, blob_offset);
+                put(index, item.second.size());
+            }
+            std::vector<uint8_t> header;
+            header.insert(header.end(), state::FILE_MAGIC, state::FILE_MAGIC + 8);
+            put(header, state::FILE_VERSION);
+            put(header, count);
+            put(header, offset + body.size());
+
+            const std::string temp_path = path + ".tmp";
+            std::FILE *file = std::fopen(temp_path.c_str(), "wb");
+            if (!file) return false;
+            bool is_ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+            if (is_ok && !index.empty()) is_ok = std::fwrite(index.data(), 1, index.size(), file) == index.size();
+            if (is_ok && !body.empty()) is_ok = std::fwrite(body.data(), 1, body.size(), file) == body.size();
+            is_ok = (std::fclose(file) == 0) && is_ok;
+            /* файл заменяется целиком, чтобы при сбое не остался недописанный снимок */
+            if (is_ok) {
+                std::remove(path.c_str());
+                is_ok = std::rename(temp_path.c_str(), path.c_str()) == 0;
+            }
+            if (!is_ok) std::remove(temp_path.c_str());
+            return is_ok;
+        }
+    };
+
+    /** \brief Чтение файла состояний набора индикаторов
+     */
+    class StateFileReader {
+    private:
+        const uint8_t *data = nullptr;
+        size_t data_size = 0;
+        uint64_t count = 0;
+#if defined(XTECHNICAL_STATE_USE_MMAP)
+        void *mapping = nullptr;
+#endif
+        std::vector<uint8_t> buffer;
+
+        inline uint64_t get(const size_t offset) const noexcept {
+            uint64_t value = 0;
+            std::memcpy(&value, data + offset, 8);
+            return value;
+        }
+
+        inline std::pair<const char*, size_t> key_at(const size_t i) const noexcept {
+            return std::make_pair((const char*)(data + get(32 + i * 32)), (size_t)get(32 + i * 32 + 8));
+        }
+
+        /** \brief Проверить заголовок и таблицу записей
+         */
+        bool validate() noexcept {
+            if (data_size < 32) return false;
+            if (std::memcmp(data, state::FILE_MAGIC, 8) != 0) return false;
+            if (get(8) != state::FILE_VERSION) return false;
+            count = get(16);
+            if (get(24) != data_size) return false;
+            if (count > (data_size - 32) / 32) return false;
+            for (size_t i = 0; i < count; ++i) {
+                const uint64_t key_offset = get(32 + i * 32);
+                const uint64_t key_size = get(32 + i * 32 + 8);
+                const uint64_t blob_offset = get(32 + i * 32 + 16);
+                const uint64_t blob_size = get(32 + i * 32 + 24);
+                if (key_offset > data_size || key_size > data_size - key_offset) return false;
+                if (blob_offset > data_size || blob_size > data_size - blob_offset) return false;
+            }
+            return true;
+        }
+
+    public:
+
+        StateFileReader() {}
+
+        StateFileReader(const StateFileReader &) = delete;
+        StateFileReader &operator=(const StateFileReader &) = delete;
+
+        ~StateFileReader() {
+            close();
+        }
+
+        /** \brief Открыть файл состояний
+         * \param path  Путь к файлу
+         * \return Вернет true в случае успеха
+         */
+        bool open(const std::string &path) {
+            close();
+#if defined(XTECHNICAL_STATE_USE_MMAP)
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+                ::close(fd);
+                return false;
+            }
+            void *ptr = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (ptr == MAP_FAILED) return false;
+            mapping = ptr;
+            data = static_cast<const uint8_t*>(ptr);
+            data_size = (size_t)st.st_size;
+#else
+            std::FILE *file = std::fopen(path.c_str(), "rb");
+            if (!file) return false;
+            std::fseek(file, 0, SEEK_END);
+            const long file_size = std::ftell(file);
+            std::fseek(file, 0, SEEK_SET);
+            if (file_size > 0) {
+                buffer.resize((size_t)file_size);
+                if (std::fread(buffer.data(), 1, buffer.size(), file) != buffer.size()) buffer.clear();
+            }
+            std::fclose(file);
+            data = buffer.data();
+            data_size = buffer.size();
+#endif
+            if (!validate()) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        /** \brief Закрыть файл состояний
+         */
+        void close() noexcept {
+#if defined(XTECHNICAL_STATE_USE_MMAP)
+            if (mapping) ::munmap(mapping, data_size);
+            mapping = nullptr;
+#endif
+            buffer.clear();
+            data = nullptr;
+            data_size = 0;
+            count = 0;
+        }
+
+        /** \brief Количество записей
+         */
+        inline size_t size() const noexcept {
+            return (size_t)count;
+        }
+
+        /** \brief Найти состояние по ключу
+         * \param key   Ключ
+         * \param blob  Указатель на состояние
+         * \param size  Размер состояния
+         * \return Вернет true, если ключ найден
+         */
+        bool find(const std::string &key, const void *&blob, size_t &size) const noexcept {
+            size_t lo = 0, hi = (size_t)count;
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                const std::pair<const char*, size_t> k = key_at(mid);
+                const int cmp = key.compare(0, std::string::npos, k.first, k.second);
+                if (cmp == 0) {
+                    blob = data + get(32 + mid * 32 + 16);
+                    size = (size_t)get(32 + mid * 32 + 24);
+                    return true;
+                }
+                if (cmp < 0) hi = mid;
+                else lo = mid + 1;
+            }
+            return false;
+        }
+
+        /** \brief Загрузить состояние индикатора
+         * \param key       Ключ
+         * \param indicator Индикатор
+         * \return Вернет 0 в случае успеха, NO_INIT если ключа нет, иначе INVALID_PARAMETER
+         */
+        template<class IND>
+        int load(const std::string &key, IND &indicator) const {
+            const void *blob = nullptr;
+            size_t size = 0;
+            if (!find(key, blob, size)) return common::NO_INIT;
+            return state::load(indicator, blob, size);
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_STATE_HPP_INCLUDED
@@ -0,0 +1,116 @@
+#ifndef XTECHNICAL_THREAD_POOL_HPP_INCLUDED
+#define XTECHNICAL_THREAD_POOL_HPP_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+namespace xtechnical {
+
+    /** \brief Пул потоков с фиксированным числом потоков
+     * Выполняет parallel_for: задачи 0..n-1 разбираются потоками пула
+     * и вызывающим потоком, метод возвращает управление после выполнения всех задач.
+     */
+    class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex call_mutex;
+        std::mutex task_mutex;
+        std::condition_variable start_cv;
+        std::condition_variable done_cv;
+        const std::function<void(const size_t)> *task = nullptr;
+        std::atomic<size_t> next_index = ATOMIC_VAR_INIT(0);
+        size_t task_size = 0;
+        size_t active = 0;
+        uint64_t generation = 0;
+        bool is_stop = false;
+
+        inline void run() noexcept {
+            size_t index = 0;
+            while ((index = next_index.fetch_add(1)) < task_size) {
+                (*task)(index);
+            }
+        }
+
+        void worker() noexcept {
+            uint64_t last_generation = 0;
+            for (;;) {
+                std::unique_lock<std::mutex> lock(task_mutex);
+                start_cv.wait(lock, [&]{ return is_stop || generation != last_generation; });
+                if (is_stop) return;
+                last_generation = generation;
+                lock.unlock();
+                run();
+                lock.lock();
+                if (--active == 0) done_cv.notify_one();
+            }
+        }
+
+    public:
+
+        /** \brief Конструктор пула потоков
+         * \param num_threads   Общее число потоков, включая вызывающий поток.
+         * Если 0, используется std::thread::hardware_concurrency()
+         */
+        ThreadPool(size_t num_threads = 0) {
+            if (num_threads == 0) num_threads = std::max(1U, std::thread::hardware_concurrency());
+            for (size_t i = 1; i < num_threads; ++i) {
+                workers.emplace_back([this]{ worker(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool &operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(task_mutex);
+                is_stop = true;
+            }
+            start_cv.notify_all();
+            for (auto &item : workers) {
+                item.join();
+            }
+        }
+
+        /** \brief Получить общее число потоков, включая вызывающий поток
+         */
+        inline size_t size() const noexcept {
+            return workers.size() + 1;
+        }
+
+        /** \brief Выполнить задачи 0..n-1 параллельно
+         * \param n     Количество задач
+         * \param f     Функция задачи, принимает индекс задачи. Не должна бросать исключения
+         */
+        void parallel_for(const size_t n, const std::function<void(const size_t)> &f) {
+            if (workers.empty() || n <= 1) {
+                for (size_t i = 0; i < n; ++i) {
+                    f(i);
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> call_lock(call_mutex);
+            std::unique_lock<std::mutex> lock(task_mutex);
+            task = &f;
+            task_size = n;
+            next_index = 0;
+            active = workers.size();
+            ++generation;
+            lock.unlock();
+            start_cv.notify_all();
+            run();
+            lock.lock();
+            done_cv.wait(lock, [&]{ return active == 0; });
+            task = nullptr;
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_THREAD_POOL_HPP_INCLUDED
@@ -0,0 +1,213 @@
+#ifndef XTECHNICAL_TIME_GRID_HPP_INCLUDED
+#define XTECHNICAL_TIME_GRID_HPP_INCLUDED
+
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include "xtechnical_memory_resource.hpp"
+
+namespace xtechnical {
+
+    /** \brief Сетка событийного времени с шагом time_step
+     *
+     * Хранит последние capacity отсчетов сетки как серии одинаковых значений
+     * (значение и длина серии). Пропуск между тиками заполняется последним
+     * значением простым увеличением длины последней серии, поэтому update
+     * работает за O(1) при любой длине пропуска. Отсчеты сетки
+     * восстанавливаются только при вызове copy_to, например перед расчетом.
+     * Серий не больше, чем отсчетов, память выделяется только при создании.
+     */
+    template<class T>
+    class TimeGrid {
+    private:
+        pmr::vector<T> values;          /**< Значения серий */
+        pmr::vector<uint64_t> lengths;  /**< Длины серий */
+        uint64_t capacity = 0;          /**< Число хранимых отсчетов */
+        uint64_t time_step = 0;
+        uint64_t last_time = 0;         /**< Время последнего отсчета */
+        uint64_t total = 0;             /**< Число отсчетов в сетке */
+        size_t head = 0;                /**< Первая серия */
+        size_t length = 0;              /**< Число серий */
+        size_t mask = 0;
+
+        inline size_t at(const size_t i) const noexcept {
+            return (head + i) & mask;
+        }
+
+        inline size_t back_index() const noexcept {
+            return at(length - 1);
+        }
+
+        /** \brief Удалить самые старые отсчеты сверх capacity
+         */
+        inline void trim() noexcept {
+            while (total > capacity) {
+                const uint64_t excess = total - capacity;
+                if (lengths[head] > excess) {
+                    lengths[head] -= excess;
+                    total = capacity;
+                    break;
+                }
+                total -= lengths[head];
+                head = (head + 1) & mask;
+                --length;
+            }
+        }
+
+    public:
+
+        TimeGrid() {};
+
+        /** \brief Конструктор сетки
+         * \param c        Число хранимых отсчетов
+         * \param s        Шаг сетки
+         * \param resource Источник памяти сетки
+         */
+        TimeGrid(const size_t c, const uint64_t s, pmr::memory_resource *resource = pmr::get_default_resource()) :
+                values(resource), lengths(resource), capacity(c), time_step(s) {
+            size_t size = 1;
+            while (size < c) size <<= 1;
+            values.resize(size);
+            lengths.resize(size);
+            mask = size - 1;
+        }
+
+        /** \brief Округлить метку времени до шага сетки
+         */
+        inline uint64_t round_time(const uint64_t timestamp) const noexcept {
+            return timestamp - (timestamp % time_step);
+        }
+
+        /** \brief Сдвинуть сетку к метке времени
+         *
+         * Отсчеты между последним отсчетом и новым получают последнее значение.
+         * Первый отсчет пустой сетки получает значение T().
+         * Метка времени раньше последнего отсчета не сдвигает сетку.
+         * \param timestamp Метка времени
+         */
+        inline void advance(const uint64_t timestamp) noexcept {
+            if (capacity == 0) return;
+            const uint64_t t = round_time(timestamp);
+            if (length == 0) {
+                head = 0;
+                values[0] = T();
+                lengths[0] = 1;
+                length = 1;
+                total = 1;
+                last_time = t;
+                return;
+            }
+            if (t <= last_time) return;
+            const uint64_t steps = (t - last_time) / time_step;
+            lengths[back_index()] += steps;
+            total += steps;
+            last_time = t;
+            trim();
+        }
+
+        /** \brief Задать значение последнего отсчета
+         * \param value Значение
+         */
+        inline void set_back(const T value) noexcept {
+            if (length == 0) return;
+            const size_t last = back_index();
+            if (lengths[last] == 1) {
+                values[last] = value;
+                return;
+            }
+            /* отделяем последний отсчет в новую серию */
+            --lengths[last];
+            const size_t pos = at(length);
+            values[pos] = value;
+            lengths[pos] = 1;
+            ++length;
+        }
+
+        /** \brief Обновить сетку
+         *
+         * Эквивалентно advance(timestamp) и set_back(value)
+         * \param value     Значение
+         * \param timestamp Метка времени
+         */
+        inline void update(const T value, const uint64_t timestamp) noexcept {
+            advance(timestamp);
+            set_back(value);
+        }
+
+        /** \brief Получить значение последнего отсчета
+         * \return Значение последнего отсчета или NaN, если сетка пуста
+         */
+        inline T back() const noexcept {
+            if (length == 0) return std::numeric_limits<T>::quiet_NaN();
+            return values[back_index()];
+        }
+
+        /** \brief Скопировать последние отсчеты сетки
+         *
+         * Отсчеты записываются от старого к новому за O(серий + n)
+         * \param out   Массив для n отсчетов
+         * \param n     Число отсчетов, не больше size()
+         * \return Число записанных отсчетов
+         */
+        size_t copy_to(T *out, const size_t n) const noexcept {
+            const uint64_t count = std::min((uint64_t)n, total);
+            uint64_t skip = total - count;
+            size_t pos = 0;
+            for (size_t i = 0; i < length; ++i) {
+                const size_t index = at(i);
+                uint64_t run = lengths[index];
+                if (skip >= run) {
+                    skip -= run;
+                    continue;
+                }
+                run -= skip;
+                skip = 0;
+                std::fill(out + pos, out + pos + run, values[index]);
+                pos += run;
+            }
+            return pos;
+        }
+
+        /** \brief Время последнего отсчета
+         */
+        inline uint64_t get_last_time() const noexcept {
+            return last_time;
+        }
+
+        /** \brief Число отсчетов в сетке
+         */
+        inline size_t size() const noexcept {
+            return (size_t)total;
+        }
+
+        /** \brief Число серий
+         */
+        inline size_t runs() const noexcept {
+            return length;
+        }
+
+        /** \brief Проверить, если сетка пуста
+         */
+        inline bool empty() const noexcept {
+            return length == 0;
+        }
+
+        /** \brief Проверить, если сетка заполнена
+         */
+        inline bool full() const noexcept {
+            return capacity > 0 && total >= capacity;
+        }
+
+        /** \brief Очистить сетку
+         */
+        inline void clear() noexcept {
+            head = 0;
+            length = 0;
+            total = 0;
+            last_time = 0;
+        }
+    };
+
+}; // xtechnical
+
+#endif // XTECHNICAL_TIME_GRID_HPP_INCLUDED
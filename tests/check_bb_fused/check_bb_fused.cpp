@@ -0,0 +1,164 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cmath>
+#include "xtechnical_indicators.hpp"
+
+/* проверка линий Боллинджера с суммами окна за O(1):
+ * сравнение с расчетом в два прохода по окну, test() без изменения состояния,
+ * полосы для нескольких множителей и скорость update/test
+ */
+
+static int errors = 0;
+
+static void check(const std::string &name, const size_t i, const double a, const double b, const double eps) {
+    if (std::isnan(a) && std::isnan(b)) return;
+    if (std::abs(a - b) <= eps * std::max(1.0, std::abs(b))) return;
+    if (errors < 10) {
+        std::cout << "error! " << name << " index " << i << " "
+            << std::setprecision(17) << a << " != " << b << std::endl;
+    }
+    ++errors;
+}
+
+/* расчет в два прохода, как в прежней версии индикатора
+ * (SMA готова к работе после period + 1 значений)
+ */
+static bool reference(const std::vector<double> &prices, const size_t end, const size_t period, double &ml, double &std_dev) {
+    if (end <= period) return false;
+    ml = 0;
+    for (size_t i = end - period; i < end; ++i) ml += prices[i];
+    ml /= (double)period;
+    double sum = 0;
+    for (size_t i = end - period; i < end; ++i) sum += (prices[i] - ml) * (prices[i] - ml);
+    std_dev = std::sqrt(sum / (double)(period - 1));
+    return true;
+}
+
+static void check_period(const std::vector<double> &prices, const size_t period) {
+    const std::vector<double> factors = {1.0, 2.0, 2.5};
+    xtechnical::BollingerBands<double> bb = xtechnical::BollingerBands<double>::with_factors(period, factors);
+    std::vector<double> history;
+    for (size_t i = 0; i < prices.size(); ++i) {
+        /* test() дает тот же результат, что и update(), и не меняет состояние */
+        const double in_test = prices[i] + 0.001;
+        double tl = 0, ml = 0, bl = 0, ref_ml = 0, ref_std = 0;
+        bb.test(in_test, tl, ml, bl);
+        history.push_back(in_test);
+        if (reference(history, history.size(), period, ref_ml, ref_std)) {
+            check("test ml", i, ml, ref_ml, 1e-9);
+            check("test std", i, bb.get_std_dev(), ref_std, 1e-7);
+        } else if (!std::isnan(tl)) {
+            check("test not ready", i, tl, std::numeric_limits<double>::quiet_NaN(), 0);
+        }
+        history.back() = prices[i];
+
+        const int err = bb.update(prices[i]);
+        if (reference(history, history.size(), period, ref_ml, ref_std)) {
+            if (err != xtechnical::common::OK) check("update ready", i, err, 0, 0);
+            check("update ml", i, bb.get_ml(), ref_ml, 1e-9);
+            check("update std", i, bb.get_std_dev(), ref_std, 1e-7);
+            for (size_t f = 0; f < factors.size(); ++f) {
+                check("update tl", i, bb.get_tl(f), ref_ml + factors[f] * ref_std, 1e-7);
+                check("update bl", i, bb.get_bl(f), ref_ml - factors[f] * ref_std, 1e-7);
+            }
+            check("update tl", i, bb.get_tl(), bb.get_tl(0), 0);
+        } else if (err == xtechnical::common::OK) {
+            check("update not ready", i, err, xtechnical::common::INDICATOR_NOT_READY_TO_WORK, 0);
+        }
+    }
+    if (bb.get_factors_size() != factors.size()) check("factors", 0, bb.get_factors_size(), factors.size(), 0);
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    /* цены с большим уровнем и малым разбросом - худший случай для сумм квадратов */
+    std::mt19937 gen(7);
+    std::normal_distribution<double> noise(0.0, 0.0001);
+    std::vector<double> prices;
+    double price = 10000.0;
+    for (size_t i = 0; i < 20000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    const size_t periods[] = {2, 3, 5, 20, 50, 200};
+    for (auto period : periods) {
+        check_period(prices, period);
+    }
+
+    /* постоянный сигнал: отклонение равно нулю с точностью до ошибки SMA */
+    {
+        xtechnical::BollingerBands<double> bb(20, 2);
+        for (size_t i = 0; i < 1000; ++i) bb.update(1.2345);
+        check("constant std", 0, bb.get_std_dev(), 0.0, 1e-12);
+        bb.clear();
+        check("clear", 0, bb.get_tl(), std::numeric_limits<double>::quiet_NaN(), 0);
+    }
+
+    /* ровное окно после движения цены: полосы совпадают со средней линией */
+    {
+        const size_t period = 5;
+        xtechnical::BollingerBands<double> bb = xtechnical::BollingerBands<double>::with_factors(period, {2.0});
+        xtechnical::fixed::BollingerBands<double, period> fixed_bb(2.0);
+        double flat = 0;
+        for (size_t i = 0; i < 2000; ++i) {
+            /* после каждых 37 цен окно из 11 одинаковых цен */
+            const bool is_flat = i % 48 >= 37;
+            if (!is_flat) flat = prices[i];
+            bb.update(flat);
+            fixed_bb.update(flat);
+            if (!is_flat || i % 48 < 37 + period) continue;
+            const double t = flat;
+            double tl = 0, ml = 0, bl = 0;
+            check("flat std", i, bb.get_std_dev(), 0.0, 0);
+            check("flat tl", i, bb.get_tl(), bb.get_ml(), 0);
+            check("flat bl", i, bb.get_bl(0), bb.get_ml(), 0);
+            check("flat fixed tl", i, fixed_bb.get_tl(), fixed_bb.get_ml(), 0);
+            bb.test(t, tl, ml, bl);
+            check("flat test tl", i, tl, ml, 0);
+            bb.test_many(&t, 1, &tl, &ml, &bl);
+            check("flat test_many tl", i, tl, ml, 0);
+        }
+    }
+
+    /* скорость update и test в сравнении с расчетом в два прохода */
+    for (auto period : periods) {
+        double sink = 0;
+        xtechnical::BollingerBands<double> bb(period, 2);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) {
+            bb.update(p);
+            sink += bb.get_tl();
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) {
+            bb.test(p);
+            sink += bb.get_tl();
+        }
+        auto t3 = std::chrono::high_resolution_clock::now();
+        double ml = 0, std_dev = 0;
+        for (size_t i = 1; i <= prices.size(); ++i) {
+            if (reference(prices, i, period, ml, std_dev)) sink += ml + 2 * std_dev;
+        }
+        auto t4 = std::chrono::high_resolution_clock::now();
+        const double n = (double)prices.size();
+        std::cout << "period " << std::setw(4) << period << std::fixed << std::setprecision(2)
+            << " update " << std::setw(8) << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / n << " ns"
+            << " test " << std::setw(8) << std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / n << " ns"
+            << " two pass " << std::setw(8) << std::chrono::duration_cast<std::chrono::nanoseconds>(t4 - t3).count() / n << " ns"
+            << std::endl;
+        if (std::isinf(sink)) std::cout << sink << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,462 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "xtechnical_circular_buffer.hpp"
+
+/* сравнение циклического буфера точного размера с прежней реализацией
+ * (размер - степень двойки, копия буфера для теста) на случайной
+ * последовательности update/test/clear, а также скорость update и test
+ */
+
+namespace reference {
+    /* прежняя реализация циклического буфера */
+        template<class T>
+        class circular_buffer {
+        private:
+	
+            std::vector<T> buffer;      /**< Основной буфер */
+            std::vector<T> buffer_test; /**< Буфер для теста */
+            uint32_t buffer_size;       /**< Размер буфера */
+            uint32_t buffer_size_div2;  /**< Индекс середины массива */
+            uint32_t buffer_offset;     /**< Смещение в буфере для размера массива не кратного степени двойки */
+            uint32_t count;             /**< Количество элементов в буфере */
+            uint32_t count_test;        /**< Количество элементов в буфере для теста */
+            uint32_t offset;            /**< Смещение в буфере */
+            uint32_t offset_test;
+            uint32_t mask;              /**< Маска */
+            bool is_power_of_two;       /**< Флаг степени двойки */
+            bool is_test;               /**< Флаг теста */
+
+            inline uint32_t cpl2(uint32_t x) const {
+                x = x - 1;
+                x = x | (x >> 1);
+                x = x | (x >> 2);
+                x = x | (x >> 4);
+                x = x | (x >> 8);
+                x = x | (x >> 16);
+                return x + 1;
+            }
+
+            inline bool check_power_of_two(const uint32_t value) const {
+                return value && !(value & (value - 1));
+            }
+		
+        public:
+	
+            typedef T value_t;
+
+            /** \brief Конструктор циклического буфера
+             */
+            circular_buffer() :
+                buffer_size(0), buffer_size_div2(0), buffer_offset(0),
+                count(0), count_test(0), offset(0), offset_test(0), mask(0),
+                is_power_of_two(false), is_test(false) {};
+
+            /** \brief Конструктор циклического буфера
+             * \param user_size Размер циклического буфера
+             */
+            circular_buffer(const size_t user_size) :
+                    buffer_size(user_size), buffer_size_div2(0), buffer_offset(0),
+                    count(0), count_test(0), offset(0), offset_test(0),
+                    is_power_of_two(false), is_test(false) {
+                if(check_power_of_two(user_size)) {
+                    buffer.resize(buffer_size);
+                    buffer_test.resize(buffer_size);
+                    mask = user_size - 1;
+                    is_power_of_two = true;
+                } else {
+                    const size_t new_size = cpl2(buffer_size);
+                    buffer.resize(new_size);
+                    buffer_test.resize(new_size);
+                    mask = new_size - 1;
+                    buffer_offset = buffer_size - new_size;
+                    is_power_of_two = false;
+                }
+                buffer_size_div2 = buffer_size / 2;
+            };
+
+            /** \brief Добавить значение в циклический буфер
+             * \param value Значение
+             */
+            inline void push_back(const T value) {
+                buffer[offset++] = value;
+                if(offset > count) count = offset;
+                offset &= mask;
+            }
+
+            /** \brief Получить размер циклического буфера
+             * \return Размер циклического буфера. Может быть меньше максимального, если буфер еще не заполнился.
+             */
+            inline size_t size() const {
+                return is_test ? std::min((size_t)count_test, (size_t)buffer_size) : std::min((size_t)count, (size_t)buffer_size);
+            }
+
+            /** \brief Проверить, если циклическй буфер пуст
+             * \return Вернет true, если циклическй буфер пуст
+             */
+            inline bool empty() const {
+                return is_test ? (count_test == 0) : (count == 0);
+            }
+
+            /** \brief Проверить, если циклическй буфер полн
+             * \return Вернет true, если циклическй буфер полн
+             */
+            inline bool full() const {
+                if(is_test) return (count_test >= buffer_size);
+                return (count >= buffer_size);
+            }
+
+            void fill(const T value) {
+                if(is_test) std::fill(buffer_test.begin(), buffer_test.end(), value);
+                else std::fill(buffer.begin(), buffer.end(), value);
+            }
+
+            /** \brief Обновить состояние циклического буфера
+             * \param value Новое значение
+             * \return Вернет true, если циклическй буфер полн
+             */
+            inline bool update(const T value) {
+                is_test = false;
+                push_back(value);
+                return full();
+            }
+
+            /** \brief Протестировать состояние циклического буфера
+             * \param value Новое значение
+             * \return Вернет true, если циклическй буфер полн
+             */
+            inline bool test(const double value) {
+                if(!is_test) {
+                    is_test = true;
+                    buffer_test = buffer;
+                    offset_test = offset;
+                    count_test = count;
+                    buffer_test[offset_test++] = value;
+                    if(offset_test > count_test) count_test = offset_test;
+                    offset_test &= mask;
+                } else {
+                    buffer_test[(offset_test - 1) & mask] = value;
+                }
+                return full();
+            }
+
+            /** \brief Получить значение циклического буфера по индексу
+             * \param index Индекс
+             * \return Значение циклического буфера
+             */
+            inline T &get(const uint32_t index) {
+                if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+                return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            }
+
+            /** \brief Получить значение циклического буфера по индексу
+             * \param index Индекс
+             * \return Значение циклического буфера
+             */
+            T& operator[](std::size_t index) {
+                if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+                return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            }
+
+            /** \brief Получить значение циклического буфера по индексу
+             * \param index Индекс
+             * \return Значение циклического буфера
+             */
+            const T& operator[](std::size_t index) const {
+                if(is_test) return buffer_test[(offset_test + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+                return buffer[(offset + (is_power_of_two ? index : (index - buffer_offset))) & mask];
+            }
+
+            /** \brief Доступ к первому элементу
+             * \return Возвращает ссылку на первый элемент циклического буфера
+             */
+            inline T &front() {
+                if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
+                return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            }
+
+            /** \brief Доступ к первому элементу
+             * \return Возвращает ссылку на первый элемент циклического буфера
+             */
+            inline const T &front() const {
+                if(is_test) return buffer_test[(offset_test - (is_power_of_two ? 0 : buffer_offset)) & mask];
+                return buffer[(offset - (is_power_of_two ? 0 : buffer_offset)) & mask];
+            }
+
+            /** \brief Доступ к последнему элементу
+             * \return Возвращает ссылку на первый элемент циклического буфера
+             */
+            inline T &back() {
+                if(is_test) return buffer_test[(offset_test - 1) & mask];
+                return buffer[(offset - 1) & mask];
+            }
+
+            /** \brief Доступ к последнему элементу
+             * \return Возвращает ссылку на первый элемент циклического буфера
+             */
+            inline const T &back() const {
+                if(is_test) return buffer_test[(offset_test - 1) & mask];
+                return buffer[(offset - 1) & mask];
+            }
+
+            /** \brief Доступ к среднему элементу
+             * \return Возвращает ссылку на первый элемент циклического буфера
+             */
+            inline T &middle() {
+                if(is_test) {
+                    if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+                    else return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
+                }
+                if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+                else return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+            }
+
+            /** \brief Доступ к среднему элементу
+             * \return Возвращает ссылку на первый элемент циклического буфера
+             */
+            inline const T &middle() const {
+                if(is_test) {
+                    if(full()) return buffer_test[(offset_test + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+                    return buffer_test[(offset_test + (is_power_of_two ? (count_test/2) : (count_test/2) - buffer_offset)) & mask];
+                }
+                if(full()) return buffer[(offset + (is_power_of_two ? buffer_size_div2 : buffer_size_div2 - buffer_offset)) & mask];
+                return buffer[(offset + (is_power_of_two ? (count/2) : (count/2) - buffer_offset)) & mask];
+            }
+
+            /** \brief Получить сумму
+             * \return Возвращает сумму элементов циклического буфера
+             */
+            inline const T sum() const {
+                T temp = 0;
+                if(is_test) {
+                    if(is_power_of_two) {
+                        for(uint32_t index = 0; index < buffer_size; ++index) {
+                            temp += buffer_test[(offset_test + index) & mask];
+                        }
+                        return temp;
+                    } else {
+                        for(uint32_t index = 0; index < buffer_size; ++index) {
+                            temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
+                        }
+                        return temp;
+                    }
+                } else {
+                    if(is_power_of_two) {
+                        for(uint32_t index = 0; index < buffer_size; ++index) {
+                            temp += buffer[(offset + index) & mask];
+                        }
+                        return temp;
+                    } else {
+                        for(uint32_t index = 0; index < buffer_size; ++index) {
+                            temp += buffer[(offset + (index - buffer_offset)) & mask];
+                        }
+                        return temp;
+                    }
+                }
+            }
+
+            /** \brief Получить сумму
+             * \param start_index Начальный индекс
+             * \param stop_index Конечный индекс
+             * \return Возвращает сумму элементов циклического буфера
+             */
+            inline const T sum(const uint32_t start_index, const uint32_t stop_index) const {
+                T temp = 0;
+                if(is_test) {
+                    if(is_power_of_two) {
+                        for(uint32_t index = start_index; index < stop_index; ++index) {
+                            temp += buffer_test[(offset_test + index) & mask];
+                        }
+                        return temp;
+                    } else {
+                        for(uint32_t index = start_index; index < stop_index; ++index) {
+                            temp += buffer_test[(offset_test + (index - buffer_offset)) & mask];
+                        }
+                        return temp;
+                    }
+                } else {
+                    if(is_power_of_two) {
+                        for(uint32_t index = start_index; index < stop_index; ++index) {
+                            temp += buffer[(offset + index) & mask];
+                        }
+                        return temp;
+                    } else {
+                        for(uint32_t index = start_index; index < stop_index; ++index) {
+                            temp += buffer[(offset + (index - buffer_offset)) & mask];
+                        }
+                        return temp;
+                    }
+                }
+            }
+
+            /** \brief Получить среднее значение
+             * \return Возвращает среднее значение элементов циклического буфера
+             */
+            inline const T mean() const {
+                return sum() / (T)buffer_size;
+            }
+
+            /** \brief Преобразовать к вектору
+             * \return Вектор
+             */
+            std::vector<T> to_vector() {
+                std::vector<T> temp;
+                temp.reserve(buffer_size);
+                const uint32_t max_index = buffer_size - 1;
+                if(is_test) {
+                    uint32_t start_index = 0;
+                    uint32_t stop_index = 0;
+                    if(is_power_of_two) {
+                        start_index = (offset_test) & mask;
+                        stop_index = (offset_test + max_index) & mask;
+                    } else {
+                        start_index = (offset_test - buffer_offset) & mask;
+                        stop_index = (offset_test + (max_index - buffer_offset)) & mask;
+                    }
+                    if(start_index > stop_index) {
+                        std::copy(buffer_test.begin() + start_index, buffer_test.end(), std::back_inserter(temp));
+                        std::copy(buffer_test.begin(), buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
+                    } else {
+                        std::copy(buffer_test.begin() + start_index, buffer_test.begin() + stop_index + 1, std::back_inserter(temp));
+                    }
+                } else {
+                    uint32_t start_index = 0;
+                    uint32_t stop_index = 0;
+                    if(is_power_of_two) {
+                        start_index = offset & mask;
+                        stop_index = (offset + max_index) & mask;
+                    } else {
+                        start_index = (offset- buffer_offset) & mask;
+                        stop_index = (offset + (max_index - buffer_offset)) & mask;
+                    }
+                    if(start_index > stop_index) {
+                        std::copy(buffer.begin() + start_index, buffer.end(), std::back_inserter(temp));
+                        std::copy(buffer.begin(), buffer.begin() + stop_index + 1, std::back_inserter(temp));
+                    } else {
+                        std::copy(buffer.begin() + start_index, buffer.begin() + stop_index + 1, std::back_inserter(temp));
+                    }
+                }
+                return temp;
+            }
+
+            /** \brief Очистить данные циклического буфера
+             */
+            inline void clear() {
+                count = 0;
+                count_test = 0;
+                offset = 0;
+                offset_test = 0;
+                is_test = false;
+                //fill(0);
+            }
+
+        };
+}
+
+static int errors = 0;
+
+static void check(const std::string &name, const size_t size, const size_t step, const double a, const double b) {
+    if (a == b) return;
+    if (errors < 10) {
+        std::cout << "error! " << name << " size " << size << " step " << step << " " << a << " != " << b << std::endl;
+    }
+    ++errors;
+}
+
+static void compare(xtechnical::circular_buffer<double> &a, reference::circular_buffer<double> &b,
+        const size_t n, const size_t step, const bool cleared) {
+    check("size", n, step, a.size(), b.size());
+    check("empty", n, step, a.empty(), b.empty());
+    check("full", n, step, a.full(), b.full());
+    if (a.empty()) return;
+    check("back", n, step, a.back(), b.back());
+    /* после clear() незаполненные ячейки содержат старые значения в разных местах */
+    const bool all = !cleared || a.full();
+    const size_t first = all ? 0 : n - a.size();
+    for (size_t i = first; i < n; ++i) check("[i]", n, step, a[i], b[i]);
+    if (!all) return;
+    check("front", n, step, a.front(), b.front());
+    check("middle", n, step, a.middle(), b.middle());
+    check("sum", n, step, a.sum(), b.sum());
+    check("sum range", n, step, a.sum(n / 3, n), b.sum(n / 3, n));
+    check("mean", n, step, a.mean(), b.mean());
+    const std::vector<double> va = a.to_vector();
+    const std::vector<double> vb = b.to_vector();
+    check("to_vector size", n, step, va.size(), vb.size());
+    for (size_t i = 0; i < std::min(va.size(), vb.size()); ++i) check("to_vector", n, step, va[i], vb[i]);
+}
+
+static void check_size(const size_t n) {
+    std::mt19937 gen(n);
+    std::uniform_int_distribution<int> op(0, 99);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    xtechnical::circular_buffer<double> a(n);
+    reference::circular_buffer<double> b(n);
+    bool cleared = false;
+    for (size_t step = 0; step < 20 * n + 100; ++step) {
+        const int k = op(gen);
+        const double v = value(gen);
+        if (k < 60) {
+            check("update", n, step, a.update(v), b.update(v));
+        } else if (k < 98) {
+            check("test", n, step, a.test(v), b.test(v));
+        } else {
+            a.clear();
+            b.clear();
+            cleared = true;
+        }
+        compare(a, b, n, step, cleared);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    for (size_t n = 1; n <= 70; ++n) check_size(n);
+    check_size(1025);
+
+    /* скорость: update и test чередуются, как при работе с незакрытым баром */
+    const size_t sizes[] = {15, 64, 1025};
+    std::vector<double> prices(100000);
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    double price = 1.0;
+    for (auto &p : prices) p = (price += noise(gen));
+    for (const size_t n : sizes) {
+        double sink = 0;
+        xtechnical::circular_buffer<double> a(n);
+        reference::circular_buffer<double> b(n);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) {
+            a.test(p + 0.0001);
+            sink += a.front();
+            a.update(p);
+            sink += a.front();
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) {
+            b.test(p + 0.0001);
+            sink += b.front();
+            b.update(p);
+            sink += b.front();
+        }
+        auto t3 = std::chrono::high_resolution_clock::now();
+        const double count = (double)prices.size();
+        std::cout << "size " << std::setw(5) << n << std::fixed << std::setprecision(2)
+            << " exact size " << std::setw(8) << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / count << " ns"
+            << " power of two " << std::setw(8) << std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / count << " ns"
+            << std::endl;
+        if (std::isinf(sink)) std::cout << sink << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
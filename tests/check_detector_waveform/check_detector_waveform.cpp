@@ -0,0 +1,174 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include "xtechnical_indicators.hpp"
+
+/* сравнение DetectorWaveform (все длины за один проход)
+ * с прежним расчетом через сортировку фрагмента для каждой длины
+ */
+
+/* прежняя реализация */
+template <typename T>
+class DetectorWaveformReference {
+private:
+    xtechnical::MW<T> iMW;
+    const size_t MIN_WAVEFORM_LEN = 3;
+    T coeff_exp = 3.141592;
+    std::vector<std::vector<T>> exp_data_up_;
+    std::vector<std::vector<T>> exp_data_dn_;
+
+    void init_exp_data_up(std::vector<T> &data) {
+        T dt = 1.0/(T)data.size();
+        for(size_t i = 0; i < data.size(); ++i) {
+            data[i] = exp(coeff_exp*(T)i*dt);
+        }
+        xtechnical::normalization::calculate_min_max(
+            data,
+            data,
+            xtechnical::common::MINMAX_UNSIGNED);
+    }
+
+    void init_exp_data_dn(std::vector<T> &data) {
+        T dt = 1.0/(T)data.size();
+        for(size_t i = 0; i < data.size(); ++i) {
+            data[i] = -exp(coeff_exp*(T)i*dt);
+        }
+        xtechnical::normalization::calculate_min_max(
+            data,
+            data,
+            xtechnical::common::MINMAX_UNSIGNED);
+    }
+public:
+    /** \brief Инициализировать класс
+     * \param max_len максимальная длина файла
+     */
+    DetectorWaveformReference(const size_t max_len) : iMW(max_len) {
+        if(max_len < MIN_WAVEFORM_LEN) return;
+        size_t max_num_exp_data = max_len - MIN_WAVEFORM_LEN + 1;
+        exp_data_up_.resize(max_num_exp_data);
+        exp_data_dn_.resize(max_num_exp_data);
+        for(size_t l = MIN_WAVEFORM_LEN; l <= max_len; ++l) {
+            exp_data_up_[l-MIN_WAVEFORM_LEN].resize(l);
+            exp_data_dn_[l-MIN_WAVEFORM_LEN].resize(l);
+            init_exp_data_up(exp_data_up_[l-MIN_WAVEFORM_LEN]);
+            init_exp_data_dn(exp_data_dn_[l-MIN_WAVEFORM_LEN]);
+        }
+    }
+
+    int update(T in, T &out, const size_t len_waveform) {
+        std::vector<T> mw_out;
+        int err = iMW.update(in, mw_out);
+        if(err == xtechnical::common::OK) {
+            if(mw_out.size() >= MIN_WAVEFORM_LEN &&
+                len_waveform <= mw_out.size()) {
+                std::vector<T> fragment_data;
+                fragment_data.insert(
+                    fragment_data.begin(),
+                    mw_out.begin() + mw_out.size() - len_waveform,
+                    mw_out.end());
+                int err_n = xtechnical::normalization::calculate_min_max(
+                    fragment_data,
+                    fragment_data,
+                    xtechnical::common::MINMAX_UNSIGNED);
+                if(err_n != xtechnical::common::OK) return err_n;
+                T coeff_up = 0, coeff_dn = 0;
+                int err_up = xtechnical::correlation::calculate_spearman_rank_correlation_coefficient(
+                    fragment_data,
+                    exp_data_up_[len_waveform-MIN_WAVEFORM_LEN],
+                    coeff_up);
+
+                int err_dn = xtechnical::correlation::calculate_spearman_rank_correlation_coefficient(
+                    fragment_data,
+                    exp_data_dn_[len_waveform-MIN_WAVEFORM_LEN],
+                    coeff_dn);
+                if(err_up != xtechnical::common::OK) return err_up;
+                if(err_dn != xtechnical::common::OK) return err_dn;
+                if(std::abs(coeff_up) > std::abs(coeff_dn)) {
+                    out = coeff_up;
+                } else {
+                    out = coeff_dn;
+                }
+                return xtechnical::common::OK;
+            }
+        }
+        return err;
+    }
+
+    void clear() {
+        iMW.clear();
+    }
+};
+
+static int errors = 0;
+
+static void check(const char *name, const size_t i, const int len, const double a, const double b) {
+    if (std::isnan(a) && std::isnan(b)) return;
+    if (std::abs(a - b) <= 1e-12) return;
+    if (errors < 10) {
+        std::cout << "error! " << name << " index " << i << " len " << len << " " << a << " != " << b << std::endl;
+    }
+    ++errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const int max_len = 30;
+    xtechnical::DetectorWaveform<double> detector(max_len);
+    std::vector<DetectorWaveformReference<double>> reference(max_len + 1, DetectorWaveformReference<double>(max_len));
+
+    /* цены с шагом 1 пункт, чтобы были одинаковые значения */
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> step(-2, 2);
+    std::vector<double> prices;
+    double price = 1.0;
+    for (size_t i = 0; i < 3000; ++i) {
+        price += 0.0001 * step(gen);
+        prices.push_back(price);
+    }
+
+    for (size_t i = 0; i < prices.size(); ++i) {
+        const int err = detector.update(prices[i]);
+        for (int len = 3; len <= max_len; ++len) {
+            double out = std::numeric_limits<double>::quiet_NaN();
+            const int err_ref = reference[len].update(prices[i], out, len);
+            if (err != err_ref) {
+                if (errors < 10) std::cout << "error! code index " << i << std::endl;
+                ++errors;
+            }
+            if (err != xtechnical::common::OK) continue;
+            check("coeff", i, len, detector.get(len), out);
+        }
+        if (i == prices.size() - 1) {
+            std::cout << "len 5 " << detector.get(5) << " len 30 " << detector.get(30) << std::endl;
+        }
+    }
+
+    /* скорость: все длины за один проход против одной длины прежним способом */
+    const int lens[] = {16, 64, 256};
+    for (const int len : lens) {
+        xtechnical::DetectorWaveform<double> a(len);
+        DetectorWaveformReference<double> b(len);
+        double sink = 0, out = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) { a.update(p); sink += a.get(len); }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) { b.update(p, out, len); sink += out; }
+        auto t3 = std::chrono::high_resolution_clock::now();
+        const double ta = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)prices.size();
+        const double tb = std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / (double)prices.size();
+        std::cout << "max_len " << std::setw(4) << len
+            << " previous (one length) " << std::fixed << std::setprecision(1) << std::setw(9) << tb
+            << " ns, all lengths " << std::setw(9) << ta << " ns" << std::endl;
+        if (std::isinf(sink)) std::cout << sink << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
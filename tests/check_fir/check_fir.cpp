@@ -0,0 +1,236 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include "xtechnical_indicators.hpp"
+
+/* проверка КИХ-фильтра:
+ * update и test совпадают побитово, update_many через БПФ совпадает
+ * с update в пределах ошибок округления, NoLagMa на КИХ-фильтре
+ * совпадает с прежней реализацией, которая хранила всю историю цен
+ */
+
+static int errors = 0;
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    if (errors < 20) std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+static bool near(const double a, const double b, const double eps) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return std::abs(a - b) <= eps * std::max(1.0, std::abs(b));
+}
+
+/** \brief Прежняя реализация NoLagMa: история всех цен и скалярный цикл
+ */
+class ReferenceNoLagMa {
+private:
+    std::vector<double> prices;
+    std::vector<double> alphas;
+    double weight = 0;
+public:
+    ReferenceNoLagMa(const int length) {
+        const double Pi = 3.14159265358979323846264338327950288;
+        const double Cycle = 4.0, Coeff = 3.0 * Pi;
+        const int Phase = length - 1;
+        const int len = length * 4 + Phase;
+        for (int k = 0; k < len; k++) {
+            double t = k <= Phase - 1 ? 1.0 * k / (Phase - 1) :
+                1.0 + (k - Phase + 1) * (2.0 * Cycle - 1.0) / (Cycle * (double)length - 1.0);
+            double g = t <= 0.5 ? 1.0 : 1.0 / (Coeff * t + 1);
+            alphas.push_back(g * std::cos(Pi * t));
+            weight += alphas.back();
+        }
+    }
+
+    double calc(const double price, const bool is_test) {
+        prices.push_back(price);
+        const int r = (int)prices.size() - 1;
+        double sum = 0;
+        for (int k = 0; k < (int)alphas.size() && (r - k) >= 0; k++) sum += alphas[k] * prices[r - k];
+        if (is_test) prices.pop_back();
+        return sum / weight;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(50);
+    std::normal_distribution<double> noise(0.0, 0.0002);
+    std::uniform_real_distribution<double> unif(-1.0, 1.0);
+    std::vector<double> prices;
+    double price = 1.1;
+    for (size_t i = 0; i < 20000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    /* update, test и прямой расчет окна */
+    const size_t lengths[] = {1, 3, 7, 16, 45, 200};
+    for (const size_t n : lengths) {
+        std::vector<double> weights(n);
+        for (auto &w : weights) w = unif(gen);
+        xtechnical::FirFilter<double> fir(weights);
+        xtechnical::FirFilter<double> fir_zero(weights, true);
+        const std::string name = "FIR " + std::to_string(n);
+        for (size_t i = 0; i < 2000; ++i) {
+            double out_test = 0, out = 0;
+            const int err_test = fir.test(prices[i], out_test);
+            const int err = fir.update(prices[i], out);
+            check(err_test == err, name + " error code, step " + std::to_string(i));
+            check(std::memcmp(&out, &out_test, sizeof(double)) == 0, name + " test, step " + std::to_string(i));
+            check((err == xtechnical::common::OK) == (i + 1 >= n), name + " ready, step " + std::to_string(i));
+
+            double expected = 0;
+            for (size_t k = 0; k < n && k <= i; ++k) expected += weights[n - 1 - k] * prices[i - k];
+            if (i + 1 >= n) check(near(out, expected, 1e-13), name + " value, step " + std::to_string(i));
+            fir_zero.update(prices[i], out);
+            check(near(out, expected, 1e-13), name + " zero padding, step " + std::to_string(i));
+        }
+    }
+
+    /* update_many: короткое ядро побитово, длинное через БПФ */
+    const size_t batch_lengths[] = {5, 64, 300};
+    for (const size_t n : batch_lengths) {
+        std::vector<double> weights(n);
+        for (auto &w : weights) w = unif(gen);
+        xtechnical::FirFilter<double> fir(weights), fir_many(weights);
+        const std::string name = "FIR " + std::to_string(n) + " update_many";
+        std::vector<double> out(prices.size()), out_many(prices.size());
+        size_t start = 0, size = 1;
+        int err = 0, err_many = 0;
+        while (start < prices.size()) {
+            size = std::min(size * 3 + 1, prices.size() - start);
+            for (size_t i = start; i < start + size; ++i) err = fir.update(prices[i], out[i]);
+            err_many = fir_many.update_many(prices.data() + start, size, out_many.data() + start);
+            check(err == err_many, name + " error code, start " + std::to_string(start));
+            start += size;
+        }
+        const double eps = n < XTECHNICAL_FIR_FFT_MIN_SIZE ? 0 : 1e-12;
+        for (size_t i = 0; i < prices.size(); ++i) {
+            if (near(out_many[i], out[i], eps)) continue;
+            check(false, name + " index " + std::to_string(i) + " " + std::to_string(out_many[i]) + " " + std::to_string(out[i]));
+            break;
+        }
+        /* после update_many состояние то же, что после update */
+        double a = 0, b = 0;
+        fir.update(1.2, a);
+        fir_many.update(1.2, b);
+        check(a == b, name + " state");
+    }
+
+    /* NoLagMa совпадает с прежней реализацией */
+    const int nlm_periods[] = {5, 10, 20};
+    for (const int period : nlm_periods) {
+        xtechnical::NoLagMa<double> nlm(period);
+        ReferenceNoLagMa reference(period);
+        const std::string name = "NoLagMa " + std::to_string(period);
+        for (size_t i = 0; i < 3000; ++i) {
+            double out = 0;
+            nlm.test(prices[i] + 0.001, out);
+            check(near(out, reference.calc(prices[i] + 0.001, true), 1e-12), name + " test, step " + std::to_string(i));
+            check(nlm.update(prices[i], out) == xtechnical::common::OK, name + " error code, step " + std::to_string(i));
+            check(near(out, reference.calc(prices[i], false), 1e-12), name + " update, step " + std::to_string(i));
+        }
+        /* после clear цены до первой снова считаются нулевыми */
+        nlm.clear();
+        ReferenceNoLagMa fresh(period);
+        double out = 0;
+        nlm.update(prices[0], out);
+        check(near(out, fresh.calc(prices[0], false), 1e-12), name + " clear");
+    }
+
+    /* WMA выражается через КИХ-фильтр с линейными весами */
+    {
+        const size_t period = 20;
+        std::vector<double> weights(period);
+        for (size_t i = 0; i < period; ++i) weights[i] = 2.0 * (double)(i + 1) / ((double)period * ((double)period + 1.0));
+        xtechnical::FirFilter<double> fir(weights);
+        xtechnical::WMA<double> wma(period);
+        for (size_t i = 0; i < 2000; ++i) {
+            double a = 0, b = 0;
+            const int err_a = fir.update(prices[i], a);
+            const int err_b = wma.update(prices[i], b);
+            check(err_a == err_b && near(a, b, 1e-13), "WMA, step " + std::to_string(i));
+        }
+    }
+
+    /* сохранение и загрузка состояния */
+    {
+        std::vector<double> weights(9);
+        for (auto &w : weights) w = unif(gen);
+        xtechnical::FirFilter<double> fir(weights), fir_copy(weights), fir_other(std::vector<double>(9, 1.0));
+        for (size_t i = 0; i < 100; ++i) fir.update(prices[i]);
+        std::vector<uint8_t> data;
+        xtechnical::StateWriter writer(data);
+        fir.save_state(writer);
+        xtechnical::StateReader reader(data.data(), data.size());
+        check(fir_copy.load_state(reader), "load_state");
+        /* неудачная загрузка не меняет фильтр */
+        xtechnical::FirFilter<double> fir_other_twin(std::vector<double>(9, 1.0));
+        fir_other.update(prices[0]);
+        fir_other_twin.update(prices[0]);
+        xtechnical::StateReader reader_other(data.data(), data.size());
+        check(!fir_other.load_state(reader_other), "load_state with other weights");
+        double a = 0, b = 0;
+        const int err_a = fir_other.update(prices[1], a);
+        const int err_b = fir_other_twin.update(prices[1], b);
+        check(err_a == err_b && (a == b || (std::isnan(a) && std::isnan(b))), "state after failed load_state");
+        for (size_t i = 100; i < 200; ++i) {
+            fir.update(prices[i]);
+            fir_copy.update(prices[i]);
+            check(fir.get() == fir_copy.get(), "state copy, step " + std::to_string(i));
+        }
+    }
+
+    /* время */
+    {
+        const int period = 20;
+        xtechnical::NoLagMa<double> nlm(period);
+        ReferenceNoLagMa reference(period);
+        double sink = 0, out = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < prices.size(); ++i) {
+            nlm.update(prices[i], out);
+            sink += out;
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        const double time_fir = std::chrono::duration<double, std::nano>(stop - start).count() / prices.size();
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < prices.size(); ++i) {
+            sink += reference.calc(prices[i], false);
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        const double time_reference = std::chrono::duration<double, std::nano>(stop - start).count() / prices.size();
+        std::cout << "NoLagMa(" << period << ") update: fir " << time_fir << " ns, scalar loop " << time_reference << " ns" << std::endl;
+
+        const size_t n = 1024;
+        std::vector<double> weights(n);
+        for (auto &w : weights) w = unif(gen);
+        xtechnical::FirFilter<double> fir(weights), fir_many(weights);
+        std::vector<double> result(prices.size());
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < prices.size(); ++i) fir.update(prices[i], result[i]);
+        stop = std::chrono::high_resolution_clock::now();
+        const double time_direct = std::chrono::duration<double, std::micro>(stop - start).count();
+        start = std::chrono::high_resolution_clock::now();
+        fir_many.update_many(prices.data(), prices.size(), result.data());
+        stop = std::chrono::high_resolution_clock::now();
+        const double time_fft = std::chrono::duration<double, std::micro>(stop - start).count();
+        std::cout << "FIR " << n << " taps, " << prices.size() << " values: update " << time_direct
+            << " us, update_many (FFT) " << time_fft << " us (" << sink << ")" << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include "xtechnical_indicators.hpp"
+
+/* сравнение индикаторов с периодом времени компиляции (xtechnical::fixed)
+ * с обычными индикаторами: совпадение значений update/test и скорость
+ */
+
+static std::vector<double> prices;
+static int errors = 0;
+
+static void check(const std::string &name, const size_t i, const double a, const double b) {
+    if (std::isnan(a) && std::isnan(b)) return;
+    if (a == b) return;
+    if (errors < 10) {
+        std::cout << "error! " << name << " index " << i << " " << a << " != " << b << std::endl;
+    }
+    ++errors;
+}
+
+template<class F>
+static double measure(F f) {
+    auto t1 = std::chrono::high_resolution_clock::now();
+    f();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)prices.size();
+}
+
+static void print(const std::string &name, const size_t period, const double runtime_ns, const double fixed_ns) {
+    std::cout << std::setw(16) << name
+        << std::setw(8) << period
+        << std::setw(14) << std::fixed << std::setprecision(2) << runtime_ns
+        << std::setw(14) << fixed_ns
+        << std::setw(10) << (runtime_ns / fixed_ns) << "x" << std::endl;
+}
+
+template<size_t N>
+void check_period() {
+    /* совпадение значений, update чередуется с test */
+    xtechnical::SMA<double> sma(N);
+    xtechnical::fixed::SMA<double, N> fsma;
+    xtechnical::EMA<double> ema(N);
+    xtechnical::fixed::EMA<double, N> fema;
+    xtechnical::RSI<double, xtechnical::SMA<double>> rsi(N);
+    xtechnical::fixed::RSI<double, N> frsi;
+    xtechnical::StdDev<double> std_dev(N);
+    xtechnical::fixed::StdDev<double, N> fstd_dev;
+    xtechnical::BollingerBands<double> bb(N, 2);
+    xtechnical::fixed::BollingerBands<double, N> fbb(2);
+    xtechnical::FastMinMax<double> min_max(N, 3);
+    xtechnical::fixed::FastMinMax<double, N, 3> fmin_max;
+
+    for (size_t i = 0; i < 5000; ++i) {
+        const double in = prices[i];
+        const double in_test = prices[i] + 0.5 * (prices[i + 1] - prices[i]);
+        sma.test(in_test); fsma.test(in_test);
+        check("SMA test", i, sma.get(), fsma.get());
+        ema.test(in_test); fema.test(in_test);
+        check("EMA test", i, ema.get(), fema.get());
+        rsi.test(in_test); frsi.test(in_test);
+        check("RSI test", i, rsi.get(), frsi.get());
+        std_dev.test(in_test); fstd_dev.test(in_test);
+        check("StdDev test", i, std_dev.get(), fstd_dev.get());
+        bb.test(in_test); fbb.test(in_test);
+        check("BB test", i, bb.get_tl(), fbb.get_tl());
+        min_max.test(in_test); fmin_max.test(in_test);
+        check("MinMax test", i, min_max.get_max(), fmin_max.get_max());
+        check("MinMax test", i, min_max.get_min(), fmin_max.get_min());
+
+        sma.update(in); fsma.update(in);
+        check("SMA", i, sma.get(), fsma.get());
+        ema.update(in); fema.update(in);
+        check("EMA", i, ema.get(), fema.get());
+        rsi.update(in); frsi.update(in);
+        check("RSI", i, rsi.get(), frsi.get());
+        std_dev.update(in); fstd_dev.update(in);
+        check("StdDev", i, std_dev.get(), fstd_dev.get());
+        bb.update(in); fbb.update(in);
+        check("BB", i, bb.get_tl(), fbb.get_tl());
+        check("BB", i, bb.get_bl(), fbb.get_bl());
+        min_max.update(in); fmin_max.update(in);
+        check("MinMax", i, min_max.get_max(), fmin_max.get_max());
+        check("MinMax", i, min_max.get_min(), fmin_max.get_min());
+    }
+
+    /* скорость update */
+    double sink = 0;
+    {
+        xtechnical::SMA<double> a(N);
+        xtechnical::fixed::SMA<double, N> b;
+        const double ta = measure([&]{ for (auto &p : prices) { a.update(p); sink += a.get(); } });
+        const double tb = measure([&]{ for (auto &p : prices) { b.update(p); sink += b.get(); } });
+        print("SMA", N, ta, tb);
+    }
+    {
+        xtechnical::EMA<double> a(N);
+        xtechnical::fixed::EMA<double, N> b;
+        const double ta = measure([&]{ for (auto &p : prices) { a.update(p); sink += a.get(); } });
+        const double tb = measure([&]{ for (auto &p : prices) { b.update(p); sink += b.get(); } });
+        print("EMA", N, ta, tb);
+    }
+    {
+        xtechnical::RSI<double, xtechnical::SMA<double>> a(N);
+        xtechnical::fixed::RSI<double, N> b;
+        const double ta = measure([&]{ for (auto &p : prices) { a.update(p); sink += a.get(); } });
+        const double tb = measure([&]{ for (auto &p : prices) { b.update(p); sink += b.get(); } });
+        print("RSI", N, ta, tb);
+    }
+    {
+        xtechnical::StdDev<double> a(N);
+        xtechnical::fixed::StdDev<double, N> b;
+        const double ta = measure([&]{ for (auto &p : prices) { a.update(p); sink += a.get(); } });
+        const double tb = measure([&]{ for (auto &p : prices) { b.update(p); sink += b.get(); } });
+        print("StdDev", N, ta, tb);
+    }
+    {
+        xtechnical::BollingerBands<double> a(N, 2);
+        xtechnical::fixed::BollingerBands<double, N> b(2);
+        const double ta = measure([&]{ for (auto &p : prices) { a.update(p); sink += a.get_tl(); } });
+        const double tb = measure([&]{ for (auto &p : prices) { b.update(p); sink += b.get_tl(); } });
+        print("BollingerBands", N, ta, tb);
+    }
+    {
+        xtechnical::FastMinMax<double> a(N);
+        xtechnical::fixed::FastMinMax<double, N> b;
+        const double ta = measure([&]{ for (auto &p : prices) { a.update(p); sink += a.get_max(); } });
+        const double tb = measure([&]{ for (auto &p : prices) { b.update(p); sink += b.get_max(); } });
+        print("FastMinMax", N, ta, tb);
+    }
+    {
+        xtechnical::BollingerBands<double> a(N, 2);
+        xtechnical::fixed::BollingerBands<double, N> b(2);
+        const double ta = measure([&]{ for (auto &p : prices) { a.test(p); sink += a.get_tl(); } });
+        const double tb = measure([&]{ for (auto &p : prices) { b.test(p); sink += b.get_tl(); } });
+        print("BB test", N, ta, tb);
+    }
+    if (std::isinf(sink)) std::cout << sink << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    double price = 1.0;
+    for (size_t i = 0; i < 200000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    std::cout << std::setw(16) << "indicator"
+        << std::setw(8) << "period"
+        << std::setw(14) << "runtime ns"
+        << std::setw(14) << "fixed ns"
+        << std::setw(11) << "speedup" << std::endl;
+
+    check_period<5>();
+    check_period<8>();
+    check_period<14>();
+    check_period<20>();
+    check_period<50>();
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include "xtechnical_indicators.hpp"
+
+/* сравнение FreqHist (нормализация, окно и ДПФ за один проход)
+ * с прежним расчетом: копия окна MW, нормализация, DftReal::update
+ */
+
+/* прежний расчет */
+template<class T>
+class FreqHistReference {
+private:
+    xtechnical::MW<T> iMW;
+    xtechnical::dft::DftReal<T> iDftReal;
+public:
+    FreqHistReference(const size_t period, const size_t window_type) :
+        iMW(period), iDftReal(period, window_type) {};
+
+    int update(
+            const T &input,
+            std::vector<T> &amplitude,
+            std::vector<T> &frequencies,
+            const T sample_rate = 0) {
+        int err = iMW.update(input);
+        if(err != xtechnical::common::OK) return err;
+        std::vector<T> buffer;
+        iMW.get_data(buffer);
+        xtechnical::normalization::calculate_min_max(
+            buffer,
+            buffer,
+            xtechnical::common::MINMAX_SIGNED);
+        return iDftReal.update(buffer, amplitude, frequencies, sample_rate);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(13);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    std::vector<double> prices;
+    double price = 1.1;
+    for (size_t i = 0; i < 3000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+    /* постоянный участок: нормализация дает нули */
+    for (size_t i = 0; i < 100; ++i) prices.push_back(price);
+
+    const size_t window_types[] = {
+        xtechnical::dft::RECTANGULAR_WINDOW,
+        xtechnical::dft::BLACKMAN_HARRIS_WINDOW,
+        xtechnical::dft::HAMMING_WINDOW,
+        xtechnical::dft::HANN_WINDOW};
+    double max_error = 0;
+    int errors = 0;
+    for (const size_t window_type : window_types) {
+        const size_t period = 64;
+        xtechnical::FreqHist<double> freq_hist(period, window_type);
+        FreqHistReference<double> reference(period, window_type);
+        std::vector<double> amplitude, frequencies, ref_amplitude, ref_frequencies;
+        for (size_t i = 0; i < prices.size(); ++i) {
+            const int err = freq_hist.update(prices[i], amplitude, frequencies, 100);
+            const int err_ref = reference.update(prices[i], ref_amplitude, ref_frequencies, 100);
+            if (err != err_ref) ++errors;
+            if (err != xtechnical::common::OK) continue;
+            if (amplitude.size() != ref_amplitude.size() || frequencies != ref_frequencies) {
+                ++errors;
+                continue;
+            }
+            for (size_t j = 0; j < amplitude.size(); ++j) {
+                max_error = std::max(max_error, std::abs(amplitude[j] - ref_amplitude[j]));
+            }
+        }
+
+        double sink = 0;
+        xtechnical::FreqHist<double> a(period, window_type);
+        FreqHistReference<double> b(period, window_type);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) { a.update(p, amplitude, frequencies); sink += amplitude[1]; }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) { b.update(p, ref_amplitude, ref_frequencies); sink += ref_amplitude[1]; }
+        auto t3 = std::chrono::high_resolution_clock::now();
+        const double ta = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)prices.size();
+        const double tb = std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / (double)prices.size();
+        std::cout << "window " << window_type
+            << " previous " << std::fixed << std::setprecision(1) << std::setw(9) << tb
+            << " ns, fused " << std::setw(9) << ta << " ns" << std::endl;
+        if (std::isinf(sink)) std::cout << sink << std::endl;
+    }
+    std::cout << "max error " << std::scientific << max_error << std::endl;
+    if (errors || max_error > 1e-9) {
+        std::cout << "error!" << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
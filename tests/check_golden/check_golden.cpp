@@ -0,0 +1,522 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include "xtechnical_indicators.hpp"
+
+/* регрессионная проверка индикаторов по эталонным значениям
+ *
+ * Детерминированный набор тиков и баров проходит через update и test
+ * каждого индикатора, результаты сравниваются с эталонным файлом golden.bin
+ * с допуском в ULP или относительной ошибке. NaN должен совпадать точно.
+ *
+ * check_golden                        проверить по эталонному файлу
+ * check_golden --generate             записать эталонный файл
+ * check_golden --update=<префикс>     перезаписать в эталонном файле только ряды,
+ *                                     имена которых начинаются с префикса
+ * check_golden --file=<путь>          путь к эталонному файлу
+ * check_golden --ulp=<N> --rel=<X>    допуски сравнения
+ */
+
+#ifndef XTECHNICAL_GOLDEN_FILE
+#define XTECHNICAL_GOLDEN_FILE "golden.bin"
+#endif
+
+using namespace xtechnical;
+
+static const size_t TICKS_SIZE = 240;
+static const size_t TICKS_PER_BAR = 4;
+
+static std::vector<double> prices;
+static std::vector<double> test_prices;
+
+class Bar {
+public:
+    double open = 0, high = 0, low = 0, close = 0, volume = 0;
+};
+
+static std::vector<Bar> bars;
+static std::vector<Bar> test_bars;
+
+/* набор рядов: имя и значения */
+class Golden {
+public:
+    std::vector<std::string> names;
+    std::deque<std::vector<double>> values;   /**< deque: ссылки на ряды не меняются при добавлении */
+
+    std::vector<double> &add(const std::string &name) {
+        names.push_back(name);
+        values.push_back(std::vector<double>());
+        return values.back();
+    }
+
+    /* формат: "XTGOLD" версия(1), количество рядов (u32),
+     * для каждого ряда: длина имени (u16), имя, количество значений (u32), значения.
+     * Значение хранится как XOR битов с предыдущим значением ряда:
+     * байт с количеством значащих байт и сами значащие байты (младшие первыми)
+     */
+    bool save(const std::string &file_name) const {
+        std::ofstream file(file_name, std::ios::binary);
+        if (!file) return false;
+        file.write("XTGOLD", 6);
+        file.put(1);
+        write_u32(file, (uint32_t)names.size());
+        for (size_t s = 0; s < names.size(); ++s) {
+            file.put((char)(names[s].size() & 0xFF));
+            file.put((char)(names[s].size() >> 8));
+            file.write(names[s].data(), names[s].size());
+            write_u32(file, (uint32_t)values[s].size());
+            uint64_t prev = 0;
+            for (const double v : values[s]) {
+                uint64_t bits = 0;
+                std::memcpy(&bits, &v, sizeof(bits));
+                uint64_t x = bits ^ prev;
+                prev = bits;
+                int n = 0;
+                while (n < 8 && (x >> (8 * n)) != 0) ++n;
+                file.put((char)n);
+                for (int i = 0; i < n; ++i) file.put((char)((x >> (8 * i)) & 0xFF));
+            }
+        }
+        return (bool)file;
+    }
+
+    bool load(const std::string &file_name) {
+        std::ifstream file(file_name, std::ios::binary);
+        if (!file) return false;
+        char magic[6];
+        file.read(magic, 6);
+        if (!file || std::memcmp(magic, "XTGOLD", 6) != 0 || file.get() != 1) return false;
+        const uint32_t count = read_u32(file);
+        for (uint32_t s = 0; s < count && file; ++s) {
+            const size_t len = (size_t)(uint8_t)file.get() | ((size_t)(uint8_t)file.get() << 8);
+            std::string name(len, ' ');
+            file.read(&name[0], len);
+            std::vector<double> &v = add(name);
+            const uint32_t size = read_u32(file);
+            uint64_t prev = 0;
+            for (uint32_t i = 0; i < size && file; ++i) {
+                const int n = file.get();
+                uint64_t x = 0;
+                for (int j = 0; j < n; ++j) x |= (uint64_t)(uint8_t)file.get() << (8 * j);
+                prev ^= x;
+                double d = 0;
+                std::memcpy(&d, &prev, sizeof(d));
+                v.push_back(d);
+            }
+        }
+        return (bool)file;
+    }
+
+private:
+    static void write_u32(std::ofstream &file, const uint32_t v) {
+        for (int i = 0; i < 4; ++i) file.put((char)((v >> (8 * i)) & 0xFF));
+    }
+
+    static uint32_t read_u32(std::ifstream &file) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= (uint32_t)(uint8_t)file.get() << (8 * i);
+        return v;
+    }
+};
+
+/* вызов update(in) + get() или update(in, out) */
+struct rank0 {};
+struct rank1 : rank0 {};
+
+template<class IND>
+auto step_update(IND &ind, const double in, rank1) -> decltype(ind.update(in), ind.get(), double()) {
+    ind.update(in);
+    return ind.get();
+}
+
+template<class IND>
+auto step_update(IND &ind, const double in, rank0) -> decltype(ind.update(in, std::declval<double&>()), double()) {
+    double out = std::numeric_limits<double>::quiet_NaN();
+    ind.update(in, out);
+    return out;
+}
+
+template<class IND>
+auto step_test(IND &ind, const double in, rank1) -> decltype(ind.test(in), ind.get(), double()) {
+    ind.test(in);
+    return ind.get();
+}
+
+template<class IND>
+auto step_test(IND &ind, const double in, rank0) -> decltype(ind.test(in, std::declval<double&>()), double()) {
+    double out = std::numeric_limits<double>::quiet_NaN();
+    ind.test(in, out);
+    return out;
+}
+
+template<class IND>
+auto has_test(rank1) -> decltype(step_test(std::declval<IND&>(), 0.0, rank1()), std::true_type());
+
+template<class IND>
+std::false_type has_test(rank0);
+
+template<class IND>
+void replay_test(Golden &golden, const std::string &name, IND ind, std::true_type) {
+    std::vector<double> &u = golden.add(name + "/update");
+    std::vector<double> &t = golden.add(name + "/test");
+    for (size_t i = 0; i < prices.size(); ++i) {
+        t.push_back(step_test(ind, test_prices[i], rank1()));
+        u.push_back(step_update(ind, prices[i], rank1()));
+    }
+}
+
+template<class IND>
+void replay_test(Golden &golden, const std::string &name, IND ind, std::false_type) {
+    std::vector<double> &u = golden.add(name + "/update");
+    for (size_t i = 0; i < prices.size(); ++i) {
+        u.push_back(step_update(ind, prices[i], rank1()));
+    }
+}
+
+/* индикатор с одним входом и одним выходом */
+template<class IND>
+void replay(Golden &golden, const std::string &name, IND ind) {
+    replay_test(golden, name, ind, decltype(has_test<IND>(rank1()))());
+}
+
+/* индикатор с произвольным входом и выходом:
+ * update(ind, i, out) и test(ind, i, out) добавляют значения в out
+ */
+template<class IND, class UPDATE, class TEST>
+void replay(Golden &golden, const std::string &name, const size_t size, IND ind, UPDATE update, TEST test) {
+    std::vector<double> &u = golden.add(name + "/update");
+    std::vector<double> &t = golden.add(name + "/test");
+    for (size_t i = 0; i < size; ++i) {
+        test(ind, i, t);
+        update(ind, i, u);
+    }
+}
+
+void make_corpus() {
+    /* цены в целых пунктах: результат не зависит от реализации стандартной библиотеки */
+    std::mt19937 gen(12345);
+    int64_t point = 110000;
+    for (size_t i = 0; i < TICKS_SIZE; ++i) {
+        const int64_t step = (int64_t)(gen() % 21) - 10;
+        /* участок без изменения цены */
+        if (i < 120 || i >= 135) point += step;
+        prices.push_back((double)point * 0.00001);
+        test_prices.push_back((double)(point + (int64_t)(gen() % 11) - 5) * 0.00001);
+    }
+    for (size_t i = 0; i + TICKS_PER_BAR <= prices.size(); i += TICKS_PER_BAR) {
+        Bar bar;
+        bar.open = bar.high = bar.low = prices[i];
+        for (size_t j = i; j < i + TICKS_PER_BAR; ++j) {
+            bar.high = std::max(bar.high, prices[j]);
+            bar.low = std::min(bar.low, prices[j]);
+            bar.volume += 1 + (double)(j % 3);
+        }
+        bar.close = prices[i + TICKS_PER_BAR - 1];
+        bars.push_back(bar);
+        Bar test_bar = bar;
+        test_bar.close = test_prices[i + TICKS_PER_BAR - 1];
+        test_bar.high = std::max(test_bar.high, test_bar.close);
+        test_bar.low = std::min(test_bar.low, test_bar.close);
+        test_bars.push_back(test_bar);
+    }
+}
+
+template<size_t N>
+void run_fixed(Golden &g) {
+    const std::string s = "/" + std::to_string(N);
+    replay(g, "fixed::SMA" + s, fixed::SMA<double, N>());
+    replay(g, "fixed::EMA" + s, fixed::EMA<double, N>());
+    replay(g, "fixed::RSI" + s, fixed::RSI<double, N>());
+    replay(g, "fixed::StdDev" + s, fixed::StdDev<double, N>());
+    replay(g, "fixed::DelayLine" + s, fixed::DelayLine<double, N>());
+    typedef fixed::BollingerBands<double, N> fbb_t;
+    replay(g, "fixed::BollingerBands" + s, prices.size(), fbb_t(2),
+        [](fbb_t &ind, size_t i, std::vector<double> &o) {
+            ind.update(prices[i]); o.push_back(ind.get_tl()); o.push_back(ind.get_ml()); o.push_back(ind.get_bl());
+        },
+        [](fbb_t &ind, size_t i, std::vector<double> &o) {
+            ind.test(test_prices[i]); o.push_back(ind.get_tl()); o.push_back(ind.get_ml()); o.push_back(ind.get_bl());
+        });
+    typedef fixed::FastMinMax<double, N> fmm_t;
+    replay(g, "fixed::FastMinMax" + s, prices.size(), fmm_t(),
+        [](fmm_t &ind, size_t i, std::vector<double> &o) {
+            ind.update(prices[i]); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+        },
+        [](fmm_t &ind, size_t i, std::vector<double> &o) {
+            ind.test(test_prices[i]); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+        });
+}
+
+void run_all(Golden &g) {
+    const size_t periods[] = {5, 20};
+    for (const size_t p : periods) {
+        const std::string s = "/" + std::to_string(p);
+        replay(g, "SMA" + s, SMA<double>(p));
+        replay(g, "EMA" + s, EMA<double>(p));
+        replay(g, "WMA" + s, WMA<double>(p));
+        replay(g, "MMA" + s, MMA<double>(p));
+        replay(g, "SUM" + s, SUM<double>(p));
+        replay(g, "LRMA" + s, LRMA<double>(p));
+        replay(g, "AMA" + s, AMA<double>(p));
+        replay(g, "NoLagMa" + s, NoLagMa<double>(p));
+        replay(g, "MAV" + s, MAV<double>(p));
+        replay(g, "MAZ" + s, MAZ<double>(p, p));
+        replay(g, "MAD" + s, MAD<double, SMA<double>>(p));
+        replay(g, "RSI<SMA>" + s, RSI<double, SMA<double>>(p));
+        replay(g, "RSI<EMA>" + s, RSI<double, EMA<double>>(p));
+        replay(g, "StdDev" + s, StdDev<double>(p));
+        replay(g, "Zscore" + s, Zscore<double>(p));
+        replay(g, "PercentRank" + s, PercentRank<double>(p, false));
+        replay(g, "PercentRank/offset" + s, PercentRank<double>(p, true));
+        replay(g, "PRI" + s, PRI<double>(p));
+        replay(g, "RoC" + s, RoC<double>(p));
+        replay(g, "PercentDifference" + s, PercentDifference<double>(p));
+        replay(g, "DelayLine" + s, DelayLine<double>(p));
+        replay(g, "CCI" + s, CCI<double, SMA<double>>(p));
+        replay(g, "ATR" + s, ATR<double, SMA<double>>(p));
+        replay(g, "RollingRegression/line" + s, RollingRegression<double>(p));
+        replay(g, "RollingRegression/parabola" + s, RollingRegression<double>(p, OlsFunctionType::PARABOLA));
+        replay(g, "TrendDirectionForceIndex" + s, TrendDirectionForceIndex<double, EMA<double>>(p));
+        replay(g, "CRSI" + s, CRSI<double, SMA<double>>(3, 2, p));
+        replay(g, "OsMa" + s, OsMa<double>(p / 2, p, 3));
+
+        typedef BollingerBands<double> bb_t;
+        replay(g, "BollingerBands" + s, prices.size(), bb_t(p, 2),
+            [](bb_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(prices[i]); o.push_back(ind.get_tl()); o.push_back(ind.get_ml()); o.push_back(ind.get_bl());
+            },
+            [](bb_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_prices[i]); o.push_back(ind.get_tl()); o.push_back(ind.get_ml()); o.push_back(ind.get_bl());
+            });
+        typedef MinMax<double> mm_t;
+        replay(g, "MinMax" + s, prices.size(), mm_t(p),
+            [](mm_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(prices[i]); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+            },
+            [](mm_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_prices[i]); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+            });
+        typedef FastMinMax<double> fmm_t;
+        replay(g, "FastMinMax" + s, prices.size(), fmm_t(p),
+            [](fmm_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(prices[i]); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+            },
+            [](fmm_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_prices[i]); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+            });
+        typedef MinMaxDiff<double> mmd_t;
+        replay(g, "MinMaxDiff" + s, prices.size(), mmd_t(p),
+            [](mmd_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(prices[i]); o.push_back(ind.get()); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+            },
+            [](mmd_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_prices[i]); o.push_back(ind.get()); o.push_back(ind.get_min()); o.push_back(ind.get_max());
+            });
+        typedef Stochastics<double, SMA<double>> st_t;
+        replay(g, "Stochastics" + s, prices.size(), st_t(p, 3, 3),
+            [](st_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(prices[i]); o.push_back(ind.get()); o.push_back(ind.get_k()); o.push_back(ind.get_d());
+            },
+            [](st_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_prices[i]); o.push_back(ind.get()); o.push_back(ind.get_k()); o.push_back(ind.get_d());
+            });
+        typedef DetectorWaveform<double> dw_t;
+        replay(g, "DetectorWaveform" + s, prices.size(), dw_t((int)p),
+            [](dw_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(prices[i]);
+                if (ind.get_up().empty()) return;
+                o.push_back(ind.get_up()[2]); o.push_back(ind.get_up().back());
+                o.push_back(ind.get_dn()[2]); o.push_back(ind.get_dn().back());
+            },
+            [](dw_t &, size_t, std::vector<double> &) {});
+
+        /* индикаторы баров */
+        typedef TrueRange<double> tr_t;
+        replay(g, "TrueRange/bar", bars.size(), tr_t(),
+            [](tr_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(bars[i].high, bars[i].low, bars[i].close); o.push_back(ind.get());
+            },
+            [](tr_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_bars[i].high, test_bars[i].low, test_bars[i].close); o.push_back(ind.get());
+            });
+        typedef ATR<double, SMA<double>> atr_t;
+        replay(g, "ATR/bar" + s, bars.size(), atr_t(p),
+            [](atr_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(bars[i].high, bars[i].low, bars[i].close); o.push_back(ind.get());
+            },
+            [](atr_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_bars[i].high, test_bars[i].low, test_bars[i].close); o.push_back(ind.get());
+            });
+        typedef CCI<double, SMA<double>> cci_t;
+        replay(g, "CCI/bar" + s, bars.size(), cci_t(p),
+            [](cci_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(bars[i].high, bars[i].low, bars[i].close); o.push_back(ind.get());
+            },
+            [](cci_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_bars[i].high, test_bars[i].low, test_bars[i].close); o.push_back(ind.get());
+            });
+        typedef SuperTrend<double, SMA<double>> stt_t;
+        replay(g, "SuperTrend/bar" + s, bars.size(), stt_t(p, p),
+            [](stt_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(bars[i].high, bars[i].low, bars[i].close); o.push_back(ind.get());
+            },
+            [](stt_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_bars[i].high, test_bars[i].low, test_bars[i].close); o.push_back(ind.get());
+            });
+        typedef BodyFilter<double, SMA<double>> bf_t;
+        replay(g, "BodyFilter/bar" + s, bars.size(), bf_t(p),
+            [](bf_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(bars[i].open, bars[i].high, bars[i].low, bars[i].close); o.push_back(ind.get());
+            },
+            [](bf_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_bars[i].open, test_bars[i].high, test_bars[i].low, test_bars[i].close); o.push_back(ind.get());
+            });
+        typedef FisherV1<double> fisher_t;
+        replay(g, "FisherV1/bar" + s, bars.size(), fisher_t(p),
+            [](fisher_t &ind, size_t i, std::vector<double> &o) {
+                const double high = bars[i].high, low = bars[i].low;
+                ind.update(high, low); o.push_back(ind.get());
+            },
+            [](fisher_t &, size_t, std::vector<double> &) {});
+        typedef VWMA<double> vwma_t;
+        replay(g, "VWMA/bar" + s, bars.size(), vwma_t(p),
+            [](vwma_t &ind, size_t i, std::vector<double> &o) {
+                ind.update(bars[i].close, bars[i].volume); o.push_back(ind.get());
+            },
+            [](vwma_t &ind, size_t i, std::vector<double> &o) {
+                ind.test(test_bars[i].close, bars[i].volume); o.push_back(ind.get());
+            });
+    }
+    run_fixed<5>(g);
+    run_fixed<20>(g);
+}
+
+/* расстояние в ULP между двумя конечными числами */
+static uint64_t ulp_distance(const double a, const double b) {
+    int64_t ia = 0, ib = 0;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) ia = std::numeric_limits<int64_t>::min() - ia;
+    if (ib < 0) ib = std::numeric_limits<int64_t>::min() - ib;
+    return ia > ib ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::string file_name = XTECHNICAL_GOLDEN_FILE;
+    bool is_generate = false;
+    std::vector<std::string> update_prefixes;
+    uint64_t max_ulp = 64;
+    double max_rel = 1e-10;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--generate") is_generate = true;
+        else if (arg.compare(0, 7, "--file=") == 0) file_name = arg.substr(7);
+        else if (arg.compare(0, 9, "--update=") == 0) update_prefixes.push_back(arg.substr(9));
+        else if (arg.compare(0, 6, "--ulp=") == 0) max_ulp = std::strtoull(arg.c_str() + 6, nullptr, 10);
+        else if (arg.compare(0, 6, "--rel=") == 0) max_rel = std::atof(arg.c_str() + 6);
+    }
+
+    make_corpus();
+    Golden current;
+    run_all(current);
+
+    if (is_generate) {
+        if (!current.save(file_name)) {
+            std::cout << "error! failed to write " << file_name << std::endl;
+            return 1;
+        }
+        std::cout << "saved " << current.names.size() << " series to " << file_name << std::endl;
+        return 0;
+    }
+
+    Golden reference;
+    if (!reference.load(file_name)) {
+        std::cout << "error! failed to read " << file_name << std::endl;
+        return 1;
+    }
+
+    if (!update_prefixes.empty()) {
+        /* остальные ряды остаются из эталонного файла */
+        Golden updated;
+        size_t count = 0;
+        for (size_t s = 0; s < current.names.size(); ++s) {
+            const std::string &name = current.names[s];
+            bool is_update = false;
+            for (const auto &prefix : update_prefixes) is_update = is_update || name.compare(0, prefix.size(), prefix) == 0;
+            size_t r = 0;
+            while (r < reference.names.size() && reference.names[r] != name) ++r;
+            if (is_update || r == reference.names.size()) {
+                updated.add(name) = current.values[s];
+                ++count;
+            } else {
+                updated.add(name) = reference.values[r];
+            }
+        }
+        if (!updated.save(file_name)) {
+            std::cout << "error! failed to write " << file_name << std::endl;
+            return 1;
+        }
+        std::cout << "updated " << count << " series in " << file_name << std::endl;
+        return 0;
+    }
+
+    int errors = 0;
+    size_t checked = 0;
+    for (size_t s = 0; s < current.names.size(); ++s) {
+        const std::string &name = current.names[s];
+        size_t r = 0;
+        while (r < reference.names.size() && reference.names[r] != name) ++r;
+        if (r == reference.names.size()) {
+            std::cout << "new series (no reference): " << name << std::endl;
+            continue;
+        }
+        const std::vector<double> &a = reference.values[r];
+        const std::vector<double> &b = current.values[s];
+        if (a.size() != b.size()) {
+            std::cout << "error! " << name << " size " << a.size() << " != " << b.size() << std::endl;
+            ++errors;
+            continue;
+        }
+        /* масштаб ряда для значений около нуля */
+        double scale = 0;
+        for (const double v : a) if (std::isfinite(v)) scale = std::max(scale, std::abs(v));
+        for (size_t i = 0; i < a.size(); ++i) {
+            ++checked;
+            if (std::isnan(a[i]) || std::isnan(b[i])) {
+                if (std::isnan(a[i]) && std::isnan(b[i])) continue;
+            } else
+            if (a[i] == b[i] || ulp_distance(a[i], b[i]) <= max_ulp ||
+                std::abs(a[i] - b[i]) <= max_rel * std::max(scale, std::max(std::abs(a[i]), std::abs(b[i])))) {
+                continue;
+            }
+            std::cout << "error! " << name << " index " << i << std::setprecision(17)
+                << " reference " << a[i] << " current " << b[i] << std::endl;
+            ++errors;
+            break;
+        }
+    }
+    for (size_t r = 0; r < reference.names.size(); ++r) {
+        bool is_found = false;
+        for (size_t s = 0; s < current.names.size() && !is_found; ++s) is_found = current.names[s] == reference.names[r];
+        if (!is_found) {
+            std::cout << "error! missing series: " << reference.names[r] << std::endl;
+            ++errors;
+        }
+    }
+    std::cout << "series " << current.names.size() << " values " << checked
+        << " max ulp " << max_ulp << " max rel " << max_rel << std::endl;
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "xtechnical_indicators.hpp"
+#include "xtechnical_pipeline.hpp"
+#include "xtechnical_ingestion.hpp"
+
+/* проверка очередей приема данных:
+ * записи каждого производителя приходят по порядку и без потерь, кроме
+ * отброшенных при заполнении очереди, счетчики сходятся, а конвейеры
+ * индикаторов инструментов получают те же значения, что и без очереди
+ */
+
+static int errors = 0;
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    if (errors < 20) std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+static xtechnical::MarketRecord make_record(const uint32_t symbol_id, const uint64_t timestamp, const double bid) {
+    xtechnical::MarketRecord record;
+    record.symbol_id = symbol_id;
+    record.timestamp = timestamp;
+    record.bid = bid;
+    record.ask = bid + 0.0001;
+    record.volume = 1.0;
+    return record;
+}
+
+/** \brief Конвейер инструмента и записи, которые он должен получить
+ */
+struct Symbol {
+    xtechnical::Pipeline<double> pipeline;
+    size_t sma_node = 0;
+    size_t rsi_node = 0;
+    uint64_t last_timestamp = 0;
+    uint64_t received = 0;
+    bool is_ordered = true;
+
+    Symbol() {
+        const size_t mid = pipeline.add_input("mid");
+        sma_node = pipeline.add<xtechnical::SMA<double>>({mid}, 20);
+        rsi_node = pipeline.add<xtechnical::RSI<double, xtechnical::SMA<double>>>({mid}, 14);
+    }
+
+    void on_record(const xtechnical::MarketRecord &record) {
+        if (record.timestamp <= last_timestamp) is_ordered = false;
+        last_timestamp = record.timestamp;
+        ++received;
+        pipeline.update((record.bid + record.ask) / 2.0);
+    }
+};
+
+/** \brief Проверить конвейеры по записям, которые были приняты очередью
+ */
+static void check_symbols(const std::string &name, std::vector<Symbol> &symbols, const std::vector<std::vector<xtechnical::MarketRecord>> &accepted) {
+    for (size_t s = 0; s < symbols.size(); ++s) {
+        Symbol expected;
+        for (const auto &record : accepted[s]) expected.on_record(record);
+        check(symbols[s].is_ordered, name + " order, symbol " + std::to_string(s));
+        check(symbols[s].received == accepted[s].size(), name + " received, symbol " + std::to_string(s));
+        const double a = symbols[s].pipeline.get(symbols[s].sma_node), b = expected.pipeline.get(expected.sma_node);
+        const double c = symbols[s].pipeline.get(symbols[s].rsi_node), d = expected.pipeline.get(expected.rsi_node);
+        check((a == b || (std::isnan(a) && std::isnan(b))) && (c == d || (std::isnan(c) && std::isnan(d))),
+            name + " pipeline, symbol " + std::to_string(s));
+    }
+}
+
+static void print_stats(const std::string &name, const xtechnical::QueueStats &stats) {
+    std::cout << name << ": pushed " << stats.pushed << " dropped " << stats.dropped
+        << " popped " << stats.popped << " max size " << stats.max_size << "/" << stats.capacity << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    /* заполнение и порядок в одном потоке */
+    {
+        xtechnical::SpscQueue<xtechnical::MarketRecord> spsc(5);
+        xtechnical::MpscQueue<xtechnical::MarketRecord> mpsc(5);
+        check(spsc.capacity() == 8 && mpsc.capacity() == 8, "capacity");
+        for (uint64_t i = 0; i < 10; ++i) {
+            const bool is_accepted = i < 8;
+            check(spsc.push(make_record(0, i, 1.0)) == is_accepted, "SPSC push " + std::to_string(i));
+            check(mpsc.push(make_record(0, i, 1.0)) == is_accepted, "MPSC push " + std::to_string(i));
+        }
+        xtechnical::MarketRecord out[8];
+        check(spsc.pop_batch(out, 3) == 3 && out[0].timestamp == 0 && out[2].timestamp == 2, "SPSC pop_batch");
+        check(mpsc.pop_batch(out, 3) == 3 && out[0].timestamp == 0 && out[2].timestamp == 2, "MPSC pop_batch");
+        check(spsc.push(make_record(0, 10, 1.0)) && mpsc.push(make_record(0, 10, 1.0)), "push after pop");
+        check(spsc.pop_batch(out, 8) == 6 && out[4].timestamp == 7 && out[5].timestamp == 10, "SPSC pop rest");
+        check(mpsc.pop_batch(out, 8) == 6 && out[4].timestamp == 7 && out[5].timestamp == 10, "MPSC pop rest");
+        const xtechnical::QueueStats a = spsc.get_stats(), b = mpsc.get_stats();
+        check(a.pushed == 9 && a.dropped == 2 && a.popped == 9 && a.size == 0 && a.max_size == 8, "SPSC stats");
+        check(b.pushed == 9 && b.dropped == 2 && b.popped == 9 && b.size == 0 && b.max_size == 8, "MPSC stats");
+    }
+
+    const size_t num_symbols = 8;
+    std::mt19937 gen(49);
+    std::normal_distribution<double> noise(0.0, 0.0002);
+    std::vector<double> prices;
+    double price = 1.1;
+    for (size_t i = 0; i < 400000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    /* один производитель, поток потребителя с конвейерами инструментов */
+    {
+        xtechnical::SpscQueue<xtechnical::MarketRecord> queue(1024);
+        xtechnical::IngestionWorker<xtechnical::SpscQueue<xtechnical::MarketRecord>> worker(queue, 64);
+        std::vector<Symbol> symbols(num_symbols);
+        for (uint32_t s = 0; s < num_symbols; ++s) {
+            worker.set_handler(s, [&symbols, s](const xtechnical::MarketRecord &record) {
+                symbols[s].on_record(record);
+            });
+        }
+        std::vector<std::vector<xtechnical::MarketRecord>> accepted(num_symbols);
+        worker.start();
+        auto start = std::chrono::high_resolution_clock::now();
+        /* первая половина: производитель сам следит за заполнением очереди, потерь нет */
+        const size_t half = prices.size() / 2;
+        for (size_t i = 0; i < half; ++i) {
+            while (queue.size() > queue.capacity() / 2) std::this_thread::yield();
+            const xtechnical::MarketRecord record = make_record(i % num_symbols, 1 + i, prices[i]);
+            if (queue.push(record)) accepted[record.symbol_id].push_back(record);
+        }
+        check(queue.get_stats().dropped == 0, "SPSC dropped with backpressure");
+        /* запись без обработчика */
+        queue.push(make_record(num_symbols + 3, 0, 1.0));
+        /* вторая половина: поток без ожидания, лишние записи отбрасываются */
+        for (size_t i = half; i < prices.size(); ++i) {
+            const xtechnical::MarketRecord record = make_record(i % num_symbols, 1 + i, prices[i]);
+            if (queue.push(record)) accepted[record.symbol_id].push_back(record);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        worker.stop();
+        const double push_time = std::chrono::duration<double, std::nano>(stop - start).count() / prices.size();
+
+        const xtechnical::QueueStats stats = queue.get_stats();
+        print_stats("SPSC", stats);
+        std::cout << "SPSC: push " << push_time << " ns, batches " << worker.get_batches() << std::endl;
+        check(stats.pushed + stats.dropped == prices.size() + 1, "SPSC pushed + dropped");
+        check(stats.popped == stats.pushed && stats.size == 0, "SPSC drained");
+        check(worker.get_processed() == stats.popped, "SPSC processed");
+        check(worker.get_unknown() == 1, "SPSC unknown symbol");
+        check(stats.max_size <= stats.capacity, "SPSC max size");
+        check_symbols("SPSC", symbols, accepted);
+    }
+
+    /* несколько производителей, у каждого свои инструменты */
+    {
+        const size_t num_producers = 4;
+        xtechnical::MpscQueue<xtechnical::MarketRecord> queue(1024);
+        xtechnical::IngestionWorker<xtechnical::MpscQueue<xtechnical::MarketRecord>> worker(queue, 64);
+        std::vector<Symbol> symbols(num_symbols);
+        for (uint32_t s = 0; s < num_symbols; ++s) {
+            worker.set_handler(s, [&symbols, s](const xtechnical::MarketRecord &record) {
+                symbols[s].on_record(record);
+            });
+        }
+        std::vector<std::vector<xtechnical::MarketRecord>> accepted(num_symbols);
+        worker.start();
+        std::vector<std::thread> producers;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t p = 0; p < num_producers; ++p) {
+            producers.emplace_back([&, p] {
+                /* инструменты p и p + num_producers принадлежат производителю p */
+                for (size_t i = p; i < prices.size(); i += num_producers) {
+                    /* первая половина с ожиданием по заполнению очереди */
+                    if (i < prices.size() / 2) {
+                        while (queue.size() > queue.capacity() / 2) std::this_thread::yield();
+                    }
+                    const uint32_t symbol_id = (uint32_t)(p + ((i / num_producers) % 2) * num_producers);
+                    const xtechnical::MarketRecord record = make_record(symbol_id, 1 + i, prices[i]);
+                    if (queue.push(record)) accepted[symbol_id].push_back(record);
+                }
+            });
+        }
+        for (auto &item : producers) item.join();
+        auto stop = std::chrono::high_resolution_clock::now();
+        worker.stop();
+        const double push_time = std::chrono::duration<double, std::nano>(stop - start).count() / prices.size();
+
+        const xtechnical::QueueStats stats = queue.get_stats();
+        print_stats("MPSC", stats);
+        std::cout << "MPSC: " << num_producers << " producers, " << push_time << " ns per record, batches " << worker.get_batches() << std::endl;
+        check(stats.pushed + stats.dropped == prices.size(), "MPSC pushed + dropped");
+        check(stats.popped == stats.pushed && stats.size == 0, "MPSC drained");
+        check(worker.get_processed() == stats.popped, "MPSC processed");
+        check(worker.get_unknown() == 0, "MPSC unknown symbol");
+        check(stats.max_size <= stats.capacity, "MPSC max size");
+        check_symbols("MPSC", symbols, accepted);
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,203 @@
+#define XTECHNICAL_USE_INSTRUMENTATION
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "xtechnical_indicators.hpp"
+
+/* проверка инструментирования: счетчики вызовов, гистограммы задержек,
+ * счетчики выделений памяти и снимок статистики
+ */
+
+XTECHNICAL_INSTRUMENTATION_DEFINE_ALLOCATION_HOOKS()
+
+using namespace xtechnical::instrumentation;
+
+static int errors = 0;
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+static bool find(const std::vector<ProbeSnapshot> &probes, const uint64_t id, ProbeSnapshot &out) {
+    for (auto &p : probes) {
+        if (p.id != id) continue;
+        out = p;
+        return true;
+    }
+    return false;
+}
+
+static ProbeSnapshot get(Probe &probe) {
+    ProbeSnapshot s;
+    if (!find(snapshot(), probe.get_id(), s)) {
+        std::cout << "error! probe " << probe.get_id() << " not found" << std::endl;
+        ++errors;
+    }
+    return s;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    std::vector<double> prices;
+    double price = 1.0;
+    for (size_t i = 0; i < 1000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    /* корзины гистограммы покрывают значения без пропусков */
+    for (size_t i = 0; i + 1 < Histogram::BUCKETS; ++i) {
+        check(Histogram::highest_of(i) + 1 == Histogram::lowest_of(i + 1), "histogram bucket gap " + std::to_string(i));
+    }
+    for (uint64_t v = 0; v < 100000; v = v * 3 / 2 + 1) {
+        const size_t i = Histogram::index_of(v);
+        check(Histogram::lowest_of(i) <= v && v <= Histogram::highest_of(i), "histogram index " + std::to_string(v));
+        check(Histogram::highest_of(i) - Histogram::lowest_of(i) <= v / 8, "histogram precision " + std::to_string(v));
+    }
+    check(Histogram::index_of(std::numeric_limits<uint64_t>::max()) == Histogram::BUCKETS - 1, "histogram last bucket");
+
+    /* счетчики вызовов и значения индикаторов */
+    const size_t period = 10;
+    xtechnical::SMA<double> sma(period);
+    xtechnical::EMA<double> ema(period);
+    xtechnical::MMA<double> mma(period);
+    xtechnical::WMA<double> wma(period);
+    xtechnical::BollingerBands<double> bb(period, 2);
+    xtechnical::SuperTrend<double, xtechnical::SMA<double>> st(period, 5);
+    for (size_t i = 0; i < prices.size(); ++i) {
+        sma.test(prices[i]);
+        if (i % 2 == 0) sma.test(prices[i] + 0.001);
+        sma.update(prices[i]);
+        ema.update(prices[i]);
+        mma.test(prices[i]);
+        mma.update(prices[i]);
+        wma.update(prices[i]);
+        bb.test(prices[i]);
+        bb.update(prices[i]);
+        st.update(prices[i]);
+        if (i >= period) {
+            double sum = 0;
+            for (size_t j = i + 1 - period; j <= i; ++j) sum += prices[j];
+            check(std::abs(sma.get() - sum / (double)period) < 1e-12, "SMA value " + std::to_string(i));
+        }
+    }
+
+    const ProbeSnapshot s_sma = get(sma.get_probe());
+    check(s_sma.name == "SMA", "SMA name " + s_sma.name);
+    check(s_sma.update.calls == prices.size(), "SMA update calls " + std::to_string(s_sma.update.calls));
+    check(s_sma.test.calls == prices.size() * 3 / 2, "SMA test calls " + std::to_string(s_sma.test.calls));
+    check(s_sma.update.timed_calls == s_sma.update.calls, "SMA timed calls");
+    check(s_sma.update.allocations == 0, "SMA allocations " + std::to_string(s_sma.update.allocations));
+    check(s_sma.update.min <= s_sma.update.p50 && s_sma.update.p50 <= s_sma.update.p90 &&
+        s_sma.update.p90 <= s_sma.update.p99 && s_sma.update.p99 <= s_sma.update.max, "SMA percentiles");
+
+    const ProbeSnapshot s_ema = get(ema.get_probe());
+    check(s_ema.name == "EMA" && s_ema.update.calls == prices.size() && s_ema.test.calls == 0, "EMA calls");
+    const ProbeSnapshot s_mma = get(mma.get_probe());
+    check(s_mma.name == "MMA" && s_mma.update.calls == prices.size() && s_mma.test.calls == prices.size(), "MMA calls");
+    const ProbeSnapshot s_wma = get(wma.get_probe());
+    check(s_wma.name == "WMA" && s_wma.update.calls == prices.size(), "WMA calls");
+    const ProbeSnapshot s_st = get(st.get_probe());
+    check(s_st.name == "SuperTrend" && s_st.update.calls == prices.size(), "SuperTrend calls");
+
+    /* BollingerBands обновляет суммы окна без выделения памяти */
+    const ProbeSnapshot s_bb = get(bb.get_probe());
+    check(s_bb.update.calls == prices.size() && s_bb.test.calls == prices.size(), "BollingerBands calls");
+    check(s_bb.update.allocations == 0 && s_bb.test.allocations == 0, "BollingerBands allocations");
+
+    /* счетчики циклических буферов: по одному на каждый вызов SMA */
+    size_t buffers = 0;
+    for (auto &p : snapshot()) {
+        if (p.name != "circular_buffer") continue;
+        if (p.update.calls == s_sma.update.calls && p.test.calls == s_sma.test.calls) ++buffers;
+        check(p.update.timed_calls == 0, "circular_buffer timed calls");
+    }
+    check(buffers >= 1, "circular_buffer calls");
+
+    /* копия индикатора - новый зонд с нулевыми счетчиками */
+    uint64_t copy_id = 0;
+    {
+        xtechnical::SMA<double> copy(sma);
+        copy_id = copy.get_probe().get_id();
+        check(copy_id != sma.get_probe().get_id(), "copy id");
+        copy.update(1.0);
+        const ProbeSnapshot s_copy = get(copy.get_probe());
+        check(s_copy.update.calls == 1, "copy calls");
+        copy = sma;
+        check(copy.get_probe().get_id() == copy_id, "assigned id");
+    }
+    ProbeSnapshot tmp;
+    check(!find(snapshot(), copy_id, tmp), "destroyed probe in snapshot");
+
+    /* метки и текстовый формат */
+    sma.get_probe().set_label("EURUSD");
+    const std::string text = to_prometheus();
+    check(text.find("xtechnical_calls_total{indicator=\"SMA\",id=\"" + std::to_string(sma.get_probe().get_id()) +
+        "\",label=\"EURUSD\",method=\"update\"} " + std::to_string(prices.size())) != std::string::npos, "prometheus text");
+
+    reset();
+    check(get(sma.get_probe()).update.calls == 0, "reset");
+
+    /* снимки из другого потока во время обновления */
+    {
+        const size_t n = 200000;
+        std::atomic<bool> done(false);
+        xtechnical::SMA<double> worker_sma(period);
+        const uint64_t id = worker_sma.get_probe().get_id();
+        std::thread worker([&] {
+            for (size_t i = 0; i < n; ++i) worker_sma.update(prices[i % prices.size()]);
+            done = true;
+        });
+        uint64_t last = 0;
+        size_t snapshots = 0;
+        while (!done) {
+            ProbeSnapshot s;
+            if (find(snapshot(), id, s)) {
+                check(s.update.calls >= last, "monotonic calls");
+                last = s.update.calls;
+            }
+            ++snapshots;
+        }
+        worker.join();
+        ProbeSnapshot s;
+        find(snapshot(), id, s);
+        check(s.update.calls == n && s.update.timed_calls == n, "worker calls " + std::to_string(s.update.calls));
+        std::cout << "snapshots during update: " << snapshots << std::endl;
+    }
+
+    /* цена инструментирования */
+    {
+        xtechnical::SMA<double> a(period);
+        double sink = 0;
+        const size_t n = 1000000;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            a.update(prices[i % prices.size()]);
+            sink += a.get();
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        const double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)n;
+        const ProbeSnapshot s = get(a.get_probe());
+        std::cout << "SMA update with instrumentation: " << std::fixed << std::setprecision(2) << ns << " ns" << std::endl;
+        std::cout << "SMA update latency " << time_unit()
+            << ": p50 " << s.update.p50 << " p99 " << s.update.p99 << " max " << s.update.max << std::endl;
+        if (std::isinf(sink)) std::cout << sink << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,299 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <new>
+#include "xtechnical_indicators.hpp"
+#include "indicators/xtechnical_cluster_shaper.hpp"
+#include "indicators/xtechnical_period_stats.hpp"
+
+/* проверка источников памяти индикаторов:
+ * набор индикаторов, созданный в арене, дает побитово те же результаты,
+ * что и набор в куче, не обращается к глобальному operator new
+ * ни при создании, ни при обновлении, а пул поверх арены перестает
+ * расти, когда число живых узлов перестает расти. Источник передается
+ * в конструкторы явно, поэтому наборы в разных аренах можно создавать
+ * из разных потоков одновременно
+ */
+
+static std::atomic<uint64_t> global_allocations(0);
+
+void *operator new(size_t size) {
+    global_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+#if __cplusplus >= 201703L
+/* std::pmr::new_delete_resource использует operator new с выравниванием */
+void *operator new(size_t size, std::align_val_t alignment) {
+    global_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *ptr = nullptr;
+    const size_t align = (size_t)alignment < sizeof(void*) ? sizeof(void*) : (size_t)alignment;
+    if (posix_memalign(&ptr, align, size ? size : 1) != 0) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
+/** \brief Источник памяти, который считает выделения у upstream
+ */
+class CountingResource : public xtechnical::pmr::memory_resource {
+public:
+    xtechnical::pmr::memory_resource *upstream;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    explicit CountingResource(xtechnical::pmr::memory_resource *u) : upstream(u) {}
+
+private:
+    void *do_allocate(size_t b, size_t alignment) override {
+        ++allocations;
+        bytes += b;
+        return upstream->allocate(b, alignment);
+    }
+
+    void do_deallocate(void *p, size_t b, size_t alignment) override {
+        upstream->deallocate(p, b, alignment);
+    }
+
+    bool do_is_equal(const xtechnical::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/** \brief Набор индикаторов с разными внутренними контейнерами
+ *
+ * Все индикаторы получают один источник памяти
+ */
+struct IndicatorSet {
+    xtechnical::SMA<double> sma;
+    xtechnical::EMA<double> ema;
+    xtechnical::WMA<double> wma;
+    xtechnical::RSI<double, xtechnical::SMA<double>> rsi;
+    xtechnical::BollingerBands<double, xtechnical::SMA<double>> bb;
+    xtechnical::MW<double> mw;
+    xtechnical::FastMinMax<double> min_max;
+    xtechnical::Stochastics<double, xtechnical::SMA<double>> stoch;
+    xtechnical::SuperTrend<double, xtechnical::SMA<double>> super_trend;
+    xtechnical::MinMaxDiff<double> min_max_diff;
+    xtechnical::circular_buffer<double> buffer;
+    xtechnical::pmr::ClusterShaper cluster;
+    xtechnical::PeriodStatsV1<double> stats_v1;
+    xtechnical::PeriodStatsV2 stats_v2;
+    double cluster_mass = 0;
+
+    IndicatorSet(const std::vector<double> &factors, xtechnical::pmr::memory_resource *resource = xtechnical::pmr::get_default_resource()) :
+        sma(20, resource), ema(20, resource), wma(20, resource), rsi(14, resource),
+        bb(xtechnical::BollingerBands<double, xtechnical::SMA<double>>::with_factors(20, factors, 0, resource)),
+        mw(50, resource), min_max(30, 2, resource), stoch(14, 3, 3, 0, resource),
+        super_trend(20, 10, 0.015, resource), min_max_diff(30, 0, resource), buffer(64, true, resource),
+        cluster(60, 0.00001, false, resource), stats_v1(300, resource), stats_v2(300, resource) {
+        cluster.on_close_bar = [this](const xtechnical::pmr::ClusterShaper::Cluster &c) {
+            cluster_mass = c.get_center_mass_norm();
+        };
+    }
+
+    void update(const double price, const uint64_t timestamp, std::vector<double> &out) {
+        sma.update(price);
+        ema.update(price);
+        wma.update(price);
+        rsi.update(price);
+        bb.update(price);
+        mw.update(price);
+        min_max.update(price);
+        stoch.update(price);
+        super_trend.update(price);
+        min_max_diff.update(price);
+        buffer.update(price);
+        cluster.update(price, timestamp);
+        stats_v1.add((int)(price * 100000.0), timestamp);
+        stats_v2.add((int)(price * 10000.0), timestamp, price > sma.get() ? 1 : -1);
+
+        double mw_std = 0;
+        mw.get_std_dev(mw_std, 20);
+        out.push_back(sma.get());
+        out.push_back(ema.get());
+        out.push_back(wma.get());
+        out.push_back(rsi.get());
+        out.push_back(bb.get_tl(2));
+        out.push_back(bb.get_bl(0));
+        out.push_back(mw_std);
+        out.push_back(min_max.get_min());
+        out.push_back(min_max.get_max());
+        out.push_back(stoch.get());
+        out.push_back(super_trend.get());
+        out.push_back(min_max_diff.get());
+        out.push_back(buffer.full() ? buffer.variance() : 0.0);
+        out.push_back(cluster_mass);
+        out.push_back(stats_v1.get_center_mass());
+        out.push_back(stats_v2.get_max_value());
+
+        /* test не меняет состояние, но создает временные копии */
+        out.push_back(sma.test(price + 0.001) == xtechnical::common::OK ? sma.get() : 0.0);
+        out.push_back(wma.test(price + 0.001) == xtechnical::common::OK ? wma.get() : 0.0);
+        out.push_back(min_max.test(price + 0.001) == xtechnical::common::OK ? min_max.get_max() : 0.0);
+        out.push_back(super_trend.test(price + 0.001) == xtechnical::common::OK ? super_trend.get() : 0.0);
+    }
+};
+
+static int errors = 0;
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+static void run(IndicatorSet &set, const std::vector<double> &prices, const size_t start, const size_t stop, std::vector<double> &out) {
+    for (size_t i = start; i < stop; ++i) {
+        set.update(prices[i], 1600000000 + i * 3, out);
+    }
+}
+
+static bool equal_bits(const std::vector<double> &a, const std::vector<double> &b) {
+    if (a.size() != b.size()) return false;
+    return std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(45);
+    std::normal_distribution<double> noise(0.0, 0.0002);
+    std::vector<double> prices;
+    double price = 1.1;
+    for (size_t i = 0; i < 20000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+    const size_t half = prices.size() / 2;
+    const std::vector<double> factors = {1.0, 2.0, 3.0};
+
+    std::vector<double> heap_out, arena_out;
+    heap_out.reserve(prices.size() * 20);
+    arena_out.reserve(prices.size() * 20);
+
+    /* набор в куче */
+    {
+        const uint64_t before = global_allocations.load();
+        IndicatorSet set(factors);
+        const uint64_t after_init = global_allocations.load();
+        run(set, prices, 0, prices.size(), heap_out);
+        const uint64_t after_run = global_allocations.load();
+        std::cout << "heap: init allocations " << (after_init - before)
+            << " update allocations " << (after_run - after_init) << std::endl;
+    }
+
+    /* набор в пуле поверх арены */
+    {
+        static unsigned char storage[1 << 20];
+        xtechnical::pmr::monotonic_buffer_resource arena(storage, sizeof(storage));
+        CountingResource counter(&arena);
+        xtechnical::pmr::unsynchronized_pool_resource pool(&counter);
+
+        const uint64_t before = global_allocations.load();
+        IndicatorSet set(factors, &pool);
+        const uint64_t after_init = global_allocations.load();
+        run(set, prices, 0, half, arena_out);
+        const uint64_t upstream_half = counter.allocations;
+        run(set, prices, half, prices.size(), arena_out);
+        const uint64_t after_run = global_allocations.load();
+        std::cout << "arena: init allocations " << (after_init - before)
+            << " update allocations " << (after_run - after_init)
+            << " upstream allocations " << counter.allocations
+            << " upstream bytes " << counter.bytes << std::endl;
+
+        check(after_init == before, "global allocations during construction in arena");
+        check(after_run == after_init, "global allocations during updates in arena");
+        /* число живых узлов ограничено, поэтому пул почти перестает запрашивать память,
+         * хотя узлы FastMinMax и PeriodStats выделяются и освобождаются на каждом обновлении
+         */
+        check(counter.allocations - upstream_half <= 4, "pool keeps growing after warm-up: "
+            + std::to_string(upstream_half) + " -> " + std::to_string(counter.allocations));
+        check(counter.bytes <= sizeof(storage), "arena overflow");
+    }
+
+    check(equal_bits(heap_out, arena_out), "arena results differ from heap results");
+
+    /* наборы в своих аренах создаются и обновляются из нескольких потоков одновременно */
+    {
+        const size_t num_threads = 4;
+        std::vector<std::vector<double>> outs(num_threads);
+        std::vector<uint64_t> upstream(num_threads, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t] {
+                xtechnical::pmr::monotonic_buffer_resource arena(1 << 16);
+                CountingResource counter(&arena);
+                xtechnical::pmr::unsynchronized_pool_resource pool(&counter);
+                IndicatorSet set(factors, &pool);
+                outs[t].reserve(prices.size() * 20);
+                run(set, prices, 0, prices.size(), outs[t]);
+                upstream[t] = counter.allocations;
+            });
+        }
+        for (auto &item : threads) item.join();
+        for (size_t t = 0; t < num_threads; ++t) {
+            check(equal_bits(heap_out, outs[t]), "thread " + std::to_string(t) + " results differ from heap results");
+            check(upstream[t] > 0, "thread " + std::to_string(t) + " arena not used");
+        }
+    }
+
+    /* источник по умолчанию не меняется */
+    check(xtechnical::pmr::get_default_resource() == xtechnical::pmr::new_delete_resource(), "default resource changed");
+
+    /* время создания и удаления наборов */
+    const size_t sets = 2000;
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t n = 0; n < sets; ++n) {
+            IndicatorSet set(factors);
+            set.update(prices[n], 1600000000 + n, heap_out);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        std::cout << "heap: create + destroy " << std::chrono::duration<double, std::micro>(stop - start).count() / sets << " us" << std::endl;
+    }
+    {
+        xtechnical::pmr::monotonic_buffer_resource arena(1 << 16);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t n = 0; n < sets; ++n) {
+            {
+                IndicatorSet set(factors, &arena);
+                set.update(prices[n], 1600000000 + n, arena_out);
+            }
+            arena.release();
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        std::cout << "arena: create + destroy " << std::chrono::duration<double, std::micro>(stop - start).count() / sets << " us" << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,428 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include "xtechnical_indicators.hpp"
+
+/* сравнение MinMax и MinMaxDiff на монотонных очередях
+ * с прежней реализацией (перебор окна циклического буфера):
+ * выходы должны совпадать побитово, в том числе для NaN и -0.0
+ */
+
+namespace reference {
+    using namespace xtechnical;
+
+    /** \brief Cкользящий Min Max
+     */
+    template <class T>
+    class MinMax {
+    private:
+        xtechnical::circular_buffer<T> buffer;
+        T output_min_value = std::numeric_limits<T>::quiet_NaN();
+        T output_max_value = std::numeric_limits<T>::quiet_NaN();
+        size_t period = 0;
+        size_t offset = 0;
+    public:
+        MinMax() {};
+
+        /** \brief Конструктор скользящего Min Max
+         * \param p     Период
+         * \param o     Смещение назад
+         */
+        MinMax(const size_t p, const size_t o = 0) :
+                buffer(p + o), period(p), offset(o) {
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in сигнал на входе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in) noexcept {
+            if(period == 0) {
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            buffer.update(in);
+            if(buffer.full()) {
+                T temp = buffer[0];
+                output_max_value = output_min_value = temp;
+                for(size_t i = 1; i < period; ++i) {
+                    temp = buffer[i];
+                    if(output_max_value < temp) output_max_value = temp;
+                    else if(output_min_value > temp) output_min_value = temp;
+                }
+            } else {
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            return common::OK;
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in        Сигнал на входе
+         * \param min_value Минимальный сигнал на выходе за период
+         * \param max_value Максимальный сигнал на выходе за период
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in, T &min_value, T &max_value) noexcept {
+            const int err = update(in);
+            min_value = output_min_value;
+            max_value = output_max_value;
+            return err;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем,
+         * что не влияет на внутреннее состояние индикатора
+         * \param in сигнал на входе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in) noexcept {
+            if(period == 0) {
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            buffer.test(in);
+            if(buffer.full()) {
+                T temp = buffer[0];
+                output_max_value = output_min_value = temp;
+                for(size_t i = 1; i < period; ++i) {
+                    temp = buffer[i];
+                    if(output_max_value < temp) output_max_value = temp;
+                    else if(output_min_value > temp) output_min_value = temp;
+                }
+            } else {
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            return common::OK;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем, что не влияет на внутреннее состояние индикатора
+         * \param in        Сигнал на входе
+         * \param min_value Минимальный сигнал на выходе за период
+         * \param max_value Максимальный сигнал на выходе за период
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in, T &min_value, T &max_value) noexcept {
+            const int err = test(in);
+            min_value = output_min_value;
+            max_value = output_max_value;
+            return err;
+        }
+
+        /** \brief Получить минимальное значение индикатора
+         * \return Минимальное значение индикатора
+         */
+        inline T get_min() const noexcept {
+            return output_min_value;
+        }
+
+        /** \brief Получить максимальное значение индикатора
+         * \return Максимальное значение индикатора
+         */
+        inline T get_max() const noexcept {
+            return output_max_value;
+        }
+
+        /** \brief Очистить данные индикатора
+         */
+        inline void clear() noexcept {
+            buffer.clear();
+            output_min_value = std::numeric_limits<T>::quiet_NaN();
+            output_max_value = std::numeric_limits<T>::quiet_NaN();
+        }
+    };
+
+    /** \brief Cкользящий Min Max Difference
+     */
+    template <typename T>
+    class MinMaxDiff {
+    private:
+        xtechnical::circular_buffer<T> buffer;
+        DelayLine<T> delay_line;
+        T output_value = std::numeric_limits<T>::quiet_NaN();
+        T output_min_value = std::numeric_limits<T>::quiet_NaN();
+        T output_max_value = std::numeric_limits<T>::quiet_NaN();
+        size_t period = 0;
+        size_t offset = 0;
+    public:
+        MinMaxDiff() {};
+
+        /** \brief Конструктор скользящего Min Max Difference
+         * \param p     Период
+         * \param o     Смещение назад
+         */
+        MinMaxDiff(const size_t p, const size_t o = 0) :
+                buffer(p + o), delay_line(1),
+                period(p), offset(o) {
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in сигнал на входе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in) noexcept {
+            if(period == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+
+            if(delay_line.update(in) != common::OK) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = std::abs(in - delay_line.get());
+            buffer.update(output_value);
+            if(buffer.full()) {
+                T temp = buffer[0];
+                output_max_value = output_min_value = temp;
+                for(size_t i = 1; i < period; ++i) {
+                    temp = buffer[i];
+                    if(output_max_value < temp) output_max_value = temp;
+                    else if(output_min_value > temp) output_min_value = temp;
+                }
+            } else {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            return common::OK;
+        }
+
+        /** \brief Обновить состояние индикатора
+         * \param in        Сигнал на входе
+         * \param out       Сигнал на выходе
+         * \param min_value Минимальный сигнал на выходе
+         * \param max_value Максимальный сигнал на выходе
+         * \return Вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int update(const T in, T &out, T &min_value, T &max_value) noexcept {
+            const int err = update(in);
+            out = output_value;
+            min_value = output_min_value;
+            max_value = output_max_value;
+            return err;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем,
+         * что не влияет на внутреннее состояние индикатора
+         * \param in сигнал на входе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in) noexcept {
+            if(period == 0) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::NO_INIT;
+            }
+            if(delay_line.test(in) != common::OK) {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            output_value = std::abs(in - delay_line.get());
+            buffer.test(output_value);
+            if(buffer.full()) {
+                T temp = buffer[0];
+                output_max_value = output_min_value = temp;
+                for(size_t i = 1; i < period; ++i) {
+                    temp = buffer[i];
+                    if(output_max_value < temp) output_max_value = temp;
+                    else if(output_min_value > temp) output_min_value = temp;
+                }
+            } else {
+                output_value = std::numeric_limits<T>::quiet_NaN();
+                output_min_value = std::numeric_limits<T>::quiet_NaN();
+                output_max_value = std::numeric_limits<T>::quiet_NaN();
+                return common::INDICATOR_NOT_READY_TO_WORK;
+            }
+            return common::OK;
+        }
+
+        /** \brief Протестировать индикатор
+         *
+         * Данная функция отличается от update тем, что не влияет на внутреннее состояние индикатора
+         * \param in Сигнал на входе
+         * \param out Сигнал на выходе
+         * \param min_value Минимальный сигнал на выходе
+         * \param max_value Максимальный сигнал на выходе
+         * \return вернет 0 в случае успеха, иначе см. ErrorType
+         */
+        int test(const T in, T &out, T &min_value, T &max_value) noexcept {
+            const int err = test(in);
+            out = output_value;
+            min_value = output_min_value;
+            max_value = output_max_value;
+            return common::OK;
+        }
+
+        /** \brief Получить значение индикатора
+         * \return Значение индикатора
+         */
+        inline T get() const noexcept {
+            return output_value;
+        }
+
+        /** \brief Получить минимальное значение индикатора
+         * \return Минимальное значение индикатора
+         */
+        inline T get_min() const noexcept {
+            return output_min_value;
+        }
+
+        /** \brief Получить максимальное значение индикатора
+         * \return Максимальное значение индикатора
+         */
+        inline T get_max() const noexcept {
+            return output_max_value;
+        }
+
+        /** \brief Очистить данные индикатора
+         */
+        inline void clear() noexcept {
+            buffer.clear();
+            output_value = std::numeric_limits<T>::quiet_NaN();
+            output_min_value = std::numeric_limits<T>::quiet_NaN();
+            output_max_value = std::numeric_limits<T>::quiet_NaN();
+        }
+    };
+};
+
+static int errors = 0;
+
+template<class T>
+static bool same(const T a, const T b) {
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+template<class T>
+static void check(const std::string &name, const size_t i, const T a, const T b, const int ea, const int eb) {
+    if (same(a, b) && ea == eb) return;
+    if (errors < 20) {
+        std::cout << "error! " << name << " index " << i << " " << a << " != " << b
+            << " err " << ea << " " << eb << std::endl;
+    }
+    ++errors;
+}
+
+/** \brief Данные с повторами, нулями разного знака и NaN
+ */
+template<class T>
+static std::vector<T> make_data(const size_t size, const uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> level(-4, 4);
+    std::uniform_int_distribution<int> kind(0, 19);
+    std::vector<T> data;
+    for (size_t i = 0; i < size; ++i) {
+        const int k = kind(gen);
+        if (k == 0) data.push_back(std::numeric_limits<T>::quiet_NaN());
+        else if (k == 1) data.push_back(-T(0));
+        else if (k == 2) data.push_back(T(0));
+        else data.push_back((T)level(gen) * (T)0.25);
+    }
+    return data;
+}
+
+template<class T>
+static void check_type(const std::string &type) {
+    const std::vector<T> data = make_data<T>(3000, 7);
+    for (size_t p = 1; p <= 12; ++p) {
+        for (size_t o = 0; o <= 5; ++o) {
+            const std::string name = type + " p" + std::to_string(p) + " o" + std::to_string(o);
+            xtechnical::MinMax<T> a(p, o);
+            reference::MinMax<T> b(p, o);
+            xtechnical::MinMaxDiff<T> c(p, o);
+            reference::MinMaxDiff<T> d(p, o);
+            for (size_t i = 0; i + 1 < data.size(); ++i) {
+                /* test вызывается несколько раз подряд, затем update */
+                for (size_t k = 0; k < 2; ++k) {
+                    const T in = data[(i + 1 + k * 13) % data.size()];
+                    int ea = a.test(in), eb = b.test(in);
+                    check("MinMax test min " + name, i, a.get_min(), b.get_min(), ea, eb);
+                    check("MinMax test max " + name, i, a.get_max(), b.get_max(), ea, eb);
+                    ea = c.test(in); eb = d.test(in);
+                    check("MinMaxDiff test min " + name, i, c.get_min(), d.get_min(), ea, eb);
+                    check("MinMaxDiff test max " + name, i, c.get_max(), d.get_max(), ea, eb);
+                }
+                int ea = a.update(data[i]), eb = b.update(data[i]);
+                check("MinMax min " + name, i, a.get_min(), b.get_min(), ea, eb);
+                check("MinMax max " + name, i, a.get_max(), b.get_max(), ea, eb);
+                ea = c.update(data[i]); eb = d.update(data[i]);
+                check("MinMaxDiff min " + name, i, c.get_min(), d.get_min(), ea, eb);
+                check("MinMaxDiff max " + name, i, c.get_max(), d.get_max(), ea, eb);
+                check("MinMaxDiff " + name, i, c.get(), d.get(), ea, eb);
+                if (i == data.size() / 2) {
+                    a.clear();
+                    b = reference::MinMax<T>(p, o);
+                }
+            }
+        }
+    }
+}
+
+template<class IND>
+static double measure(const std::vector<double> &prices, const size_t period, const size_t offset) {
+    IND ind(period, offset);
+    double sink = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (auto &p : prices) {
+        ind.update(p);
+        sink += ind.get_max() - ind.get_min();
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    if (std::isinf(sink)) std::cout << sink << std::endl;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)prices.size();
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    check_type<double>("double");
+    check_type<float>("float");
+
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    std::vector<double> prices;
+    double price = 1.0;
+    for (size_t i = 0; i < 200000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+    std::cout << std::setw(8) << "period"
+        << std::setw(14) << "scan ns"
+        << std::setw(14) << "monotonic ns" << std::endl;
+    for (size_t period : {10, 50, 200, 1000}) {
+        const double ta = measure<reference::MinMax<double>>(prices, period, 2);
+        const double tb = measure<xtechnical::MinMax<double>>(prices, period, 2);
+        std::cout << std::setw(8) << period
+            << std::setw(14) << std::fixed << std::setprecision(2) << ta
+            << std::setw(14) << tb << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include "xtechnical_indicators.hpp"
+
+/* сравнение MultiBarShaper с набором независимых BarShaperV1:
+ * последовательность закрытых и несформированных баров должна совпадать
+ */
+
+typedef xtechnical::BarShaperV1<double>::Bar Bar;
+
+struct Event {
+    size_t tf = 0;
+    bool is_close = false;
+    Bar bar;
+
+    bool operator == (const Event &e) const {
+        return tf == e.tf && is_close == e.is_close &&
+            bar.open == e.bar.open && bar.high == e.bar.high &&
+            bar.low == e.bar.low && bar.close == e.bar.close &&
+            bar.timestamp == e.bar.timestamp;
+    }
+};
+
+class Sink {
+public:
+    std::vector<Event> events;
+
+    void on_close_bar(const size_t tf, const Bar &bar) {
+        Event e;
+        e.tf = tf;
+        e.is_close = true;
+        e.bar = bar;
+        events.push_back(e);
+    }
+
+    void on_unformed_bar(const size_t tf, const Bar &bar) {
+        Event e;
+        e.tf = tf;
+        e.is_close = false;
+        e.bar = bar;
+        events.push_back(e);
+    }
+};
+
+class CountSink {
+public:
+    double sum = 0;
+    void on_close_bar(const size_t, const Bar &bar) {sum += bar.close;}
+    void on_unformed_bar(const size_t, const Bar &) {}
+};
+
+static const std::array<uint64_t, 4> periods = {{60, 300, 900, 3600}};
+
+static std::vector<double> prices;
+static std::vector<uint64_t> timestamps;
+
+bool check(const bool oepc, const bool ubst, const bool uf, const bool uub) {
+    std::vector<xtechnical::BarShaperV1<double>> shapers;
+    Sink sink_a, sink_b;
+    for (size_t k = 0; k < periods.size(); ++k) {
+        shapers.push_back(xtechnical::BarShaperV1<double>(periods[k], oepc, ubst, uf));
+        shapers.back().on_close_bar = [&, k](const Bar &bar) {
+            sink_a.on_close_bar(k, bar);
+        };
+        if (uub) {
+            shapers.back().on_unformed_bar = [&, k](const Bar &bar) {
+                sink_a.on_unformed_bar(k, bar);
+            };
+        }
+    }
+    xtechnical::MultiBarShaper<double, 4> multi_shaper(periods, oepc, ubst, uf, uub);
+    /* первая половина по одному тику, вторая - массивом */
+    const size_t half = prices.size() / 2;
+    for (size_t i = 0; i < prices.size(); ++i) {
+        for (auto &s : shapers) s.update(prices[i], timestamps[i]);
+        if (i < half) multi_shaper.update(prices[i], timestamps[i], sink_b);
+    }
+    multi_shaper.update(prices.data() + half, timestamps.data() + half, prices.size() - half, sink_b);
+
+    std::cout << "oepc " << oepc << " ubst " << ubst << " uf " << uf << " uub " << uub
+        << " events " << sink_a.events.size() << std::endl;
+    if (sink_a.events.size() != sink_b.events.size()) {
+        std::cout << "error! size " << sink_a.events.size() << " != " << sink_b.events.size() << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < sink_a.events.size(); ++i) {
+        if (!(sink_a.events[i] == sink_b.events[i])) {
+            const Event &a = sink_a.events[i], &b = sink_b.events[i];
+            std::cout << "error! event " << i
+                << " tf " << a.tf << "/" << b.tf
+                << " close " << a.is_close << "/" << b.is_close
+                << " t " << a.bar.timestamp << "/" << b.bar.timestamp
+                << " o " << a.bar.open << "/" << b.bar.open
+                << " h " << a.bar.high << "/" << b.bar.high
+                << " l " << a.bar.low << "/" << b.bar.low
+                << " c " << a.bar.close << "/" << b.bar.close << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    std::uniform_int_distribution<int> step(0, 3);
+    std::uniform_int_distribution<int> gap(0, 20000);
+    double price = 1.0;
+    uint64_t timestamp = 1600000000 - 7;
+    for (size_t i = 0; i < 400000; ++i) {
+        price += noise(gen);
+        timestamp += step(gen);
+        /* редкие разрывы разной длины для проверки заполнения пропущенных баров */
+        if (gap(gen) < 3) timestamp += gap(gen);
+        prices.push_back(price);
+        timestamps.push_back(timestamp);
+    }
+
+    for (int flags = 0; flags < 16; ++flags) {
+        if (!check(flags & 1, flags & 2, flags & 4, flags & 8)) return 1;
+    }
+
+    /* скорость */
+    {
+        std::vector<xtechnical::BarShaperV1<double>> shapers;
+        double sum_a = 0;
+        for (size_t k = 0; k < periods.size(); ++k) {
+            shapers.push_back(xtechnical::BarShaperV1<double>(periods[k]));
+            shapers.back().on_close_bar = [&](const Bar &bar) {sum_a += bar.close;};
+        }
+        xtechnical::MultiBarShaper<double, 4> multi_shaper(periods);
+        CountSink sink;
+
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < prices.size(); ++i) {
+            for (auto &s : shapers) s.update(prices[i], timestamps[i]);
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        multi_shaper.update(prices.data(), timestamps.data(), prices.size(), sink);
+        auto t3 = std::chrono::high_resolution_clock::now();
+        const double ta = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)prices.size();
+        const double tb = std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / (double)prices.size();
+        std::cout << "4 x BarShaperV1 " << std::fixed << std::setprecision(2) << ta << " ns" << std::endl;
+        std::cout << "MultiBarShaper  " << tb << " ns" << std::endl;
+        if (sum_a != sink.sum) {
+            std::cout << "error! sum " << sum_a << " != " << sink.sum << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
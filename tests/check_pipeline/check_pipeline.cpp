@@ -0,0 +1,144 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include "xtechnical_indicators.hpp"
+#include "xtechnical_pipeline.hpp"
+
+/* проверка конвейера индикаторов: узлы не дублируются,
+ * значения совпадают с отдельными индикаторами
+ */
+
+static int errors = 0;
+
+static void check(const char *name, const size_t i, const double a, const double b) {
+    if (std::isnan(a) && std::isnan(b)) return;
+    if (a == b) return;
+    if (errors < 10) {
+        std::cout << "error! " << name << " index " << i << " " << a << " != " << b << std::endl;
+    }
+    ++errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    typedef xtechnical::SMA<double> sma_t;
+    typedef xtechnical::RSI<double, sma_t> rsi_t;
+    typedef xtechnical::BollingerBands<double> bb_t;
+    typedef xtechnical::ATR<double, sma_t> atr_t;
+
+    xtechnical::Pipeline<double> pipeline;
+    const size_t high = pipeline.add_input("high");
+    const size_t low = pipeline.add_input("low");
+    const size_t close = pipeline.add_input("close");
+
+    /* два "составных индикатора" используют общие SMA(20) и ATR(14) */
+    const size_t sma = pipeline.add<sma_t>({close}, 20);
+    const size_t bb = pipeline.add<bb_t>({close}, 20, 2);
+    const size_t atr = pipeline.add<atr_t>({high, low, close}, 14);
+    const size_t rsi = pipeline.add<rsi_t>({close}, 14);
+    const size_t rsi_ma = pipeline.add<sma_t>({rsi}, 12);
+    const size_t upper = pipeline.add_function("upper", {sma, atr}, [](const double *in) {
+        return in[0] + 2.0 * in[1];
+    });
+
+    const size_t sma_2 = pipeline.add<sma_t>({close}, 20);
+    const size_t atr_2 = pipeline.add<atr_t>({high, low, close}, 14);
+    const size_t rsi_2 = pipeline.add<rsi_t>({close}, 14);
+    const size_t rsi_ma_2 = pipeline.add<sma_t>({rsi_2}, 12);
+    const size_t upper_2 = pipeline.add_function("upper", {sma_2, atr_2}, [](const double *in) {
+        return in[0] + 2.0 * in[1];
+    });
+    const size_t sma_3 = pipeline.add<sma_t>({high}, 20);
+
+    std::cout << "nodes: " << pipeline.size() << std::endl;
+    if (sma != sma_2 || atr != atr_2 || rsi != rsi_2 || rsi_ma != rsi_ma_2 || upper != upper_2 || sma == sma_3) {
+        std::cout << "error! duplicate nodes" << std::endl;
+        return 1;
+    }
+    if (pipeline.size() != 10) {
+        std::cout << "error! size " << pipeline.size() << std::endl;
+        return 1;
+    }
+    if (pipeline.add<sma_t>({100}, 20) != xtechnical::Pipeline<double>::NO_NODE ||
+        pipeline.add<sma_t>({high, low, close}, 20) != xtechnical::Pipeline<double>::NO_NODE) {
+        std::cout << "error! invalid inputs" << std::endl;
+        return 1;
+    }
+    /* get_indicator проверяет тип узла */
+    if (!pipeline.get_indicator<bb_t>(bb) || pipeline.get_indicator<sma_t>(bb) ||
+        pipeline.get_indicator<sma_t>(close) || pipeline.get_indicator<sma_t>(upper) ||
+        pipeline.get_indicator<sma_t>(100)) {
+        std::cout << "error! get_indicator" << std::endl;
+        return 1;
+    }
+    for (size_t id = 0; id < pipeline.size(); ++id) {
+        std::cout << id << " " << pipeline.get_name(id) << std::endl;
+    }
+
+    /* те же индикаторы по отдельности */
+    sma_t ref_sma(20);
+    bb_t ref_bb(20, 2);
+    atr_t ref_atr(14);
+    rsi_t ref_rsi(14);
+    sma_t ref_rsi_ma(12);
+
+    std::mt19937 gen(3);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    double price = 1.0;
+    for (size_t i = 0; i < 2000; ++i) {
+        const double c = price + noise(gen);
+        const double h = std::max(price, c) + std::abs(noise(gen));
+        const double l = std::min(price, c) - std::abs(noise(gen));
+        price = c;
+
+        /* проверяем методы тест */
+        const double t = c + noise(gen);
+        pipeline.test({h, l, t});
+        ref_sma.test(t);
+        ref_bb.test(t);
+        ref_atr.test(h, l, t);
+        ref_rsi.test(t);
+        if (!std::isnan(ref_rsi.get())) ref_rsi_ma.test(ref_rsi.get());
+        else ref_rsi_ma.test(std::numeric_limits<double>::quiet_NaN());
+        check("sma test", i, pipeline.get(sma), ref_sma.get());
+        check("bb test", i, pipeline.get_indicator<bb_t>(bb)->get_tl(), ref_bb.get_tl());
+        check("atr test", i, pipeline.get(atr), ref_atr.get());
+        check("rsi test", i, pipeline.get(rsi), ref_rsi.get());
+        if (!std::isnan(ref_rsi.get())) check("rsi ma test", i, pipeline.get(rsi_ma), ref_rsi_ma.get());
+
+        pipeline.update({h, l, c});
+        ref_sma.update(c);
+        ref_bb.update(c);
+        ref_atr.update(h, l, c);
+        ref_rsi.update(c);
+        if (!std::isnan(ref_rsi.get())) ref_rsi_ma.update(ref_rsi.get());
+        check("sma", i, pipeline.get(sma), ref_sma.get());
+        check("bb", i, pipeline.get_indicator<bb_t>(bb)->get_tl(), ref_bb.get_tl());
+        check("bb", i, pipeline.get_indicator<bb_t>(bb)->get_bl(), ref_bb.get_bl());
+        check("atr", i, pipeline.get(atr), ref_atr.get());
+        check("rsi", i, pipeline.get(rsi), ref_rsi.get());
+        if (!std::isnan(ref_rsi.get())) check("rsi ma", i, pipeline.get(rsi_ma), ref_rsi_ma.get());
+        else check("rsi ma", i, pipeline.get(rsi_ma), std::numeric_limits<double>::quiet_NaN());
+        check("upper", i, pipeline.get(upper), ref_sma.get() + 2.0 * ref_atr.get());
+        if (i == 1999) {
+            std::cout << "sma " << pipeline.get(sma) << " atr " << pipeline.get(atr)
+                << " rsi " << pipeline.get(rsi) << " upper " << pipeline.get(upper) << std::endl;
+        }
+    }
+
+    pipeline.clear();
+    if (!std::isnan(pipeline.get(sma))) {
+        std::cout << "error! clear" << std::endl;
+        return 1;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
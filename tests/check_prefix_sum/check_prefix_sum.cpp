@@ -0,0 +1,110 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cmath>
+#include "xtechnical_circular_buffer.hpp"
+
+/* проверка префиксных сумм циклического буфера:
+ * sum(start, stop), mean() и variance() сравниваются с перебором элементов
+ * в режимах update и test, для размеров буфера со степенью двойки и без
+ */
+
+static int errors = 0;
+
+static void check(const std::string &name, const size_t i, const double a, const double b, const double eps) {
+    if (std::abs(a - b) <= eps * std::max(1.0, std::abs(b))) return;
+    if (errors < 10) {
+        std::cout << "error! " << name << " index " << i << " "
+            << std::setprecision(17) << a << " != " << b << std::endl;
+    }
+    ++errors;
+}
+
+static void check_ranges(const xtechnical::circular_buffer<double> &a, const xtechnical::circular_buffer<double> &b, const size_t size, const size_t i) {
+    check("sum", i, a.sum(), b.sum(), 1e-12);
+    check("mean", i, a.mean(), b.mean(), 1e-12);
+    check("variance", i, a.variance(), b.variance(), 1e-7);
+    for (uint32_t start = 0; start < size; start += 3) {
+        for (uint32_t stop = start; stop <= size; stop += 2) {
+            check("sum range", i, a.sum(start, stop), b.sum(start, stop), 1e-12);
+            check("variance range", i, a.variance(start, stop), b.variance(start, stop), 1e-7);
+        }
+    }
+}
+
+static void check_size(const std::vector<double> &prices, const size_t size) {
+    xtechnical::circular_buffer<double> a(size, true);
+    xtechnical::circular_buffer<double> b(size);
+    if (!a.has_prefix_sum() || b.has_prefix_sum()) check("has_prefix_sum", 0, 0, 1, 0);
+    for (size_t i = 0; i < 2000; ++i) {
+        a.update(prices[i]);
+        b.update(prices[i]);
+        check_ranges(a, b, size, i);
+        /* два теста подряд заменяют последнее значение */
+        a.test(prices[i] + 1.0);
+        b.test(prices[i] + 1.0);
+        a.test(prices[i] + 0.5);
+        b.test(prices[i] + 0.5);
+        check_ranges(a, b, size, i);
+    }
+    a.clear();
+    b.clear();
+    for (size_t i = 0; i < 3; ++i) {
+        a.update(prices[i]);
+        b.update(prices[i]);
+    }
+    check_ranges(a, b, size, 0);
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(3);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    std::vector<double> prices;
+    double price = 1.2;
+    for (size_t i = 0; i < 200000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    const size_t sizes[] = {1, 2, 5, 8, 20, 64, 100};
+    for (auto size : sizes) {
+        check_size(prices, size);
+    }
+
+    /* скорость: сумма всех окон длиной 10 на каждом баре */
+    const size_t sizes_speed[] = {20, 100, 500};
+    for (auto size : sizes_speed) {
+        double sink = 0;
+        xtechnical::circular_buffer<double> a(size, true);
+        xtechnical::circular_buffer<double> b(size);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) {
+            a.update(p);
+            for (uint32_t start = 0; start + 10 <= size; start += 10) sink += a.sum(start, start + 10);
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) {
+            b.update(p);
+            for (uint32_t start = 0; start + 10 <= size; start += 10) sink += b.sum(start, start + 10);
+        }
+        auto t3 = std::chrono::high_resolution_clock::now();
+        const double n = (double)prices.size();
+        std::cout << "size " << std::setw(4) << size << std::fixed << std::setprecision(2)
+            << " prefix sum " << std::setw(8) << std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / n << " ns"
+            << " loop " << std::setw(8) << std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / n << " ns"
+            << std::endl;
+        if (std::isinf(sink)) std::cout << sink << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,197 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include "xtechnical_indicators.hpp"
+
+/* проверка RenkoBatch (сравнение с RenkoChart) и RangeBarBatch
+ * (сравнение с построением по одному пункту), а также скорость
+ */
+
+typedef xtechnical::RenkoChart<double>::Bar RenkoBar;
+typedef xtechnical::BarShaperV1<double>::Bar RangeBar;
+
+static const uint64_t digits = 5;
+static std::vector<double> prices;
+static std::vector<uint64_t> timestamps;
+static std::vector<int64_t> points;
+
+/* построение range-баров по одному пункту */
+class RangeBarReference {
+public:
+    int64_t range = 0;
+    int64_t open = 0, high = 0, low = 0, close = 0;
+    bool is_once = false;
+    std::vector<RangeBar> bars;
+
+    void add(const int64_t o, const int64_t h, const int64_t l, const int64_t c, const uint64_t t) {
+        RangeBar bar;
+        bar.open = (double)o * 0.00001;
+        bar.high = (double)h * 0.00001;
+        bar.low = (double)l * 0.00001;
+        bar.close = (double)c * 0.00001;
+        bar.timestamp = t;
+        bars.push_back(bar);
+    }
+
+    void update(const int64_t price, const uint64_t t) {
+        if (!is_once) {
+            open = high = low = close = price;
+            is_once = true;
+            return;
+        }
+        const int64_t dir = price > close ? 1 : -1;
+        for (int64_t p = close + dir; p != price + dir; p += dir) {
+            if (p > low + range) {
+                add(open, low + range, low, low + range, t);
+                open = low = low + range;
+                high = p;
+            } else
+            if (p < high - range) {
+                add(open, high, high - range, high - range, t);
+                open = high = high - range;
+                low = p;
+            } else {
+                high = std::max(high, p);
+                low = std::min(low, p);
+            }
+            close = p;
+        }
+    }
+};
+
+template<class BATCH, class BAR>
+std::vector<std::vector<BAR>> run_batch(BATCH &batch, const size_t capacity) {
+    const size_t n = batch.size();
+    std::vector<std::vector<BAR>> buffers(n, std::vector<BAR>(capacity));
+    std::vector<BAR*> output(n);
+    std::vector<size_t> output_size(n);
+    std::vector<std::vector<BAR>> result(n);
+    for (size_t j = 0; j < n; ++j) output[j] = buffers[j].data();
+    size_t pos = 0;
+    while (pos < prices.size()) {
+        pos += batch.update(prices.data() + pos, timestamps.data() + pos, prices.size() - pos,
+            output.data(), output_size.data(), capacity);
+        for (size_t j = 0; j < n; ++j) {
+            result[j].insert(result[j].end(), buffers[j].begin(), buffers[j].begin() + output_size[j]);
+        }
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 3.0);
+    std::uniform_int_distribution<int> jump(0, 5000);
+    int64_t point = 110000;
+    uint64_t timestamp = 1600000000;
+    for (size_t i = 0; i < 1000000; ++i) {
+        point += (int64_t)std::round(noise(gen));
+        if (jump(gen) == 0) point += jump(gen) / 20 - 125;
+        ++timestamp;
+        points.push_back(point);
+        /* смещение 0.3 пункта, чтобы цена не попадала на границу уровня */
+        prices.push_back(((double)point + 0.3) * 0.00001);
+        timestamps.push_back(timestamp);
+    }
+
+    const std::vector<uint64_t> steps = {1, 2, 5, 10, 20, 50, 100, 200};
+
+    /* ренко */
+    {
+        xtechnical::RenkoBatch<double> batch(digits, steps);
+        const std::vector<std::vector<RenkoBar>> result = run_batch<xtechnical::RenkoBatch<double>, RenkoBar>(batch, 300);
+        for (size_t j = 0; j < steps.size(); ++j) {
+            std::vector<RenkoBar> bars;
+            xtechnical::RenkoChart<double> renko(digits, steps[j]);
+            renko.on_close_bar = [&](const RenkoBar &bar) {
+                bars.push_back(bar);
+            };
+            for (size_t i = 0; i < prices.size(); ++i) {
+                renko.update(prices[i], timestamps[i]);
+            }
+            std::cout << "renko step " << steps[j] << " bricks " << bars.size() << std::endl;
+            if (bars.size() != result[j].size() || bars.empty()) {
+                std::cout << "error! size " << bars.size() << " != " << result[j].size() << std::endl;
+                return 1;
+            }
+            for (size_t i = 0; i < bars.size(); ++i) {
+                if (bars[i].close != result[j][i].close || bars[i].timestamp != result[j][i].timestamp) {
+                    std::cout << "error! step " << steps[j] << " brick " << i << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    /* range-бары */
+    {
+        xtechnical::RangeBarBatch<double> batch(digits, steps);
+        const std::vector<std::vector<RangeBar>> result = run_batch<xtechnical::RangeBarBatch<double>, RangeBar>(batch, 300);
+        for (size_t j = 0; j < steps.size(); ++j) {
+            RangeBarReference reference;
+            reference.range = steps[j];
+            for (size_t i = 0; i < points.size(); ++i) {
+                reference.update(points[i], timestamps[i]);
+            }
+            const std::vector<RangeBar> &bars = reference.bars;
+            std::cout << "range " << steps[j] << " bars " << bars.size() << std::endl;
+            if (bars.size() != result[j].size() || bars.empty()) {
+                std::cout << "error! size " << bars.size() << " != " << result[j].size() << std::endl;
+                return 1;
+            }
+            for (size_t i = 0; i < bars.size(); ++i) {
+                const RangeBar &a = bars[i], &b = result[j][i];
+                if (a.open != b.open || a.high != b.high || a.low != b.low ||
+                    a.close != b.close || a.timestamp != b.timestamp) {
+                    std::cout << "error! range " << steps[j] << " bar " << i << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    /* скорость: все размеры кирпича за один проход против RenkoChart для каждого размера */
+    {
+        size_t count_a = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t j = 0; j < steps.size(); ++j) {
+            xtechnical::RenkoChart<double> renko(digits, steps[j]);
+            renko.on_close_bar = [&](const RenkoBar &) {
+                ++count_a;
+            };
+            for (size_t i = 0; i < prices.size(); ++i) {
+                renko.update(prices[i], timestamps[i]);
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        xtechnical::RenkoBatch<double> batch(digits, steps);
+        const size_t capacity = 4096;
+        std::vector<std::vector<RenkoBar>> buffers(steps.size(), std::vector<RenkoBar>(capacity));
+        std::vector<RenkoBar*> output(steps.size());
+        std::vector<size_t> output_size(steps.size());
+        for (size_t j = 0; j < steps.size(); ++j) output[j] = buffers[j].data();
+        size_t count_b = 0;
+        size_t pos = 0;
+        auto t3 = std::chrono::high_resolution_clock::now();
+        while (pos < prices.size()) {
+            pos += batch.update(prices.data() + pos, timestamps.data() + pos, prices.size() - pos,
+                output.data(), output_size.data(), capacity);
+            for (size_t j = 0; j < steps.size(); ++j) count_b += output_size[j];
+        }
+        auto t4 = std::chrono::high_resolution_clock::now();
+        const double ta = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)prices.size();
+        const double tb = std::chrono::duration_cast<std::chrono::nanoseconds>(t4 - t3).count() / (double)prices.size();
+        std::cout << steps.size() << " x RenkoChart " << std::fixed << std::setprecision(2) << ta << " ns/tick" << std::endl;
+        std::cout << "RenkoBatch     " << tb << " ns/tick" << std::endl;
+        if (count_a != count_b) {
+            std::cout << "error! count " << count_a << " != " << count_b << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,281 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include "xtechnical_indicators.hpp"
+
+/* проверка сохранения и загрузки состояния индикаторов:
+ * индикатор после загрузки должен работать так же, как исходный
+ */
+
+static std::vector<double> prices;
+static int errors = 0;
+
+static bool equal(const double a, const double b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    if (errors < 20) std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+/** \brief Сохранить индикатор в середине данных, загрузить в новый
+ * и сравнить выходы обоих индикаторов до конца данных
+ */
+template<class IND, class MAKE, class STEP>
+void check_restore(const std::string &name, MAKE make, STEP step) {
+    IND a = make();
+    const size_t half = prices.size() / 2;
+    for (size_t i = 0; i < half; ++i) step(a, i);
+
+    const std::vector<uint8_t> blob = xtechnical::state::save(a);
+    IND b = make();
+    check(xtechnical::state::load(b, blob) == xtechnical::common::OK, name + " load");
+
+    for (size_t i = half; i < prices.size(); ++i) {
+        const std::vector<double> ra = step(a, i);
+        const std::vector<double> rb = step(b, i);
+        for (size_t k = 0; k < ra.size(); ++k) {
+            if (equal(ra[k], rb[k])) continue;
+            check(false, name + " index " + std::to_string(i) + " output " + std::to_string(k));
+            return;
+        }
+    }
+    /* состояние нового индикатора тоже сохраняется и загружается */
+    IND c = make();
+    check(xtechnical::state::load(c, xtechnical::state::save(make())) == xtechnical::common::OK, name + " load empty");
+    std::cout << std::setw(16) << name << std::setw(8) << blob.size() << " bytes" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(1);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    double price = 1.0;
+    for (size_t i = 0; i < 2000; ++i) {
+        price += noise(gen);
+        prices.push_back(std::round(price * 100000.0) / 100000.0);
+    }
+    const double eps = 0.00005;
+
+    check_restore<xtechnical::circular_buffer<double>>("circular_buffer",
+        []{ return xtechnical::circular_buffer<double>(20); },
+        [&](xtechnical::circular_buffer<double> &ind, const size_t i) {
+            ind.test(prices[i] + eps);
+            std::vector<double> r{ind.front(), ind.back()};
+            ind.update(prices[i]);
+            r.push_back(ind.sum());
+            r.push_back(ind.front());
+            return r;
+        });
+    check_restore<xtechnical::circular_buffer<double>>("circular_buffer",
+        []{ return xtechnical::circular_buffer<double>(13); },
+        [&](xtechnical::circular_buffer<double> &ind, const size_t i) {
+            ind.update(prices[i]);
+            return std::vector<double>{ind.sum(), ind.front(), ind.back(), (double)ind.size()};
+        });
+
+#   define CHECK_SIMPLE(NAME, TYPE, ...) \
+    check_restore<TYPE>(NAME, []{ return TYPE(__VA_ARGS__); }, \
+        [&](TYPE &ind, const size_t i) { \
+            ind.test(prices[i] + eps); \
+            const double t = ind.get(); \
+            ind.update(prices[i]); \
+            return std::vector<double>{t, ind.get()}; \
+        })
+
+    CHECK_SIMPLE("DelayLine", xtechnical::DelayLine<double>, 5);
+    CHECK_SIMPLE("SMA", xtechnical::SMA<double>, 20);
+    CHECK_SIMPLE("EMA", xtechnical::EMA<double>, 20);
+    CHECK_SIMPLE("MMA", xtechnical::MMA<double>, 20);
+    CHECK_SIMPLE("WMA", xtechnical::WMA<double>, 20);
+    CHECK_SIMPLE("StdDev", xtechnical::StdDev<double>, 20);
+    CHECK_SIMPLE("SMA float", xtechnical::SMA<float>, 20);
+    typedef xtechnical::RSI<double, xtechnical::SMA<double>> RSI_SMA;
+    typedef xtechnical::RSI<double, xtechnical::EMA<double>> RSI_EMA;
+    typedef xtechnical::ATR<double, xtechnical::SMA<double>> ATR_SMA;
+    typedef xtechnical::CCI<double, xtechnical::SMA<double>> CCI_SMA;
+    CHECK_SIMPLE("RSI<SMA>", RSI_SMA, 14);
+    CHECK_SIMPLE("RSI<EMA>", RSI_EMA, 14);
+    CHECK_SIMPLE("ATR", ATR_SMA, 14);
+    CHECK_SIMPLE("CCI", CCI_SMA, 20);
+
+    typedef xtechnical::SuperTrend<double, xtechnical::SMA<double>> SuperTrend;
+    check_restore<SuperTrend>("SuperTrend", []{ return SuperTrend(20, 5); },
+        [&](SuperTrend &ind, const size_t i) {
+            ind.test(prices[i] + eps);
+            const double t = ind.get();
+            ind.update(prices[i]);
+            return std::vector<double>{t, ind.get(), ind.get_cci()};
+        });
+
+    typedef xtechnical::BollingerBands<double> BB;
+    check_restore<BB>("BollingerBands", []{ return BB(20, 2, 3); },
+        [&](BB &ind, const size_t i) {
+            ind.test(prices[i] + eps);
+            const double t = ind.get_tl();
+            ind.update(prices[i]);
+            return std::vector<double>{t, ind.get_tl(), ind.get_ml(), ind.get_bl()};
+        });
+
+    typedef xtechnical::FastMinMax<double> FastMinMax;
+    check_restore<FastMinMax>("FastMinMax", []{ return FastMinMax(20, 2); },
+        [&](FastMinMax &ind, const size_t i) {
+            ind.test(prices[i] + eps);
+            const double t = ind.get_max();
+            ind.update(prices[i]);
+            return std::vector<double>{t, ind.get_max(), ind.get_min()};
+        });
+
+    /* формирователь кластеров: сравниваем закрытые кластеры */
+    {
+        typedef xtechnical::ClusterShaper ClusterShaper;
+        std::vector<double> closed;
+        auto make = [&]{
+            ClusterShaper shaper(60, 0.00001);
+            shaper.on_close_bar = [&](const ClusterShaper::Cluster &c) {
+                closed.push_back((double)c.timestamp);
+                closed.push_back(c.get_center_mass_price());
+                closed.push_back((double)c.volume);
+                closed.push_back(c.get_max_volume_price());
+            };
+            return shaper;
+        };
+        check_restore<ClusterShaper>("ClusterShaper", make,
+            [&](ClusterShaper &ind, const size_t i) {
+                closed.clear();
+                ind.update(prices[i], 1600000000 + i * 7);
+                return closed;
+            });
+    }
+
+    /* загрузка с ошибкой не меняет индикатор */
+    {
+        xtechnical::SMA<double> a(10), b(11), c(10);
+        xtechnical::SMA<float> f(10);
+        for (size_t i = 0; i < 100; ++i) {
+            a.update(prices[i]);
+            b.update(prices[i + 1]);
+            c.update(prices[i + 2]);
+            f.update(prices[i]);
+        }
+        std::vector<uint8_t> blob = xtechnical::state::save(a);
+        const double before = b.get();
+        check(xtechnical::state::load(b, blob) == xtechnical::common::INVALID_PARAMETER, "period mismatch");
+        check(equal(b.get(), before), "state after failed load");
+        check(xtechnical::state::load(f, blob) == xtechnical::common::INVALID_PARAMETER, "type mismatch");
+        xtechnical::EMA<double> ema(10);
+        check(xtechnical::state::load(ema, blob) == xtechnical::common::INVALID_PARAMETER, "class mismatch");
+        std::vector<uint8_t> truncated(blob.begin(), blob.end() - 1);
+        check(xtechnical::state::load(c, truncated) == xtechnical::common::INVALID_PARAMETER, "truncated blob");
+        for (size_t k = 0; k < blob.size(); ++k) {
+            std::vector<uint8_t> corrupted = blob;
+            corrupted[k] ^= 0x10;
+            check(xtechnical::state::load(c, corrupted) == xtechnical::common::INVALID_PARAMETER,
+                "corrupted blob byte " + std::to_string(k));
+        }
+        check(xtechnical::state::load(c, blob) == xtechnical::common::OK && c.get() == a.get(), "load");
+    }
+
+    /* файл состояний набора индикаторов */
+    {
+        const std::vector<size_t> periods = {5, 10, 20, 50, 100, 200};
+        const size_t symbols = 200;
+        typedef xtechnical::RSI<double, xtechnical::EMA<double>> RSI;
+        std::vector<xtechnical::SMA<double>> sma;
+        std::vector<BB> bb;
+        std::vector<RSI> rsi;
+        auto make_bank = [&]{
+            sma.clear();
+            bb.clear();
+            rsi.clear();
+            for (size_t s = 0; s < symbols; ++s) {
+                for (auto p : periods) {
+                    sma.push_back(xtechnical::SMA<double>(p));
+                    bb.push_back(BB(p, 2));
+                    rsi.push_back(RSI(p));
+                }
+            }
+        };
+        auto key = [&](const std::string &name, const size_t i) {
+            return "S" + std::to_string(i / periods.size()) + "/" + name + std::to_string(periods[i % periods.size()]);
+        };
+        const size_t history = 1000;
+        make_bank();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < sma.size(); ++i) {
+            const size_t shift = (i / periods.size()) % 500;
+            for (size_t j = 0; j < history; ++j) {
+                sma[i].update(prices[shift + j]);
+                bb[i].update(prices[shift + j]);
+                rsi[i].update(prices[shift + j]);
+            }
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        xtechnical::StateFileWriter writer;
+        for (size_t i = 0; i < sma.size(); ++i) {
+            writer.add(key("SMA", i), sma[i]);
+            writer.add(key("BB", i), bb[i]);
+            writer.add(key("RSI", i), rsi[i]);
+        }
+        const std::string path = "check_state.bin";
+        check(writer.write(path), "write state file");
+        auto t3 = std::chrono::high_resolution_clock::now();
+
+        const std::vector<xtechnical::SMA<double>> sma_ref = sma;
+        const std::vector<BB> bb_ref = bb;
+        const std::vector<RSI> rsi_ref = rsi;
+        make_bank();
+        auto t4 = std::chrono::high_resolution_clock::now();
+        xtechnical::StateFileReader reader;
+        check(reader.open(path), "open state file");
+        check(reader.size() == sma.size() * 3, "state file size");
+        for (size_t i = 0; i < sma.size(); ++i) {
+            check(reader.load(key("SMA", i), sma[i]) == xtechnical::common::OK, "file SMA " + key("SMA", i));
+            check(reader.load(key("BB", i), bb[i]) == xtechnical::common::OK, "file BB " + key("BB", i));
+            check(reader.load(key("RSI", i), rsi[i]) == xtechnical::common::OK, "file RSI " + key("RSI", i));
+        }
+        auto t5 = std::chrono::high_resolution_clock::now();
+        check(reader.load("unknown", sma[0]) == xtechnical::common::NO_INIT, "file unknown key");
+        check(reader.load(key("SMA", 1), sma[0]) == xtechnical::common::INVALID_PARAMETER, "file wrong key");
+
+        for (size_t i = 0; i < sma.size(); ++i) {
+            xtechnical::SMA<double> s = sma_ref[i];
+            BB b = bb_ref[i];
+            RSI r = rsi_ref[i];
+            for (size_t j = 1500; j < 1600; ++j) {
+                s.update(prices[j]); sma[i].update(prices[j]);
+                b.update(prices[j]); bb[i].update(prices[j]);
+                r.update(prices[j]); rsi[i].update(prices[j]);
+                if (!equal(s.get(), sma[i].get()) || !equal(b.get_tl(), bb[i].get_tl()) || !equal(r.get(), rsi[i].get())) {
+                    check(false, "file bank " + std::to_string(i));
+                    break;
+                }
+            }
+        }
+        reader.close();
+        std::remove(path.c_str());
+
+        auto ms = [](std::chrono::high_resolution_clock::time_point a, std::chrono::high_resolution_clock::time_point b) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(b - a).count() / 1000.0;
+        };
+        std::cout << "indicators: " << sma.size() * 3 << std::endl;
+        std::cout << "replay " << history << " bars: " << ms(t1, t2) << " ms" << std::endl;
+        std::cout << "save to file: " << ms(t2, t3) << " ms" << std::endl;
+        std::cout << "load from file: " << ms(t4, t5) << " ms" << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
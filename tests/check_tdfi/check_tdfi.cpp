@@ -0,0 +1,201 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "xtechnical_indicators.hpp"
+
+/* сравнение TrendDirectionForceIndex (максимум через монотонную очередь)
+ * с прямым поиском максимума по буферу
+ */
+
+/* прежний расчет нормировки: поиск максимума по всему буферу */
+template <typename T, class INDICATOR_TYPE>
+class TdfiReference {
+private:
+    INDICATOR_TYPE ma1;
+    INDICATOR_TYPE ma2;
+    xtechnical::circular_buffer<T> buffer;
+    T prev_ma1 = std::numeric_limits<T>::quiet_NaN();
+    T prev_ma2 = std::numeric_limits<T>::quiet_NaN();
+    T output = std::numeric_limits<T>::quiet_NaN();
+
+    int calc(const T v1, const T v2, const bool is_test) {
+        const T ma1_diff = v1 - prev_ma1;
+        const T ma2_diff = v2 - prev_ma2;
+        const T ma_diff_avg = (ma1_diff + ma2_diff) / 2.0;
+        const T tdf = std::abs(v1 - v2) * ma_diff_avg * ma_diff_avg * ma_diff_avg;
+        prev_ma1 = v1;
+        prev_ma2 = v2;
+        if (is_test) buffer.test(std::abs(tdf));
+        else buffer.update(std::abs(tdf));
+        if(buffer.full()) {
+            T h = 0;
+            std::vector<T> data = buffer.to_vector();
+            for (size_t i = 0; i < data.size(); ++i) {
+                if (h < data[i]) h = data[i];
+            }
+            output = (h > 0.0) ? (tdf / h) : 0.0;
+            return xtechnical::common::OK;
+        };
+        return xtechnical::common::NO_INIT;
+    }
+public:
+    TdfiReference(const size_t p) : ma1(p), ma2(p), buffer(3 * p) {}
+
+    int update(const T in) {
+        output = std::numeric_limits<T>::quiet_NaN();
+        T v1, v2 = 0;
+        if(ma1.update(in, v1) != xtechnical::common::OK) return xtechnical::common::NO_INIT;
+        if(ma2.update(v1, v2) != xtechnical::common::OK) return xtechnical::common::NO_INIT;
+        if(std::isnan(prev_ma1) || std::isnan(prev_ma2)) {
+            prev_ma1 = v1;
+            prev_ma2 = v2;
+            return xtechnical::common::NO_INIT;
+        }
+        return calc(v1, v2, false);
+    }
+
+    int test(const T in) {
+        output = std::numeric_limits<T>::quiet_NaN();
+        T v1, v2 = 0;
+        if(ma1.test(in, v1) != xtechnical::common::OK) return xtechnical::common::NO_INIT;
+        if(ma2.test(v1, v2) != xtechnical::common::OK) return xtechnical::common::NO_INIT;
+        if(std::isnan(prev_ma1) || std::isnan(prev_ma2)) return xtechnical::common::NO_INIT;
+        return calc(v1, v2, true);
+    }
+
+    T get() const {return output;}
+};
+
+/* EMA, которая пропускает NaN на выход, не меняя состояние */
+template <typename T>
+class NanEma {
+private:
+    xtechnical::EMA<T> ema;
+public:
+    NanEma(const size_t p) : ema(p) {}
+
+    int update(const T in, T &out) {
+        if (std::isnan(in)) {
+            out = in;
+            return xtechnical::common::OK;
+        }
+        return ema.update(in, out);
+    }
+
+    int test(const T in, T &out) {
+        if (std::isnan(in)) {
+            out = in;
+            return xtechnical::common::OK;
+        }
+        return ema.test(in, out);
+    }
+
+    void clear() {ema.clear();}
+};
+
+static int errors = 0;
+
+static void check(const char *name, const size_t i, const double a, const double b) {
+    if (std::isnan(a) && std::isnan(b)) return;
+    if (a == b) return;
+    if (errors < 10) {
+        std::cout << "error! " << name << " index " << i << " " << a << " != " << b << std::endl;
+    }
+    ++errors;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(5);
+    std::normal_distribution<double> noise(0.0, 0.001);
+    std::vector<double> prices;
+    double price = 1.0;
+    for (size_t i = 0; i < 20000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    /* монотонная очередь против прямого поиска минимума и максимума */
+    {
+        const size_t period = 7;
+        xtechnical::MonotonicQueue<double> max_queue(period);
+        xtechnical::MonotonicQueue<double, std::less<double>> min_queue(period);
+        std::uniform_int_distribution<int> level(0, 5);
+        std::vector<double> data;
+        for (size_t i = 0; i < 5000; ++i) {
+            /* значения с повторами */
+            const double value = (double)level(gen);
+            const double value_test = (double)level(gen);
+            std::vector<double> window(data.end() - std::min(data.size(), period - 1), data.end());
+            window.push_back(value_test);
+            check("queue test max", i, max_queue.test(value_test), *std::max_element(window.begin(), window.end()));
+            check("queue test min", i, min_queue.test(value_test), *std::min_element(window.begin(), window.end()));
+
+            data.push_back(value);
+            max_queue.update(value);
+            min_queue.update(value);
+            std::vector<double> window2(data.end() - std::min(data.size(), period), data.end());
+            check("queue max", i, max_queue.get(), *std::max_element(window2.begin(), window2.end()));
+            check("queue min", i, min_queue.get(), *std::min_element(window2.begin(), window2.end()));
+        }
+    }
+
+    const size_t periods[] = {2, 14, 50};
+    for (const size_t period : periods) {
+        xtechnical::TrendDirectionForceIndex<double, xtechnical::EMA<double>> tdfi(period);
+        TdfiReference<double, xtechnical::EMA<double>> ref(period);
+        for (size_t i = 0; i + 1 < prices.size(); ++i) {
+            if (i % 3 == 0) {
+                const double t = prices[i] + noise(gen);
+                tdfi.test(t);
+                ref.test(t);
+                check("tdfi test", i, tdfi.get(), ref.get());
+            }
+            tdfi.update(prices[i]);
+            ref.update(prices[i]);
+            check("tdfi", i, tdfi.get(), ref.get());
+        }
+
+        /* NaN в ряду TDF не должен сбрасывать максимум окна */
+        xtechnical::TrendDirectionForceIndex<double, NanEma<double>> tdfi_nan(period);
+        TdfiReference<double, NanEma<double>> ref_nan(period);
+        for (size_t i = 0; i + 1 < prices.size(); ++i) {
+            const double value = i % 97 == 50 ? std::numeric_limits<double>::quiet_NaN() : prices[i];
+            if (i % 5 == 0) {
+                const double t = i % 10 == 0 ? std::numeric_limits<double>::quiet_NaN() : prices[i] + noise(gen);
+                tdfi_nan.test(t);
+                ref_nan.test(t);
+                check("tdfi nan test", i, tdfi_nan.get(), ref_nan.get());
+            }
+            tdfi_nan.update(value);
+            ref_nan.update(value);
+            check("tdfi nan", i, tdfi_nan.get(), ref_nan.get());
+        }
+
+        double sink = 0;
+        xtechnical::TrendDirectionForceIndex<double, xtechnical::EMA<double>> a(period);
+        TdfiReference<double, xtechnical::EMA<double>> b(period);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) { a.update(p); sink += a.get(); }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        for (auto &p : prices) { b.update(p); sink += b.get(); }
+        auto t3 = std::chrono::high_resolution_clock::now();
+        const double ta = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)prices.size();
+        const double tb = std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count() / (double)prices.size();
+        std::cout << "period " << std::setw(4) << period
+            << " buffer scan " << std::fixed << std::setprecision(1) << std::setw(8) << tb
+            << " ns, monotonic queue " << std::setw(8) << ta << " ns" << std::endl;
+        if (std::isinf(sink)) std::cout << sink << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,241 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include "xtechnical_indicators.hpp"
+
+/* проверка test_many и test_inverse:
+ * test_many для лестницы цен сравнивается с вызовами test для каждой цены,
+ * test_inverse проверяется подстановкой найденной цены в test
+ */
+
+static int errors = 0;
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    if (errors < 20) std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+static bool same(const double a, const double b, const double eps) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    if (eps == 0) return std::memcmp(&a, &b, sizeof(double)) == 0;
+    return std::abs(a - b) <= eps * std::max(1.0, std::abs(b));
+}
+
+static void make_ladder(const double price, const size_t size, std::vector<double> &ladder) {
+    ladder.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        ladder[i] = price + ((double)i - (double)(size / 2)) * 0.00001;
+    }
+}
+
+/** \brief Сравнить test_many индикатора с одним выходом и test для каждого значения
+ */
+template<class INDICATOR>
+static void check_single(const std::string &name, INDICATOR &indicator, const std::vector<double> &ladder, const double eps, const size_t step) {
+    std::vector<double> out_many(ladder.size()), out_one(ladder.size());
+    const int err_many = indicator.test_many(ladder.data(), ladder.size(), out_many.data());
+    const double get_many = indicator.get();
+    int err_one = xtechnical::common::OK;
+    for (size_t i = 0; i < ladder.size(); ++i) {
+        err_one = indicator.test(ladder[i]);
+        out_one[i] = indicator.get();
+    }
+    check(err_many == err_one, name + " error code, step " + std::to_string(step));
+    check(same(get_many, indicator.get(), eps), name + " get(), step " + std::to_string(step));
+    for (size_t i = 0; i < ladder.size(); ++i) {
+        if (same(out_many[i], out_one[i], eps)) continue;
+        check(false, name + " step " + std::to_string(step) + " index " + std::to_string(i));
+        break;
+    }
+}
+
+template<class MA_TYPE>
+static void check_bb(const std::string &name, xtechnical::BollingerBands<double, MA_TYPE> &bb, const std::vector<double> &ladder, const size_t step) {
+    const size_t n = ladder.size();
+    std::vector<double> tl(n), ml(n), bl(n), tl_one(n), ml_one(n), bl_one(n);
+    const int err_many = bb.test_many(ladder.data(), n, tl.data(), ml.data(), bl.data());
+    const double get_many = bb.get_tl();
+    int err_one = xtechnical::common::OK;
+    for (size_t i = 0; i < n; ++i) {
+        err_one = bb.test(ladder[i], tl_one[i], ml_one[i], bl_one[i]);
+    }
+    check(err_many == err_one, name + " error code, step " + std::to_string(step));
+    check(same(get_many, bb.get_tl(), 0), name + " get_tl(), step " + std::to_string(step));
+    for (size_t i = 0; i < n; ++i) {
+        if (same(tl[i], tl_one[i], 0) && same(ml[i], ml_one[i], 0) && same(bl[i], bl_one[i], 0)) continue;
+        check(false, name + " step " + std::to_string(step) + " index " + std::to_string(i));
+        break;
+    }
+}
+
+template<class MA_TYPE>
+static void check_stochastics(const std::string &name, xtechnical::Stochastics<double, MA_TYPE> &stoch, const std::vector<double> &ladder, const size_t step) {
+    const size_t n = ladder.size();
+    std::vector<double> k(n), d(n), k_one(n), d_one(n);
+    const int err_many = stoch.test_many(ladder.data(), n, k.data(), d.data());
+    const double get_k = stoch.get_k(), get_d = stoch.get_d();
+    int err_one = xtechnical::common::OK;
+    for (size_t i = 0; i < n; ++i) {
+        err_one = stoch.test(ladder[i], k_one[i], d_one[i]);
+    }
+    check(err_many == err_one, name + " error code, step " + std::to_string(step));
+    check(same(get_k, stoch.get_k(), 0) && same(get_d, stoch.get_d(), 0), name + " get_k(), get_d(), step " + std::to_string(step));
+    for (size_t i = 0; i < n; ++i) {
+        if (same(k[i], k_one[i], 0) && same(d[i], d_one[i], 0)) continue;
+        check(false, name + " step " + std::to_string(step) + " index " + std::to_string(i));
+        break;
+    }
+}
+
+/** \brief Проверить, что test в найденной точке дает заданное значение
+ */
+template<class INDICATOR>
+static void check_inverse(const std::string &name, INDICATOR &indicator, const double value, const double eps, const size_t step) {
+    double in = 0;
+    const int err = indicator.test_inverse(value, in);
+    if (err == xtechnical::common::INDICATOR_NOT_READY_TO_WORK) return;
+    check(err == xtechnical::common::OK, name + " inverse error " + std::to_string(err) + ", step " + std::to_string(step));
+    if (err != xtechnical::common::OK) return;
+    double out = 0;
+    indicator.test(in, out);
+    check(std::abs(out - value) <= eps, name + " inverse " + std::to_string(value) + " -> " + std::to_string(out) + ", step " + std::to_string(step));
+}
+
+template<class MA_TYPE>
+static void check_stochastics_inverse(const std::string &name, xtechnical::Stochastics<double, MA_TYPE> &stoch, const double value, const size_t step) {
+    double in = 0;
+    const int err = stoch.test_inverse(value, in);
+    if (err != xtechnical::common::OK) return;
+    double k = 0, d = 0;
+    stoch.test(in, k, d);
+    check(std::abs(k - value) <= 1e-7, name + " inverse " + std::to_string(value) + " -> " + std::to_string(k) + ", step " + std::to_string(step));
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(46);
+    std::normal_distribution<double> noise(0.0, 0.0002);
+    std::vector<double> prices;
+    double price = 1.1;
+    for (size_t i = 0; i < 3000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+    }
+
+    xtechnical::SMA<double> sma(14);
+    xtechnical::EMA<double> ema(14);
+    xtechnical::MMA<double> mma(14);
+    xtechnical::RSI<double, xtechnical::SMA<double>> rsi_sma(14);
+    xtechnical::RSI<double, xtechnical::EMA<double>> rsi_ema(14);
+    xtechnical::StdDev<double> std_dev(20);
+    xtechnical::BollingerBands<double, xtechnical::SMA<double>> bb(20, 2);
+    xtechnical::BollingerBands<double, xtechnical::EMA<double>> bb_offset(20, 2, 3);
+    xtechnical::Stochastics<double, xtechnical::SMA<double>> stoch(14, 3, 3);
+    xtechnical::Stochastics<double, xtechnical::SMA<double>> stoch_offset(14, 3, 3, 2);
+    xtechnical::CCI<double, xtechnical::SMA<double>> cci(20);
+
+    std::vector<double> ladder;
+    for (size_t step = 0; step < prices.size(); ++step) {
+        /* лестница длиннее блока проверяет обработку блоками */
+        make_ladder(prices[step], step % 7 == 0 ? 601 : 201, ladder);
+        check_single("SMA", sma, ladder, 0, step);
+        check_single("EMA", ema, ladder, 0, step);
+        check_single("MMA", mma, ladder, 0, step);
+        check_single("RSI<SMA>", rsi_sma, ladder, 0, step);
+        check_single("RSI<EMA>", rsi_ema, ladder, 0, step);
+        check_single("StdDev", std_dev, ladder, 1e-9, step);
+        check_single("CCI", cci, ladder, 0, step);
+        check_bb("BollingerBands", bb, ladder, step);
+        check_bb("BollingerBands offset", bb_offset, ladder, step);
+        check_stochastics("Stochastics", stoch, ladder, step);
+        check_stochastics("Stochastics offset", stoch_offset, ladder, step);
+
+        const double targets[] = {10.0, 30.0, 50.0, 70.0, 90.0};
+        for (const double target : targets) {
+            check_inverse("RSI<SMA>", rsi_sma, target, 1e-7, step);
+            check_inverse("RSI<EMA>", rsi_ema, target, 1e-7, step);
+            check_stochastics_inverse("Stochastics", stoch, target, step);
+            check_stochastics_inverse("Stochastics offset", stoch_offset, target, step);
+        }
+        check_inverse("SMA", sma, prices[step] + 0.0003, 1e-12, step);
+        check_inverse("EMA", ema, prices[step] - 0.0003, 1e-12, step);
+
+        sma.update(prices[step]);
+        ema.update(prices[step]);
+        mma.update(prices[step]);
+        rsi_sma.update(prices[step]);
+        rsi_ema.update(prices[step]);
+        std_dev.update(prices[step]);
+        bb.update(prices[step]);
+        bb_offset.update(prices[step]);
+        stoch.update(prices[step]);
+        stoch_offset.update(prices[step]);
+        cci.update(prices[step]);
+    }
+
+    /* недостижимые значения RSI */
+    {
+        double in = 0;
+        check(rsi_sma.test_inverse(0.0, in) == xtechnical::common::INVALID_PARAMETER, "RSI inverse 0");
+        check(rsi_sma.test_inverse(100.0, in) == xtechnical::common::INVALID_PARAMETER, "RSI inverse 100");
+    }
+
+    /* RSI на ровном ряду: U = D = 0 для прежней цены, NaN в лестнице */
+    {
+        xtechnical::RSI<double, xtechnical::SMA<double>> rsi_flat(5);
+        for (size_t i = 0; i < 10; ++i) rsi_flat.update(1.0);
+        make_ladder(1.0, 201, ladder);
+        ladder[10] = std::numeric_limits<double>::quiet_NaN();
+        check_single("RSI flat", rsi_flat, ladder, 0, 0);
+        double out = 0;
+        rsi_flat.test(1.0, out);
+        check(out == 100.0, "RSI flat value");
+    }
+
+    /* время: 201 цена через test и через test_many */
+    {
+        make_ladder(price, 201, ladder);
+        std::vector<double> out(ladder.size());
+        const size_t repeats = 2000;
+        double sink = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < ladder.size(); ++i) {
+                rsi_sma.test(ladder[i], out[i]);
+                sink += out[i];
+                cci.test(ladder[i], out[i]);
+                sink += out[i];
+                std_dev.test(ladder[i], out[i]);
+                sink += out[i];
+            }
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        const double time_test = std::chrono::duration<double, std::micro>(stop - start).count() / repeats;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < repeats; ++r) {
+            rsi_sma.test_many(ladder.data(), ladder.size(), out.data());
+            sink += out[r % out.size()];
+            cci.test_many(ladder.data(), ladder.size(), out.data());
+            sink += out[r % out.size()];
+            std_dev.test_many(ladder.data(), ladder.size(), out.data());
+            sink += out[r % out.size()];
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        const double time_many = std::chrono::duration<double, std::micro>(stop - start).count() / repeats;
+        std::cout << "RSI + CCI + StdDev, 201 prices: test " << time_test << " us, test_many " << time_many << " us (" << sink << ")" << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include "xtechnical_indicators.hpp"
+
+/* проверка индикаторов для целых тиков:
+ * результаты сравниваются с индикаторами для double, которые получают
+ * цены ticks * pips_size, скользящая сумма тиков остается точной
+ * на любом числе обновлений, а состояние сохраняется и загружается
+ */
+
+static int errors = 0;
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    if (errors < 20) std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+static bool near(const double a, const double b, const double eps) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return std::abs(a - b) <= eps;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    const double pips_size = 0.00001;
+    std::mt19937 gen(47);
+    std::normal_distribution<double> noise(0.0, 20.0);
+    std::vector<int32_t> ticks;
+    double price = 110000;
+    for (size_t i = 0; i < 100000; ++i) {
+        price += noise(gen);
+        ticks.push_back((int32_t)std::llround(price));
+    }
+
+    /* перевод цены в тики */
+    check(xtechnical::tick::to_ticks<int32_t>(1.10001, pips_size) == 110001, "to_ticks 1.10001");
+    check(xtechnical::tick::to_ticks<int32_t>(1.099995, pips_size) == 110000, "to_ticks 1.099995");
+
+    /* сравнение с индикаторами для double */
+    {
+        const size_t period = 20;
+        xtechnical::tick::SMA<int32_t> sma(period, pips_size);
+        xtechnical::tick::SUM<int32_t> sum(period, pips_size);
+        xtechnical::tick::StdDev<int32_t> std_dev(period, pips_size);
+        xtechnical::tick::MinMax<int32_t> min_max(period, 0, pips_size);
+        xtechnical::tick::ATR<int32_t> atr(period, pips_size);
+        xtechnical::SMA<double> sma_d(period);
+        xtechnical::SUM<double> sum_d(period);
+        xtechnical::StdDev<double> std_dev_d(period);
+        xtechnical::FastMinMax<double> min_max_d(period);
+        xtechnical::ATR<double, xtechnical::SMA<double>> atr_d(period);
+
+        for (size_t i = 0; i < 5000; ++i) {
+            const int32_t in = ticks[i];
+            const double in_d = (double)in * pips_size;
+            const int32_t in_test = in + 7;
+            const double in_test_d = (double)in_test * pips_size;
+            const std::string step = " step " + std::to_string(i);
+
+            check(sma.test(in_test) == sma_d.test(in_test_d), "SMA test error code" + step);
+            check(near(sma.get(), sma_d.get(), 1e-12), "SMA test" + step);
+            check(std_dev.test(in_test) == std_dev_d.test(in_test_d), "StdDev test error code" + step);
+            check(near(std_dev.get(), std_dev_d.get(), 1e-12), "StdDev test" + step);
+            check(atr.test(in_test) == atr_d.test(in_test_d), "ATR test error code" + step);
+            check(near(atr.get(), atr_d.get(), 1e-12), "ATR test" + step);
+
+            check(sma.update(in) == sma_d.update(in_d), "SMA error code" + step);
+            check(near(sma.get(), sma_d.get(), 1e-12), "SMA" + step);
+            check(sum.update(in) == sum_d.update(in_d), "SUM error code" + step);
+            check(near(sum.get(), sum_d.get(), 1e-10), "SUM" + step);
+            check(std_dev.update(in) == std_dev_d.update(in_d), "StdDev error code" + step);
+            check(near(std_dev.get(), std_dev_d.get(), 1e-12), "StdDev" + step);
+            check(min_max.update(in) == min_max_d.update(in_d), "MinMax error code" + step);
+            check(near(min_max.get_min(), min_max_d.get_min(), 1e-12) &&
+                near(min_max.get_max(), min_max_d.get_max(), 1e-12), "MinMax" + step);
+            check(atr.update(in) == atr_d.update(in_d), "ATR error code" + step);
+            check(near(atr.get(), atr_d.get(), 1e-12), "ATR" + step);
+            if (sma.get_sum_ticks() != 0 && !std::isnan(sma.get())) {
+                int64_t s = 0;
+                for (size_t j = i + 1 - period; j <= i; ++j) s += ticks[j];
+                check(sma.get_sum_ticks() == s, "SMA sum ticks" + step);
+            }
+        }
+    }
+
+    /* точность на длинном ряду: сумма тиков точна, сумма double накапливает ошибку */
+    {
+        const size_t period = 1000;
+        xtechnical::tick::SMA<int32_t> sma(period, pips_size);
+        xtechnical::SMA<double> sma_d(period);
+        xtechnical::tick::StdDev<int32_t> std_dev(period, pips_size);
+        int64_t exact = 0;
+        double max_error_tick = 0, max_error_double = 0;
+        for (size_t i = 0; i < ticks.size(); ++i) {
+            sma.update(ticks[i]);
+            sma_d.update((double)ticks[i] * pips_size);
+            std_dev.update(ticks[i]);
+            exact += ticks[i];
+            if (i >= period) exact -= ticks[i - period];
+            if (i < period) continue;
+            const double expected = (double)exact * pips_size / (double)period;
+            max_error_tick = std::max(max_error_tick, std::abs(sma.get() - expected));
+            max_error_double = std::max(max_error_double, std::abs(sma_d.get() - expected));
+            check(sma.get_sum_ticks() == exact, "long SMA sum ticks, step " + std::to_string(i));
+        }
+        /* стандартное отклонение по окну, посчитанное заново в long double */
+        long double mean = 0, var = 0;
+        for (size_t j = ticks.size() - period; j < ticks.size(); ++j) mean += ticks[j];
+        mean /= period;
+        for (size_t j = ticks.size() - period; j < ticks.size(); ++j) var += (ticks[j] - mean) * (ticks[j] - mean);
+        const double expected_std = (double)std::sqrt(var / (period - 1)) * pips_size;
+        check(std::abs(std_dev.get() - expected_std) <= 1e-15, "long StdDev");
+        std::cout << "SMA(" << period << ") after " << ticks.size() << " updates: max error ticks "
+            << max_error_tick << ", double " << max_error_double << std::endl;
+        check(max_error_tick <= 1e-15, "long SMA error");
+    }
+
+    /* сохранение и загрузка состояния */
+    {
+        xtechnical::tick::SMA<int32_t> sma(14, pips_size), sma_copy(14, pips_size);
+        xtechnical::tick::StdDev<int32_t> std_dev(14, pips_size), std_dev_copy(14, pips_size);
+        xtechnical::tick::ATR<int32_t> atr(14, pips_size), atr_copy(14, pips_size);
+        for (size_t i = 0; i < 100; ++i) {
+            sma.update(ticks[i]);
+            std_dev.update(ticks[i]);
+            atr.update(ticks[i]);
+        }
+        std::vector<uint8_t> data;
+        xtechnical::StateWriter writer(data);
+        sma.save_state(writer);
+        std_dev.save_state(writer);
+        atr.save_state(writer);
+        xtechnical::StateReader reader(data.data(), data.size());
+        check(sma_copy.load_state(reader), "SMA load_state");
+        check(std_dev_copy.load_state(reader), "StdDev load_state");
+        check(atr_copy.load_state(reader), "ATR load_state");
+        for (size_t i = 100; i < 200; ++i) {
+            sma.update(ticks[i]);
+            sma_copy.update(ticks[i]);
+            std_dev.update(ticks[i]);
+            std_dev_copy.update(ticks[i]);
+            atr.update(ticks[i]);
+            atr_copy.update(ticks[i]);
+            check(sma.get() == sma_copy.get() && std_dev.get() == std_dev_copy.get() &&
+                atr.get() == atr_copy.get(), "state copy, step " + std::to_string(i));
+        }
+        xtechnical::tick::SMA<int32_t> sma_other(15, pips_size);
+        xtechnical::StateReader reader_other(data.data(), data.size());
+        check(!sma_other.load_state(reader_other), "SMA load_state with other period");
+    }
+
+    /* память и время */
+    {
+        const size_t period = 1000;
+        std::cout << "window memory, period " << period << ": int32_t " << (period + 1) * sizeof(int32_t)
+            << " bytes, double " << (period + 1) * sizeof(double) << " bytes" << std::endl;
+        xtechnical::tick::StdDev<int32_t> std_dev(period, pips_size);
+        xtechnical::StdDev<double> std_dev_d(period);
+        double sink = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < ticks.size(); ++i) {
+            std_dev.update(ticks[i]);
+            if (!std::isnan(std_dev.get())) sink += std_dev.get();
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        const double time_tick = std::chrono::duration<double, std::nano>(stop - start).count() / ticks.size();
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < ticks.size(); ++i) {
+            std_dev_d.update((double)ticks[i] * pips_size);
+            if (!std::isnan(std_dev_d.get())) sink += std_dev_d.get();
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        const double time_double = std::chrono::duration<double, std::nano>(stop - start).count() / ticks.size();
+        std::cout << "StdDev(" << period << ") update: ticks " << time_tick << " ns, double " << time_double << " ns (" << sink << ")" << std::endl;
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <string>
+#include "xtechnical_time_grid.hpp"
+#include "xtechnical_delay_meter.hpp"
+
+/* проверка сетки событийного времени:
+ * отсчеты сетки сравниваются с простой моделью, которая на каждый шаг
+ * пропуска добавляет отсчет, время обновления не зависит от длины пропуска
+ */
+
+static int errors = 0;
+
+static void check(const bool value, const std::string &message) {
+    if (value) return;
+    if (errors < 20) std::cout << "error! " << message << std::endl;
+    ++errors;
+}
+
+/** \brief Простая модель: один отсчет на каждый шаг сетки
+ */
+class NaiveGrid {
+public:
+    std::deque<double> data;
+    size_t capacity = 0;
+    uint64_t time_step = 0;
+    uint64_t last_time = 0;
+
+    NaiveGrid(const size_t c, const uint64_t s) : capacity(c), time_step(s) {}
+
+    void update(const double value, const uint64_t timestamp) {
+        const uint64_t t = timestamp - timestamp % time_step;
+        if (data.empty()) {
+            data.push_back(0.0);
+            last_time = t;
+        }
+        for (; last_time < t; last_time += time_step) {
+            data.push_back(data.back());
+            if (data.size() > capacity) data.pop_front();
+        }
+        data.back() = value;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+
+    std::mt19937 gen(48);
+    std::uniform_real_distribution<double> price(1.0, 2.0);
+    std::uniform_int_distribution<int> gap_kind(0, 99);
+    std::uniform_int_distribution<int> small_gap(0, 120);
+    std::uniform_int_distribution<int> long_gap(1000, 5000);
+
+    /* сравнение с простой моделью, включая метки времени в прошлом */
+    {
+        const size_t capacity = 1000;
+        const uint64_t step = 50;
+        xtechnical::TimeGrid<double> grid(capacity, step);
+        NaiveGrid naive(capacity, step);
+        uint64_t timestamp = 1600000000000;
+        std::vector<double> out(capacity);
+        for (size_t i = 0; i < 50000; ++i) {
+            const int kind = gap_kind(gen);
+            if (kind < 3) timestamp += long_gap(gen) * step;
+            else if (kind < 10 && timestamp > 200) timestamp -= 200;
+            else timestamp += small_gap(gen);
+            const double value = price(gen);
+            grid.update(value, timestamp);
+            naive.update(value, std::max(timestamp, naive.last_time));
+
+            const std::string step_name = " step " + std::to_string(i);
+            check(grid.size() == naive.data.size(), "size" + step_name);
+            check(grid.back() == naive.data.back(), "back" + step_name);
+            check(grid.runs() <= grid.size(), "runs" + step_name);
+            if (i % 101 != 0) continue;
+            const size_t n = grid.copy_to(out.data(), capacity);
+            check(n == naive.data.size(), "copy_to size" + step_name);
+            for (size_t j = 0; j < n; ++j) {
+                if (out[j] == naive.data[j]) continue;
+                check(false, "copy_to" + step_name + " index " + std::to_string(j));
+                break;
+            }
+            /* последние отсчеты */
+            const size_t m = std::min((size_t)10, n);
+            grid.copy_to(out.data(), m);
+            for (size_t j = 0; j < m; ++j) {
+                check(out[j] == naive.data[naive.data.size() - m + j], "copy_to tail" + step_name);
+            }
+        }
+        check(grid.full(), "full");
+    }
+
+    /* время update не зависит от длины пропуска */
+    {
+        const uint64_t step = 1;
+        xtechnical::TimeGrid<double> grid(100000, step);
+        NaiveGrid naive(100000, step);
+        uint64_t timestamp = 1600000000000;
+        const size_t updates = 200;
+        const uint64_t gap = 5000;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < updates; ++i) {
+            timestamp += gap;
+            grid.update((double)i, timestamp);
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        const double time_grid = std::chrono::duration<double, std::nano>(stop - start).count() / updates;
+
+        timestamp = 1600000000000;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < updates; ++i) {
+            timestamp += gap;
+            naive.update((double)i, timestamp);
+        }
+        stop = std::chrono::high_resolution_clock::now();
+        const double time_naive = std::chrono::duration<double, std::nano>(stop - start).count() / updates;
+        std::cout << "update after " << gap << " empty steps: grid " << time_grid << " ns, per-step fill " << time_naive << " ns" << std::endl;
+        check(grid.size() == naive.data.size() && grid.back() == naive.data.back(), "gap grid");
+
+        /* пропуск длиннее сетки */
+        grid.update(1.5, timestamp + 1000000000);
+        check(grid.size() == 100000 && grid.runs() == 2, "very long gap");
+    }
+
+    /* измеритель задержки находит сдвиг потока на сетке */
+    {
+        std::uniform_real_distribution<double> unif(10, 100);
+        std::uniform_real_distribution<double> unif2(0.1, 10);
+        std::vector<double> first_data, second_data;
+        for (size_t i = 0; i < 5000; ++i) {
+            const double p = unif(gen);
+            first_data.push_back(p);
+            second_data.push_back(p + unif2(gen));
+        }
+        xtechnical::DelayMeter delay_meter(1200, 600, 50);
+        for (size_t i = 0; i < 4000; ++i) {
+            /* пропуск в 7 секунд посередине */
+            const double ftimestamp = 1000.0 + (double)i * 0.05 + (i > 2000 ? 7.0 : 0.0);
+            delay_meter.update(first_data[i], ftimestamp, 0);
+            delay_meter.update(second_data[i + 15], ftimestamp, 1);
+        }
+        check(delay_meter.check_full_data(), "DelayMeter full data");
+        delay_meter.calc();
+        std::cout << "delay = " << delay_meter.get_delay() << " corr = " << delay_meter.get_pearson_correlation() << std::endl;
+        check(std::abs(delay_meter.get_delay() - 0.75) < 1e-9, "DelayMeter delay");
+    }
+
+    if (errors) {
+        std::cout << "errors: " << errors << std::endl;
+        return 1;
+    }
+    std::cout << "ok" << std::endl;
+    return 0;
+}
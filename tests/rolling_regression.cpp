@@ -0,0 +1,128 @@
+#include <iostream>
+#include "xtechnical_indicators.hpp"
+#include <random>
+#include <array>
+#include <vector>
+
+/* прямой расчет МНК по окну для сравнения */
+template<class T>
+void calc_direct(const std::vector<T> &y, const bool is_parabola, T coeff[3]) {
+    const size_t n = y.size();
+    double s[5] = {0,0,0,0,0}, sy[3] = {0,0,0};
+    for (size_t i = 0; i < n; ++i) {
+        double xp = 1;
+        for (size_t k = 0; k < 5; ++k) {
+            s[k] += xp;
+            if (k < 3) sy[k] += xp * y[i];
+            xp *= (double)i;
+        }
+    }
+    if (!is_parabola) {
+        const double d = s[0] * s[2] - s[1] * s[1];
+        coeff[1] = (T)((s[0] * sy[1] - s[1] * sy[0]) / d);
+        coeff[0] = (T)((sy[0] - coeff[1] * s[1]) / s[0]);
+        coeff[2] = 0;
+        return;
+    }
+    /* метод Гаусса для матрицы 3 x 3 */
+    double m[3][4] = {
+        {s[0], s[1], s[2], sy[0]},
+        {s[1], s[2], s[3], sy[1]},
+        {s[2], s[3], s[4], sy[2]}};
+    for (size_t c = 0; c < 3; ++c) {
+        for (size_t r = c + 1; r < 3; ++r) {
+            const double f = m[r][c] / m[c][c];
+            for (size_t k = c; k < 4; ++k) m[r][k] -= f * m[c][k];
+        }
+    }
+    double x[3];
+    for (int r = 2; r >= 0; --r) {
+        double v = m[r][3];
+        for (size_t k = r + 1; k < 3; ++k) v -= m[r][k] * x[k];
+        x[r] = v / m[r][r];
+    }
+    for (size_t k = 0; k < 3; ++k) coeff[k] = (T)x[k];
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+    std::array<double, 20> test_data = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19};
+
+    const size_t period = 4;
+    xtechnical::RollingRegression<double> line(period);
+    xtechnical::RollingRegression<double> parabola(period, xtechnical::OlsFunctionType::PARABOLA);
+
+    for(size_t i = 0; i < test_data.size(); ++i) {
+        line.update(test_data[i]);
+        parabola.update(test_data[i] * test_data[i]);
+        std::cout
+            << "update " << test_data[i]
+            << " line " << line.get()
+            << " slope " << line.get_slope()
+            << " r2 " << line.get_r_squared()
+            << " parabola " << parabola.get()
+            << " curvature " << parabola.get_curvature()
+            << std::endl;
+    }
+
+    /* проверяем методы тест */
+    std::cout << "test(20)" << std::endl;
+    line.test(20);
+    std::cout << "get " << line.get() << std::endl;
+
+    std::cout << "test(10)" << std::endl;
+    line.test(10);
+    std::cout << "get " << line.get() << std::endl;
+
+    /* сравниваем с прямым расчетом МНК */
+    std::mt19937 gen(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    const size_t check_period = 30;
+    xtechnical::RollingRegression<double> line_check(check_period);
+    xtechnical::RollingRegression<double> parabola_check(check_period, xtechnical::OlsFunctionType::PARABOLA);
+    std::vector<double> prices;
+    double price = 100;
+    double max_error = 0;
+    for (size_t i = 0; i < 5000; ++i) {
+        price += noise(gen);
+        prices.push_back(price);
+        const double test_price = price + noise(gen);
+
+        parabola_check.test(test_price);
+        double test_value = parabola_check.get();
+
+        line_check.update(price);
+        parabola_check.update(price);
+        if (prices.size() < check_period) {
+            if (!std::isnan(line_check.get())) {
+                std::cout << "error! not ready " << i << std::endl;
+                return 1;
+            }
+            continue;
+        }
+
+        std::vector<double> window(prices.end() - check_period, prices.end());
+        double coeff[3];
+        calc_direct(window, false, coeff);
+        const double x_last = check_period - 1;
+        max_error = std::max(max_error, std::abs(line_check.get_slope() - coeff[1]));
+        max_error = std::max(max_error, std::abs(line_check.get() - (coeff[0] + coeff[1] * x_last)));
+        calc_direct(window, true, coeff);
+        max_error = std::max(max_error, std::abs(parabola_check.get_curvature() - coeff[2]));
+        max_error = std::max(max_error, std::abs(parabola_check.get() - (coeff[0] + coeff[1] * x_last + coeff[2] * x_last * x_last)));
+
+        if (prices.size() > check_period) {
+            std::vector<double> test_window(prices.end() - check_period - 1, prices.end() - 1);
+            test_window.erase(test_window.begin());
+            test_window.push_back(test_price);
+            calc_direct(test_window, true, coeff);
+            max_error = std::max(max_error, std::abs(test_value - (coeff[0] + coeff[1] * x_last + coeff[2] * x_last * x_last)));
+        }
+    }
+    std::cout << "max error " << max_error << std::endl;
+    if (max_error > 1e-6) {
+        std::cout << "error!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -44,5 +44,55 @@ int main(int argc, char* argv[]) {
 
     std::cout << "get_metric:\n" << SSA.get_metric() << std::endl;
 
+    /* сравниваем быстрый режим (лаговая ковариационная матрица) с JacobiSVD */
+    typedef xtechnical::SSA<double> SSAd;
+    std::mt19937 gen(42);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    std::vector<double> prices(400);
+    for (size_t i = 0; i < prices.size(); ++i) {
+        prices[i] = 1.0 + 0.001 * i + 0.1 * std::sin(2.0 * 3.14159265 * i / 20.0) + noise(gen);
+    }
+
+    const double tolerance = 1e-6;
+    double max_diff = 0;
+    const SSAd::SSAMode modes[] = {
+        SSAd::SSAMode::RestoredSeriesAddition,
+        SSAd::SSAMode::OriginalSeriesAddition,
+        SSAd::SSAMode::OriginalSeriesForecast};
+    const size_t ranks[] = {2, 4, 0};
+    for (auto mode : modes)
+    for (auto r : ranks) {
+        SSAd ssa_svd(100), ssa_fast(100, 2);
+        for (size_t i = 0; i < prices.size(); ++i) {
+            ssa_svd.update(prices[i]);
+            ssa_fast.update(prices[i]);
+            if (i < 150 || (i % 7) != 0) continue;
+            ssa_svd.calc(10, 20, 3, 5, SSAd::MetricType::None, true, mode, r, SSAd::SolverType::JacobiSVD);
+            ssa_fast.calc(10, 20, 3, 5, SSAd::MetricType::None, true, mode, r, SSAd::SolverType::LagCovariance);
+            const auto &a = ssa_svd.get_reconstructed();
+            const auto &b = ssa_fast.get_reconstructed();
+            for (size_t j = 0; j < a.size(); ++j) {
+                max_diff = std::max(max_diff, std::abs(a[j] - b[j]));
+            }
+        }
+    }
+    std::cout << "JacobiSVD vs LagCovariance max diff: " << max_diff << std::endl;
+    if (!(max_diff < tolerance)) {
+        std::cout << "error!" << std::endl;
+        return 1;
+    }
+
+    const size_t bench_len = 200;
+    Eigen::VectorXd xb(bench_len);
+    for (size_t i = 0; i < bench_len; ++i) xb(i) = prices[i];
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto f1 = SSAd::calc_ssa(xb, 10, 50, 4, SSAd::SSAMode::OriginalSeriesForecast, SSAd::SolverType::JacobiSVD);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    auto f2 = SSAd::calc_ssa(xb, 10, 50, 4, SSAd::SSAMode::OriginalSeriesForecast, SSAd::SolverType::LagCovariance);
+    auto t3 = std::chrono::high_resolution_clock::now();
+    std::cout << "JacobiSVD: " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "LagCovariance: " << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " us" << std::endl;
+    std::cout << "last forecast: " << f1(f1.size() - 1) << " " << f2(f2.size() - 1) << std::endl;
+
     return 0;
 }
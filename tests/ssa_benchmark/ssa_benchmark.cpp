@@ -0,0 +1,71 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include "xtechnical_indicators.hpp"
+
+/* задержка SSA::calc на один тик для окон M = 32..512,
+ * усреднение по нескольким периодам, 1 поток и все потоки
+ */
+int main(int argc, char* argv[]) {
+    std::cout << "Hello world!" << std::endl;
+#ifndef NO_EIGEN
+    typedef xtechnical::SSA<double> SSAd;
+
+    std::mt19937 gen(42);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    std::vector<double> prices(2048);
+    for (size_t i = 0; i < prices.size(); ++i) {
+        prices[i] = 1.0 + 0.0005 * i + 0.1 * std::sin(2.0 * 3.14159265 * i / 40.0) + noise(gen);
+    }
+
+    const size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+    const size_t horizon = 8;
+    const size_t num_period = 4;
+    const size_t rank = 4;
+
+    std::cout << "threads: " << num_threads << std::endl;
+    std::cout << std::setw(6) << "M"
+        << std::setw(16) << "solver"
+        << std::setw(10) << "threads"
+        << std::setw(16) << "us/tick" << std::endl;
+
+    const SSAd::SolverType solvers[] = {SSAd::SolverType::JacobiSVD, SSAd::SolverType::LagCovariance};
+    for (size_t M = 32; M <= 512; M *= 2) {
+        const size_t start_period = M / 8;
+        const size_t step_period = M / 16;
+        for (auto solver : solvers) {
+            const bool is_svd = solver == SSAd::SolverType::JacobiSVD;
+            /* JacobiSVD на больших окнах медленный, ограничиваем число тиков */
+            const size_t ticks = is_svd ? std::max((size_t)2, (size_t)(1024 / M)) : 32;
+            const size_t threads_list[] = {1, num_threads};
+            for (size_t t = 0; t < 2; ++t) {
+                if (t == 1 && num_threads == 1) break;
+                SSAd ssa(M, threads_list[t]);
+                size_t i = 0;
+                for (; i < M; ++i) {
+                    ssa.update(prices[i]);
+                }
+                auto t1 = std::chrono::high_resolution_clock::now();
+                for (size_t n = 0; n < ticks; ++n, ++i) {
+                    ssa.update(prices[i]);
+                    ssa.calc(horizon, start_period, num_period, step_period,
+                        SSAd::MetricType::None, false,
+                        SSAd::SSAMode::OriginalSeriesForecast, rank, solver);
+                }
+                auto t2 = std::chrono::high_resolution_clock::now();
+                const double us = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / 1000.0 / ticks;
+                std::cout << std::setw(6) << M
+                    << std::setw(16) << (is_svd ? "JacobiSVD" : "LagCovariance")
+                    << std::setw(10) << threads_list[t]
+                    << std::setw(16) << std::fixed << std::setprecision(1) << us
+                    << " forecast " << std::setprecision(5) << ssa.get_last_forecast() << std::endl;
+            }
+        }
+    }
+#endif
+    return 0;
+}